@@ -0,0 +1,173 @@
+#ifndef MOCO_BENCHMARKING_H
+#define MOCO_BENCHMARKING_H
+/* -------------------------------------------------------------------------- *
+ * OpenSim Moco: Benchmarking.h                                               *
+ * -------------------------------------------------------------------------- *
+ * Copyright (c) 2020 Stanford University and the Authors                     *
+ *                                                                            *
+ * Author(s): Christopher Dembia                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0          *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Helpers shared by the benchmark executables in this directory. The
+// benchmarks use only Moco's public interface; the time spent in Moco's
+// internal functions is obtained from the timing profile of a MocoSolution.
+
+#include <Moco/osimMoco.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <numeric>
+#include <thread>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace OpenSim {
+
+/// Peak resident memory of this process so far, in kilobytes.
+inline long long getPeakMemoryInKB() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+    return (long long)counters.PeakWorkingSetSize / 1024;
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    // macOS reports bytes.
+    return (long long)usage.ru_maxrss / 1024;
+#else
+    return (long long)usage.ru_maxrss;
+#endif
+#endif
+}
+
+struct BenchmarkResult {
+    std::string name;
+    int numThreads = 1;
+    /// Seconds, one per repetition.
+    std::vector<double> latencies;
+    /// Number of operations (e.g., function evaluations) per second.
+    double throughput = SimTK::NaN;
+    long long peakMemoryInKB = -1;
+    /// Additional quantities specific to the benchmark.
+    std::vector<std::pair<std::string, double>> metrics;
+};
+
+inline double calcPercentile(std::vector<double> values, double percentile) {
+    std::sort(values.begin(), values.end());
+    const double position = percentile / 100.0 * (values.size() - 1);
+    const auto lower = (std::size_t)std::floor(position);
+    const auto upper = std::min(lower + 1, values.size() - 1);
+    return values[lower] +
+           (position - lower) * (values[upper] - values[lower]);
+}
+
+inline void printResult(const BenchmarkResult& result) {
+    StreamFormat streamFormat(std::cout);
+    std::cout << std::left << std::setw(32) << result.name << std::right
+              << " threads: " << std::setw(2) << result.numThreads
+              << std::scientific << std::setprecision(3)
+              << "  median latency (s): "
+              << calcPercentile(result.latencies, 50)
+              << "  throughput (1/s): " << result.throughput
+              << "  peak memory (kB): " << result.peakMemoryInKB << std::endl;
+}
+
+/// The `info` strings (e.g., the model file) are written as top-level fields.
+inline void writeJSON(const std::string& filepath,
+        const std::vector<BenchmarkResult>& results,
+        const std::vector<std::pair<std::string, std::string>>& info = {}) {
+    std::ofstream file(filepath);
+    OPENSIM_THROW_IF(!file.good(), Exception,
+            format("Could not open file '%s' for writing.", filepath));
+    const auto& number = formatJSONNumber;
+    file << "{\n";
+    file << "  \"date\": \"" << getMocoFormattedDateTime(false, "ISO")
+         << "\",\n";
+    file << "  \"hardware_concurrency\": "
+         << std::thread::hardware_concurrency() << ",\n";
+    for (const auto& entry : info) {
+        file << "  \"" << entry.first << "\": \"" << entry.second << "\",\n";
+    }
+    file << "  \"benchmarks\": [\n";
+    for (int ir = 0; ir < (int)results.size(); ++ir) {
+        const auto& result = results[ir];
+        file << "    {\n";
+        file << "      \"name\": \"" << result.name << "\",\n";
+        file << "      \"threads\": " << result.numThreads << ",\n";
+        file << "      \"repetitions\": " << result.latencies.size() << ",\n";
+        file << "      \"latency_seconds\": {";
+        file << "\"min\": " << number(calcPercentile(result.latencies, 0));
+        file << ", \"median\": "
+             << number(calcPercentile(result.latencies, 50));
+        file << ", \"p90\": " << number(calcPercentile(result.latencies, 90));
+        file << ", \"p99\": " << number(calcPercentile(result.latencies, 99));
+        file << ", \"max\": " << number(calcPercentile(result.latencies, 100));
+        file << ", \"mean\": "
+             << number(std::accumulate(result.latencies.begin(),
+                               result.latencies.end(), 0.0) /
+                       result.latencies.size());
+        file << "},\n";
+        file << "      \"throughput_per_second\": " << number(result.throughput)
+             << ",\n";
+        file << "      \"peak_memory_kb\": " << result.peakMemoryInKB;
+        for (const auto& metric : result.metrics) {
+            file << ",\n      \"" << metric.first
+                 << "\": " << number(metric.second);
+        }
+        file << "\n    }" << (ir + 1 < (int)results.size() ? "," : "") << "\n";
+    }
+    file << "  ]\n";
+    file << "}\n";
+}
+
+/// Evaluate the nonlinear program's functions and their derivatives at the
+/// guess by running the optimizer for 0 iterations. The study must use
+/// MocoCasADiSolver. The timing profile of the returned solution contains the
+/// time spent in, and the number of calls to, each function.
+inline MocoSolution evaluateAtGuess(MocoStudy study) {
+    study.updSolver<MocoCasADiSolver>().set_optim_max_iterations(0);
+    return study.solve();
+}
+
+/// The mean time, in seconds, of one evaluation of the multibody system
+/// function (explicit or implicit, including kinematic constraint errors)
+/// according to the timing profile of a solution from MocoCasADiSolver. This
+/// includes the evaluations used to compute finite differences.
+inline double calcMultibodySystemLatency(const MocoSolution& solution) {
+    for (const std::string mode : {"explicit", "implicit"}) {
+        const std::string name = "function_" + mode + "_multibody_system";
+        const auto names = solution.getTimingEntryNames();
+        if (std::find(names.begin(), names.end(), name) != names.end()) {
+            return solution.getTimingEntryDuration(name) /
+                   solution.getTimingEntryNumCalls(name);
+        }
+    }
+    OPENSIM_THROW(Exception,
+            "Expected the solution's timing profile to contain the multibody "
+            "system function.");
+}
+
+} // namespace OpenSim
+
+#endif // MOCO_BENCHMARKING_H
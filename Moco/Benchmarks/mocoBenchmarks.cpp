@@ -0,0 +1,307 @@
+/* -------------------------------------------------------------------------- *
+ * OpenSim Moco: mocoBenchmarks.cpp                                           *
+ * -------------------------------------------------------------------------- *
+ * Copyright (c) 2020 Stanford University and the Authors                     *
+ *                                                                            *
+ * Author(s): Christopher Dembia                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0          *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Performance benchmarks for Moco. Build the moco_benchmarks target and run it
+// from its build directory (which contains the model and data files):
+//
+//     moco_benchmarks [--filter <substring>] [--threads <n1,n2,...>]
+//                     [--repetitions <n>] [--output <file.json>]
+//
+// Each problem is benchmarked at three levels:
+//   point/<problem>   evaluating the multibody system function at a single
+//                     time point (the mean over the evaluations performed to
+//                     compute the NLP functions at the guess);
+//   nlp/<problem>     evaluating the NLP constraints and constraint Jacobian
+//                     once (IPOPT with 0 iterations);
+//   solve/<problem>   solving the problem completely.
+// The nlp and solve benchmarks are repeated for each thread count (the
+// MocoCasADiSolver `parallel` property). For each benchmark, we report
+// latency statistics, throughput, and the peak resident memory of the
+// process so far. Results are printed and written as JSON for tracking
+// trends; all settings are fixed so that results are comparable over time.
+
+#include "Benchmarking.h"
+
+#include <Moco/osimMoco.h>
+
+#include <OpenSim/Actuators/CoordinateActuator.h>
+#include <OpenSim/Simulation/SimbodyEngine/SliderJoint.h>
+
+#include <numeric>
+#include <thread>
+
+using namespace OpenSim;
+
+// Problems.
+// =========
+
+MocoStudy createSlidingMassStudy() {
+    Model model;
+    model.setName("sliding_mass");
+    model.set_gravity(SimTK::Vec3(0, 0, 0));
+    auto* body = new Body("body", 10.0, SimTK::Vec3(0), SimTK::Inertia(0));
+    model.addComponent(body);
+    auto* joint = new SliderJoint("slider", model.getGround(), *body);
+    auto& coord = joint->updCoordinate(SliderJoint::Coord::TranslationX);
+    coord.setName("position");
+    model.addComponent(joint);
+    auto* actu = new CoordinateActuator();
+    actu->setCoordinate(&coord);
+    actu->setName("actuator");
+    actu->setOptimalForce(1);
+    model.addComponent(actu);
+
+    MocoStudy study;
+    study.setName("sliding_mass");
+    MocoProblem& problem = study.updProblem();
+    problem.setModelCopy(model);
+    problem.setTimeBounds(0, {0, 5});
+    problem.setStateInfo("/slider/position/value", {-5, 5}, 0, 1);
+    problem.setStateInfo("/slider/position/speed", {-50, 50}, 0, 0);
+    problem.setControlInfo("/actuator", {-50, 50});
+    problem.addGoal<MocoFinalTimeGoal>();
+    auto& solver = study.initCasADiSolver();
+    solver.set_num_mesh_intervals(50);
+    return study;
+}
+
+MocoStudy create2DWalkingStudy() {
+    MocoTrack track;
+    track.setName("walking_2d");
+    track.setModel(ModelProcessor("2D_gait.osim"));
+    track.setStatesReference(
+            TableProcessor("referenceCoordinates.sto") | TabOpLowPassFilter(6));
+    track.set_states_global_tracking_weight(10.0);
+    track.set_allow_unused_references(true);
+    track.set_track_reference_position_derivatives(true);
+    track.set_apply_tracked_states_to_guess(true);
+    track.set_initial_time(0.0);
+    track.set_final_time(0.47008941);
+    MocoStudy study = track.initialize();
+    auto& solver = study.updSolver<MocoCasADiSolver>();
+    solver.set_num_mesh_intervals(25);
+    solver.set_optim_convergence_tolerance(1e-4);
+    solver.set_optim_constraint_tolerance(1e-4);
+    return study;
+}
+
+MocoStudy createInverseStudy() {
+    MocoInverse inverse;
+    inverse.setName("inverse_18musc");
+    inverse.setModel(ModelProcessor("subject_walk_armless_18musc.osim") |
+                     ModOpReplaceJointsWithWelds(
+                             {"subtalar_r", "subtalar_l", "mtp_r", "mtp_l"}) |
+                     ModOpReplaceMusclesWithDeGrooteFregly2016() |
+                     ModOpIgnorePassiveFiberForcesDGF() |
+                     ModOpTendonComplianceDynamicsModeDGF("implicit") |
+                     ModOpAddExternalLoads(
+                             "subject_walk_armless_external_loads.xml"));
+    inverse.setKinematics(
+            TableProcessor("subject_walk_armless_coordinates.mot") |
+            TabOpLowPassFilter(6));
+    inverse.set_initial_time(0.450);
+    inverse.set_final_time(1.0);
+    inverse.set_kinematics_allow_extra_columns(true);
+    inverse.set_mesh_interval(0.05);
+    return inverse.initialize();
+}
+
+MocoStudy createTrackStudy() {
+    MocoTrack track;
+    track.setName("track_gait1018");
+    // Keep the muscles (with implicit tendon compliance dynamics) so that
+    // this benchmarks muscle-driven tracking; the small reserves only help
+    // the problem converge.
+    track.setModel(ModelProcessor("testGait10dof18musc_subject01.osim") |
+                   ModOpReplaceMusclesWithDeGrooteFregly2016() |
+                   ModOpIgnorePassiveFiberForcesDGF() |
+                   ModOpTendonComplianceDynamicsModeDGF("implicit") |
+                   ModOpAddReserves(10) |
+                   ModOpAddExternalLoads("walk_gait1018_subject01_grf.xml"));
+    track.setStatesReference(
+            TableProcessor("walk_gait1018_state_reference.mot") |
+            TabOpLowPassFilter(6));
+    track.set_initial_time(0.01);
+    track.set_final_time(1.3);
+    return track.initialize();
+}
+
+// Benchmarks.
+// ===========
+
+/// Time the multibody system function (explicit or implicit, including
+/// kinematic constraint errors) at the time points of the guess, as evaluated
+/// while computing the NLP functions and their derivatives. Each latency is
+/// the mean over the evaluations in one repetition.
+BenchmarkResult benchmarkPointEvaluation(
+        const std::string& name, MocoStudy study, int repetitions) {
+    study.updSolver<MocoCasADiSolver>().set_parallel(0);
+
+    BenchmarkResult result;
+    result.name = "point/" + name;
+    for (int i = 0; i < repetitions; ++i) {
+        result.latencies.push_back(
+                calcMultibodySystemLatency(evaluateAtGuess(study)));
+    }
+    result.throughput = repetitions /
+                        std::accumulate(result.latencies.begin(),
+                                result.latencies.end(), 0.0);
+    result.peakMemoryInKB = getPeakMemoryInKB();
+    return result;
+}
+
+/// Evaluate the NLP functions at the initial guess by running IPOPT for 0
+/// iterations; the latency is that of one evaluation of the constraint
+/// Jacobian.
+BenchmarkResult benchmarkNLPEvaluation(const std::string& name,
+        MocoStudy study, int numThreads, int repetitions) {
+    study.updSolver<MocoCasADiSolver>().set_parallel(numThreads);
+
+    BenchmarkResult result;
+    result.name = "nlp/" + name;
+    result.numThreads = numThreads;
+    double constraintTime = 0;
+    int numConstraintCalls = 0;
+    for (int i = 0; i < repetitions; ++i) {
+        const MocoSolution solution = evaluateAtGuess(study);
+        const int numCalls = solution.getTimingEntryNumCalls("nlp_jac_g");
+        result.latencies.push_back(
+                solution.getTimingEntryDuration("nlp_jac_g") / numCalls);
+        constraintTime += solution.getTimingEntryDuration("nlp_g");
+        numConstraintCalls += solution.getTimingEntryNumCalls("nlp_g");
+    }
+    result.throughput = 1.0 / calcPercentile(result.latencies, 50);
+    result.metrics.emplace_back(
+            "constraints_latency_seconds", constraintTime / numConstraintCalls);
+    result.peakMemoryInKB = getPeakMemoryInKB();
+    return result;
+}
+
+/// Solve the problem; the throughput is the number of multibody system
+/// evaluations per second.
+BenchmarkResult benchmarkSolve(const std::string& name, MocoStudy study,
+        int numThreads, int repetitions) {
+    auto& solver = study.updSolver<MocoCasADiSolver>();
+    solver.set_parallel(numThreads);
+
+    BenchmarkResult result;
+    result.name = "solve/" + name;
+    result.numThreads = numThreads;
+    MocoSolution solution;
+    for (int i = 0; i < repetitions; ++i) {
+        // Report failed solves as well.
+        solution = study.solve().unseal();
+        result.latencies.push_back(solution.getSolverDuration());
+    }
+    double numEvaluations = 0;
+    double nlpSolveTime = solution.getTimingEntryDuration("nlp_solve");
+    for (const auto& entry : solution.getTimingEntryNames()) {
+        if (entry.find("function_") == 0 &&
+                entry.find("multibody_system") != std::string::npos) {
+            numEvaluations += solution.getTimingEntryNumCalls(entry);
+        }
+    }
+    result.throughput = numEvaluations / nlpSolveTime;
+    result.metrics.emplace_back("success", solution.success());
+    result.metrics.emplace_back("iterations", solution.getNumIterations());
+    result.metrics.emplace_back("objective", solution.getObjective());
+    result.metrics.emplace_back("optimizer_seconds",
+            solution.getTimingEntryDuration("optimizer"));
+    result.peakMemoryInKB = getPeakMemoryInKB();
+    return result;
+}
+
+int main(int argc, char* argv[]) {
+    std::string filter;
+    std::string output = "moco_benchmarks.json";
+    int repetitions = 1;
+    std::vector<int> threadCounts;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        OPENSIM_THROW_IF(i + 1 == argc, Exception,
+                format("Expected a value after '%s'.", arg));
+        const std::string value = argv[++i];
+        if (arg == "--filter") {
+            filter = value;
+        } else if (arg == "--output") {
+            output = value;
+        } else if (arg == "--repetitions") {
+            repetitions = std::stoi(value);
+        } else if (arg == "--threads") {
+            std::stringstream ss(value);
+            std::string count;
+            while (std::getline(ss, count, ',')) {
+                threadCounts.push_back(std::stoi(count));
+            }
+        } else {
+            OPENSIM_THROW(
+                    Exception, format("Unrecognized argument '%s'.", arg));
+        }
+    }
+    if (threadCounts.empty()) {
+        const int maxThreads =
+                std::max(1, (int)std::thread::hardware_concurrency());
+        for (int n = 1; n < maxThreads; n *= 2) threadCounts.push_back(n);
+        threadCounts.push_back(maxThreads);
+    }
+
+    const std::vector<std::pair<std::string, MocoStudy (*)()>> problems{
+            {"sliding_mass", &createSlidingMassStudy},
+            {"walking_2d", &create2DWalkingStudy},
+            {"inverse_18musc", &createInverseStudy},
+            {"track_gait1018", &createTrackStudy}};
+    const auto selected = [&filter](const std::string& name) -> bool {
+        return filter.empty() || name.find(filter) != std::string::npos;
+    };
+
+    std::vector<BenchmarkResult> results;
+    const auto record = [&results](BenchmarkResult result) {
+        printResult(result);
+        results.push_back(std::move(result));
+    };
+    for (const auto& problem : problems) {
+        const std::string& name = problem.first;
+        if (!selected("point/" + name) && !selected("nlp/" + name) &&
+                !selected("solve/" + name)) {
+            continue;
+        }
+        MocoStudy study = problem.second();
+        study.set_write_solution("false");
+        auto& solver = study.updSolver<MocoCasADiSolver>();
+        solver.set_verbosity(0);
+
+        if (selected("point/" + name)) {
+            record(benchmarkPointEvaluation(name, study, 5 * repetitions));
+        }
+        for (const int numThreads : threadCounts) {
+            if (selected("nlp/" + name)) {
+                record(benchmarkNLPEvaluation(
+                        name, study, numThreads, 5 * repetitions));
+            }
+        }
+        for (const int numThreads : threadCounts) {
+            if (selected("solve/" + name)) {
+                record(benchmarkSolve(name, study, numThreads, repetitions));
+            }
+        }
+    }
+
+    writeJSON(output, results);
+    std::cout << "Wrote " << output << "." << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,379 @@
+/* -------------------------------------------------------------------------- *
+ * OpenSim Moco: mocoRealizationBenchmarks.cpp                                *
+ * -------------------------------------------------------------------------- *
+ * Copyright (c) 2020 Stanford University and the Authors                     *
+ *                                                                            *
+ * Author(s): Christopher Dembia                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0          *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Microbenchmarks of the OpenSim/Simbody realization that Moco performs each
+// time it evaluates the multibody dynamics, for any model:
+//
+//     moco_realization_benchmarks <model.osim> [--trajectory <file.sto>]
+//                                 [--num-points <n>] [--repetitions <n>]
+//                                 [--output <file.json>]
+//
+// The inputs are the time points of a random guess (within the default
+// bounds) or, with --trajectory, of a MocoTrajectory (e.g., a solution) for
+// the model. For both multibody dynamics modes, we time:
+//   moco/<mode>                   the multibody system function that
+//                                 MocoCasADiSolver evaluates, including Moco's
+//                                 overhead (MocoProblemRep jar, copying the
+//                                 input), from the timing profile of
+//                                 evaluating the NLP functions at the guess;
+//   stage/<mode>/<order>/<stage>  each stage of the same call sequence
+//                                 (setting the state, realizeAcceleration()
+//                                 and, in implicit mode, findMotionForces()),
+//                                 performed directly on a MocoProblemRep.
+// The order in which the stages' time points are evaluated affects how much
+// of the working set is still in the processor's caches:
+//   repeated    the first time point, over and over;
+//   sequential  the time points in order, as during transcription;
+//   shuffled    the time points in a fixed random order.
+// Implicit mode adds variables and constraints to the optimal control
+// problem, so a cheaper evaluation does not by itself mean a faster solve;
+// use these results together with those of moco_benchmarks.
+
+#include "Benchmarking.h"
+
+#include <Moco/MocoProblemRep.h>
+#include <Moco/osimMoco.h>
+
+#include <random>
+
+using namespace OpenSim;
+
+/// Input for one time point of the stage benchmarks.
+struct PointInput {
+    double time;
+    SimTK::Vector y;
+    SimTK::Vector controls;
+    SimTK::Vector multipliers;
+    SimTK::Vector udot;
+    SimTK::Vector auxiliaryDerivatives;
+};
+
+const std::vector<std::string> stageNames{"set_state", "realize_position",
+        "realize_velocity", "set_controls", "constraint_forces",
+        "realize_dynamics", "realize_acceleration", "find_motion_forces"};
+
+std::vector<PointInput> createPointInputs(
+        const MocoTrajectory& guess, const MocoProblemRep& rep) {
+    const auto& model = rep.getModelBase();
+    const auto yIndexMap = createSystemYIndexMap(model);
+    const auto controlIndexMap = createSystemControlIndexMap(model);
+    const int nq = rep.getStateBase().getNQ();
+    const int nu = rep.getStateBase().getNU();
+
+
+    std::vector<PointInput> inputs(guess.getNumTimes());
+    for (int itime = 0; itime < guess.getNumTimes(); ++itime) {
+        auto& input = inputs[itime];
+        input.time = guess.getTime()[itime];
+        input.y = rep.getStateBase().getY();
+        for (int is = 0; is < (int)guess.getStateNames().size(); ++is) {
+            input.y[yIndexMap.at(guess.getStateNames()[is])] =
+                    guess.getStatesTrajectory()(itime, is);
+        }
+        input.controls = SimTK::Vector(model.getNumControls(), 0.0);
+        for (int ic = 0; ic < (int)guess.getControlNames().size(); ++ic) {
+            input.controls[controlIndexMap.at(guess.getControlNames()[ic])] =
+                    guess.getControlsTrajectory()(itime, ic);
+        }
+        input.multipliers = ~guess.getMultipliersTrajectory()[itime];
+
+        // The derivatives are the generalized accelerations followed by the
+        // derivatives for components with implicit dynamics.
+        input.udot = SimTK::Vector(nu, 0.0);
+        std::vector<double> auxiliaryDerivatives;
+        const auto& derivNames = guess.getDerivativeNames();
+        for (int id = 0; id < (int)derivNames.size(); ++id) {
+            const double value = guess.getDerivativesTrajectory()(itime, id);
+            const auto leafpos = derivNames[id].rfind("/accel");
+            if (leafpos != std::string::npos &&
+                    leafpos + 6 == derivNames[id].size()) {
+                const std::string speedName =
+                        derivNames[id].substr(0, leafpos) + "/speed";
+                input.udot[yIndexMap.at(speedName) - nq] = value;
+            } else {
+                auxiliaryDerivatives.push_back(value);
+            }
+        }
+        input.auxiliaryDerivatives = SimTK::Vector(
+                (int)auxiliaryDerivatives.size(), auxiliaryDerivatives.data());
+    }
+    return inputs;
+}
+
+std::vector<int> createOrder(const std::string& order, int numPoints) {
+    std::vector<int> indices(numPoints);
+    std::iota(indices.begin(), indices.end(), 0);
+    if (order == "repeated") {
+        std::fill(indices.begin(), indices.end(), 0);
+    } else if (order == "shuffled") {
+        std::mt19937 generator(0);
+        std::shuffle(indices.begin(), indices.end(), generator);
+    }
+    return indices;
+}
+
+/// Time the multibody system function that MocoCasADiSolver evaluates, by
+/// evaluating the NLP functions at the study's guess. Each latency is the mean
+/// over the evaluations in one repetition.
+BenchmarkResult benchmarkMoco(
+        const std::string& mode, const MocoStudy& study, int repetitions) {
+    // Warm up.
+    evaluateAtGuess(study);
+    BenchmarkResult result;
+    result.name = "moco/" + mode;
+    for (int irep = 0; irep < repetitions; ++irep) {
+        result.latencies.push_back(
+                calcMultibodySystemLatency(evaluateAtGuess(study)));
+    }
+    result.throughput = result.latencies.size() /
+                        std::accumulate(result.latencies.begin(),
+                                result.latencies.end(), 0.0);
+    result.peakMemoryInKB = getPeakMemoryInKB();
+    return result;
+}
+
+/// Time each stage of the sequence of calls that MocoCasADiSolver makes to
+/// evaluate the multibody system. The stages are reordered slightly so that
+/// each realization stage can be timed on its own; the work is the same.
+/// The last result is the total.
+std::vector<BenchmarkResult> benchmarkStages(const std::string& mode,
+        const std::string& order, const MocoProblemRep& rep,
+        const std::vector<PointInput>& inputs, int repetitions) {
+    const bool implicit = mode == "implicit";
+    const auto& modelBase = rep.getModelBase();
+    auto& stateBase = rep.updStateBase();
+    const auto& modelDisabledConstraints = rep.getModelDisabledConstraints();
+    auto& stateDisabledConstraints = rep.updStateDisabledConstraints();
+    const auto& matterDisabledConstraints =
+            modelDisabledConstraints.getMatterSubsystem();
+    const auto& implicitRefs = rep.getImplicitComponentReferencePtrs();
+    OPENSIM_THROW_IF(stateBase.getNY() != stateDisabledConstraints.getNY(),
+            Exception,
+            "Expected the base model and the model with disabled constraints "
+            "to have the same number of state variables.");
+
+    SimTK::Vector_<SimTK::SpatialVec> constraintBodyForces;
+    SimTK::Vector constraintMobilityForces;
+    SimTK::Vector residual(stateDisabledConstraints.getNU(), 0.0);
+    const int numStages = (int)stageNames.size();
+    std::vector<long long> times(numStages + 1);
+    const auto evaluate = [&](const PointInput& input) {
+        // set_state
+        times[0] = SimTK::realTimeInNs();
+        modelBase.getSystem().prescribe(stateBase);
+        modelDisabledConstraints.getSystem().prescribe(
+                stateDisabledConstraints);
+        if (implicit) {
+            const auto& accel = rep.getAccelerationMotion();
+            accel.setEnabled(stateDisabledConstraints, true);
+            accel.setUDot(stateDisabledConstraints, input.udot);
+        }
+        for (int i = 0; i < (int)implicitRefs.size(); ++i) {
+            implicitRefs[i].second->setDiscreteVariableValue(
+                    stateDisabledConstraints, implicitRefs[i].first,
+                    input.auxiliaryDerivatives[i]);
+        }
+        for (auto* state : {&stateBase, &stateDisabledConstraints}) {
+            state->setTime(input.time);
+            state->updY() = input.y;
+        }
+        modelBase.getSystem().prescribe(stateBase);
+        modelDisabledConstraints.getSystem().prescribe(
+                stateDisabledConstraints);
+
+        // realize_position
+        times[1] = SimTK::realTimeInNs();
+        modelBase.realizePosition(stateBase);
+        modelDisabledConstraints.realizePosition(stateDisabledConstraints);
+
+        // realize_velocity
+        times[2] = SimTK::realTimeInNs();
+        modelBase.realizeVelocity(stateBase);
+        modelDisabledConstraints.realizeVelocity(stateDisabledConstraints);
+
+        // set_controls
+        times[3] = SimTK::realTimeInNs();
+        for (const Model* model : {&modelBase, &modelDisabledConstraints}) {
+            auto& state = model == &modelBase ? stateBase
+                                              : stateDisabledConstraints;
+            auto& controls = model->updControls(state);
+            controls = input.controls;
+            model->realizeVelocity(state);
+            model->setControls(state, controls);
+        }
+
+        // constraint_forces
+        times[4] = SimTK::realTimeInNs();
+        if (input.multipliers.size()) {
+            modelBase.realizeVelocity(stateBase);
+            modelBase.getMatterSubsystem().calcConstraintForcesFromMultipliers(
+                    stateBase, -input.multipliers, constraintBodyForces,
+                    constraintMobilityForces);
+            rep.getConstraintForces().setAllForces(stateDisabledConstraints,
+                    constraintMobilityForces, constraintBodyForces);
+        }
+
+        // realize_dynamics
+        times[5] = SimTK::realTimeInNs();
+        modelDisabledConstraints.realizeDynamics(stateDisabledConstraints);
+
+        // realize_acceleration
+        times[6] = SimTK::realTimeInNs();
+        modelDisabledConstraints.realizeAcceleration(stateDisabledConstraints);
+
+        // find_motion_forces
+        times[7] = SimTK::realTimeInNs();
+        if (implicit) {
+            matterDisabledConstraints.findMotionForces(
+                    stateDisabledConstraints, residual);
+        }
+        times[8] = SimTK::realTimeInNs();
+    };
+
+    const auto indices = createOrder(order, (int)inputs.size());
+    // Warm up.
+    for (const int index : indices) evaluate(inputs[index]);
+
+    std::vector<BenchmarkResult> results(numStages + 1);
+    for (int irep = 0; irep < repetitions; ++irep) {
+        for (const int index : indices) {
+            evaluate(inputs[index]);
+            for (int istage = 0; istage < numStages; ++istage) {
+                results[istage].latencies.push_back(SimTK::nsToSec(
+                        times[istage + 1] - times[istage]));
+            }
+            results.back().latencies.push_back(
+                    SimTK::nsToSec(times[numStages] - times[0]));
+        }
+    }
+    for (int i = 0; i < (int)results.size(); ++i) {
+        auto& result = results[i];
+        result.name = "stage/" + mode + "/" + order + "/" +
+                      (i < numStages ? stageNames[i] : "total");
+        result.throughput = result.latencies.size() /
+                            std::accumulate(result.latencies.begin(),
+                                    result.latencies.end(), 0.0);
+        result.peakMemoryInKB = getPeakMemoryInKB();
+    }
+    return results;
+}
+
+int main(int argc, char* argv[]) {
+    OPENSIM_THROW_IF(argc < 2 || std::string(argv[1]).find("--") == 0,
+            Exception,
+            "Usage: moco_realization_benchmarks <model.osim> "
+            "[--trajectory <file.sto>] [--num-points <n>] "
+            "[--repetitions <n>] [--output <file.json>]");
+    const std::string modelFile = argv[1];
+    std::string trajectoryFile;
+    std::string output = "moco_realization_benchmarks.json";
+    int numPoints = 101;
+    int repetitions = 10;
+    for (int i = 2; i < argc; ++i) {
+        const std::string arg = argv[i];
+        OPENSIM_THROW_IF(i + 1 == argc, Exception,
+                format("Expected a value after '%s'.", arg));
+        const std::string value = argv[++i];
+        if (arg == "--trajectory") {
+            trajectoryFile = value;
+        } else if (arg == "--num-points") {
+            numPoints = std::stoi(value);
+        } else if (arg == "--repetitions") {
+            repetitions = std::stoi(value);
+        } else if (arg == "--output") {
+            output = value;
+        } else {
+            OPENSIM_THROW(
+                    Exception, format("Unrecognized argument '%s'.", arg));
+        }
+    }
+    OPENSIM_THROW_IF(numPoints < 2, Exception,
+            format("Expected at least 2 points, but got %i.", numPoints));
+
+    MocoStudy study;
+    MocoProblem& problem = study.updProblem();
+    problem.setModel(make_unique<Model>(modelFile));
+    std::unique_ptr<MocoTrajectory> trajectory;
+    if (trajectoryFile.empty()) {
+        problem.setTimeBounds(0, 1);
+    } else {
+        trajectory = make_unique<MocoTrajectory>(trajectoryFile);
+        problem.setTimeBounds(
+                trajectory->getInitialTime(), trajectory->getFinalTime());
+    }
+    study.set_write_solution("false");
+    auto& solver = study.initCasADiSolver();
+    solver.set_transcription_scheme("trapezoidal");
+    solver.set_num_mesh_intervals(numPoints - 1);
+    solver.set_parallel(0);
+    solver.set_verbosity(0);
+
+    std::vector<BenchmarkResult> results;
+    std::vector<std::pair<std::string, double>> summary;
+    for (const std::string mode : {"explicit", "implicit"}) {
+        solver.set_multibody_dynamics_mode(mode);
+        solver.resetProblem(problem);
+
+        MocoTrajectory guess = solver.createGuess(
+                trajectory ? "bounds" : "random");
+        if (trajectory) {
+            guess.insertStatesTrajectory(
+                    trajectory->exportToStatesTable(), true);
+            guess.insertControlsTrajectory(
+                    trajectory->exportToControlsTable(), true);
+        }
+
+        solver.setGuess(guess);
+
+        results.push_back(benchmarkMoco(mode, study, repetitions));
+        printResult(results.back());
+        const double mocoMedian = calcPercentile(results.back().latencies, 50);
+        summary.emplace_back(mode, mocoMedian);
+
+        const auto rep = problem.createRepHeap();
+        const auto inputs = createPointInputs(guess, *rep);
+        for (const std::string order :
+                {"repeated", "sequential", "shuffled"}) {
+            for (auto& result : benchmarkStages(
+                         mode, order, *rep, inputs, repetitions)) {
+                printResult(result);
+                results.push_back(std::move(result));
+            }
+            const double stageMedian =
+                    calcPercentile(results.back().latencies, 50);
+            results.back().metrics.emplace_back(
+                    "moco_overhead_seconds", mocoMedian - stageMedian);
+        }
+    }
+
+    std::cout << "\nMedian latency of the multibody system function:"
+              << std::endl;
+    for (const auto& entry : summary) {
+        std::cout << "  " << entry.first << ": " << entry.second << " s"
+                  << std::endl;
+    }
+    std::cout << "The " << (summary[1].second < summary[0].second
+                                       ? "implicit" : "explicit")
+              << " multibody dynamics mode evaluates faster for this model."
+              << std::endl;
+
+    writeJSON(output, results,
+            {{"model", modelFile}, {"trajectory", trajectoryFile}});
+    std::cout << "Wrote " << output << "." << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -11,6 +11,7 @@
 #include <Moco/Components/MultivariatePolynomialFunction.h>
 #include <Moco/Components/PositionMotion.h>
 #include <Moco/Components/SmoothSphereHalfSpaceForce.h>
+#include <Moco/Components/SmoothMultiSphereHalfSpaceForce.h>
 #include <Moco/MocoBounds.h>
 #include <Moco/MocoCasADiSolver/MocoCasADiSolver.h>
 #include <Moco/MocoControlBoundConstraint.h>
@@ -203,6 +203,15 @@ namespace OpenSim {
 }
 %include <Moco/MocoTropterSolver.h>
 %include <Moco/MocoCasADiSolver/MocoCasADiSolver.h>
+
+// For MocoStudy::solveContinuation().
+%include <Moco/MocoContinuationChange.h>
+%template(StdVectorMocoContinuationChange)
+        std::vector<OpenSim::MocoContinuationChange>;
+%template(StdVectorStdVectorMocoContinuationChange)
+        std::vector<std::vector<OpenSim::MocoContinuationChange>>;
+%template(StdVectorMocoSolution) std::vector<OpenSim::MocoSolution>;
+
 %include <Moco/MocoStudy.h>
 %include <Moco/MocoStudyFactory.h>
 
@@ -222,6 +231,7 @@ moco_unique_ptr(OpenSim::PositionMotion);
 
 %include <Moco/Components/ModelFactory.h>
 %include <Moco/Components/SmoothSphereHalfSpaceForce.h>
+%include <Moco/Components/SmoothMultiSphereHalfSpaceForce.h>
 %include <Moco/Components/MultivariatePolynomialFunction.h>
 
 %include <Moco/ModelOperators.h>
@@ -22,8 +22,33 @@
 #include <OpenSim/Actuators/Thelen2003Muscle.h>
 #include <OpenSim/Simulation/Model/Model.h>
 
+#include <map>
+#include <mutex>
+
 using namespace OpenSim;
 
+namespace {
+/// Each spline depends only on the named curve and a single muscle parameter
+/// (0 if the curve has no parameters). The splines are expensive to build
+/// and are never modified, so all muscles in the process share them, rather
+/// than rebuilding them on every finalizeFromProperties() (e.g., for each copy
+/// of a model).
+std::shared_ptr<const TabulatedCubicSpline> getSharedTabulatedCurve(
+        const std::string& curveName, double parameter,
+        const std::function<TabulatedCubicSpline()>& createCurve) {
+    static std::mutex mutex;
+    static std::map<std::pair<std::string, double>,
+            std::shared_ptr<const TabulatedCubicSpline>>
+            curves;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& curve = curves[std::make_pair(curveName, parameter)];
+    if (!curve) {
+        curve = std::make_shared<const TabulatedCubicSpline>(createCurve());
+    }
+    return curve;
+}
+} // anonymous namespace
+
 const std::string DeGrooteFregly2016Muscle::STATE_ACTIVATION_NAME("activation");
 const std::string DeGrooteFregly2016Muscle::STATE_NORMALIZED_TENDON_FORCE_NAME(
         "normalized_tendon_force");
@@ -59,6 +84,7 @@ void DeGrooteFregly2016Muscle::constructProperties() {
     constructProperty_tendon_strain_at_one_norm_force(0.049);
     constructProperty_ignore_passive_fiber_force(false);
     constructProperty_tendon_compliance_dynamics_mode("explicit");
+    constructProperty_curve_evaluation_mode("analytic");
 }
 
 void DeGrooteFregly2016Muscle::extendFinalizeFromProperties() {
@@ -134,6 +160,93 @@ void DeGrooteFregly2016Muscle::extendFinalizeFromProperties() {
            (1.0 + get_tendon_strain_at_one_norm_force() - c2);
     m_isTendonDynamicsExplicit =
             get_tendon_compliance_dynamics_mode() == "explicit";
+
+    checkPropertyInSet(*this, getProperty_curve_evaluation_mode(),
+            {"analytic", "tabulated"});
+    m_useTabulatedCurves = false;
+    if (get_curve_evaluation_mode() == "tabulated") {
+        createTabulatedCurves();
+        m_useTabulatedCurves = true;
+    }
+}
+
+void DeGrooteFregly2016Muscle::createTabulatedCurves() {
+    // The splines are fit to the analytic curves, so this must be invoked
+    // while m_useTabulatedCurves is false.
+    const double& scale = get_active_force_width_scale();
+    m_activeForceLengthCurve =
+            getSharedTabulatedCurve("active_force_length", scale, [this]() {
+                return TabulatedCubicSpline(
+                        [this](double x) {
+                            return calcActiveForceLengthMultiplier(x);
+                        },
+                        [this](double x) {
+                            return calcActiveForceLengthMultiplierDerivative(
+                                    x);
+                        },
+                        m_minNormFiberLength, m_maxNormFiberLength);
+            });
+    m_passiveForceLengthCurve.reset();
+    if (!get_ignore_passive_fiber_force()) {
+        m_passiveForceLengthCurve = getSharedTabulatedCurve(
+                "passive_force_length", 0, [this]() {
+                    return TabulatedCubicSpline(
+                            [this](double x) {
+                                return calcPassiveForceMultiplier(x);
+                            },
+                            [this](double x) {
+                                return calcPassiveForceMultiplierDerivative(x);
+                            },
+                            m_minNormFiberLength, m_maxNormFiberLength);
+                });
+    }
+    m_forceVelocityCurve =
+            getSharedTabulatedCurve("force_velocity", 0, []() {
+                return TabulatedCubicSpline(
+                        [](double v) { return calcForceVelocityMultiplier(v); },
+                        [](double v) {
+                            return d1 * d2 /
+                                   sqrt(SimTK::square(d2 * v + d3) + 1.0);
+                        },
+                        -1.0, 1.0);
+            });
+    m_forceVelocityInverseCurve = getSharedTabulatedCurve(
+            "force_velocity_inverse", 0, []() {
+                return TabulatedCubicSpline(
+                        [](double f) {
+                            return calcForceVelocityInverseCurve(f);
+                        },
+                        [](double f) {
+                            return cosh(1.0 / d1 * (f - d4)) / (d1 * d2);
+                        },
+                        0.0, calcForceVelocityMultiplier(1.0));
+            });
+    // The tendon curves depend on kT, which is computed from
+    // tendon_strain_at_one_norm_force.
+    m_tendonForceLengthCurve =
+            getSharedTabulatedCurve("tendon_force_length", m_kT, [this]() {
+                return TabulatedCubicSpline(
+                        [this](double x) {
+                            return calcTendonForceMultiplier(x);
+                        },
+                        [this](double x) {
+                            return calcTendonForceMultiplierDerivative(x);
+                        },
+                        calcTendonForceLengthInverseCurve(
+                                getMinNormalizedTendonForce()),
+                        calcTendonForceLengthInverseCurve(
+                                getMaxNormalizedTendonForce()));
+            });
+    m_tendonForceLengthInverseCurve = getSharedTabulatedCurve(
+            "tendon_force_length_inverse", m_kT, [this]() {
+                return TabulatedCubicSpline(
+                        [this](double f) {
+                            return calcTendonForceLengthInverseCurve(f);
+                        },
+                        [this](double f) { return 1.0 / (m_kT * (f + c3)); },
+                        getMinNormalizedTendonForce(),
+                        getMaxNormalizedTendonForce());
+            });
 }
 
 void DeGrooteFregly2016Muscle::extendAddToSystem(
@@ -182,23 +295,8 @@ void DeGrooteFregly2016Muscle::computeStateVariableDerivatives(
     // Activation dynamics.
     // --------------------
     if (!get_ignore_activation_dynamics()) {
-        const auto& activation = getActivation(s);
-        const auto& excitation = getControl(s);
-        static const double actTimeConst = get_activation_time_constant();
-        static const double deactTimeConst = get_deactivation_time_constant();
-        static const double tanhSteepness = 0.1;
-        //     f = 0.5 tanh(b(e - a))
-        //     z = 0.5 + 1.5a
-        // da/dt = [(f + 0.5)/(tau_a * z) + (-f + 0.5)*z/tau_d] * (e - a)
-        const SimTK::Real timeConstFactor = 0.5 + 1.5 * activation;
-        const SimTK::Real tempAct = 1.0 / (actTimeConst * timeConstFactor);
-        const SimTK::Real tempDeact = timeConstFactor / deactTimeConst;
-        const SimTK::Real f =
-                0.5 * tanh(tanhSteepness * (excitation - activation));
-        const SimTK::Real timeConst =
-                tempAct * (f + 0.5) + tempDeact * (-f + 0.5);
-        const SimTK::Real derivative = timeConst * (excitation - activation);
-        setStateVariableDerivativeValue(s, STATE_ACTIVATION_NAME, derivative);
+        setStateVariableDerivativeValue(s, STATE_ACTIVATION_NAME,
+                calcActivationDerivative(getControl(s), getActivation(s)));
     }
 
     // Tendon compliance dynamics.
@@ -225,6 +323,75 @@ void DeGrooteFregly2016Muscle::computeStateVariableDerivatives(
     }
 }
 
+SimTK::Real DeGrooteFregly2016Muscle::calcActivationDerivative(
+        const SimTK::Real& excitation, const SimTK::Real& activation) const {
+    const double& actTimeConst = get_activation_time_constant();
+    const double& deactTimeConst = get_deactivation_time_constant();
+    const double tanhSteepness = 0.1;
+    //     f = 0.5 tanh(b(e - a))
+    //     z = 0.5 + 1.5a
+    // da/dt = [(f + 0.5)/(tau_a * z) + (-f + 0.5)*z/tau_d] * (e - a)
+    const SimTK::Real timeConstFactor = 0.5 + 1.5 * activation;
+    const SimTK::Real tempAct = 1.0 / (actTimeConst * timeConstFactor);
+    const SimTK::Real tempDeact = timeConstFactor / deactTimeConst;
+    const SimTK::Real f = 0.5 * tanh(tanhSteepness * (excitation - activation));
+    const SimTK::Real timeConst = tempAct * (f + 0.5) + tempDeact * (-f + 0.5);
+    return timeConst * (excitation - activation);
+}
+
+void DeGrooteFregly2016Muscle::calcDynamicsFromKinematics(
+        const SimTK::Real& muscleTendonLength,
+        const SimTK::Real& muscleTendonVelocity, const SimTK::Real& excitation,
+        const SimTK::Real& activation, const SimTK::Real& normTendonForce,
+        const SimTK::Real& normTendonForceDerivative, SimTK::Real& tendonForce,
+        SimTK::Real& activationDerivative,
+        SimTK::Real& normTendonForceStateDerivative,
+        SimTK::Real& implicitResidual) const {
+    const bool ignoreTendonCompliance = get_ignore_tendon_compliance();
+    const SimTK::Real& act =
+            get_ignore_activation_dynamics() ? excitation : activation;
+    const SimTK::Real normTendonForceState =
+            ignoreTendonCompliance ? SimTK::NaN : normTendonForce;
+    const SimTK::Real normTendonForceDerivativeDiscrete =
+            (ignoreTendonCompliance || m_isTendonDynamicsExplicit)
+                    ? SimTK::NaN
+                    : normTendonForceDerivative;
+
+    // These mirror calcMuscleLengthInfo(), calcFiberVelocityInfo(), and
+    // calcMuscleDynamicsInfo().
+    MuscleLengthInfo mli;
+    FiberVelocityInfo fvi;
+    MuscleDynamicsInfo mdi;
+    calcMuscleLengthInfoHelper(muscleTendonLength, ignoreTendonCompliance, mli,
+            normTendonForceState);
+    calcFiberVelocityInfoHelper(muscleTendonVelocity, act,
+            ignoreTendonCompliance, m_isTendonDynamicsExplicit, mli, fvi,
+            m_isTendonDynamicsExplicit ? normTendonForceState : SimTK::NaN,
+            normTendonForceDerivativeDiscrete);
+    calcMuscleDynamicsInfoHelper(act, muscleTendonVelocity,
+            ignoreTendonCompliance, mli, fvi, mdi, normTendonForceState);
+    tendonForce = mdi.tendonForce;
+
+    // These mirror computeStateVariableDerivatives() and
+    // getImplicitResidualNormalizedTendonForce().
+    activationDerivative = get_ignore_activation_dynamics()
+                                   ? SimTK::NaN
+                                   : calcActivationDerivative(excitation, act);
+    if (ignoreTendonCompliance) {
+        normTendonForceStateDerivative = SimTK::NaN;
+        implicitResidual = 0;
+    } else if (m_isTendonDynamicsExplicit) {
+        normTendonForceStateDerivative =
+                fvi.normTendonVelocity *
+                calcTendonForceMultiplierDerivative(mli.normTendonLength);
+        implicitResidual = SimTK::NaN;
+    } else {
+        normTendonForceStateDerivative = normTendonForceDerivative;
+        implicitResidual = calcEquilibriumResidual(
+                mdi.tendonForce, mdi.fiberForceAlongTendon);
+    }
+}
+
 double DeGrooteFregly2016Muscle::computeActuation(const SimTK::State& s) const {
     const auto& mdi = getMuscleDynamicsInfo(s);
     return mdi.tendonForce;
@@ -281,7 +448,7 @@ void DeGrooteFregly2016Muscle::calcFiberVelocityInfoHelper(
                 (normFiberForce - mli.fiberPassiveForceLengthMultiplier) /
                 (activation * mli.fiberActiveForceLengthMultiplier);
         fvi.normFiberVelocity =
-                calcForceVelocityInverseCurve(fvi.fiberForceVelocityMultiplier);
+                evalForceVelocityInverseCurve(fvi.fiberForceVelocityMultiplier);
         fvi.fiberVelocity =
                 fvi.normFiberVelocity *
                 m_maxContractionVelocityInMetersPerSecond;
@@ -306,7 +473,7 @@ void DeGrooteFregly2016Muscle::calcFiberVelocityInfoHelper(
         fvi.normFiberVelocity =
                 fvi.fiberVelocity / m_maxContractionVelocityInMetersPerSecond;
         fvi.fiberForceVelocityMultiplier =
-                calcForceVelocityMultiplier(fvi.normFiberVelocity);
+                evalForceVelocityMultiplier(fvi.normFiberVelocity);
     }
 
     const SimTK::Real tanPennationAngle =
@@ -536,10 +703,18 @@ void DeGrooteFregly2016Muscle::computeInitialFiberEquilibrium(
     FiberVelocityInfo fvi;
     MuscleDynamicsInfo mdi;
 
+    // The derivative of the residual with respect to normalized tendon force
+    // is computed from the tendon and fiber stiffnesses, holding the fiber
+    // velocity fixed:
+    //   d_residual/d_normTendonForce
+    //      = maxIsometricForce
+    //        + fiberStiffnessAlongTendon * d_tendonLength/d_normTendonForce
+    //      = maxIsometricForce * (1 + fiberStiffnessAlongTendon /
+    //                                 tendonStiffness).
     auto calcResidual = [this, &muscleTendonLength, &muscleTendonVelocity,
                                 &normTendonForceDerivative, &activation, &mli,
-                                &fvi,
-                                &mdi](const SimTK::Real& normTendonForce) {
+                                &fvi, &mdi](const SimTK::Real& normTendonForce,
+                                SimTK::Real& derivative) {
         calcMuscleLengthInfoHelper(muscleTendonLength, false, mli,
                 normTendonForce);
         calcFiberVelocityInfoHelper(muscleTendonVelocity, activation, false,
@@ -547,14 +722,22 @@ void DeGrooteFregly2016Muscle::computeInitialFiberEquilibrium(
         calcMuscleDynamicsInfoHelper(activation, muscleTendonVelocity, false,
                 mli, fvi, mdi, normTendonForce);
 
+        derivative = get_max_isometric_force() *
+                     (1.0 + mdi.fiberStiffnessAlongTendon /
+                                    mdi.tendonStiffness);
         return calcEquilibriumResidual(
                 mdi.tendonForce, mdi.fiberForceAlongTendon);
     };
 
-    const auto equilNormTendonForce = solveBisection(calcResidual,
+    const auto result = solveNewtonBisection(calcResidual,
             m_minNormTendonForce, m_maxNormTendonForce, 1e-10, 100);
+    if (!result.converged) {
+        printMessage("Warning: %s did not reach fiber equilibrium after %i "
+                     "iterations (residual: %g).\n",
+                getName(), result.numIterations, result.residual);
+    }
 
-    setNormalizedTendonForce(s, equilNormTendonForce);
+    setNormalizedTendonForce(s, result.root);
 
     // TODO not working as well as bisection, revisist later.
     //const double tolerance = std::max(
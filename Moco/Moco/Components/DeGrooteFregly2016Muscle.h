@@ -110,6 +110,10 @@ public:
     OpenSim_DECLARE_PROPERTY(tendon_compliance_dynamics_mode, std::string,
             "The dynamics method used to enforce tendon compliance dynamics. "
             "Options: 'explicit' or 'implicit'. Default: 'explicit'. ");
+    OpenSim_DECLARE_PROPERTY(curve_evaluation_mode, std::string,
+            "How the force-length, force-velocity, and tendon force-length "
+            "curves are evaluated. Options: 'analytic' or 'tabulated'. "
+            "Default: 'analytic'.");
 
     OpenSim_DECLARE_OUTPUT(implicitresidual_normalized_tendon_force, double,
             getImplicitResidualNormalizedTendonForce, SimTK::Stage::Dynamics);
@@ -299,6 +303,14 @@ public:
     /// These functions compute the values of normalized/dimensionless curves,
     /// their derivatives and integrals, and other quantities of the muscle.
     /// These do not depend on a SimTK::State.
+    /// If curve_evaluation_mode is 'tabulated', the non-static curves (and
+    /// the force-velocity curves, when used internally by the muscle) are
+    /// evaluated from cubic splines within the normalized fiber length range
+    /// [0.2, 1.8], the normalized fiber velocity range [-1, 1], and the
+    /// normalized tendon force range [0, 5]. The splines are built in
+    /// finalizeFromProperties() so that the error in each curve and its
+    /// derivative is at most 1e-8 and 1e-6, respectively, relative to
+    /// (1 + |curve|). Outside these ranges, the analytic curves are used.
     /// @{
 
     /// The active force-length curve is the sum of 3 Gaussian-like curves. The
@@ -306,6 +318,10 @@ public:
     /// property.
     SimTK::Real calcActiveForceLengthMultiplier(
             const SimTK::Real& normFiberLength) const {
+        if (m_useTabulatedCurves &&
+                m_activeForceLengthCurve->isInDomain(normFiberLength)) {
+            return m_activeForceLengthCurve->calcValue(normFiberLength);
+        }
         const double& scale = get_active_force_width_scale();
         // Shift the curve so its peak is at the origin, scale it
         // horizontally, then shift it back so its peak is still at x = 1.0.
@@ -322,6 +338,10 @@ public:
     /// derivative curve.
     SimTK::Real calcActiveForceLengthMultiplierDerivative(
             const SimTK::Real& normFiberLength) const {
+        if (m_useTabulatedCurves &&
+                m_activeForceLengthCurve->isInDomain(normFiberLength)) {
+            return m_activeForceLengthCurve->calcDerivative(normFiberLength);
+        }
         const double& scale = get_active_force_width_scale();
         // Shift the curve so its peak is at the origin, scale it
         // horizontally, then shift it back so its peak is still at x = 1.0.
@@ -371,6 +391,10 @@ public:
         // supplementary materials allows for negative forces.
 
         if (get_ignore_passive_fiber_force()) return 0;
+        if (m_useTabulatedCurves &&
+                m_passiveForceLengthCurve->isInDomain(normFiberLength)) {
+            return m_passiveForceLengthCurve->calcValue(normFiberLength);
+        }
         return (exp(kPE * (normFiberLength - 1.0) / e0) - numer_offset) / denom;
     }
 
@@ -380,6 +404,10 @@ public:
             const SimTK::Real& normFiberLength) const {
 
         if (get_ignore_passive_fiber_force()) return 0;
+        if (m_useTabulatedCurves &&
+                m_passiveForceLengthCurve->isInDomain(normFiberLength)) {
+            return m_passiveForceLengthCurve->calcDerivative(normFiberLength);
+        }
         return (kPE * exp((kPE * (normFiberLength - 1)) / e0)) /
                (e0 * (exp(kPE) - 1));
     }
@@ -403,6 +431,10 @@ public:
     // TODO: In explicit mode, do not allow negative tendon forces?
     SimTK::Real calcTendonForceMultiplier(
             const SimTK::Real& normTendonLength) const {
+        if (m_useTabulatedCurves &&
+                m_tendonForceLengthCurve->isInDomain(normTendonLength)) {
+            return m_tendonForceLengthCurve->calcValue(normTendonLength);
+        }
         return c1 * exp(m_kT * (normTendonLength - c2)) - c3;
     }
 
@@ -410,6 +442,10 @@ public:
     /// normalized tendon length.
     SimTK::Real calcTendonForceMultiplierDerivative(
             const SimTK::Real& normTendonLength) const {
+        if (m_useTabulatedCurves &&
+                m_tendonForceLengthCurve->isInDomain(normTendonLength)) {
+            return m_tendonForceLengthCurve->calcDerivative(normTendonLength);
+        }
         return c1 * m_kT * exp(m_kT * (normTendonLength - c2));
     }
 
@@ -425,6 +461,10 @@ public:
     /// normalized tendon length as a function of the normalized tendon force.
     SimTK::Real calcTendonForceLengthInverseCurve(
             const SimTK::Real& normTendonForce) const {
+        if (m_useTabulatedCurves &&
+                m_tendonForceLengthInverseCurve->isInDomain(normTendonForce)) {
+            return m_tendonForceLengthInverseCurve->calcValue(normTendonForce);
+        }
         return log((1.0 / c1) * (normTendonForce + c3)) / m_kT + c2;
     }
 
@@ -435,7 +475,7 @@ public:
             const SimTK::Real& derivNormTendonForce,
             const SimTK::Real& normTendonLength) const {
         return derivNormTendonForce /
-               (c1 * m_kT * exp(m_kT * (normTendonLength - c2)));
+               calcTendonForceMultiplierDerivative(normTendonLength);
     }
 
     /// This computes both the total fiber force and the individual components
@@ -615,6 +655,30 @@ public:
                tendonStiffness *
                        (muscleTendonVelocity - fiberVelocityAlongTendon);
     }
+
+    /// Compute the tendon force, the derivatives of the state variables, and
+    /// the implicit residual from the provided muscle-tendon length and
+    /// velocity, without a SimTK::State. This is useful when the kinematics
+    /// (and therefore the muscle-tendon lengths and velocities) are known in
+    /// advance; MocoCasADiSolver uses this if the kinematics are prescribed.
+    /// The results are the same as those obtained from the state.
+    ///
+    /// The activation and normTendonForce arguments are the state variable
+    /// values, and are ignored if ignore_activation_dynamics or
+    /// ignore_tendon_compliance is true, respectively (if activation dynamics
+    /// are ignored, activation is the excitation). normTendonForceDerivative
+    /// is the discrete variable used only if tendon_compliance_dynamics_mode
+    /// is 'implicit'. The derivative of a state variable that the muscle
+    /// does not have is NaN; see getImplicitResidualNormalizedTendonForce()
+    /// for the value of implicitResidual.
+    void calcDynamicsFromKinematics(const SimTK::Real& muscleTendonLength,
+            const SimTK::Real& muscleTendonVelocity,
+            const SimTK::Real& excitation, const SimTK::Real& activation,
+            const SimTK::Real& normTendonForce,
+            const SimTK::Real& normTendonForceDerivative,
+            SimTK::Real& tendonForce, SimTK::Real& activationDerivative,
+            SimTK::Real& normTendonForceStateDerivative,
+            SimTK::Real& implicitResidual) const;
     /// @}
 
     /// @name Utilities
@@ -674,6 +738,32 @@ private:
             const SimTK::Real& normTendonForce) const;
     void calcMusclePotentialEnergyInfoHelper(const bool& ignoreTendonCompliance,
             const MuscleLengthInfo& mli, MusclePotentialEnergyInfo& mpei) const;
+    SimTK::Real calcActivationDerivative(const SimTK::Real& excitation,
+            const SimTK::Real& activation) const;
+
+    /// The force-velocity curves used by the muscle itself; these use the
+    /// tabulated curves if curve_evaluation_mode is 'tabulated'.
+    SimTK::Real evalForceVelocityMultiplier(
+            const SimTK::Real& normFiberVelocity) const {
+        if (m_useTabulatedCurves &&
+                m_forceVelocityCurve->isInDomain(normFiberVelocity)) {
+            return m_forceVelocityCurve->calcValue(normFiberVelocity);
+        }
+        return calcForceVelocityMultiplier(normFiberVelocity);
+    }
+    SimTK::Real evalForceVelocityInverseCurve(
+            const SimTK::Real& forceVelocityMult) const {
+        if (m_useTabulatedCurves &&
+                m_forceVelocityInverseCurve->isInDomain(forceVelocityMult)) {
+            return m_forceVelocityInverseCurve->calcValue(forceVelocityMult);
+        }
+        return calcForceVelocityInverseCurve(forceVelocityMult);
+    }
+
+    /// Obtain the splines used when curve_evaluation_mode is 'tabulated',
+    /// building them only if no muscle has built them for the same
+    /// parameters.
+    void createTabulatedCurves();
 
     /// This is a Gaussian-like function used in the active force-length curve.
     /// A proper Gaussian function does not have the variable in the denominator
@@ -797,6 +887,18 @@ private:
     // kT, users specify tendon strain at 1 norm force, which is more intuitive.
     SimTK::Real m_kT = SimTK::NaN;
     bool m_isTendonDynamicsExplicit = true;
+
+    // Approximations of the curves, used if curve_evaluation_mode is
+    // 'tabulated'. The splines never change once built, so copies of this
+    // muscle, and other muscles with the same curve parameters, share them.
+    bool m_useTabulatedCurves = false;
+    std::shared_ptr<const TabulatedCubicSpline> m_activeForceLengthCurve;
+    std::shared_ptr<const TabulatedCubicSpline> m_passiveForceLengthCurve;
+    std::shared_ptr<const TabulatedCubicSpline> m_forceVelocityCurve;
+    std::shared_ptr<const TabulatedCubicSpline> m_forceVelocityInverseCurve;
+    std::shared_ptr<const TabulatedCubicSpline> m_tendonForceLengthCurve;
+    std::shared_ptr<const TabulatedCubicSpline>
+            m_tendonForceLengthInverseCurve;
 };
 
 } // namespace OpenSim
@@ -18,8 +18,11 @@
 
 #include "ModelFactory.h"
 
+#include "MultivariatePolynomialFunction.h"
 #include "../MocoUtilities.h"
 
+#include <iomanip>
+
 #include <OpenSim/Actuators/CoordinateActuator.h>
 #include <OpenSim/Simulation/SimbodyEngine/PinJoint.h>
 #include <OpenSim/Simulation/SimbodyEngine/SliderJoint.h>
@@ -325,3 +328,347 @@ void ModelFactory::createReserveActuators(Model& model, double optimalForce,
     }
 }
 
+#ifdef MOCO_WITH_PATH_APPROXIMATION
+namespace {
+/// Set the values of the provided coordinates, satisfy the model's
+/// constraints (if any), and realize to Position.
+void setCoordinateValues(Model& model, SimTK::State& state,
+        const std::vector<const Coordinate*>& coordinates,
+        const SimTK::Vector& values) {
+    for (int i = 0; i < (int)coordinates.size(); ++i) {
+        coordinates[i]->setValue(state, values[i], false);
+    }
+    if (model.getConstraintSet().getSize()) model.assemble(state);
+    model.realizePosition(state);
+}
+
+/// Sample values uniformly within the range of each coordinate.
+void sampleCoordinateValues(SimTK::Random& random,
+        const std::vector<const Coordinate*>& coordinates,
+        SimTK::Vector& values) {
+    values.resize((int)coordinates.size());
+    for (int i = 0; i < (int)coordinates.size(); ++i) {
+        const double lower = coordinates[i]->getRangeMin();
+        const double upper = coordinates[i]->getRangeMax();
+        values[i] = lower + (upper - lower) * random.getValue();
+    }
+}
+
+/// Compute the muscle-tendon length and moment arms at random values of the
+/// provided coordinates. Row i of the matrices holds sample i.
+void samplePath(Model& model, SimTK::State& state, const GeometryPath& path,
+        const std::vector<const Coordinate*>& coordinates,
+        SimTK::Random& random, int numSamples, SimTK::Matrix& values,
+        SimTK::Vector& lengths, SimTK::Matrix& momentArms) {
+    const int numCoords = (int)coordinates.size();
+    values.resize(numSamples, numCoords);
+    lengths.resize(numSamples);
+    momentArms.resize(numSamples, numCoords);
+    SimTK::Vector sample;
+    for (int isample = 0; isample < numSamples; ++isample) {
+        sampleCoordinateValues(random, coordinates, sample);
+        setCoordinateValues(model, state, coordinates, sample);
+        values[isample] = ~sample;
+        lengths[isample] = path.getLength(state);
+        for (int ic = 0; ic < numCoords; ++ic) {
+            momentArms(isample, ic) =
+                    path.computeMomentArm(state, *coordinates[ic]);
+        }
+    }
+}
+
+/// Fit a polynomial to the path of the muscle. The model must be a copy that
+/// is not used by any other thread.
+ModelFactory::PolynomialPathFit fitPolynomialPath(Model& model,
+        SimTK::State& state, const Muscle& muscle,
+        const std::vector<const Coordinate*>& candidates,
+        const SimTK::Vector& defaultValues, int maxOrder,
+        double lengthTolerance, double momentArmTolerance, int numSamples,
+        int seed) {
+    ModelFactory::PolynomialPathFit fit;
+    fit.muscle = muscle.getAbsolutePathString();
+    const auto& path = muscle.getGeometryPath();
+
+    SimTK::Random::Uniform random(0, 1);
+    random.setSeed(seed);
+
+    // Detect the coordinates that the muscle spans.
+    // ---------------------------------------------
+    const int numDetectionSamples = 10;
+    const double momentArmThreshold = 1e-5;
+    std::vector<bool> spans(candidates.size(), false);
+    SimTK::Vector sample;
+    for (int isample = 0; isample < numDetectionSamples; ++isample) {
+        sampleCoordinateValues(random, candidates, sample);
+        setCoordinateValues(model, state, candidates, sample);
+        for (int ic = 0; ic < (int)candidates.size(); ++ic) {
+            if (!spans[ic] && std::abs(path.computeMomentArm(
+                                      state, *candidates[ic])) >
+                                      momentArmThreshold) {
+                spans[ic] = true;
+            }
+        }
+    }
+    // Coordinates that the muscle does not span stay at their default values.
+    setCoordinateValues(model, state, candidates, defaultValues);
+    std::vector<const Coordinate*> coordinates;
+    for (int ic = 0; ic < (int)candidates.size(); ++ic) {
+        if (spans[ic]) {
+            coordinates.push_back(candidates[ic]);
+            fit.coordinates.push_back(candidates[ic]->getAbsolutePathString());
+        }
+    }
+    const int dimension = (int)coordinates.size();
+    if (dimension == 0) {
+        fit.message = "Muscle does not span any coordinates.";
+        return fit;
+    }
+    if (dimension > 4) {
+        fit.message = format("Muscle spans %i coordinates, but at most 4 are "
+                             "supported.", dimension);
+        return fit;
+    }
+
+    // Sample the path.
+    // ----------------
+    SimTK::Matrix values;
+    SimTK::Vector lengths;
+    SimTK::Matrix momentArms;
+    samplePath(model, state, path, coordinates, random, numSamples, values,
+            lengths, momentArms);
+    SimTK::Matrix testValues;
+    SimTK::Vector testLengths;
+    SimTK::Matrix testMomentArms;
+    samplePath(model, state, path, coordinates, random,
+            std::max(numSamples / 2, 1), testValues, testLengths,
+            testMomentArms);
+
+    // Fit polynomials of increasing order.
+    // ------------------------------------
+    // Each sample provides one equation for the length and one for each
+    // moment arm, r = -dL/dq.
+    const int numEquationsPerSample = 1 + dimension;
+    double bestScore = SimTK::Infinity;
+    for (int order = 1; order <= maxOrder; ++order) {
+        const int numCoefficients =
+                SimTKMultivariatePolynomial<double>::calcNumCoefficients(
+                        dimension, order);
+        if (numSamples * numEquationsPerSample < 2 * numCoefficients) {
+            if (fit.message.empty()) {
+                fit.message = format("Too few samples to fit order %i.",
+                        order);
+            }
+            break;
+        }
+        const SimTKMultivariatePolynomial<double> basis(
+                SimTK::Vector(numCoefficients, 0.0), dimension, order);
+        SimTK::Matrix A(numSamples * numEquationsPerSample, numCoefficients);
+        SimTK::Vector b(numSamples * numEquationsPerSample);
+        SimTK::Vector point(dimension);
+        SimTK::Vector monomials;
+        SimTK::Matrix derivatives;
+        for (int isample = 0; isample < numSamples; ++isample) {
+            for (int ic = 0; ic < dimension; ++ic) {
+                point[ic] = values(isample, ic);
+            }
+            basis.calcMonomialsAndDerivatives(point, monomials, derivatives);
+            const int row = isample * numEquationsPerSample;
+            A[row] = ~monomials;
+            b[row] = lengths[isample];
+            for (int ic = 0; ic < dimension; ++ic) {
+                A[row + 1 + ic] = derivatives[ic];
+                b[row + 1 + ic] = -momentArms(isample, ic);
+            }
+        }
+        SimTK::Vector coefficients;
+        SimTK::FactorQTZ(A).solve(b, coefficients);
+
+        // Compute the errors on the test samples.
+        const SimTKMultivariatePolynomial<double> polynomial(
+                coefficients, dimension, order);
+        double lengthSumSq = 0;
+        double lengthMax = 0;
+        double momentArmSumSq = 0;
+        double momentArmMax = 0;
+        SimTK::Vector lengthDerivatives;
+        for (int isample = 0; isample < testValues.nrow(); ++isample) {
+            for (int ic = 0; ic < dimension; ++ic) {
+                point[ic] = testValues(isample, ic);
+            }
+            const double lengthError =
+                    polynomial.calcValueAndDerivatives(
+                            point, lengthDerivatives) -
+                    testLengths[isample];
+            lengthSumSq += SimTK::square(lengthError);
+            lengthMax = std::max(lengthMax, std::abs(lengthError));
+            for (int ic = 0; ic < dimension; ++ic) {
+                const double momentArmError = -lengthDerivatives[ic] -
+                                              testMomentArms(isample, ic);
+                momentArmSumSq += SimTK::square(momentArmError);
+                momentArmMax = std::max(momentArmMax, std::abs(momentArmError));
+            }
+        }
+        // Keep the best fit in case no order meets the tolerances.
+        const double score = std::max(lengthMax / lengthTolerance,
+                momentArmMax / momentArmTolerance);
+        if (score < bestScore) {
+            bestScore = score;
+            fit.order = order;
+            fit.coefficients = coefficients;
+            fit.lengthRMSError =
+                    std::sqrt(lengthSumSq / testValues.nrow());
+            fit.lengthMaxError = lengthMax;
+            fit.momentArmRMSError = std::sqrt(
+                    momentArmSumSq / (testValues.nrow() * dimension));
+            fit.momentArmMaxError = momentArmMax;
+        }
+        if (score <= 1) {
+            fit.replaced = true;
+            fit.message.clear();
+            break;
+        }
+    }
+    if (!fit.replaced && fit.message.empty()) {
+        fit.message = "Could not meet the tolerances.";
+    }
+    return fit;
+}
+} // anonymous namespace
+#endif
+
+std::vector<ModelFactory::PolynomialPathFit>
+ModelFactory::replacePathsWithPolynomials(Model& model, int maxOrder,
+        double lengthTolerance, double momentArmTolerance, int numSamples,
+        int parallel) {
+    OPENSIM_THROW_IF(maxOrder < 1, Exception,
+            format("Expected maxOrder to be at least 1, but got %i.",
+                    maxOrder));
+    OPENSIM_THROW_IF(lengthTolerance <= 0 || momentArmTolerance <= 0,
+            Exception, "Expected the tolerances to be positive.");
+    OPENSIM_THROW_IF(numSamples < 1, Exception,
+            format("Expected numSamples to be positive, but got %i.",
+                    numSamples));
+#ifndef MOCO_WITH_PATH_APPROXIMATION
+    OPENSIM_THROW(Exception,
+            "Replacing paths with polynomials requires GeometryPath's "
+            "polynomial approximation (use_approximation), which this build "
+            "of opensim-core does not provide.");
+#else
+
+    model.finalizeConnections();
+    std::vector<std::string> musclePaths;
+    for (const auto& muscle : model.getComponentList<Muscle>()) {
+        musclePaths.push_back(muscle.getAbsolutePathString());
+    }
+    std::vector<PolynomialPathFit> fits(musclePaths.size());
+    if (musclePaths.empty()) return fits;
+
+    const int numThreads =
+            getNumThreadsForParallel(parallel, (int)musclePaths.size());
+
+    std::cout << "Fitting polynomials to the paths of " << musclePaths.size()
+              << " muscle(s) using " << numThreads << " thread(s)..."
+              << std::endl;
+
+    // Each thread uses its own copy of the model. The coordinates that are
+    // unlocked and unconstrained in the default state are candidates for the
+    // coordinates spanned by each muscle. We sample the original paths, even
+    // if the model already uses polynomial approximations.
+    struct Worker {
+        std::unique_ptr<Model> model;
+        SimTK::State state;
+        std::vector<const Coordinate*> candidates;
+        SimTK::Vector defaultValues;
+    };
+    std::vector<Worker> workers(numThreads);
+    for (auto& worker : workers) {
+        worker.model.reset(new Model(model));
+        for (auto& path : worker.model->updComponentList<GeometryPath>()) {
+            path.set_use_approximation(false);
+        }
+        worker.state = worker.model->initSystem();
+        for (const auto& coord :
+                worker.model->getComponentList<Coordinate>()) {
+            if (!coord.getLocked(worker.state) &&
+                    !coord.isConstrained(worker.state)) {
+                worker.candidates.push_back(&coord);
+            }
+        }
+        worker.defaultValues.resize((int)worker.candidates.size());
+        for (int ic = 0; ic < (int)worker.candidates.size(); ++ic) {
+            worker.defaultValues[ic] =
+                    worker.candidates[ic]->getValue(worker.state);
+        }
+    }
+
+    performTasksInParallel(numThreads, (int)musclePaths.size(),
+            [&](int ithread, int imuscle) {
+                auto& worker = workers[ithread];
+                const auto& muscle = worker.model->getComponent<Muscle>(
+                        musclePaths[imuscle]);
+                try {
+                    // Seed with the muscle index so that the result does not
+                    // depend on the number of threads.
+                    fits[imuscle] = fitPolynomialPath(*worker.model,
+                            worker.state, muscle, worker.candidates,
+                            worker.defaultValues, maxOrder, lengthTolerance,
+                            momentArmTolerance, numSamples, imuscle);
+                } catch (const std::exception& e) {
+                    fits[imuscle].muscle = musclePaths[imuscle];
+                    fits[imuscle].message = e.what();
+                }
+            });
+
+    // Install the polynomials.
+    int numReplaced = 0;
+    for (const auto& fit : fits) {
+        if (!fit.replaced) {
+            std::cout << "Warning: Did not replace the path of muscle '"
+                      << fit.muscle << "': " << fit.message << std::endl;
+            continue;
+        }
+        auto& path = model.updComponent<Muscle>(fit.muscle).updGeometryPath();
+        path.set_use_approximation(true);
+        path.updProperty_length_approximation().clear();
+        path.append_length_approximation(MultivariatePolynomialFunction(
+                fit.coefficients, (int)fit.coordinates.size(), fit.order));
+        path.updProperty_approximation_coordinates().clear();
+        for (const auto& coordinate : fit.coordinates) {
+            path.append_approximation_coordinates(coordinate);
+        }
+        ++numReplaced;
+    }
+    model.finalizeFromProperties();
+    std::cout << "Replaced the paths of " << numReplaced << " of "
+              << fits.size() << " muscle(s) with polynomials." << std::endl;
+    return fits;
+#endif
+}
+
+void ModelFactory::printPolynomialPathFitReport(
+        const std::vector<PolynomialPathFit>& fits, std::ostream& stream) {
+    // Errors are reported in millimeters.
+    stream << std::left << std::setw(40) << "muscle" << std::right
+           << std::setw(6) << "order" << std::setw(10) << "length"
+           << std::setw(10) << "length" << std::setw(10) << "mom. arm"
+           << std::setw(10) << "mom. arm"
+           << "  coordinates\n";
+    stream << std::setw(46) << "" << std::setw(10) << "RMS (mm)"
+           << std::setw(10) << "max (mm)" << std::setw(10) << "RMS (mm)"
+           << std::setw(10) << "max (mm)" << "\n";
+    for (const auto& fit : fits) {
+        stream << std::left << std::setw(40) << fit.muscle << std::right
+               << std::setw(6) << fit.order << std::fixed
+               << std::setprecision(3) << std::setw(10)
+               << 1000 * fit.lengthRMSError << std::setw(10)
+               << 1000 * fit.lengthMaxError << std::setw(10)
+               << 1000 * fit.momentArmRMSError << std::setw(10)
+               << 1000 * fit.momentArmMaxError << std::defaultfloat << " ";
+        for (const auto& coordinate : fit.coordinates) {
+            stream << " " << coordinate;
+        }
+        if (!fit.replaced) stream << " (not replaced: " << fit.message << ")";
+        stream << "\n";
+    }
+    stream.flush();
+}
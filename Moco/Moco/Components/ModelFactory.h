@@ -91,6 +91,65 @@ public:
             double bound = SimTK::NaN,
             bool skipCoordinatesWithExistingActuators = true);
 
+#ifndef SWIG
+    /// The result of fitting a polynomial to the path of one muscle; see
+    /// replacePathsWithPolynomials().
+    struct PolynomialPathFit {
+        /// Absolute path of the muscle.
+        std::string muscle;
+        /// Absolute paths of the coordinates spanned by the muscle, in the
+        /// order of the dependent components of the polynomial.
+        std::vector<std::string> coordinates;
+        int order = 0;
+        SimTK::Vector coefficients;
+        /// Errors in muscle-tendon length and moment arms (m) on a set of
+        /// sampled coordinate values that were not used for the fit.
+        double lengthRMSError = SimTK::NaN;
+        double lengthMaxError = SimTK::NaN;
+        double momentArmRMSError = SimTK::NaN;
+        double momentArmMaxError = SimTK::NaN;
+        /// Was the muscle's GeometryPath replaced with the polynomial?
+        bool replaced = false;
+        /// Reason the GeometryPath was not replaced, if applicable.
+        std::string message;
+    };
+
+    /// Replace the GeometryPath of each muscle in the model with a polynomial
+    /// approximation (MultivariatePolynomialFunction) of its muscle-tendon
+    /// length in terms of the coordinates it spans, using the GeometryPath's
+    /// use_approximation, length_approximation, and approximation_coordinates
+    /// properties. Evaluating the polynomial is much faster than computing a
+    /// path with wrapping surfaces or moving path points.
+    ///
+    /// For each muscle, we detect the spanned coordinates (those with nonzero
+    /// moment arms at a few random poses), sample numSamples random values of
+    /// these coordinates within their ranges, and fit the polynomial
+    /// coefficients to the sampled lengths and moment arms (the moment arm is
+    /// the negative of the derivative of the length) with linear least
+    /// squares. We select the lowest order (up to maxOrder) whose maximum
+    /// errors in length and moment arm on a separate set of samples are below
+    /// the provided tolerances. A muscle's path is not replaced if no order
+    /// meets the tolerances or if the muscle spans more than 4 coordinates.
+    /// The fits for different muscles are computed in parallel, with the
+    /// number of threads determined by `parallel` as for
+    /// MocoCasADiSolver's `parallel` property.
+    /// @note This only considers coordinates that are not locked or
+    ///       constrained in the model's default state.
+    /// @note This requires a version of opensim-core whose GeometryPath
+    ///       provides the polynomial approximation properties; otherwise,
+    ///       this throws an exception.
+    static std::vector<PolynomialPathFit> replacePathsWithPolynomials(
+            Model& model, int maxOrder = 9, double lengthTolerance = 0.003,
+            double momentArmTolerance = 0.003, int numSamples = 1000,
+            int parallel = 1);
+
+    /// Print a table describing the quality of the fits from
+    /// replacePathsWithPolynomials().
+    static void printPolynomialPathFitReport(
+            const std::vector<PolynomialPathFit>& fits,
+            std::ostream& stream = std::cout);
+#endif
+
     /// @}
 };
 
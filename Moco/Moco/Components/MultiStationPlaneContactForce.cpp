@@ -0,0 +1,334 @@
+/* -------------------------------------------------------------------------- *
+ * OpenSim Moco: MultiStationPlaneContactForce.cpp                            *
+ * -------------------------------------------------------------------------- *
+ * Copyright (c) 2026 Stanford University and the Authors                     *
+ *                                                                            *
+ * Author(s): agent                                                           *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0          *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "MultiStationPlaneContactForce.h"
+
+#include <OpenSim/Simulation/Model/Model.h>
+
+using namespace OpenSim;
+
+namespace {
+/// Working memory for the stations of a MultiStationPlaneContactForce. Each
+/// thread has its own instance (see calcContactForces()), since a model may
+/// be evaluated by multiple threads at once (e.g., by the parallel solvers).
+struct StationWorkspace {
+    std::vector<double> height;
+    std::vector<double> normalVelocity;
+    std::vector<double> slidingVelocity;
+    std::vector<double> normalForce;
+    std::vector<double> frictionForce;
+    void resize(int numStations) {
+        height.resize(numStations);
+        normalVelocity.resize(numStations);
+        slidingVelocity.resize(numStations);
+        normalForce.resize(numStations);
+        frictionForce.resize(numStations);
+    }
+};
+} // anonymous namespace
+
+MultiStationPlaneContactForce::MultiStationPlaneContactForce() {
+    constructProperty_station_names();
+    constructProperty_station_locations();
+}
+
+void MultiStationPlaneContactForce::extendFinalizeFromProperties() {
+    Super::extendFinalizeFromProperties();
+    OPENSIM_THROW_IF_FRMOBJ(getProperty_station_names().size() !=
+                                    getProperty_station_locations().size(),
+            Exception,
+            format("Expected station_names and station_locations to have the "
+                   "same number of elements, but got %i and %i.",
+                    getProperty_station_names().size(),
+                    getProperty_station_locations().size()));
+    const int numStations = getNumStations();
+    auto& output = updOutput("force_on_station");
+    output.clearChannels();
+    m_stationIndices.clear();
+    for (int i = 0; i < numStations; ++i) {
+        const auto& name = get_station_names(i);
+        OPENSIM_THROW_IF_FRMOBJ(m_stationIndices.count(name), Exception,
+                format("Station name '%s' appears more than once.", name));
+        m_stationIndices[name] = i;
+        output.addChannel(name);
+    }
+}
+
+void MultiStationPlaneContactForce::extendConnectToModel(Model& model) {
+    Super::extendConnectToModel(model);
+    const auto& frame = getConnectee<PhysicalFrame>("frame");
+    const SimTK::Transform X_BF = frame.findTransformInBaseFrame();
+    m_stationLocationsInBase.resize(getNumStations());
+    for (int i = 0; i < getNumStations(); ++i) {
+        m_stationLocationsInBase[i] = X_BF * get_station_locations(i);
+    }
+}
+
+void MultiStationPlaneContactForce::extendAddToSystem(
+        SimTK::MultibodySystem& system) const {
+    Super::extendAddToSystem(system);
+    addCacheVariable("station_locations_in_ground",
+            std::vector<SimTK::Vec3>(), SimTK::Stage::Position);
+    addCacheVariable("forces_on_stations", std::vector<SimTK::Vec3>(),
+            SimTK::Stage::Velocity);
+}
+
+const std::vector<SimTK::Vec3>&
+MultiStationPlaneContactForce::getStationLocationsInGround(
+        const SimTK::State& s) const {
+    calcContactForces(s);
+    return getCacheVariableValue<std::vector<SimTK::Vec3>>(
+            s, "station_locations_in_ground");
+}
+
+const std::vector<SimTK::Vec3>&
+MultiStationPlaneContactForce::getContactForcesOnStations(
+        const SimTK::State& s) const {
+    calcContactForces(s);
+    return getCacheVariableValue<std::vector<SimTK::Vec3>>(
+            s, "forces_on_stations");
+}
+
+SimTK::Vec3 MultiStationPlaneContactForce::getContactForceOnStation(
+        const SimTK::State& s, const std::string& channel) const {
+    const auto it = m_stationIndices.find(channel);
+    OPENSIM_THROW_IF_FRMOBJ(it == m_stationIndices.end(), Exception,
+            format("No station named '%s'.", channel));
+    return getContactForcesOnStations(s)[it->second];
+}
+
+void MultiStationPlaneContactForce::calcContactForces(
+        const SimTK::State& s) const {
+    if (isCacheVariableValid(s, "forces_on_stations")) return;
+
+    const auto& body = getConnectee<PhysicalFrame>("frame").getMobilizedBody();
+
+    // Quantities shared by all stations.
+    // ----------------------------------
+    const SimTK::Transform& X_GB = body.getBodyTransform(s);
+    const SimTK::SpatialVec& V_GB = body.getBodyVelocity(s);
+
+    // Kinematics.
+    // -----------
+    const int numStations = (int)m_stationLocationsInBase.size();
+    thread_local StationWorkspace work;
+    work.resize(numStations);
+    auto& locations = updCacheVariableValue<std::vector<SimTK::Vec3>>(
+            s, "station_locations_in_ground");
+    locations.resize(numStations);
+    for (int i = 0; i < numStations; ++i) {
+        const SimTK::Vec3 offset = X_GB.R() * m_stationLocationsInBase[i];
+        const SimTK::Vec3 velocity = V_GB[1] + V_GB[0] % offset;
+        locations[i] = X_GB.p() + offset;
+        // The velocity is already expressed in ground, and the plane's normal
+        // is the ground y axis, so no projection is necessary: the normal
+        // velocity is the y component and (since friction acts only along
+        // ground x) the sliding velocity is the x component.
+        work.height[i] = locations[i][1];
+        work.normalVelocity[i] = velocity[1];
+        work.slidingVelocity[i] = velocity[0];
+    }
+    markCacheVariableValid(s, "station_locations_in_ground");
+
+    // Contact law.
+    // ------------
+    calcContactLaw(work.height, work.normalVelocity, work.slidingVelocity,
+            work.normalForce, work.frictionForce);
+
+    auto& forces = updCacheVariableValue<std::vector<SimTK::Vec3>>(
+            s, "forces_on_stations");
+    forces.resize(numStations);
+    for (int i = 0; i < numStations; ++i) {
+        forces[i] = SimTK::Vec3(work.frictionForce[i], work.normalForce[i], 0);
+    }
+    markCacheVariableValid(s, "forces_on_stations");
+}
+
+void MultiStationPlaneContactForce::computeForce(const SimTK::State& s,
+        SimTK::Vector_<SimTK::SpatialVec>& bodyForces,
+        SimTK::Vector& /*generalizedForces*/) const {
+    const auto& forces = getContactForcesOnStations(s);
+    const auto& locations = getStationLocationsInGround(s);
+
+    const auto& body = getConnectee<PhysicalFrame>("frame").getMobilizedBody();
+    const SimTK::Vec3& bodyOrigin = body.getBodyOriginLocation(s);
+    SimTK::SpatialVec bodyForce(SimTK::Vec3(0), SimTK::Vec3(0));
+    SimTK::SpatialVec groundForce(SimTK::Vec3(0), SimTK::Vec3(0));
+    for (int i = 0; i < (int)forces.size(); ++i) {
+        const SimTK::Vec3& force = forces[i];
+        bodyForce[0] += (locations[i] - bodyOrigin) % force;
+        bodyForce[1] += force;
+        groundForce[0] -= locations[i] % force;
+        groundForce[1] -= force;
+    }
+    bodyForces[body.getMobilizedBodyIndex()] += bodyForce;
+    bodyForces[SimTK::GroundIndex] += groundForce;
+}
+
+OpenSim::Array<std::string>
+MultiStationPlaneContactForce::getRecordLabels() const {
+    OpenSim::Array<std::string> labels("");
+
+    labels.append(getName() + ".Frame" + ".force.X");
+    labels.append(getName() + ".Frame" + ".force.Y");
+    labels.append(getName() + ".Frame" + ".force.Z");
+    labels.append(getName() + ".Frame" + ".torque.X");
+    labels.append(getName() + ".Frame" + ".torque.Y");
+    labels.append(getName() + ".Frame" + ".torque.Z");
+
+    labels.append(getName() + ".Plane" + ".force.X");
+    labels.append(getName() + ".Plane" + ".force.Y");
+    labels.append(getName() + ".Plane" + ".force.Z");
+    labels.append(getName() + ".Plane" + ".torque.X");
+    labels.append(getName() + ".Plane" + ".torque.Y");
+    labels.append(getName() + ".Plane" + ".torque.Z");
+
+    for (int i = 0; i < getNumStations(); ++i) {
+        const std::string prefix = getName() + "." + get_station_names(i);
+        labels.append(prefix + ".force.X");
+        labels.append(prefix + ".force.Y");
+        labels.append(prefix + ".force.Z");
+    }
+
+    return labels;
+}
+
+OpenSim::Array<double> MultiStationPlaneContactForce::getRecordValues(
+        const SimTK::State& s) const {
+    const auto& body = getConnectee<PhysicalFrame>("frame").getMobilizedBody();
+
+    SimTK::Vector_<SimTK::SpatialVec> bodyForces(
+            getModel().getMatterSubsystem().getNumBodies(),
+            SimTK::SpatialVec(SimTK::Vec3(0), SimTK::Vec3(0)));
+    SimTK::Vector generalizedForces;
+    computeForce(s, bodyForces, generalizedForces);
+
+    OpenSim::Array<double> values(1);
+
+    // On the frame's body.
+    const auto& bodyForce = bodyForces[body.getMobilizedBodyIndex()];
+    values.append(3, &bodyForce[1][0]);
+    values.append(3, &bodyForce[0][0]);
+
+    // On ground.
+    const auto& groundForce = bodyForces[SimTK::GroundIndex];
+    values.append(3, &groundForce[1][0]);
+    values.append(3, &groundForce[0][0]);
+
+    // On the frame's body, from each station.
+    for (const auto& force : getContactForcesOnStations(s)) {
+        values.append(3, &force[0]);
+    }
+
+    return values;
+}
+
+void MultiStationPlaneContactForce::generateDecorations(bool fixed,
+        const ModelDisplayHints& hints, const SimTK::State& s,
+        SimTK::Array_<SimTK::DecorativeGeometry>& geoms) const {
+    Super::generateDecorations(fixed, hints, s, geoms);
+    if (!fixed) {
+        getModel().realizeVelocity(s);
+        // The line is 1 meter long if the contact force magnitude is 1000 N,
+        // as in StationPlaneContactForce.
+        const double arrowLengthPerForce = 1.0 / 1000.0; // meters / Newton
+        const auto& forces = getContactForcesOnStations(s);
+        const auto& locations = getStationLocationsInGround(s);
+        const auto& frame = getConnectee<PhysicalFrame>("frame");
+        for (int i = 0; i < (int)forces.size(); ++i) {
+            SimTK::DecorativeLine line(locations[i],
+                    locations[i] + forces[i] * arrowLengthPerForce);
+            line.setColor(SimTK::Green);
+            line.setLineThickness(0.10);
+            geoms.push_back(line);
+
+            SimTK::DecorativeSphere sphere;
+            sphere.setColor(SimTK::Green);
+            sphere.setRadius(0.01);
+            sphere.setBodyId(frame.getMobilizedBodyIndex());
+            sphere.setRepresentation(SimTK::DecorativeGeometry::DrawWireframe);
+            sphere.setTransform(SimTK::Transform(m_stationLocationsInBase[i]));
+            geoms.push_back(sphere);
+        }
+    }
+}
+
+void MultiStationAckermannVanDenBogert2010Force::calcContactLaw(
+        const std::vector<double>& heights,
+        const std::vector<double>& normalVelocities,
+        const std::vector<double>& slidingVelocities,
+        std::vector<double>& normalForces,
+        std::vector<double>& frictionForces) const {
+    const double a = get_stiffness();
+    const double b = get_dissipation();
+    const double frictionCoefficient = get_friction_coefficient();
+    const double velSlidingScaling = get_tangent_velocity_scaling_factor();
+    const double voidStiffness = 1.0; // N/m
+    const int numStations = (int)heights.size();
+    for (int i = 0; i < numStations; ++i) {
+        const double depth = 0 - heights[i];
+        const double depthRate = 0 - normalVelocities[i];
+        const double contact =
+                depth > 0 ? std::fmax(0, a * depth * depth * depth *
+                                                 (1 + b * depthRate))
+                          : 0;
+        normalForces[i] = contact + voidStiffness * depth;
+    }
+    for (int i = 0; i < numStations; ++i) {
+        // The paper used (1 - exp(-x)) / (1 + exp(-x)) = tanh(2x).
+        const double transition =
+                std::tanh(slidingVelocities[i] / velSlidingScaling / 2);
+        frictionForces[i] =
+                -transition * frictionCoefficient * normalForces[i];
+    }
+}
+
+void MultiStationMeyerFregly2016Force::calcContactLaw(
+        const std::vector<double>& heights,
+        const std::vector<double>& normalVelocities,
+        const std::vector<double>& slidingVelocities,
+        std::vector<double>& normalForces,
+        std::vector<double>& frictionForces) const {
+    const double Kval = get_stiffness();
+    const double Cval = get_dissipation();
+    const double tscale = get_tscale();
+    const double klow = 1e-1 / (tscale * tscale);
+    const double h = 1e-3;
+    const double c = 5e-4;
+    const double ymax = 1e-2;
+    const double vp = (Kval + klow) / (Kval - klow);
+    const double sp = (Kval - klow) / 2;
+    const double constant =
+            -sp * (vp * ymax - c * std::log(std::cosh((ymax + h) / c)));
+    const int numStations = (int)heights.size();
+    for (int i = 0; i < numStations; ++i) {
+        const double y = heights[i];
+        double Fspring =
+                -sp * (vp * y - c * std::log(std::cosh((y + h) / c))) -
+                constant;
+        if (SimTK::isNaN(Fspring) || SimTK::isInf(Fspring)) Fspring = 0;
+        const double depthRate = 0 - normalVelocities[i];
+        normalForces[i] = Fspring * (1 + Cval * depthRate);
+    }
+    const double mu_d = 1;
+    const double latchvel = 0.05; // m/s
+    for (int i = 0; i < numStations; ++i) {
+        const double mu = mu_d * std::tanh(slidingVelocities[i] / latchvel / 2);
+        frictionForces[i] = -normalForces[i] * mu;
+    }
+}
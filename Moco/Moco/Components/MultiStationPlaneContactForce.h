@@ -0,0 +1,200 @@
+#ifndef MOCO_MULTISTATIONPLANECONTACTFORCE_H
+#define MOCO_MULTISTATIONPLANECONTACTFORCE_H
+/* -------------------------------------------------------------------------- *
+ * OpenSim Moco: MultiStationPlaneContactForce.h                              *
+ * -------------------------------------------------------------------------- *
+ * Copyright (c) 2026 Stanford University and the Authors                     *
+ *                                                                            *
+ * Author(s): agent                                                           *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0          *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "../MocoUtilities.h"
+#include "../osimMocoDLL.h"
+
+#include <OpenSim/Simulation/Model/Force.h>
+
+namespace OpenSim {
+
+/// Compliant point contact between many stations fixed to one frame and the
+/// ground plane y = 0. One instance of a concrete subclass is equivalent to
+/// one corresponding StationPlaneContactForce per station (with the same
+/// contact parameters), but is faster: the transform and velocity of the
+/// frame's body are computed once for all stations, and the contact law is
+/// evaluated in loops over contiguous arrays of station quantities. This is
+/// useful for feet with many contact points.
+///
+/// The stations are specified with the list properties station_names and
+/// station_locations (in the frame), which must have the same number of
+/// elements. The force on each station, expressed in ground, is available
+/// from the force_on_station list output, which has one channel per station
+/// (named after the station).
+///
+/// As with StationPlaneContactForce, friction acts only along the ground's x
+/// direction.
+///
+/// @underdevelopment
+class OSIMMOCO_API MultiStationPlaneContactForce : public Force {
+    OpenSim_DECLARE_ABSTRACT_OBJECT(MultiStationPlaneContactForce, Force);
+
+public:
+    OpenSim_DECLARE_LIST_PROPERTY(station_names, std::string,
+            "The name of each contact station; used for the channels of the "
+            "force_on_station output.");
+    OpenSim_DECLARE_LIST_PROPERTY(station_locations, SimTK::Vec3,
+            "The location of each contact station in the frame.");
+
+    OpenSim_DECLARE_LIST_OUTPUT(force_on_station, SimTK::Vec3,
+            getContactForceOnStation, SimTK::Stage::Velocity);
+
+    OpenSim_DECLARE_SOCKET(frame, PhysicalFrame,
+            "The frame to which the contact stations are fixed.");
+
+    MultiStationPlaneContactForce();
+
+    /// Append a contact station.
+    void addStation(const std::string& name, SimTK::Vec3 location) {
+        append_station_names(name);
+        append_station_locations(location);
+    }
+    int getNumStations() const {
+        return getProperty_station_locations().size();
+    }
+
+    /// The force applied to the frame's body by each station, at the station,
+    /// expressed in ground.
+    const std::vector<SimTK::Vec3>& getContactForcesOnStations(
+            const SimTK::State& s) const;
+    /// The force for the station whose name is `channel`; this is used for
+    /// the force_on_station output.
+    SimTK::Vec3 getContactForceOnStation(
+            const SimTK::State& s, const std::string& channel) const;
+
+    /// Obtain names of the quantities (column labels) of the force values to
+    /// be reported. The first 12 values have the same meaning as in
+    /// SmoothMultiSphereHalfSpaceForce: the three forces and three torques
+    /// applied on the frame's body followed by the three forces and three
+    /// torques applied on ground, summed over all stations. Next are the
+    /// three forces applied to the frame's body by each station (as in
+    /// StationPlaneContactForce). Forces and torques are expressed in the
+    /// ground frame, and torques are about the origin of the body.
+    OpenSim::Array<std::string> getRecordLabels() const override;
+    OpenSim::Array<double> getRecordValues(
+            const SimTK::State& s) const override;
+
+protected:
+    /// Compute the normal (ground y) and friction (ground x) force on each
+    /// station from its height above the plane and its velocity in ground.
+    /// All arguments have one element per station, and the output arguments
+    /// are already sized.
+    virtual void calcContactLaw(const std::vector<double>& heights,
+            const std::vector<double>& normalVelocities,
+            const std::vector<double>& slidingVelocities,
+            std::vector<double>& normalForces,
+            std::vector<double>& frictionForces) const = 0;
+
+    void extendFinalizeFromProperties() override;
+    void extendConnectToModel(Model& model) override;
+    void extendAddToSystem(SimTK::MultibodySystem& system) const override;
+    void computeForce(const SimTK::State& s,
+            SimTK::Vector_<SimTK::SpatialVec>& bodyForces,
+            SimTK::Vector& generalizedForces) const override;
+    void generateDecorations(bool fixed, const ModelDisplayHints& hints,
+            const SimTK::State& s,
+            SimTK::Array_<SimTK::DecorativeGeometry>& geoms) const override;
+
+private:
+    /// Fill the cache variables for the station locations in ground and the
+    /// forces on the stations, if they are not already valid.
+    void calcContactForces(const SimTK::State& s) const;
+    const std::vector<SimTK::Vec3>& getStationLocationsInGround(
+            const SimTK::State& s) const;
+
+    // The station locations in the base frame of the frame.
+    std::vector<SimTK::Vec3> m_stationLocationsInBase;
+    std::unordered_map<std::string, int> m_stationIndices;
+};
+
+/// The contact law of AckermannVanDenBogert2010Force, applied to many
+/// stations on one frame.
+/// @underdevelopment
+class OSIMMOCO_API MultiStationAckermannVanDenBogert2010Force
+        : public MultiStationPlaneContactForce {
+    OpenSim_DECLARE_CONCRETE_OBJECT(MultiStationAckermannVanDenBogert2010Force,
+            MultiStationPlaneContactForce);
+
+public:
+    OpenSim_DECLARE_PROPERTY(stiffness, double,
+            "Spring stiffness in N/m^3 (default: 5e7).");
+    OpenSim_DECLARE_PROPERTY(dissipation, double,
+            "Dissipation coefficient in s/m (default: 1.0).");
+    OpenSim_DECLARE_PROPERTY(friction_coefficient, double,
+            "Friction coefficient");
+    OpenSim_DECLARE_PROPERTY(tangent_velocity_scaling_factor, double,
+            "Governs how rapidly friction develops (default: 0.05).");
+
+    MultiStationAckermannVanDenBogert2010Force() { constructProperties(); }
+
+protected:
+    void calcContactLaw(const std::vector<double>& heights,
+            const std::vector<double>& normalVelocities,
+            const std::vector<double>& slidingVelocities,
+            std::vector<double>& normalForces,
+            std::vector<double>& frictionForces) const override;
+
+private:
+    void constructProperties() {
+        constructProperty_friction_coefficient(1.0);
+        constructProperty_stiffness(5e7);
+        constructProperty_dissipation(1.0);
+        constructProperty_tangent_velocity_scaling_factor(0.05);
+    }
+};
+
+/// The contact law of MeyerFregly2016Force, applied to many stations on one
+/// frame.
+/// @underdevelopment
+class OSIMMOCO_API MultiStationMeyerFregly2016Force
+        : public MultiStationPlaneContactForce {
+    OpenSim_DECLARE_CONCRETE_OBJECT(MultiStationMeyerFregly2016Force,
+            MultiStationPlaneContactForce);
+
+public:
+    OpenSim_DECLARE_PROPERTY(stiffness, double,
+            "Spring stiffness in N/m (default: 1e4).");
+    OpenSim_DECLARE_PROPERTY(dissipation, double,
+            "Dissipation coefficient in s/m (default: 0.01).");
+    OpenSim_DECLARE_PROPERTY(tscale, double,
+            "Sets the small stiffness that acts on a station above the plane "
+            "to 0.1 / tscale^2 N/m, so that the force is smooth (default: "
+            "1.0).");
+
+    MultiStationMeyerFregly2016Force() { constructProperties(); }
+
+protected:
+    void calcContactLaw(const std::vector<double>& heights,
+            const std::vector<double>& normalVelocities,
+            const std::vector<double>& slidingVelocities,
+            std::vector<double>& normalForces,
+            std::vector<double>& frictionForces) const override;
+
+private:
+    void constructProperties() {
+        constructProperty_stiffness(1e4);
+        constructProperty_dissipation(1e-2);
+        constructProperty_tscale(1.0);
+    }
+};
+
+} // namespace OpenSim
+
+#endif // MOCO_MULTISTATIONPLANECONTACTFORCE_H
@@ -57,6 +57,11 @@ public:
     /// 19    | 3  0  0
     /// </pre>
     /// Assuming c6 the index 6 coefficient, the corresponding term is Y Z^2.
+    ///
+    /// The exponents of each monomial are tabulated on construction, and each
+    /// evaluation computes the powers of each component once and shares them
+    /// among all monomials (and all derivatives). For orders up to 6, we use
+    /// an evaluator generated for the specific dimension and order.
     /// @param dimension the number of dependent components
     /// @param order the polynomial order
     SimTKMultivariatePolynomial(const SimTK::Vector_<T>& coefficients,
@@ -64,8 +69,9 @@ public:
             coefficients(coefficients), dimension(dimension), order(order) {
         OPENSIM_THROW_IF(dimension < 0 || dimension > 4, Exception, format(
                 "Expected dimension >= 0 && <=4 but got %i.", dimension));
+        // Tabulate the exponents of each monomial so that evaluating the
+        // polynomial does not need to walk the nested loops.
         std::array<int, 4> nq {{0, 0, 0, 0}};
-        int coeff_nr = 0;
         for (nq[0] = 0; nq[0] < order + 1; ++nq[0]) {
             int nq2_s;
             if (dimension < 2) nq2_s = 0;
@@ -79,110 +85,27 @@ public:
                     if (dimension < 4) nq4_s = 0;
                     else nq4_s = order - nq[0] - nq[1] - nq[2];
                     for (nq[3] = 0; nq[3] < nq4_s + 1; ++nq[3]) {
-                        ++coeff_nr;
+                        exponents.push_back(nq);
                     }
                 }
             }
         }
+        const int coeff_nr = (int)exponents.size();
         OPENSIM_THROW_IF(coefficients.size() != coeff_nr, Exception,
                 format("Expected %i coefficients but got %i.",
                         coeff_nr, coefficients.size()));
-
+        evaluator = selectEvaluator(dimension, order);
     }
     T calcValue(const SimTK::Vector& x) const override {
-        std::array<int, 4> nq {{0, 0, 0, 0}};
-        T value = static_cast<T>(0);
-        int coeff_nr = 0;
-        for (nq[0] = 0; nq[0] < order + 1; ++nq[0]) {
-            int nq2_s;
-            if (dimension < 2) nq2_s = 0;
-            else nq2_s = order - nq[0];
-            for (nq[1] = 0; nq[1] < nq2_s + 1; ++nq[1]) {
-                int nq3_s;
-                if (dimension < 3) nq3_s = 0;
-                else nq3_s = order - nq[0] - nq[1];
-                for (nq[2] = 0; nq[2] < nq3_s + 1; ++nq[2]) {
-                    int nq4_s;
-                    if (dimension < 4) nq4_s = 0;
-                    else nq4_s = order - nq[0] - nq[1] - nq[2];
-                    for (nq[3] = 0; nq[3] < nq4_s + 1; ++nq[3]) {
-                        T valueP = static_cast<T>(1);
-                        for (int i = 0; i < dimension; ++i) {
-                            valueP *= std::pow(x[i], nq[i]);
-                        }
-                        value += valueP * coefficients[coeff_nr];
-                        ++coeff_nr;
-                    }
-                }
-            }
-        }
-        return value;
+        return (this->*evaluator)(x, nullptr, -1);
     }
     T calcDerivative(const SimTK::Array_<int>& derivComponent,
                      const SimTK::Vector& x) const override {
-        std::array<int, 4> nq {{0, 0, 0, 0}};
-        T value = static_cast<T>(0);
-        int nqNonNegative;
-        int coeff_nr = 0;
-        for (nq[0] = 0; nq[0] < order + 1; ++nq[0]) {
-            int nq2_s;
-            if (dimension < 2) nq2_s = 0;
-            else nq2_s = order - nq[0];
-            for (nq[1] = 0; nq[1] < nq2_s + 1; ++nq[1]) {
-                int nq3_s;
-                if (dimension < 3) nq3_s = 0;
-                else nq3_s = order - nq[0] - nq[1];
-                for (nq[2] = 0; nq[2] < nq3_s + 1; ++nq[2]) {
-                    int nq4_s;
-                    if (dimension < 4) nq4_s = 0;
-                    else nq4_s = order - nq[0] - nq[1] - nq[2];
-                    for (nq[3] = 0; nq[3] < nq4_s + 1; ++nq[3]) {
-                        if (derivComponent[0] == 0) {
-                            nqNonNegative = nq[0] - 1;
-                            if (nqNonNegative < 0) nqNonNegative = 0;
-                            T valueP = nq[0] * std::pow(x[0], nqNonNegative);
-                            for (int i = 0; i < dimension; ++i) {
-                                if (i == derivComponent[0]) continue;
-                                valueP *= std::pow(x[i], nq[i]);
-                            }
-                            value += valueP * coefficients[coeff_nr];
-                        }
-                        else if (derivComponent[0] == 1) {
-                            nqNonNegative = nq[1] - 1;
-                            if (nqNonNegative < 0) nqNonNegative = 0;
-                            T valueP = nq[1] * std::pow(x[1], nqNonNegative);
-                            for (int i = 0; i < dimension; ++i) {
-                                if (i == derivComponent[0]) continue;
-                                valueP *= std::pow(x[i], nq[i]);
-                            }
-                            value += valueP * coefficients[coeff_nr];
-                        }
-                        else if (derivComponent[0] == 2) {
-                            nqNonNegative = nq[2] - 1;
-                            if (nqNonNegative < 0) nqNonNegative = 0;
-                            T valueP = nq[2] * std::pow(x[2], nqNonNegative);
-                            for (int i = 0; i < dimension; ++i) {
-                                if (i == derivComponent[0]) continue;
-                                valueP *= std::pow(x[i], nq[i]);
-                            }
-                            value += valueP * coefficients[coeff_nr];
-                        }
-                        else if (derivComponent[0] == 3) {
-                            nqNonNegative = nq[3] - 1;
-                            if (nqNonNegative < 0) nqNonNegative = 0;
-                            T valueP = nq[3] * std::pow(x[3], nqNonNegative);
-                            for (int i = 0; i < dimension; ++i) {
-                                if (i == derivComponent[0]) continue;
-                                valueP *= std::pow(x[i], nq[i]);
-                            }
-                            value += valueP * coefficients[coeff_nr];
-                        }
-                        ++coeff_nr;
-                    }
-                }
-            }
+        const int component = derivComponent[0];
+        if (component < 0 || component >= dimension) {
+            return static_cast<T>(0);
         }
-        return value;
+        return (this->*evaluator)(x, nullptr, component);
     }
     int getArgumentSize() const override {
         return dimension;
@@ -197,10 +120,234 @@ public:
         const SimTK::Vector& x) const {
         return calcDerivative(SimTK::ArrayViewConst_<int>(derivComponent), x);
     }
+    /// Compute the value of the polynomial and its first derivatives with
+    /// respect to all dependent components at once. This is much cheaper than
+    /// calling calcValue() and calcDerivative() for each component (e.g., to
+    /// compute a muscle-tendon length and its moment arms), since the powers
+    /// of each component are shared among all of these quantities.
+    T calcValueAndDerivatives(const SimTK::Vector& x,
+            SimTK::Vector_<T>& derivatives) const {
+        std::array<T, 4> derivs;
+        const T value = (this->*evaluator)(x, derivs.data(), -1);
+        derivatives.resize(dimension);
+        for (int i = 0; i < dimension; ++i) derivatives[i] = derivs[i];
+        return value;
+    }
+    /// Evaluate the polynomial and its first derivatives at many points. Each
+    /// row of x is a point; the value at row i is placed in values[i] and the
+    /// derivatives in row i of derivatives.
+    void calcValuesAndDerivatives(const SimTK::Matrix& x,
+            SimTK::Vector_<T>& values, SimTK::Matrix_<T>& derivatives) const {
+        OPENSIM_THROW_IF(x.ncol() != dimension, Exception,
+                format("Expected %i columns but got %i.", dimension,
+                        x.ncol()));
+        values.resize(x.nrow());
+        derivatives.resize(x.nrow(), dimension);
+        SimTK::Vector point(dimension);
+        std::array<T, 4> derivs;
+        for (int irow = 0; irow < x.nrow(); ++irow) {
+            for (int i = 0; i < dimension; ++i) point[i] = x(irow, i);
+            values[irow] = (this->*evaluator)(point, derivs.data(), -1);
+            for (int i = 0; i < dimension; ++i) {
+                derivatives(irow, i) = derivs[i];
+            }
+        }
+    }
+    /// Compute the value of each monomial of the polynomial (that is, the
+    /// value of the polynomial if the corresponding coefficient were 1 and
+    /// all others were 0) and the first derivatives of each monomial
+    /// (dimension x number of coefficients). This is useful for fitting the
+    /// coefficients with linear least squares; the coefficients of this
+    /// object are not used.
+    void calcMonomialsAndDerivatives(const SimTK::Vector& x,
+            SimTK::Vector& monomials, SimTK::Matrix& derivatives) const {
+        const int numCoefficients = (int)exponents.size();
+        monomials.resize(numCoefficients);
+        derivatives.resize(dimension, numCoefficients);
+        for (int c = 0; c < numCoefficients; ++c) {
+            const std::array<int, 4>& nq = exponents[c];
+            monomials[c] = 1;
+            for (int i = 0; i < dimension; ++i) {
+                monomials[c] *= std::pow(x[i], nq[i]);
+            }
+            for (int j = 0; j < dimension; ++j) {
+                if (nq[j] == 0) {
+                    derivatives(j, c) = 0;
+                    continue;
+                }
+                double derivP = nq[j] * std::pow(x[j], nq[j] - 1);
+                for (int i = 0; i < dimension; ++i) {
+                    if (i != j) derivP *= std::pow(x[i], nq[i]);
+                }
+                derivatives(j, c) = derivP;
+            }
+        }
+    }
+    /// The number of coefficients of a polynomial with the given dimension
+    /// and order: (order + dimension)! / (order! dimension!).
+    static constexpr int calcNumCoefficients(int dimension, int order) {
+        return dimension == 0 ? 1
+                              : calcNumCoefficients(dimension - 1, order) *
+                                        (order + dimension) / dimension;
+    }
 private:
+    /// If derivComponent is -1, returns the value; in that case, if
+    /// derivatives is not null, it must have room for `dimension` elements
+    /// and is filled with the first derivatives. Otherwise, returns only the
+    /// first derivative with respect to component derivComponent (and
+    /// derivatives is not used).
+    using Evaluator = T (SimTKMultivariatePolynomial::*)(
+            const SimTK::Vector&, T*, int) const;
+
+    // The polynomial orders for which we generate an evaluator with the
+    // dimension and order known at compile time. Higher orders use
+    // calcValueAndDerivativesGeneric().
+    static constexpr int MaxSpecializedOrder = 6;
+
+    static Evaluator selectEvaluator(int dimension, int order) {
+        switch (dimension) {
+        case 1: return selectEvaluator<1>(order);
+        case 2: return selectEvaluator<2>(order);
+        case 3: return selectEvaluator<3>(order);
+        case 4: return selectEvaluator<4>(order);
+        default:
+            return &SimTKMultivariatePolynomial::
+                    calcValueAndDerivativesGeneric;
+        }
+    }
+    template <int D>
+    static Evaluator selectEvaluator(int order) {
+        static_assert(MaxSpecializedOrder == 6,
+                "Update the cases below.");
+        switch (order) {
+        case 1: return &SimTKMultivariatePolynomial::template
+                calcValueAndDerivativesFixed<D, 1>;
+        case 2: return &SimTKMultivariatePolynomial::template
+                calcValueAndDerivativesFixed<D, 2>;
+        case 3: return &SimTKMultivariatePolynomial::template
+                calcValueAndDerivativesFixed<D, 3>;
+        case 4: return &SimTKMultivariatePolynomial::template
+                calcValueAndDerivativesFixed<D, 4>;
+        case 5: return &SimTKMultivariatePolynomial::template
+                calcValueAndDerivativesFixed<D, 5>;
+        case 6: return &SimTKMultivariatePolynomial::template
+                calcValueAndDerivativesFixed<D, 6>;
+        default:
+            return &SimTKMultivariatePolynomial::
+                    calcValueAndDerivativesGeneric;
+        }
+    }
+
+    /// Evaluate with the dimension and order known at compile time, so that
+    /// the compiler can unroll the loops and keep the powers in registers.
+    /// The powers x_i^k are computed once and shared by all monomials.
+    template <int D, int N>
+    T calcValueAndDerivativesFixed(const SimTK::Vector& x, T* derivatives,
+            int derivComponent) const {
+        double powers[D][N + 1];
+        for (int i = 0; i < D; ++i) {
+            powers[i][0] = 1;
+            for (int k = 1; k <= N; ++k) {
+                powers[i][k] = powers[i][k - 1] * x[i];
+            }
+        }
+        if (derivComponent >= 0) {
+            const int j = derivComponent;
+            T deriv = static_cast<T>(0);
+            for (int c = 0; c < calcNumCoefficients(D, N); ++c) {
+                const std::array<int, 4>& nq = exponents[c];
+                if (nq[j] == 0) continue;
+                double derivP = nq[j] * powers[j][nq[j] - 1];
+                for (int i = 0; i < D; ++i) {
+                    if (i != j) derivP *= powers[i][nq[i]];
+                }
+                deriv += derivP * coefficients[c];
+            }
+            return deriv;
+        }
+        T value = static_cast<T>(0);
+        if (derivatives) {
+            for (int i = 0; i < D; ++i) derivatives[i] = static_cast<T>(0);
+        }
+        for (int c = 0; c < calcNumCoefficients(D, N); ++c) {
+            const std::array<int, 4>& nq = exponents[c];
+            double valueP = 1;
+            for (int i = 0; i < D; ++i) valueP *= powers[i][nq[i]];
+            value += valueP * coefficients[c];
+            if (derivatives) {
+                for (int j = 0; j < D; ++j) {
+                    if (nq[j] == 0) continue;
+                    double derivP = nq[j] * powers[j][nq[j] - 1];
+                    for (int i = 0; i < D; ++i) {
+                        if (i != j) derivP *= powers[i][nq[i]];
+                    }
+                    derivatives[j] += derivP * coefficients[c];
+                }
+            }
+        }
+        return value;
+    }
+
+    /// Evaluate any dimension and order supported by this class.
+    T calcValueAndDerivativesGeneric(const SimTK::Vector& x, T* derivatives,
+            int derivComponent) const {
+        std::vector<double> powers(dimension * (order + 1));
+        for (int i = 0; i < dimension; ++i) {
+            double* powers_i = &powers[i * (order + 1)];
+            powers_i[0] = 1;
+            for (int k = 1; k <= order; ++k) {
+                powers_i[k] = powers_i[k - 1] * x[i];
+            }
+        }
+        const auto power = [&](int i, int k) {
+            return powers[i * (order + 1) + k];
+        };
+        if (derivComponent >= 0) {
+            const int j = derivComponent;
+            T deriv = static_cast<T>(0);
+            for (int c = 0; c < (int)exponents.size(); ++c) {
+                const std::array<int, 4>& nq = exponents[c];
+                if (nq[j] == 0) continue;
+                double derivP = nq[j] * power(j, nq[j] - 1);
+                for (int i = 0; i < dimension; ++i) {
+                    if (i != j) derivP *= power(i, nq[i]);
+                }
+                deriv += derivP * coefficients[c];
+            }
+            return deriv;
+        }
+        T value = static_cast<T>(0);
+        if (derivatives) {
+            for (int i = 0; i < dimension; ++i) {
+                derivatives[i] = static_cast<T>(0);
+            }
+        }
+        for (int c = 0; c < (int)exponents.size(); ++c) {
+            const std::array<int, 4>& nq = exponents[c];
+            double valueP = 1;
+            for (int i = 0; i < dimension; ++i) valueP *= power(i, nq[i]);
+            value += valueP * coefficients[c];
+            if (derivatives) {
+                for (int j = 0; j < dimension; ++j) {
+                    if (nq[j] == 0) continue;
+                    double derivP = nq[j] * power(j, nq[j] - 1);
+                    for (int i = 0; i < dimension; ++i) {
+                        if (i != j) derivP *= power(i, nq[i]);
+                    }
+                    derivatives[j] += derivP * coefficients[c];
+                }
+            }
+        }
+        return value;
+    }
+
     SimTK::Vector_<T> coefficients;
     int dimension;
     int order;
+    // The exponents of each dependent component in each monomial, in the
+    // same order as the coefficients.
+    std::vector<std::array<int, 4>> exponents;
+    Evaluator evaluator;
 };
 
 class OSIMMOCO_API MultivariatePolynomialFunction : public Function {
@@ -21,6 +21,7 @@
 #include "../MocoUtilities.h"
 
 #include <OpenSim/Common/Function.h>
+#include <OpenSim/Common/GCVSpline.h>
 #include <OpenSim/Common/GCVSplineSet.h>
 #include <OpenSim/Simulation/Model/Model.h>
 #include <OpenSim/Simulation/SimbodyEngine/Coordinate.h>
@@ -28,11 +29,209 @@
 
 using namespace OpenSim;
 
+namespace {
+
+/// The GCVSplines of a PositionMotion (with identical knots) represented as
+/// polynomials in each interval between knots. For interval i and function
+/// j, the polynomial is
+/// \f[ p(t) = \sum_{k=0}^{d} c_{ijk} s^k, \quad s = (t - t_i) / h_i, \f]
+/// where \f$ h_i = t_{i+1} - t_i \f$. The coefficients for all functions in
+/// an interval are contiguous so that evaluating all functions at one time
+/// touches a single block of memory.
+class PositionMotionTable {
+public:
+    /// Returns null if the functions are not all GCVSplines of the same
+    /// degree with the same knots, or if the polynomials do not reproduce
+    /// the splines.
+    static std::unique_ptr<PositionMotionTable> create(
+            const std::vector<const Function*>& functions);
+
+    /// Compute the value and first and second derivatives of all functions at
+    /// the given time, unless they were already computed for this time.
+    /// Returns false if the time is outside the knots.
+    bool realize(double time) const {
+        if (time == m_time) return true;
+        if (!(time >= m_knots.front() && time <= m_knots.back())) {
+            return false;
+        }
+        const int interval = findInterval(time);
+        const double step = m_knots[interval + 1] - m_knots[interval];
+        const double s = (time - m_knots[interval]) / step;
+        const double* coefficients =
+                &m_coefficients[interval * m_numFunctions * (m_degree + 1)];
+        for (int ifunc = 0; ifunc < m_numFunctions; ++ifunc) {
+            // Horner's method for the polynomial and its derivatives.
+            const double* c = coefficients + ifunc * (m_degree + 1);
+            double value = c[m_degree];
+            double deriv = 0;
+            double deriv2 = 0;
+            for (int k = m_degree - 1; k >= 0; --k) {
+                deriv2 = deriv2 * s + 2 * deriv;
+                deriv = deriv * s + value;
+                value = value * s + c[k];
+            }
+            m_values[ifunc] = value;
+            m_speeds[ifunc] = deriv / step;
+            m_accelerations[ifunc] = deriv2 / (step * step);
+        }
+        m_time = time;
+        return true;
+    }
+    double getValue(int ifunc) const { return m_values[ifunc]; }
+    double getSpeed(int ifunc) const { return m_speeds[ifunc]; }
+    double getAcceleration(int ifunc) const {
+        return m_accelerations[ifunc];
+    }
+
+private:
+    PositionMotionTable() = default;
+
+    /// The collocation grid is fixed and usually uniform, and consecutive
+    /// evaluations are usually in the same or the next interval, so we avoid
+    /// a binary search in most cases.
+    int findInterval(double time) const {
+        const int numIntervals = (int)m_knots.size() - 1;
+        int interval;
+        if (m_uniform) {
+            interval = (int)((time - m_knots.front()) * m_inverseStep);
+            interval = std::max(0, std::min(interval, numIntervals - 1));
+            // Correct for roundoff.
+            if (time < m_knots[interval]) --interval;
+            else if (time > m_knots[interval + 1]) ++interval;
+            return interval;
+        }
+        interval = m_lastInterval;
+        if (time >= m_knots[interval] && time <= m_knots[interval + 1]) {
+            return interval;
+        }
+        if (interval + 1 < numIntervals && time >= m_knots[interval + 1] &&
+                time <= m_knots[interval + 2]) {
+            m_lastInterval = interval + 1;
+            return m_lastInterval;
+        }
+        const auto it = std::upper_bound(
+                m_knots.begin(), m_knots.end() - 1, time);
+        interval = std::max(0, (int)(it - m_knots.begin()) - 1);
+        m_lastInterval = std::min(interval, numIntervals - 1);
+        return m_lastInterval;
+    }
+
+    int m_numFunctions = 0;
+    int m_degree = 0;
+    std::vector<double> m_knots;
+    bool m_uniform = false;
+    double m_inverseStep = 0;
+    std::vector<double> m_coefficients;
+
+    mutable int m_lastInterval = 0;
+    mutable double m_time = SimTK::NaN;
+    mutable std::vector<double> m_values;
+    mutable std::vector<double> m_speeds;
+    mutable std::vector<double> m_accelerations;
+};
+
+std::unique_ptr<PositionMotionTable> PositionMotionTable::create(
+        const std::vector<const Function*>& functions) {
+    std::unique_ptr<PositionMotionTable> table;
+    if (functions.empty()) return table;
+    std::vector<const GCVSpline*> splines;
+    for (const auto* function : functions) {
+        splines.push_back(dynamic_cast<const GCVSpline*>(function));
+        if (!splines.back()) return table;
+    }
+    const int degree = splines[0]->getDegree();
+    const int numKnots = splines[0]->getSize();
+    if (numKnots < 2) return table;
+    const double* knots = splines[0]->getXValues();
+    for (const auto* spline : splines) {
+        if (spline->getDegree() != degree || spline->getSize() != numKnots ||
+                !std::equal(knots, knots + numKnots, spline->getXValues())) {
+            return table;
+        }
+    }
+    for (int i = 0; i < numKnots - 1; ++i) {
+        if (!(knots[i + 1] > knots[i])) return table;
+    }
+
+    table.reset(new PositionMotionTable());
+    const int numFunctions = (int)functions.size();
+    const int numIntervals = numKnots - 1;
+    table->m_numFunctions = numFunctions;
+    table->m_degree = degree;
+    table->m_knots.assign(knots, knots + numKnots);
+    const double step = (knots[numKnots - 1] - knots[0]) / numIntervals;
+    table->m_uniform = true;
+    for (int i = 0; i < numIntervals; ++i) {
+        if (std::abs(knots[i + 1] - knots[i] - step) > 1e-10 * step) {
+            table->m_uniform = false;
+            break;
+        }
+    }
+    table->m_inverseStep = 1.0 / step;
+    table->m_values.resize(numFunctions);
+    table->m_speeds.resize(numFunctions);
+    table->m_accelerations.resize(numFunctions);
+
+    // In each interval, interpolate each spline at Chebyshev points to
+    // obtain the coefficients of its polynomial.
+    const int n = degree + 1;
+    SimTK::Vector nodes(n);
+    SimTK::Matrix vandermonde(n, n);
+    for (int j = 0; j < n; ++j) {
+        nodes[j] = 0.5 * (1 - std::cos(SimTK::Pi * (j + 0.5) / n));
+        for (int k = 0; k < n; ++k) vandermonde(j, k) = std::pow(nodes[j], k);
+    }
+    SimTK::FactorLU factor(vandermonde);
+    table->m_coefficients.resize(numIntervals * numFunctions * n);
+    SimTK::Vector time(1);
+    SimTK::Vector values(n);
+    SimTK::Vector coefficients(n);
+    for (int i = 0; i < numIntervals; ++i) {
+        const double h = knots[i + 1] - knots[i];
+        for (int ifunc = 0; ifunc < numFunctions; ++ifunc) {
+            for (int j = 0; j < n; ++j) {
+                time[0] = knots[i] + nodes[j] * h;
+                values[j] = splines[ifunc]->calcValue(time);
+            }
+            factor.solve(values, coefficients);
+            std::copy_n(&coefficients[0], n,
+                    &table->m_coefficients[(i * numFunctions + ifunc) * n]);
+        }
+    }
+
+    // Ensure the polynomials reproduce the splines at a point between the
+    // interpolation points of each interval.
+    const double sCheck = 0.5 * (nodes[0] + nodes[1]);
+    for (int i = 0; i < numIntervals; ++i) {
+        table->m_time = SimTK::NaN;
+        table->realize(knots[i] + sCheck * (knots[i + 1] - knots[i]));
+        time[0] = table->m_time;
+        for (int ifunc = 0; ifunc < numFunctions; ++ifunc) {
+            const double expected = splines[ifunc]->calcValue(time);
+            if (std::abs(table->m_values[ifunc] - expected) >
+                    1e-8 * (1 + std::abs(expected))) {
+                table.reset();
+                return table;
+            }
+        }
+    }
+    table->m_time = SimTK::NaN;
+    return table;
+}
+
+} // anonymous namespace
+
 class SimTKPositionMotionImplementation
         : public SimTK::Motion::Custom::Implementation {
 public:
-    void setFunctions(std::vector<Function*> functions) {
+    /// If table is not null, indices contains the index within the table of
+    /// each function.
+    void setFunctions(std::vector<Function*> functions,
+            std::shared_ptr<const PositionMotionTable> table,
+            std::vector<int> indices) {
         m_functions = std::move(functions);
+        m_table = std::move(table);
+        m_indices = std::move(indices);
     }
 
     SimTK::Motion::Level getLevel(const SimTK::State&) const override {
@@ -43,6 +242,12 @@ public:
     void calcPrescribedPosition(
             const SimTK::State& s, int nq, SimTK::Real* q) const override {
         if (m_functions.size()) {
+            if (m_table && m_table->realize(s.getTime())) {
+                for (int i = 0; i < nq; ++i) {
+                    q[i] = m_table->getValue(m_indices[i]);
+                }
+                return;
+            }
             for (int i = 0; i < nq; ++i) {
                 m_funcArgs[0] = s.getTime();
                 q[i] = m_functions[i]->calcValue(m_funcArgs);
@@ -52,6 +257,12 @@ public:
     void calcPrescribedPositionDot(
             const SimTK::State& s, int nq, SimTK::Real* qdot) const override {
         if (m_functions.size()) {
+            if (m_table && m_table->realize(s.getTime())) {
+                for (int i = 0; i < nq; ++i) {
+                    qdot[i] = m_table->getSpeed(m_indices[i]);
+                }
+                return;
+            }
             for (int i = 0; i < nq; ++i) {
                 m_funcArgs[0] = s.getTime();
                 qdot[i] = m_functions[i]->calcDerivative(
@@ -62,6 +273,12 @@ public:
     void calcPrescribedPositionDotDot(const SimTK::State& s, int nq,
             SimTK::Real* qdotdot) const override {
         if (m_functions.size()) {
+            if (m_table && m_table->realize(s.getTime())) {
+                for (int i = 0; i < nq; ++i) {
+                    qdotdot[i] = m_table->getAcceleration(m_indices[i]);
+                }
+                return;
+            }
             for (int i = 0; i < nq; ++i) {
                 m_funcArgs[0] = s.getTime();
                 qdotdot[i] = m_functions[i]->calcDerivative(
@@ -72,6 +289,8 @@ public:
 
 private:
     std::vector<Function*> m_functions;
+    std::shared_ptr<const PositionMotionTable> m_table;
+    std::vector<int> m_indices;
     mutable SimTK::Vector m_funcArgs = SimTK::Vector(1);
     static const std::vector<int> m_qdotDerivComponents;
     static const std::vector<int> m_qdotdotDerivComponents;
@@ -86,9 +305,12 @@ class SimTKPositionMotion : public SimTK::Motion::Custom {
 public:
     SimTKPositionMotion(SimTK::MobilizedBody& mobod)
             : Motion::Custom(mobod, new SimTKPositionMotionImplementation()) {}
-    void setFunctions(std::vector<Function*> functions) {
+    void setFunctions(std::vector<Function*> functions,
+            std::shared_ptr<const PositionMotionTable> table,
+            std::vector<int> indices) {
         static_cast<SimTKPositionMotionImplementation&>(updImplementation())
-                .setFunctions(std::move(functions));
+                .setFunctions(std::move(functions), std::move(table),
+                        std::move(indices));
     }
 };
 
@@ -208,12 +430,24 @@ void PositionMotion::extendRealizeTopology(SimTK::State& state) const {
         indicesToCoordName[std::make_pair(mbi, qIndex)] = path;
     }
 
+    // Convert the functions into a table, if possible. Column i of the table
+    // corresponds to function i.
+    std::vector<const Function*> functions;
+    for (int i = 0; i < get_functions().getSize(); ++i) {
+        functions.push_back(&get_functions().get(i));
+    }
+    // The table is shared by the SimTK::Motions for all MobilizedBodies.
+    std::shared_ptr<const PositionMotionTable> table(
+            PositionMotionTable::create(functions));
+    m_usingPolynomialTable = table != nullptr;
+
     auto& matter = getSystem().getMatterSubsystem();
     for (SimTK::MobilizedBodyIndex mbi(0); mbi < matter.getNumBodies(); ++mbi) {
         auto& mobod = matter.getMobilizedBody(mbi);
         // Create the vector of functions to provide to the SimTK::Motion for
         // this MobilizedBody.
         std::vector<Function*> mobodFunctions;
+        std::vector<int> mobodIndices;
         for (int iq = 0; iq < mobod.getNumQ(state); ++iq) {
             const auto key = std::make_pair(mbi, iq);
             // This skips over unused quaternion slots, as indicesToCoordName
@@ -222,10 +456,12 @@ void PositionMotion::extendRealizeTopology(SimTK::State& state) const {
                 const auto& coordName = indicesToCoordName.at(key);
                 mobodFunctions.push_back(
                         const_cast<Function*>(&get_functions().get(coordName)));
+                mobodIndices.push_back(get_functions().getIndex(coordName));
             }
         }
         auto& motion = const_cast<SimTK::Motion&>(m_motions[mbi]);
         auto& customMotion = static_cast<SimTKPositionMotion&>(motion);
-        customMotion.setFunctions(std::move(mobodFunctions));
+        customMotion.setFunctions(
+                std::move(mobodFunctions), table, std::move(mobodIndices));
     }
 }
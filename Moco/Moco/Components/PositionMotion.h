@@ -40,6 +40,16 @@ class StatesTrajectory;
 /// constraint forces to apply to enforce the prescribed motion;
 /// such forces are available via SimbodyMatterSubsystem::findMotionForces().
 /// @note This class requires that *all* coordinates are prescribed.
+///
+/// If all functions are GCVSpline%s with the same knots (as created by
+/// createFromTable() and createFromStatesTrajectory()), the splines are
+/// converted into a table of polynomial coefficients for each interval
+/// between knots when the system is created. The value, speed, and
+/// acceleration of all coordinates are then computed together from this
+/// table (once per time), which is much faster than evaluating each
+/// function and its derivatives separately. The result is the same as
+/// evaluating the splines, up to roundoff error. Times outside the knots are
+/// evaluated with the functions directly.
 class OSIMMOCO_API PositionMotion : public ModelComponent {
     OpenSim_DECLARE_CONCRETE_OBJECT(PositionMotion, ModelComponent);
 
@@ -93,6 +103,10 @@ public:
     static std::unique_ptr<PositionMotion> createFromStatesTrajectory(
             const Model& model, const StatesTrajectory& statesTraj);
     TimeSeriesTable exportToTable(const std::vector<double>& time) const;
+    /// Whether the functions were converted into a table of polynomial
+    /// coefficients (see above) when the system was created. This is false
+    /// before Model::initSystem().
+    bool isUsingPolynomialTable() const { return m_usingPolynomialTable; }
 
 private:
     /// Allocate SimTK::Motion%s.
@@ -101,6 +115,7 @@ private:
     /// so that we can iterate through the system's MobilizedBodies.
     void extendRealizeTopology(SimTK::State& state) const override;
     mutable SimTK::ResetOnCopy<std::vector<SimTK::Motion>> m_motions;
+    mutable SimTK::ResetOnCopy<bool> m_usingPolynomialTable = false;
 };
 
 } // namespace OpenSim
@@ -0,0 +1,557 @@
+/* -------------------------------------------------------------------------- *
+ * OpenSim Moco: SmoothMultiSphereHalfSpaceForce.cpp                          *
+ * -------------------------------------------------------------------------- *
+ * Copyright (c) 2026 Stanford University and the Authors                     *
+ *                                                                            *
+ * Author(s): agent                                                           *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0          *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "SmoothMultiSphereHalfSpaceForce.h"
+
+#include <OpenSim/Simulation/Model/Model.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+        (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    define MOCO_SMOOTH_MULTI_SPHERE_SSE2
+#    include <emmintrin.h>
+#endif
+
+using namespace OpenSim;
+
+namespace {
+
+// The contact law below is written once, as a template, and instantiated for
+// a single double (scalar) and for a pack of two doubles (SSE2). The
+// arithmetic operators and the functions calcSqrt(), calcMin(), and
+// calcExp() are overloaded for both.
+
+constexpr double expLog2e = 1.4426950408889634073599;
+// ln(2) split into a part with a short mantissa (exact when multiplied by n)
+// and the remainder (Cody-Waite argument reduction).
+constexpr double expLn2High = 6.93145751953125e-1;
+constexpr double expLn2Low = 1.42860682030941723212e-6;
+// Clamping the argument keeps 2^n a normal number; exp(-708) is negligible
+// compared to 1 wherever it is used below.
+constexpr double expMaxArg = 708.0;
+
+/// exp(r) for |r| <= ln(2) / 2, using the rational approximation from
+/// Cephes' exp(), which is accurate to about 1 ulp.
+template <typename T>
+T calcExpOfReducedArg(const T& r) {
+    const T rr = r * r;
+    const T p = r * ((1.26177193074810590878e-4 * rr +
+                             3.02994407707441961300e-2) *
+                                    rr +
+                            9.99999999999999999910e-1);
+    const T q = ((3.00198505138664455042e-6 * rr +
+                         2.52448340349684104192e-3) *
+                                rr +
+                        2.27265548208155028766e-1) *
+                        rr +
+                2.00000000000000000009e0;
+    return 1.0 + 2.0 * p / (q - p);
+}
+
+// exp(x) = 2^n exp(x - n ln(2)), with n the integer nearest to x / ln(2).
+double calcExp(double x) {
+    x = std::min(std::max(x, -expMaxArg), expMaxArg);
+    const double n = std::nearbyint(x * expLog2e);
+    const double r = x - n * expLn2High - n * expLn2Low;
+    return std::ldexp(calcExpOfReducedArg(r), (int)n);
+}
+double calcSqrt(double x) { return std::sqrt(x); }
+double calcMin(double a, double b) { return std::min(a, b); }
+
+#ifdef MOCO_SMOOTH_MULTI_SPHERE_SSE2
+/// Two doubles, processed together with SSE2 instructions.
+struct Pack {
+    static constexpr int size = 2;
+    Pack(__m128d v) : v(v) {}
+    Pack(double a) : v(_mm_set1_pd(a)) {}
+    explicit Pack(const double* p) : v(_mm_loadu_pd(p)) {}
+    void store(double* p) const { _mm_storeu_pd(p, v); }
+    __m128d v;
+};
+Pack operator+(const Pack& a, const Pack& b) { return _mm_add_pd(a.v, b.v); }
+Pack operator-(const Pack& a, const Pack& b) { return _mm_sub_pd(a.v, b.v); }
+Pack operator*(const Pack& a, const Pack& b) { return _mm_mul_pd(a.v, b.v); }
+Pack operator/(const Pack& a, const Pack& b) { return _mm_div_pd(a.v, b.v); }
+Pack calcSqrt(const Pack& x) { return _mm_sqrt_pd(x.v); }
+Pack calcMin(const Pack& a, const Pack& b) { return _mm_min_pd(a.v, b.v); }
+Pack calcExp(const Pack& x) {
+    const __m128d clamped = _mm_max_pd(_mm_min_pd(x.v, _mm_set1_pd(expMaxArg)),
+            _mm_set1_pd(-expMaxArg));
+    // Converting to integers rounds to the nearest integer (in the default
+    // rounding mode).
+    const __m128i ni =
+            _mm_cvtpd_epi32(_mm_mul_pd(clamped, _mm_set1_pd(expLog2e)));
+    const Pack n = _mm_cvtepi32_pd(ni);
+    const Pack r = Pack(clamped) - n * expLn2High - n * expLn2Low;
+    // Form 2^n by writing the biased exponent n + 1023 into the exponent
+    // bits of each double.
+    const __m128i biased = _mm_add_epi32(ni, _mm_set1_epi32(1023));
+    const __m128i pow2n = _mm_slli_epi64(
+            _mm_shuffle_epi32(biased, _MM_SHUFFLE(1, 1, 0, 0)), 52);
+    return calcExpOfReducedArg(r) * Pack(_mm_castsi128_pd(pow2n));
+}
+#endif
+
+/// Contact parameters shared by all spheres.
+struct ContactLaw {
+    double k;
+    double dissipation;
+    double transitionVelocity;
+    double staticFriction;
+    double dynamicFriction;
+    double viscousFriction;
+    double constantContactForce;
+    double hertzSmoothing;
+    double huntCrossleySmoothing;
+    double huntCrossleyOffset;
+};
+
+/// The smoothed Hertz, Hunt-Crossley, and friction laws of
+/// SmoothSphereHalfSpaceForce. We use 0.5 + 0.5 tanh(x) = 1 / (1 + exp(-2x))
+/// and pow(s, 1.5) = s sqrt(s), so that only exp() and sqrt() are needed.
+template <typename T>
+void calcContactLaw(const ContactLaw& law, const T& radius,
+        const T& indentation, const T& indentationVelocity,
+        const T& slipSpeedSquared, T& normalForce, T& frictionForceOverSlip) {
+    const T& d = indentation;
+    const T& v = indentationVelocity;
+    // Smoothed Hertz force.
+    const T s = calcSqrt(d * d + law.constantContactForce);
+    const T hertz = (4.0 / 3.0) * law.k * calcSqrt(radius * law.k) * s *
+                    calcSqrt(s) /
+                    (1.0 + calcExp(-2.0 * law.hertzSmoothing * d));
+    // Smoothed Hunt-Crossley force.
+    normalForce = hertz * (1.0 + 1.5 * law.dissipation * v) /
+                  (1.0 + calcExp(-2.0 * law.huntCrossleySmoothing *
+                                 (v + law.huntCrossleyOffset)));
+    // Friction.
+    const T slip = calcSqrt(slipSpeedSquared + law.constantContactForce);
+    const T vrel = slip / law.transitionVelocity;
+    const T frictionCoefficient =
+            calcMin(vrel, 1.0) *
+                    (law.dynamicFriction +
+                            2.0 * (law.staticFriction - law.dynamicFriction) /
+                                    (1.0 + vrel * vrel)) +
+            law.viscousFriction * slip;
+    frictionForceOverSlip = normalForce * frictionCoefficient / slip;
+}
+
+/// Working memory for the spheres of a SmoothMultiSphereHalfSpaceForce. Each
+/// thread has its own instance (see calcContactForces()), since a model may
+/// be evaluated by multiple threads at once (e.g., by the parallel solvers).
+struct SphereWorkspace {
+    std::vector<double> indentation;
+    std::vector<double> indentationVelocity;
+    std::vector<SimTK::Vec3> tangentVelocity;
+    std::vector<double> slipSpeedSquared;
+    std::vector<double> normalForce;
+    std::vector<double> frictionForceOverSlip;
+    void resize(int numSpheres) {
+        indentation.resize(numSpheres);
+        indentationVelocity.resize(numSpheres);
+        tangentVelocity.resize(numSpheres);
+        slipSpeedSquared.resize(numSpheres);
+        normalForce.resize(numSpheres);
+        frictionForceOverSlip.resize(numSpheres);
+    }
+};
+
+} // anonymous namespace
+
+SmoothMultiSphereHalfSpaceForce::SmoothMultiSphereHalfSpaceForce() {
+    constructProperties();
+}
+
+SmoothMultiSphereHalfSpaceForce::SmoothMultiSphereHalfSpaceForce(
+        const std::string& name, const Frame& contactSphereBodyFrame,
+        const Frame& contactHalfSpaceBodyFrame,
+        SimTK::Vec3 contactHalfSpaceLocation,
+        SimTK::Vec3 contactHalfSpaceOrientation) {
+    setName(name);
+    connectSocket_sphere_frame(contactSphereBodyFrame);
+    connectSocket_half_space_frame(contactHalfSpaceBodyFrame);
+
+    constructProperties();
+    set_contact_half_space_location(contactHalfSpaceLocation);
+    set_contact_half_space_orientation(contactHalfSpaceOrientation);
+}
+
+void SmoothMultiSphereHalfSpaceForce::constructProperties() {
+    constructProperty_contact_sphere_radii();
+    constructProperty_contact_sphere_locations();
+    constructProperty_contact_half_space_location(SimTK::Vec3(0));
+    constructProperty_contact_half_space_orientation(
+            SimTK::Vec3(0, 0, -0.5 * SimTK::Pi));
+    constructProperty_stiffness(1.0);
+    constructProperty_dissipation(0.0);
+    constructProperty_static_friction(0.0);
+    constructProperty_dynamic_friction(0.0);
+    constructProperty_viscous_friction(0.0);
+    constructProperty_transition_velocity(0.01);
+    constructProperty_constant_contact_force(1e-5);
+    constructProperty_hertz_smoothing(300.0);
+    constructProperty_hunt_crossley_smoothing(50.0);
+    constructProperty_force_visualization_radius(0.01);
+    constructProperty_force_visualization_scale_factor();
+
+    Appearance defaultAppearance;
+    defaultAppearance.set_color(SimTK::Cyan);
+    defaultAppearance.set_representation(VisualRepresentation::DrawWireframe);
+    constructProperty_Appearance(defaultAppearance);
+}
+
+SimTK::Transform
+SmoothMultiSphereHalfSpaceForce::getHalfSpaceTransformInHalfSpaceFrame()
+        const {
+    return {SimTK::Rotation(SimTK::BodyRotationSequence,
+                    get_contact_half_space_orientation()[0], SimTK::XAxis,
+                    get_contact_half_space_orientation()[1], SimTK::YAxis,
+                    get_contact_half_space_orientation()[2], SimTK::ZAxis),
+            get_contact_half_space_location()};
+}
+
+void SmoothMultiSphereHalfSpaceForce::extendFinalizeFromProperties() {
+    Super::extendFinalizeFromProperties();
+    OPENSIM_THROW_IF_FRMOBJ(getProperty_contact_sphere_radii().size() !=
+                                    getProperty_contact_sphere_locations()
+                                            .size(),
+            Exception,
+            format("Expected contact_sphere_radii and "
+                   "contact_sphere_locations to have the same number of "
+                   "elements, but got %i and %i.",
+                    getProperty_contact_sphere_radii().size(),
+                    getProperty_contact_sphere_locations().size()));
+    const int numSpheres = getNumContactSpheres();
+    m_sphereRadii.resize(numSpheres);
+    for (int i = 0; i < numSpheres; ++i) {
+        m_sphereRadii[i] = get_contact_sphere_radii(i);
+    }
+}
+
+void SmoothMultiSphereHalfSpaceForce::extendConnectToModel(Model& model) {
+    Super::extendConnectToModel(model);
+    const auto& sphereFrame = getConnectee<PhysicalFrame>("sphere_frame");
+    const auto& halfSpaceFrame =
+            getConnectee<PhysicalFrame>("half_space_frame");
+    const SimTK::Transform X_BS = sphereFrame.findTransformInBaseFrame();
+    m_sphereLocationsInBase.resize(getNumContactSpheres());
+    for (int i = 0; i < getNumContactSpheres(); ++i) {
+        m_sphereLocationsInBase[i] = X_BS * get_contact_sphere_locations(i);
+    }
+    m_halfSpaceTransformInBase = halfSpaceFrame.findTransformInBaseFrame() *
+                                 getHalfSpaceTransformInHalfSpaceFrame();
+}
+
+void SmoothMultiSphereHalfSpaceForce::extendAddToSystem(
+        SimTK::MultibodySystem& system) const {
+    Super::extendAddToSystem(system);
+    addCacheVariable("contact_points_in_ground", std::vector<SimTK::Vec3>(),
+            SimTK::Stage::Position);
+    addCacheVariable("forces_on_spheres", std::vector<SimTK::Vec3>(),
+            SimTK::Stage::Velocity);
+}
+
+void SmoothMultiSphereHalfSpaceForce::extendRealizeInstance(
+        const SimTK::State& state) const {
+    Super::extendRealizeInstance(state);
+    if (!getProperty_force_visualization_scale_factor().empty()) {
+        m_forceVizScaleFactor = get_force_visualization_scale_factor();
+    } else {
+        const Model& model = getModel();
+        const double mass = model.getTotalMass(state);
+        const double weight = mass * model.getGravity().norm();
+        m_forceVizScaleFactor = 1 / weight;
+    }
+}
+
+const std::vector<SimTK::Vec3>&
+SmoothMultiSphereHalfSpaceForce::getContactPointsInGround(
+        const SimTK::State& state) const {
+    calcContactForces(state);
+    return getCacheVariableValue<std::vector<SimTK::Vec3>>(
+            state, "contact_points_in_ground");
+}
+
+const std::vector<SimTK::Vec3>&
+SmoothMultiSphereHalfSpaceForce::getContactForcesOnSpheres(
+        const SimTK::State& state) const {
+    calcContactForces(state);
+    return getCacheVariableValue<std::vector<SimTK::Vec3>>(
+            state, "forces_on_spheres");
+}
+
+void SmoothMultiSphereHalfSpaceForce::calcContactForces(
+        const SimTK::State& state) const {
+    if (isCacheVariableValid(state, "forces_on_spheres")) return;
+
+    const auto& sphereBody =
+            getConnectee<PhysicalFrame>("sphere_frame").getMobilizedBody();
+    const auto& halfSpaceBody =
+            getConnectee<PhysicalFrame>("half_space_frame").getMobilizedBody();
+
+    // Quantities shared by all spheres.
+    // ---------------------------------
+    const SimTK::Transform& X_GS = sphereBody.getBodyTransform(state);
+    const SimTK::Transform& X_GB = halfSpaceBody.getBodyTransform(state);
+    const SimTK::SpatialVec& V_GS = sphereBody.getBodyVelocity(state);
+    const SimTK::SpatialVec& V_GB = halfSpaceBody.getBodyVelocity(state);
+    const SimTK::Transform X_GH = X_GB * m_halfSpaceTransformInBase;
+    // The half space occupies the positive x side of its frame, so the
+    // outward normal is the negative x axis.
+    const SimTK::Vec3 normal = -X_GH.R().x().asVec3();
+    const SimTK::Real normalHalfSpaceOrigin = ~normal * X_GH.p();
+
+    ContactLaw law;
+    law.k = 0.5 * std::pow(get_stiffness(), 2.0 / 3.0);
+    law.dissipation = get_dissipation();
+    law.transitionVelocity = get_transition_velocity();
+    law.staticFriction = get_static_friction();
+    law.dynamicFriction = get_dynamic_friction();
+    law.viscousFriction = get_viscous_friction();
+    law.constantContactForce = get_constant_contact_force();
+    law.hertzSmoothing = get_hertz_smoothing();
+    law.huntCrossleySmoothing = get_hunt_crossley_smoothing();
+    law.huntCrossleyOffset = 2.0 / (3.0 * law.dissipation);
+
+    // Kinematics.
+    // -----------
+    const int numSpheres = (int)m_sphereRadii.size();
+    thread_local SphereWorkspace work;
+    work.resize(numSpheres);
+    auto& contactPoints = updCacheVariableValue<std::vector<SimTK::Vec3>>(
+            state, "contact_points_in_ground");
+    contactPoints.resize(numSpheres);
+    for (int i = 0; i < numSpheres; ++i) {
+        const SimTK::Vec3 center =
+                X_GS.p() + X_GS.R() * m_sphereLocationsInBase[i];
+        const double indentation =
+                m_sphereRadii[i] - (~normal * center - normalHalfSpaceOrigin);
+        // The contact point is midway between the surfaces of the sphere and
+        // the half space, assuming both have the same stiffness.
+        contactPoints[i] =
+                center - (m_sphereRadii[i] - 0.5 * indentation) * normal;
+        const SimTK::Vec3 velocity =
+                (V_GS[1] + V_GS[0] % (contactPoints[i] - X_GS.p())) -
+                (V_GB[1] + V_GB[0] % (contactPoints[i] - X_GB.p()));
+        const double normalVelocity = ~velocity * normal;
+        work.indentation[i] = indentation;
+        work.indentationVelocity[i] = -normalVelocity;
+        work.tangentVelocity[i] = velocity - normalVelocity * normal;
+        work.slipSpeedSquared[i] = work.tangentVelocity[i].normSqr();
+    }
+    markCacheVariableValid(state, "contact_points_in_ground");
+
+    // Contact law.
+    // ------------
+    int i = 0;
+#ifdef MOCO_SMOOTH_MULTI_SPHERE_SSE2
+    for (; i + Pack::size <= numSpheres; i += Pack::size) {
+        Pack normalForce(0.0);
+        Pack frictionForceOverSlip(0.0);
+        calcContactLaw<Pack>(law, Pack(&m_sphereRadii[i]),
+                Pack(&work.indentation[i]), Pack(&work.indentationVelocity[i]),
+                Pack(&work.slipSpeedSquared[i]), normalForce,
+                frictionForceOverSlip);
+        normalForce.store(&work.normalForce[i]);
+        frictionForceOverSlip.store(&work.frictionForceOverSlip[i]);
+    }
+#endif
+    // The remaining spheres (or all of them, without SSE2).
+    for (; i < numSpheres; ++i) {
+        calcContactLaw<double>(law, m_sphereRadii[i], work.indentation[i],
+                work.indentationVelocity[i], work.slipSpeedSquared[i],
+                work.normalForce[i], work.frictionForceOverSlip[i]);
+    }
+
+    auto& forces = updCacheVariableValue<std::vector<SimTK::Vec3>>(
+            state, "forces_on_spheres");
+    forces.resize(numSpheres);
+    for (int i = 0; i < numSpheres; ++i) {
+        forces[i] = -work.frictionForceOverSlip[i] * work.tangentVelocity[i] +
+                    work.normalForce[i] * normal;
+    }
+    markCacheVariableValid(state, "forces_on_spheres");
+}
+
+void SmoothMultiSphereHalfSpaceForce::computeForce(const SimTK::State& state,
+        SimTK::Vector_<SimTK::SpatialVec>& bodyForces,
+        SimTK::Vector& /*generalizedForces*/) const {
+    const auto& forces = getContactForcesOnSpheres(state);
+    const auto& contactPoints = getContactPointsInGround(state);
+
+    const auto& sphereBody =
+            getConnectee<PhysicalFrame>("sphere_frame").getMobilizedBody();
+    const auto& halfSpaceBody =
+            getConnectee<PhysicalFrame>("half_space_frame").getMobilizedBody();
+    const SimTK::Vec3& sphereOrigin = sphereBody.getBodyOriginLocation(state);
+    const SimTK::Vec3& halfSpaceOrigin =
+            halfSpaceBody.getBodyOriginLocation(state);
+    SimTK::SpatialVec sphereBodyForce(SimTK::Vec3(0), SimTK::Vec3(0));
+    SimTK::SpatialVec halfSpaceBodyForce(SimTK::Vec3(0), SimTK::Vec3(0));
+    for (int i = 0; i < (int)forces.size(); ++i) {
+        const SimTK::Vec3& force = forces[i];
+        sphereBodyForce[0] += (contactPoints[i] - sphereOrigin) % force;
+        sphereBodyForce[1] += force;
+        halfSpaceBodyForce[0] -= (contactPoints[i] - halfSpaceOrigin) % force;
+        halfSpaceBodyForce[1] -= force;
+    }
+    bodyForces[sphereBody.getMobilizedBodyIndex()] += sphereBodyForce;
+    bodyForces[halfSpaceBody.getMobilizedBodyIndex()] += halfSpaceBodyForce;
+}
+
+//=============================================================================
+//  REPORTING
+//=============================================================================
+OpenSim::Array<std::string>
+SmoothMultiSphereHalfSpaceForce::getRecordLabels() const {
+    OpenSim::Array<std::string> labels("");
+
+    labels.append(getName() + ".Sphere" + ".force.X");
+    labels.append(getName() + ".Sphere" + ".force.Y");
+    labels.append(getName() + ".Sphere" + ".force.Z");
+    labels.append(getName() + ".Sphere" + ".torque.X");
+    labels.append(getName() + ".Sphere" + ".torque.Y");
+    labels.append(getName() + ".Sphere" + ".torque.Z");
+
+    labels.append(getName() + ".HalfSpace" + ".force.X");
+    labels.append(getName() + ".HalfSpace" + ".force.Y");
+    labels.append(getName() + ".HalfSpace" + ".force.Z");
+    labels.append(getName() + ".HalfSpace" + ".torque.X");
+    labels.append(getName() + ".HalfSpace" + ".torque.Y");
+    labels.append(getName() + ".HalfSpace" + ".torque.Z");
+
+    for (int i = 0; i < getNumContactSpheres(); ++i) {
+        const std::string prefix = getName() + ".Sphere" + std::to_string(i);
+        labels.append(prefix + ".force.X");
+        labels.append(prefix + ".force.Y");
+        labels.append(prefix + ".force.Z");
+        labels.append(prefix + ".torque.X");
+        labels.append(prefix + ".torque.Y");
+        labels.append(prefix + ".torque.Z");
+    }
+
+    return labels;
+}
+
+OpenSim::Array<double> SmoothMultiSphereHalfSpaceForce::getRecordValues(
+        const SimTK::State& state) const {
+
+    const auto& sphereBody =
+            getConnectee<PhysicalFrame>("sphere_frame").getMobilizedBody();
+    const auto& halfSpaceBody =
+            getConnectee<PhysicalFrame>("half_space_frame").getMobilizedBody();
+
+    SimTK::Vector_<SimTK::SpatialVec> bodyForces(
+            getModel().getMatterSubsystem().getNumBodies(),
+            SimTK::SpatialVec(SimTK::Vec3(0), SimTK::Vec3(0)));
+    SimTK::Vector generalizedForces;
+    computeForce(state, bodyForces, generalizedForces);
+
+    OpenSim::Array<double> values(1);
+
+    // On sphere
+    const auto& sphereBodyForce =
+            bodyForces[sphereBody.getMobilizedBodyIndex()];
+    values.append(3, &sphereBodyForce[1][0]);
+    values.append(3, &sphereBodyForce[0][0]);
+
+    // On plane
+    const auto& halfSpaceBodyForce =
+            bodyForces[halfSpaceBody.getMobilizedBodyIndex()];
+    values.append(3, &halfSpaceBodyForce[1][0]);
+    values.append(3, &halfSpaceBodyForce[0][0]);
+
+    // On sphere, from each sphere.
+    const auto& forces = getContactForcesOnSpheres(state);
+    const auto& contactPoints = getContactPointsInGround(state);
+    const SimTK::Vec3& sphereOrigin = sphereBody.getBodyOriginLocation(state);
+    for (int i = 0; i < (int)forces.size(); ++i) {
+        const SimTK::Vec3 torque =
+                (contactPoints[i] - sphereOrigin) % forces[i];
+        values.append(3, &forces[i][0]);
+        values.append(3, &torque[0]);
+    }
+
+    return values;
+}
+
+void SmoothMultiSphereHalfSpaceForce::generateDecorations(bool fixed,
+        const ModelDisplayHints& hints, const SimTK::State& state,
+        SimTK::Array_<SimTK::DecorativeGeometry>& geometry) const {
+    Super::generateDecorations(fixed, hints, state, geometry);
+
+    const auto& sphereFrame = getConnectee<PhysicalFrame>("sphere_frame");
+
+    if (!fixed && (state.getSystemStage() >= SimTK::Stage::Dynamics) &&
+            hints.get_show_forces()) {
+        const auto& forces = getContactForcesOnSpheres(state);
+        for (int i = 0; i < (int)forces.size(); ++i) {
+            // Scale the contact force vector and compute the cylinder length.
+            const SimTK::Vec3 scaledContactForce =
+                    m_forceVizScaleFactor * forces[i];
+            const SimTK::Real length(scaledContactForce.norm());
+
+            const SimTK::Vec3 contactSpherePosition =
+                    sphereFrame.findStationLocationInGround(
+                            state, get_contact_sphere_locations(i));
+            const SimTK::Transform forceVizTransform(
+                    SimTK::Rotation(SimTK::UnitVec3(scaledContactForce),
+                            SimTK::YAxis),
+                    contactSpherePosition + scaledContactForce / 2.0);
+
+            SimTK::DecorativeCylinder forceViz(
+                    get_force_visualization_radius(), 0.5 * length);
+            forceViz.setTransform(forceVizTransform);
+            forceViz.setColor(SimTK::Vec3(0.0, 0.6, 0.0));
+            geometry.push_back(forceViz);
+        }
+    }
+
+    if (!hints.get_show_contact_geometry()) return;
+
+    for (int i = 0; i < (int)m_sphereLocationsInBase.size(); ++i) {
+        geometry.push_back(
+                SimTK::DecorativeSphere(get_contact_sphere_radii(i))
+                        .setTransform(m_sphereLocationsInBase[i])
+                        .setScale(1)
+                        .setRepresentation(
+                                get_Appearance().get_representation())
+                        .setBodyId(sphereFrame.getMobilizedBodyIndex())
+                        .setColor(get_Appearance().get_color())
+                        .setOpacity(get_Appearance().get_opacity()));
+    }
+    {
+        static const double brickHalfThickness = 0.0005;
+
+        const auto& halfSpaceFrame =
+                getConnectee<PhysicalFrame>("half_space_frame");
+        // The brick is centered on the origin. To ensure the
+        // decorative geometry is within the contact geometry,
+        // we must offset by half the thickness of the brick.
+        SimTK::Transform X_within(SimTK::Vec3(brickHalfThickness, 0, 0));
+        geometry.push_back(
+                SimTK::DecorativeBrick(
+                        SimTK::Vec3(brickHalfThickness, 0.5, 0.5))
+                        .setTransform(m_halfSpaceTransformInBase * X_within)
+                        .setScale(1)
+                        .setRepresentation(
+                                get_Appearance().get_representation())
+                        .setBodyId(halfSpaceFrame.getMobilizedBodyIndex())
+                        .setColor(get_Appearance().get_color())
+                        .setOpacity(get_Appearance().get_opacity()));
+    }
+}
@@ -0,0 +1,193 @@
+#ifndef MOCO_SMOOTH_MULTI_SPHERE_HALFSPACE_FORCE_H
+#define MOCO_SMOOTH_MULTI_SPHERE_HALFSPACE_FORCE_H
+/* -------------------------------------------------------------------------- *
+ * OpenSim Moco: SmoothMultiSphereHalfSpaceForce.h                            *
+ * -------------------------------------------------------------------------- *
+ * Copyright (c) 2026 Stanford University and the Authors                     *
+ *                                                                            *
+ * Author(s): agent                                                           *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0          *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "../MocoUtilities.h"
+#include "../osimMocoDLL.h"
+
+#include <OpenSim/Simulation/Model/Force.h>
+
+namespace OpenSim {
+
+/// Contact between many spheres attached to one frame and a single half
+/// space, using the same smoothed Hertz, Hunt-Crossley, and friction laws as
+/// SmoothSphereHalfSpaceForce. One instance of this force is equivalent to
+/// one SmoothSphereHalfSpaceForce per sphere (with the same contact
+/// parameters), but is faster: the transforms and velocities of the two
+/// bodies are computed once for all spheres, and the contact law is evaluated
+/// over contiguous arrays of sphere quantities, two spheres at a time with
+/// SSE2 instructions on x86 processors (other processors use an equivalent
+/// scalar loop). This is useful for feet with many contact spheres.
+///
+/// The contact law is evaluated with the logistic function in place of
+/// 0.5 + 0.5 tanh(), and with a rational approximation of exp() that is
+/// accurate to about 1 ulp, so the forces agree with those of
+/// SmoothSphereHalfSpaceForce to within roundoff.
+///
+/// The spheres are specified with the list properties
+/// contact_sphere_locations (in the sphere frame) and contact_sphere_radii,
+/// which must have the same number of elements.
+///
+/// @underdevelopment
+class OSIMMOCO_API SmoothMultiSphereHalfSpaceForce : public Force {
+    OpenSim_DECLARE_CONCRETE_OBJECT(SmoothMultiSphereHalfSpaceForce, Force);
+
+public:
+    //=========================================================================
+    // PROPERTIES
+    //=========================================================================
+    OpenSim_DECLARE_PROPERTY(stiffness, double,
+            "The stiffness constant (i.e., plain strain modulus), "
+            "default is 1 (N/m^2)");
+    OpenSim_DECLARE_PROPERTY(dissipation, double,
+            "The dissipation coefficient, default is 0 (s/m).");
+    OpenSim_DECLARE_PROPERTY(static_friction, double,
+            "The coefficient of static friction, default is 0.");
+    OpenSim_DECLARE_PROPERTY(dynamic_friction, double,
+            "The coefficient of dynamic friction, default is 0.");
+    OpenSim_DECLARE_PROPERTY(viscous_friction, double,
+            "The coefficient of viscous friction, default is 0.");
+    OpenSim_DECLARE_PROPERTY(transition_velocity, double,
+            "The transition velocity, default is 0.01 (m/s).");
+    OpenSim_DECLARE_PROPERTY(constant_contact_force, double,
+            "The constant that enforces non-null derivatives, "
+            "default is 1e-5.");
+    OpenSim_DECLARE_PROPERTY(hertz_smoothing, double,
+            "The parameter that determines the smoothness of the transition "
+            "of the tanh used to smooth the Hertz force. The larger the "
+            "steeper the transition but the worse for optimization, "
+            "default is 300.");
+    OpenSim_DECLARE_PROPERTY(hunt_crossley_smoothing, double,
+            "The parameter that determines the smoothness of the transition "
+            "of the tanh used to smooth the Hunt-Crossley force. The larger "
+            "the steeper the transition but the worse for optimization, "
+            "default is 50.");
+    OpenSim_DECLARE_LIST_PROPERTY(contact_sphere_radii, double,
+            "The radius of each contact sphere.");
+    OpenSim_DECLARE_LIST_PROPERTY(contact_sphere_locations, SimTK::Vec3,
+            "The location of each contact sphere in the sphere frame.");
+    OpenSim_DECLARE_PROPERTY(contact_half_space_location, SimTK::Vec3,
+            "The location of the contact half space in the half space frame, "
+            "default is Vec3(0).");
+    OpenSim_DECLARE_PROPERTY(contact_half_space_orientation, SimTK::Vec3,
+            "The orientation of the contact half space in the half space "
+            "frame (body-fixed XYZ Euler angles), default represents ground "
+            "(0,0,-0.5*SimTK::Pi).");
+    OpenSim_DECLARE_PROPERTY(force_visualization_radius, double,
+            "The radius of the cylinder that visualizes contact "
+            "forces generated by this force component. Default: 0.01 m");
+    OpenSim_DECLARE_OPTIONAL_PROPERTY(force_visualization_scale_factor, double,
+            "(Optional) The scale factor that determines the length of the "
+            "cylinder that visualizes contact forces generated by this force "
+            "component. The cylinder will be one meter long when the contact "
+            "force magnitude is equal to this value. If this property is not "
+            "specified, the total weight of the model is used "
+            "as the scale factor.")
+    OpenSim_DECLARE_UNNAMED_PROPERTY(
+            Appearance, "Default appearance for this Geometry");
+
+    //=========================================================================
+    // SOCKETS
+    //=========================================================================
+    OpenSim_DECLARE_SOCKET(sphere_frame, PhysicalFrame,
+            "The body to which the contact spheres are attached.");
+    OpenSim_DECLARE_SOCKET(half_space_frame, PhysicalFrame,
+            "The body to which the contact half space is attached.");
+
+    //=========================================================================
+    // PUBLIC METHODS
+    //=========================================================================
+    SmoothMultiSphereHalfSpaceForce();
+
+    SmoothMultiSphereHalfSpaceForce(const std::string& name,
+            const Frame& contactSphereBodyFrame,
+            const Frame& contactHalfSpaceBodyFrame,
+            SimTK::Vec3 contactHalfSpaceLocation,
+            SimTK::Vec3 contactHalfSpaceOrientation);
+
+    /// Append a contact sphere.
+    void addContactSphere(SimTK::Vec3 location, double radius) {
+        append_contact_sphere_locations(location);
+        append_contact_sphere_radii(radius);
+    }
+    int getNumContactSpheres() const {
+        return getProperty_contact_sphere_radii().size();
+    }
+
+    SimTK::Transform getHalfSpaceTransformInHalfSpaceFrame() const;
+
+    /// The point of application of the contact force from each sphere,
+    /// expressed in ground. The point is midway between the surfaces of the
+    /// sphere and the half space.
+    const std::vector<SimTK::Vec3>& getContactPointsInGround(
+            const SimTK::State& state) const;
+    /// The force applied to the sphere frame's body by each sphere, at the
+    /// sphere's contact point, expressed in ground. The force on the half
+    /// space's body is the negation.
+    const std::vector<SimTK::Vec3>& getContactForcesOnSpheres(
+            const SimTK::State& state) const;
+
+    //=========================================================================
+    // REPORTING
+    //=========================================================================
+    /// Obtain names of the quantities (column labels) of the force values to
+    /// be reported. The first 12 values have the same meaning as in
+    /// SmoothSphereHalfSpaceForce: the three forces and three torques applied
+    /// on the sphere frame's body followed by the three forces and three
+    /// torques applied on the half space's body, summed over all spheres.
+    /// Next are the three forces and three torques applied to the sphere
+    /// frame's body by each sphere. Forces and torques are expressed in the
+    /// ground frame, and torques are about the origin of the body.
+    OpenSim::Array<std::string> getRecordLabels() const override;
+    /// Obtain the values to be reported that correspond to the labels. The
+    /// values are expressed in the ground frame.
+    OpenSim::Array<double> getRecordValues(
+            const SimTK::State& state) const override;
+
+protected:
+    void extendFinalizeFromProperties() override;
+    void extendConnectToModel(Model& model) override;
+    void extendAddToSystem(SimTK::MultibodySystem& system) const override;
+    void extendRealizeInstance(const SimTK::State& state) const override;
+    void computeForce(const SimTK::State& state,
+            SimTK::Vector_<SimTK::SpatialVec>& bodyForces,
+            SimTK::Vector& generalizedForces) const override;
+    void generateDecorations(bool fixed, const ModelDisplayHints& hints,
+            const SimTK::State& state,
+            SimTK::Array_<SimTK::DecorativeGeometry>& geometry) const override;
+
+private:
+    void constructProperties();
+
+    /// Fill the cache variables for the contact points in ground and the
+    /// forces on the spheres, if they are not already valid.
+    void calcContactForces(const SimTK::State& state) const;
+
+    // The sphere locations in the base frame of the sphere frame.
+    std::vector<SimTK::Vec3> m_sphereLocationsInBase;
+    std::vector<double> m_sphereRadii;
+    // The half space frame in the base frame of the half space frame.
+    SimTK::Transform m_halfSpaceTransformInBase;
+
+    mutable double m_forceVizScaleFactor;
+};
+
+} // namespace OpenSim
+
+#endif // MOCO_SMOOTH_MULTI_SPHERE_HALFSPACE_FORCE_H
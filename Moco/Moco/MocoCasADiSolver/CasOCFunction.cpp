@@ -92,16 +92,39 @@ casadi::Sparsity Function::get_jacobian_sparsity() const {
         }
 
         // Evaluate the function.
-        std::vector<casadi::DM> out = this->eval(in);
+        std::vector<casadi::DM> out = this->evalImpl(in);
 
         // Create output.
         y = casadi::DM::veccat(out);
     };
 
+    SparsityCache* cache = m_casProblem->getSparsityCache();
+    if (cache) {
+        const auto it = cache->patterns.find(this->name());
+        if (it != cache->patterns.end() &&
+                it->second.size1() == this->nnz_out() &&
+                it->second.size2() == this->nnz_in()) {
+            return it->second;
+        }
+    }
+
+    const long long start = SimTK::realTimeInNs();
     const VectorDM x0s = getSubsetPointsForSparsityDetection();
 
-    return calcJacobianSparsityWithPerturbation(
+    const auto sparsity = calcJacobianSparsityWithPerturbation(
             x0s, (int)this->nnz_out(), function);
+    m_sparsityDetectionTimeInNs += SimTK::realTimeInNs() - start;
+    if (cache) cache->patterns[this->name()] = sparsity;
+    return sparsity;
+}
+
+VectorDM Function::eval(const VectorDM& args) const {
+    const long long start = SimTK::realTimeInNs();
+    VectorDM out = evalImpl(args);
+    m_evaluationTimeInNs.fetch_add(
+            SimTK::realTimeInNs() - start, std::memory_order_relaxed);
+    m_numEvaluations.fetch_add(1, std::memory_order_relaxed);
+    return out;
 }
 
 void Function::constructFunction(const Problem* casProblem,
@@ -111,6 +134,8 @@ void Function::constructFunction(const Problem* casProblem,
     m_casProblem = casProblem;
     m_finite_difference_scheme = finiteDiffScheme;
     m_fullPointsForSparsityDetection = pointsForSparsityDetection;
+    resetEvaluationStatistics();
+    casProblem->addFunction(this);
     casadi::Dict opts;
     setCommonOptions(opts);
     this->construct(name, opts);
@@ -134,7 +159,7 @@ casadi::Sparsity Function::get_sparsity_in(casadi_int i) {
     }
 }
 
-VectorDM PathConstraint::eval(const VectorDM& args) const {
+VectorDM PathConstraint::evalImpl(const VectorDM& args) const {
     Problem::ContinuousInput input{args.at(0).scalar(), args.at(1), args.at(2),
             args.at(3), args.at(4), args.at(5)};
     VectorDM out{casadi::DM(sparsity_out(0))};
@@ -142,7 +167,7 @@ VectorDM PathConstraint::eval(const VectorDM& args) const {
     return out;
 }
 
-VectorDM CostIntegrand::eval(const VectorDM& args) const {
+VectorDM CostIntegrand::evalImpl(const VectorDM& args) const {
     Problem::ContinuousInput input{args.at(0).scalar(), args.at(1), args.at(2),
             args.at(3), args.at(4), args.at(5)};
     VectorDM out{casadi::DM(casadi::Sparsity::scalar())};
@@ -150,7 +175,7 @@ VectorDM CostIntegrand::eval(const VectorDM& args) const {
     return out;
 }
 
-VectorDM EndpointConstraintIntegrand::eval(const VectorDM& args) const {
+VectorDM EndpointConstraintIntegrand::evalImpl(const VectorDM& args) const {
     Problem::ContinuousInput input{args.at(0).scalar(), args.at(1), args.at(2),
                                    args.at(3), args.at(4), args.at(5)};
     VectorDM out{casadi::DM(casadi::Sparsity::scalar())};
@@ -188,7 +213,7 @@ casadi::Sparsity Endpoint::get_sparsity_in(casadi_int i) {
         return casadi::Sparsity(0, 0);
     }
 }
-VectorDM Cost::eval(const VectorDM& args) const {
+VectorDM Cost::evalImpl(const VectorDM& args) const {
     Problem::CostInput input{args.at(0).scalar(), args.at(1), args.at(2),
             args.at(3), args.at(4), args.at(5).scalar(), args.at(6), args.at(7),
             args.at(8), args.at(9), args.at(10), args.at(11).scalar()};
@@ -196,7 +221,7 @@ VectorDM Cost::eval(const VectorDM& args) const {
     m_casProblem->calcCost(m_index, input, out.at(0));
     return out;
 }
-VectorDM EndpointConstraint::eval(const VectorDM& args) const {
+VectorDM EndpointConstraint::evalImpl(const VectorDM& args) const {
     Problem::CostInput input{args.at(0).scalar(), args.at(1), args.at(2),
             args.at(3), args.at(4), args.at(5).scalar(), args.at(6), args.at(7),
             args.at(8), args.at(9), args.at(10), args.at(11).scalar()};
@@ -230,7 +255,7 @@ casadi::Sparsity MultibodySystemExplicit<CalcKCErrors>::get_sparsity_out(
 }
 
 template <bool CalcKCErrors>
-VectorDM MultibodySystemExplicit<CalcKCErrors>::eval(
+VectorDM MultibodySystemExplicit<CalcKCErrors>::evalImpl(
         const VectorDM& args) const {
     Problem::ContinuousInput input{args.at(0).scalar(), args.at(1), args.at(2),
             args.at(3), args.at(4), args.at(5)};
@@ -283,7 +308,7 @@ casadi::DM VelocityCorrection::getSubsetPoint(
             fullPoint.at(slacks)(Slice(), itime), fullPoint.at(parameters)});
 }
 
-VectorDM VelocityCorrection::eval(const VectorDM& args) const {
+VectorDM VelocityCorrection::evalImpl(const VectorDM& args) const {
     VectorDM out{casadi::DM(sparsity_out(0))};
     m_casProblem->calcVelocityCorrection(
             args.at(0).scalar(), args.at(1), args.at(2), args.at(3), out[0]);
@@ -315,7 +340,7 @@ casadi::Sparsity MultibodySystemImplicit<CalcKCErrors>::get_sparsity_out(
 }
 
 template <bool CalcKCErrors>
-VectorDM MultibodySystemImplicit<CalcKCErrors>::eval(
+VectorDM MultibodySystemImplicit<CalcKCErrors>::evalImpl(
         const VectorDM& args) const {
     Problem::ContinuousInput input{args.at(0).scalar(), args.at(1), args.at(2),
             args.at(3), args.at(4), args.at(5)};
@@ -332,3 +357,78 @@ VectorDM MultibodySystemImplicit<CalcKCErrors>::eval(
 
 template class CasOC::MultibodySystemImplicit<false>;
 template class CasOC::MultibodySystemImplicit<true>;
+
+casadi::Sparsity ShootingIntegrator::get_sparsity_in(casadi_int i) {
+    if (i == 0 || i == 1) {
+        return casadi::Sparsity::dense(1, 1);
+    } else if (i == 2) {
+        return casadi::Sparsity::dense(m_casProblem->getNumStates(), 1);
+    } else if (i == 3 || i == 4) {
+        return casadi::Sparsity::dense(m_casProblem->getNumControls(), 1);
+    } else if (i == 5) {
+        return casadi::Sparsity::dense(m_casProblem->getNumParameters(), 1);
+    } else {
+        return casadi::Sparsity(0, 0);
+    }
+}
+
+casadi::Sparsity ShootingIntegrator::get_sparsity_out(casadi_int i) {
+    if (i == 0) {
+        return casadi::Sparsity::dense(m_casProblem->getNumStates(), 1);
+    } else {
+        return casadi::Sparsity(0, 0);
+    }
+}
+
+VectorDM ShootingIntegrator::evalImpl(const VectorDM& args) const {
+    using casadi::DM;
+    using casadi::Slice;
+    const double initialTime = args.at(0).scalar();
+    const double duration = args.at(1).scalar();
+    const DM& initialControls = args.at(3);
+    const DM& finalControls = args.at(4);
+    const DM& parameters = args.at(5);
+
+    const int NQ = m_casProblem->getNumCoordinates();
+    const int NU = m_casProblem->getNumSpeeds();
+    // The problem writes into these through ptr(), so they must be dense.
+    const DM multipliers = DM::zeros(m_casProblem->getNumMultipliers(), 1);
+    const DM derivatives = DM::zeros(m_casProblem->getNumDerivatives(), 1);
+    DM multibodyDerivatives =
+            DM::zeros(m_casProblem->getNumMultibodyDynamicsEquations(), 1);
+    DM auxiliaryDerivatives =
+            DM::zeros(m_casProblem->getNumAuxiliaryStates(), 1);
+    DM auxiliaryResiduals =
+            DM::zeros(m_casProblem->getNumAuxiliaryResidualEquations(), 1);
+    DM kinematicConstraintErrors = DM::zeros(0, 1);
+    Problem::MultibodySystemExplicitOutput output{multibodyDerivatives,
+            auxiliaryDerivatives, auxiliaryResiduals,
+            kinematicConstraintErrors};
+
+    auto calcStateDerivatives = [&](const double& time,
+                                        const DM& states) -> DM {
+        const double fraction =
+                duration > 0 ? (time - initialTime) / duration : 0;
+        const DM controls =
+                (1 - fraction) * initialControls + fraction * finalControls;
+        Problem::ContinuousInput input{time, states, controls, multipliers,
+                derivatives, parameters};
+        m_casProblem->calcMultibodySystemExplicit(input, false, output);
+        // qdot = u (we do not support quaternions).
+        return DM::vertcat({states(Slice(NQ, NQ + NU)), multibodyDerivatives,
+                auxiliaryDerivatives});
+    };
+
+    DM states = args.at(2);
+    const double h = duration / m_numSteps;
+    for (int istep = 0; istep < m_numSteps; ++istep) {
+        const double time = initialTime + istep * h;
+        const double midTime = time + 0.5 * h;
+        const DM k1 = calcStateDerivatives(time, states);
+        const DM k2 = calcStateDerivatives(midTime, states + 0.5 * h * k1);
+        const DM k3 = calcStateDerivatives(midTime, states + 0.5 * h * k2);
+        const DM k4 = calcStateDerivatives(time + h, states + h * k3);
+        states += (h / 6.0) * (k1 + 2.0 * k2 + 2.0 * k3 + k4);
+    }
+    return {states};
+}
@@ -21,6 +21,8 @@
 #include "CasOCIterate.h"
 
 #include <OpenSim/Common/Exception.h>
+#include <atomic>
+#include <map>
 
 namespace CasOC {
 
@@ -28,6 +30,15 @@ class Problem;
 
 using VectorDM = std::vector<casadi::DM>;
 
+/// Jacobian sparsity patterns detected by Function%s, keyed by function name.
+/// Functions whose problem has a cache use a pattern from the cache (if its
+/// dimensions match) instead of detecting it, and store the patterns they
+/// detect. This allows solving a sequence of problems with the same sparsity
+/// (e.g., differing only in goal weights) while detecting sparsity once.
+struct SparsityCache {
+    std::map<std::string, casadi::Sparsity> patterns;
+};
+
 class Function : public casadi::Callback {
 public:
     virtual ~Function() = default;
@@ -63,7 +74,31 @@ public:
     }
     casadi::Sparsity get_jacobian_sparsity() const override;
 
+    /// This records the number of evaluations and the time spent in them,
+    /// and invokes evalImpl().
+    VectorDM eval(const VectorDM& args) const override final;
+
+    /// @name Evaluation statistics
+    /// These are accumulated over all threads since constructFunction() or
+    /// resetEvaluationStatistics(). Evaluations performed to detect sparsity
+    /// are not counted as evaluations.
+    /// @{
+    long long getNumEvaluations() const { return m_numEvaluations; }
+    long long getEvaluationTimeInNs() const { return m_evaluationTimeInNs; }
+    /// Time spent in get_jacobian_sparsity().
+    long long getSparsityDetectionTimeInNs() const {
+        return m_sparsityDetectionTimeInNs;
+    }
+    void resetEvaluationStatistics() const {
+        m_numEvaluations = 0;
+        m_evaluationTimeInNs = 0;
+        m_sparsityDetectionTimeInNs = 0;
+    }
+    /// @}
+
 protected:
+    virtual VectorDM evalImpl(const VectorDM& args) const = 0;
+
     const Problem* m_casProblem;
 
 private:
@@ -91,6 +126,12 @@ private:
 
     std::shared_ptr<const std::vector<VariablesDM>>
             m_fullPointsForSparsityDetection;
+
+    // Atomics, rather than a lock, keep the overhead of recording small when
+    // the function is evaluated from multiple threads.
+    mutable std::atomic<long long> m_numEvaluations{0};
+    mutable std::atomic<long long> m_evaluationTimeInNs{0};
+    mutable std::atomic<long long> m_sparsityDetectionTimeInNs{0};
 };
 
 class PathConstraint : public Function {
@@ -117,7 +158,7 @@ public:
         } else
             return casadi::Sparsity(0, 0);
     }
-    VectorDM eval(const VectorDM& args) const override;
+    VectorDM evalImpl(const VectorDM& args) const override;
 
 protected:
     int m_index = -1;
@@ -154,12 +195,12 @@ protected:
 
 class CostIntegrand : public Integrand {
 public:
-    VectorDM eval(const VectorDM& args) const override;
+    VectorDM evalImpl(const VectorDM& args) const override;
 };
 
 class EndpointConstraintIntegrand : public Integrand {
 public:
-    VectorDM eval(const VectorDM& args) const override;
+    VectorDM evalImpl(const VectorDM& args) const override;
 };
 
 /// This function takes initial states/controls, final states/controls, and an
@@ -241,13 +282,13 @@ protected:
 /// This invokes CasOC::Problem::calcCost().
 class Cost : public Endpoint {
 public:
-    VectorDM eval(const VectorDM& args) const override;
+    VectorDM evalImpl(const VectorDM& args) const override;
 };
 
 /// This invokes CasOC::Problem::calcEndpointConstraint().
 class EndpointConstraint : public Endpoint {
 public:
-    VectorDM eval(const VectorDM& args) const override;
+    VectorDM evalImpl(const VectorDM& args) const override;
 
 };
 
@@ -267,7 +308,7 @@ public:
         }
     }
     casadi::Sparsity get_sparsity_out(casadi_int i) override final;
-    VectorDM eval(const VectorDM& args) const override;
+    VectorDM evalImpl(const VectorDM& args) const override;
 };
 
 /// This function should compute a velocity correction term to make feasible
@@ -293,7 +334,7 @@ public:
     }
     casadi::Sparsity get_sparsity_in(casadi_int i) override final;
     casadi::Sparsity get_sparsity_out(casadi_int i) override final;
-    VectorDM eval(const VectorDM& args) const override;
+    VectorDM evalImpl(const VectorDM& args) const override;
     casadi::DM getSubsetPoint(const VariablesDM& fullPoint) const override;
 };
 
@@ -310,7 +351,57 @@ class MultibodySystemImplicit : public Function {
         }
     }
     casadi::Sparsity get_sparsity_out(casadi_int i) override final;
-    VectorDM eval(const VectorDM& args) const override;
+    VectorDM evalImpl(const VectorDM& args) const override;
+};
+
+/// This function integrates the explicit multibody and auxiliary dynamics
+/// across a mesh interval, for multiple shooting. The controls vary linearly
+/// between their values at the start and end of the mesh interval. The
+/// dynamics are integrated with a fixed number of steps of the classical
+/// fourth-order Runge-Kutta method, so that finite differences of this
+/// function (the sensitivities of the final states) are smooth.
+/// This function does not support kinematic constraints or auxiliary residual
+/// equations.
+class ShootingIntegrator : public Function {
+public:
+    void constructFunction(const Problem* casProblem, const std::string& name,
+            int numSteps, const std::string& finiteDiffScheme,
+            std::shared_ptr<const std::vector<VariablesDM>>
+                    pointsForSparsityDetection) {
+        m_numSteps = numSteps;
+        Function::constructFunction(
+                casProblem, name, finiteDiffScheme, pointsForSparsityDetection);
+    }
+    casadi_int get_n_in() override final { return 6; }
+    std::string get_name_in(casadi_int i) override final {
+        switch (i) {
+        case 0: return "time";
+        case 1: return "duration";
+        case 2: return "states";
+        case 3: return "initial_controls";
+        case 4: return "final_controls";
+        case 5: return "parameters";
+        default: OPENSIM_THROW(OpenSim::Exception, "Internal error.");
+        }
+    }
+    casadi::Sparsity get_sparsity_in(casadi_int i) override final;
+    casadi_int get_n_out() override final { return 1; }
+    std::string get_name_out(casadi_int i) override final {
+        switch (i) {
+        case 0: return "final_states";
+        default: OPENSIM_THROW(OpenSim::Exception, "Internal error.");
+        }
+    }
+    casadi::Sparsity get_sparsity_out(casadi_int i) override final;
+    VectorDM evalImpl(const VectorDM& args) const override;
+    /// Each evaluation takes m_numSteps Runge-Kutta steps, each of which
+    /// computes the multibody system dynamics 4 times.
+    int getNumDynamicsEvaluationsPerEvaluation() const {
+        return 4 * m_numSteps;
+    }
+
+private:
+    int m_numSteps = -1;
 };
 
 } // namespace CasOC
@@ -61,6 +61,12 @@ struct Iterate {
     std::vector<std::string> slack_names;
     std::vector<std::string> derivative_names;
     std::vector<std::string> parameter_names;
+    /// Multipliers for the NLP constraints and variable bounds (CasADi's
+    /// lam_g and lam_x), used to warm-start the optimizer. These are empty
+    /// unless the iterate came from a solution, and are used only if their
+    /// sizes match the NLP.
+    casadi::DM lam_g;
+    casadi::DM lam_x;
     int iteration = -1;
     /// Return a new iterate in which the data is resampled at the times in
     /// newTimes.
@@ -70,10 +76,31 @@ struct Iterate {
 /// This struct is used to return a solution to a problem. Use `stats`
 /// to check if the problem converged.
 using ObjectiveBreakdown = std::vector<std::pair<std::string, double>>;
+/// The wall time, in seconds, spent in one part of solving a problem, and the
+/// number of times that part was invoked (-1 if not applicable).
+struct TimingEntry {
+    std::string name;
+    double duration;
+    int num_calls;
+};
+using TimingProfile = std::vector<TimingEntry>;
+/// Information about one iteration of the NLP solver, computed from the
+/// iterate that the solver passes to the iteration callback (CasADi does not
+/// pass on the solver's own statistics during the solve).
+struct IterationInfo {
+    int iteration;
+    double objective;
+    /// Maximum violation of the bounds on the constraints and variables.
+    double primal_infeasibility;
+    /// Infinity norm of the change in the variables since the previous
+    /// iteration (NaN for the first iteration).
+    double step_norm;
+};
 struct Solution : public Iterate {
     casadi::Dict stats;
     double objective;
     ObjectiveBreakdown objective_breakdown;
+    TimingProfile timing_profile;
 };
 
 } // namespace CasOC
@@ -0,0 +1,161 @@
+/* -------------------------------------------------------------------------- *
+ * OpenSim Moco: CasOCLegendreGaussRadau.cpp                                  *
+ * -------------------------------------------------------------------------- *
+ * Copyright (c) 2020 Stanford University and the Authors                     *
+ *                                                                            *
+ * Author(s): Christopher Dembia                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0          *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+#include "CasOCLegendreGaussRadau.h"
+
+#include <cmath>
+
+using casadi::DM;
+using casadi::MX;
+using casadi::Slice;
+
+namespace CasOC {
+
+void LegendreGaussRadau::createCollocationMatrices() {
+    // CasADi provides the Radau points on [0, 1] that include 1 (the flipped
+    // LGR points). The LGR points are their reflection about 0.5.
+    const std::vector<double> radau =
+            casadi::collocation_points(m_degree, "radau");
+    m_points.clear();
+    if (m_flipped) {
+        m_points.push_back(0);
+        m_points.insert(m_points.end(), radau.begin(), radau.end());
+    } else {
+        for (int i = m_degree - 1; i >= 0; --i) {
+            m_points.push_back(1.0 - radau[i]);
+        }
+        m_points.push_back(1);
+    }
+    // Guard against roundoff in the tabulated points.
+    m_points.front() = 0;
+    m_points.back() = 1;
+
+    const int numPoints = m_degree + 1;
+    const int first = getFirstCollocationIndex();
+
+    // Differentiation matrix, using the barycentric form of the Lagrange
+    // polynomials.
+    std::vector<double> barycentricWeights(numPoints, 1.0);
+    for (int j = 0; j < numPoints; ++j) {
+        for (int k = 0; k < numPoints; ++k) {
+            if (k != j) barycentricWeights[j] /= (m_points[j] - m_points[k]);
+        }
+    }
+    m_differentiationMatrix = DM::zeros(m_degree, numPoints);
+    for (int i = 0; i < m_degree; ++i) {
+        const int ipoint = first + i;
+        double diagonal = 0;
+        for (int j = 0; j < numPoints; ++j) {
+            if (j == ipoint) continue;
+            const double value =
+                    (barycentricWeights[j] / barycentricWeights[ipoint]) /
+                    (m_points[ipoint] - m_points[j]);
+            m_differentiationMatrix(i, j) = value;
+            diagonal -= value;
+        }
+        m_differentiationMatrix(i, ipoint) = diagonal;
+    }
+
+    // Quadrature weights: integrate the Lagrange polynomials for the
+    // collocation points over [0, 1] by matching the moments of the
+    // monomials.
+    DM vandermondeTranspose = DM::zeros(m_degree, m_degree);
+    DM moments = DM::zeros(m_degree, 1);
+    for (int k = 0; k < m_degree; ++k) {
+        moments(k) = 1.0 / (k + 1);
+        for (int i = 0; i < m_degree; ++i) {
+            vandermondeTranspose(k, i) = std::pow(m_points[first + i], k);
+        }
+    }
+    m_quadratureWeights = DM::solve(vandermondeTranspose, moments);
+
+    // Extrapolation to the non-collocated point.
+    const double target = m_flipped ? 0.0 : 1.0;
+    m_extrapolationCoefficients = DM::ones(m_degree, 1);
+    for (int j = 0; j < m_degree; ++j) {
+        for (int k = 0; k < m_degree; ++k) {
+            if (k == j) continue;
+            m_extrapolationCoefficients(j) *=
+                    (target - m_points[first + k]) /
+                    (m_points[first + j] - m_points[first + k]);
+        }
+    }
+}
+
+DM LegendreGaussRadau::createQuadratureCoefficientsImpl() const {
+    const auto& mesh = m_solver.getMesh();
+    const int first = getFirstCollocationIndex();
+    DM quadCoeffs(m_numGridPoints, 1);
+    for (int imesh = 0; imesh < m_numMeshIntervals; ++imesh) {
+        const double h = mesh[imesh + 1] - mesh[imesh];
+        for (int i = 0; i < m_degree; ++i) {
+            quadCoeffs(m_degree * imesh + first + i) +=
+                    h * m_quadratureWeights(i);
+        }
+    }
+    return quadCoeffs;
+}
+
+DM LegendreGaussRadau::createMeshIndicesImpl() const {
+    DM indices = DM::zeros(1, m_numGridPoints);
+    for (int i = 0; i < m_numGridPoints; i += m_degree) { indices(i) = 1; }
+    return indices;
+}
+
+void LegendreGaussRadau::calcDefectsImpl(const casadi::MX& x,
+        const casadi::MX& xdot, casadi::MX& defects) const {
+    // For more information, see doxygen documentation for the class.
+
+    const int NS = m_problem.getNumStates();
+    const int first = getFirstCollocationIndex();
+    const MX D = m_differentiationMatrix;
+    for (int imesh = 0; imesh < m_numMeshIntervals; ++imesh) {
+        const int igrid = m_degree * imesh;
+        const auto h = m_times(igrid + m_degree) - m_times(igrid);
+        const auto x_interval = x(Slice(), Slice(igrid, igrid + m_degree + 1));
+        const auto xdot_collocation = xdot(Slice(),
+                Slice(igrid + first, igrid + first + m_degree));
+        // The derivative of the state polynomial with respect to normalized
+        // time must match the (scaled) state derivatives.
+        const auto intervalDefects =
+                MX::mtimes(x_interval, D.T()) - h * xdot_collocation;
+        defects(Slice(), imesh) =
+                MX::reshape(intervalDefects, NS * m_degree, 1);
+    }
+}
+
+void LegendreGaussRadau::calcInterpolatingControlsImpl(
+        const casadi::MX& controls, casadi::MX& interpControls) const {
+    if (m_problem.getNumControls()) {
+        int igrid;
+        int iextrap;
+        if (m_flipped) {
+            igrid = 1;
+            iextrap = 0;
+        } else {
+            igrid = m_numGridPoints - 1 - m_degree;
+            iextrap = m_numGridPoints - 1;
+        }
+        const auto c_collocation =
+                controls(Slice(), Slice(igrid, igrid + m_degree));
+        interpControls(Slice(), 0) =
+                controls(Slice(), iextrap) -
+                MX::mtimes(c_collocation, MX(m_extrapolationCoefficients));
+    }
+}
+
+} // namespace CasOC
@@ -0,0 +1,137 @@
+#ifndef MOCO_CASOCLEGENDREGAUSSRADAU_H
+#define MOCO_CASOCLEGENDREGAUSSRADAU_H
+/* -------------------------------------------------------------------------- *
+ * OpenSim Moco: CasOCLegendreGaussRadau.h                                    *
+ * -------------------------------------------------------------------------- *
+ * Copyright (c) 2020 Stanford University and the Authors                     *
+ *                                                                            *
+ * Author(s): Christopher Dembia                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0          *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "CasOCTranscription.h"
+
+namespace CasOC {
+
+/// Enforce the differential equations in the problem using Legendre-Gauss-
+/// Radau (LGR) orthogonal collocation, in which the states in each mesh
+/// interval are approximated by a polynomial of a chosen degree N. This is
+/// the "hp" flavor of the pseudospectral method: the degree sets the
+/// accuracy within a mesh interval, and the mesh sets the number of
+/// intervals. For smooth problems, a higher degree achieves the same
+/// accuracy as Hermite-Simpson with far fewer grid points. The integral in
+/// the objective function is approximated by Gauss-Radau quadrature, which is
+/// exact for polynomials of degree 2N - 2.
+///
+/// Grid and collocation points.
+/// ----------------------------
+/// Each mesh interval contains the N LGR points, which include the start of
+/// the mesh interval but not the end, plus the end of the mesh interval. The
+/// grid therefore contains N - 1 points in the interior of each mesh interval.
+/// The dynamics are collocated at the N LGR points. In the "flipped" variant,
+/// the LGR points are mirrored so that they include the end of the mesh
+/// interval but not the start.
+///
+/// Defect constraints.
+/// -------------------
+/// For each state variable, there are N defect constraints per mesh interval
+/// (one per collocation point), which require the derivative of the state
+/// polynomial (computed with a differentiation matrix) to match the state
+/// derivatives from the dynamics.
+///
+/// Controls at the non-collocated point.
+/// -------------------------------------
+/// The controls at the final time (or initial time, for the flipped variant)
+/// do not affect the defects. We constrain these controls to equal the
+/// extrapolation of the polynomial through the controls at the collocation
+/// points of that mesh interval, so that they are uniquely determined.
+///
+/// Kinematic constraints and path constraints.
+/// -------------------------------------------
+/// Kinematic constraint and path constraint errors are enforced only at the
+/// mesh points. Enforcing derivatives of kinematic constraints is not
+/// supported.
+class LegendreGaussRadau : public Transcription {
+public:
+    /// @param degree The degree of the state polynomial within each mesh
+    ///     interval, which is also the number of collocation points per mesh
+    ///     interval. Must be between 1 and 9.
+    /// @param flipped Use the flipped LGR points, which include the end
+    ///     rather than the start of each mesh interval.
+    LegendreGaussRadau(const Solver& solver, const Problem& problem,
+            int degree, bool flipped)
+            : Transcription(solver, problem), m_degree(degree),
+              m_flipped(flipped) {
+
+        OPENSIM_THROW_IF(m_degree < 1 || m_degree > 9, OpenSim::Exception,
+                OpenSim::format("Expected the Legendre-Gauss-Radau degree to "
+                                "be between 1 and 9, but got %i.",
+                        m_degree));
+        OPENSIM_THROW_IF(problem.getEnforceConstraintDerivatives(),
+                OpenSim::Exception,
+                "Enforcing kinematic constraint derivatives "
+                "not supported with Legendre-Gauss-Radau transcription.");
+        createCollocationMatrices();
+
+        const auto& mesh = m_solver.getMesh();
+        const int numMeshIntervals = (int)mesh.size() - 1;
+        casadi::DM grid = casadi::DM::zeros(1, m_degree * numMeshIntervals + 1);
+        for (int imesh = 0; imesh < numMeshIntervals; ++imesh) {
+            const double h = mesh[imesh + 1] - mesh[imesh];
+            for (int i = 0; i < m_degree; ++i) {
+                grid(m_degree * imesh + i) = mesh[imesh] + h * m_points[i];
+            }
+        }
+        grid(grid.numel() - 1) = mesh.back();
+
+        // The constraint on the controls at the non-collocated point is
+        // grouped with the mesh interval it belongs to.
+        casadi::DM pointsForInterpControls = casadi::DM::zeros(1, 1);
+        if (!m_flipped) {
+            pointsForInterpControls(0) = grid(grid.numel() - 2);
+        }
+        createVariablesAndSetBounds(grid, m_degree * m_problem.getNumStates(),
+                pointsForInterpControls);
+    }
+
+private:
+    casadi::DM createQuadratureCoefficientsImpl() const override;
+    casadi::DM createMeshIndicesImpl() const override;
+    void calcDefectsImpl(const casadi::MX& x, const casadi::MX& xdot,
+            casadi::MX& defects) const override;
+    void calcInterpolatingControlsImpl(const casadi::MX& controls,
+            casadi::MX& interpControls) const override;
+
+    /// Compute m_points, m_differentiationMatrix, m_quadratureWeights, and
+    /// m_extrapolationCoefficients.
+    void createCollocationMatrices();
+    /// The index of the first collocation point within a mesh interval (0 or
+    /// 1), among the degree + 1 points in the mesh interval.
+    int getFirstCollocationIndex() const { return m_flipped ? 1 : 0; }
+
+    int m_degree;
+    bool m_flipped;
+    /// The degree + 1 points within a mesh interval, normalized to [0, 1].
+    std::vector<double> m_points;
+    /// Row i contains the derivative, at collocation point i, of the Lagrange
+    /// polynomials for all degree + 1 points (normalized time).
+    casadi::DM m_differentiationMatrix;
+    /// Quadrature weights for the collocation points (normalized time).
+    casadi::DM m_quadratureWeights;
+    /// Coefficients that extrapolate values at the collocation points to the
+    /// non-collocated point.
+    casadi::DM m_extrapolationCoefficients;
+};
+
+} // namespace CasOC
+
+#endif // MOCO_CASOCLEGENDREGAUSSRADAU_H
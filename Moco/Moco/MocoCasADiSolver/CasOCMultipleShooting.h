@@ -0,0 +1,86 @@
+#ifndef MOCO_CASOCMULTIPLESHOOTING_H
+#define MOCO_CASOCMULTIPLESHOOTING_H
+/* -------------------------------------------------------------------------- *
+ * OpenSim Moco: CasOCMultipleShooting.h                                      *
+ * -------------------------------------------------------------------------- *
+ * Copyright (c) 2020 Stanford University and the Authors                     *
+ *                                                                            *
+ * Author(s): Christopher Dembia                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0          *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "CasOCFunction.h"
+#include "CasOCTranscription.h"
+
+namespace CasOC {
+
+/// Enforce the differential equations in the problem using direct multiple
+/// shooting: the states and controls are variables only at the mesh points,
+/// and the dynamics are integrated across each mesh interval (the shooting
+/// interval) from the states at the start of the interval, with controls
+/// varying linearly across the interval. The defect constraints require the
+/// integrated states to match the states at the end of the interval. The
+/// integral in the objective function is approximated by trapezoidal
+/// quadrature.
+///
+/// The intervals are integrated independently, and in parallel if the
+/// solver's parallelism allows. Each interval is integrated with
+/// Solver::getMultipleShootingNumSteps() steps of a fourth-order Runge-Kutta
+/// method (see ShootingIntegrator), and the sensitivities of the integrated
+/// states are computed with finite differences.
+///
+/// Compared to direct collocation, the nonlinear program has far fewer
+/// variables and constraints for the same mesh, but each evaluation of the
+/// constraints is more expensive, and stiff dynamics require many integrator
+/// steps.
+///
+/// Only explicit dynamics without kinematic constraints or auxiliary residual
+/// equations are supported.
+class MultipleShooting : public Transcription {
+public:
+    MultipleShooting(const Solver& solver, const Problem& problem)
+            : Transcription(solver, problem) {
+
+        OPENSIM_THROW_IF(problem.isDynamicsModeImplicit(),
+                OpenSim::Exception,
+                "Implicit dynamics mode not supported with multiple "
+                "shooting.");
+        OPENSIM_THROW_IF(problem.getNumKinematicConstraintEquations() ||
+                                 problem.getNumAuxiliaryResidualEquations(),
+                OpenSim::Exception,
+                "Kinematic constraints and auxiliary residual equations are "
+                "not supported with multiple shooting.");
+        OPENSIM_THROW_IF(problem.isPrescribedKinematics(), OpenSim::Exception,
+                "Prescribed kinematics not supported with multiple shooting.");
+        createVariablesAndSetBounds(m_solver.getMesh(),
+                m_problem.getNumStates());
+    }
+    ~MultipleShooting() override {
+        // The problem outlives this transcription.
+        if (m_integrator) m_problem.removeFunction(m_integrator.get());
+    }
+
+private:
+    casadi::DM createQuadratureCoefficientsImpl() const override;
+    casadi::DM createMeshIndicesImpl() const override;
+
+    void calcDefectsImpl(const casadi::MX& x, const casadi::MX& xdot,
+            casadi::MX& defects) const override;
+
+    // This is created when transcribing, since the problem's finite
+    // difference settings are not available until then.
+    mutable std::unique_ptr<ShootingIntegrator> m_integrator;
+};
+
+} // namespace CasOC
+
+#endif // MOCO_CASOCMULTIPLESHOOTING_H
@@ -20,6 +20,7 @@
 
 #include "../MocoUtilities.h"
 #include "CasOCFunction.h"
+#include <algorithm>
 #include <casadi/casadi.hpp>
 #include <string>
 #include <unordered_map>
@@ -334,12 +335,18 @@ public:
     virtual std::vector<std::string>
     createKinematicConstraintEquationNamesImpl() const;
 
-    void intermediateCallback() const { intermediateCallbackImpl(); }
+    /// Returns false if the optimization should stop.
+    bool intermediateCallback(const IterationInfo& info) const {
+        return intermediateCallbackImpl(info);
+    }
     void intermediateCallbackWithIterate(const CasOC::Iterate& it) const {
         intermediateCallbackWithIterateImpl(it);
     }
     /// This is invoked once for each iterate in the optimization process.
-    virtual void intermediateCallbackImpl() const {}
+    /// Return false to stop the optimization.
+    virtual bool intermediateCallbackImpl(const IterationInfo&) const {
+        return true;
+    }
     /// Process an intermediate iterate. The frequency with which this is
     /// evaluated is governed by Solver::getOutputInterval().
     virtual void intermediateCallbackWithIterateImpl(
@@ -381,10 +388,15 @@ public:
         return it;
     }
 
+    /// If `sparsityCache` is provided, functions reuse the sparsity patterns
+    /// it contains and add those they detect (see SparsityCache).
     void initialize(const std::string& finiteDiffScheme,
             std::shared_ptr<const std::vector<VariablesDM>>
-                    pointsForSparsityDetection) const {
+                    pointsForSparsityDetection,
+            std::shared_ptr<SparsityCache> sparsityCache = nullptr) const {
         auto* mutThis = const_cast<Problem*>(this);
+        m_functions.clear();
+        m_sparsityCache = std::move(sparsityCache);
 
         {
             int index = 0;
@@ -596,6 +608,28 @@ public:
     getImplicitMultibodySystemIgnoringConstraints() const {
         return *m_implicitMultibodyFuncIgnoringConstraints;
     }
+    /// The functions constructed since the last call to initialize(),
+    /// including those constructed by the transcription. Use these to obtain
+    /// the evaluation statistics of each function.
+    const std::vector<const Function*>& getFunctions() const {
+        return m_functions;
+    }
+    /// This is called by Function::constructFunction().
+    void addFunction(const Function* function) const {
+        if (std::find(m_functions.begin(), m_functions.end(), function) ==
+                m_functions.end()) {
+            m_functions.push_back(function);
+        }
+    }
+    /// The cache provided to initialize(), or nullptr if none was provided.
+    SparsityCache* getSparsityCache() const { return m_sparsityCache.get(); }
+    /// Functions that are destroyed before this problem (e.g., those owned
+    /// by a transcription) must remove themselves with this function.
+    void removeFunction(const Function* function) const {
+        m_functions.erase(std::remove(m_functions.begin(), m_functions.end(),
+                                  function),
+                m_functions.end());
+    }
     /// @}
 
 private:
@@ -636,6 +670,8 @@ private:
     std::unique_ptr<MultibodySystemImplicit<false>>
             m_implicitMultibodyFuncIgnoringConstraints;
     std::unique_ptr<VelocityCorrection> m_velocityCorrectionFunc;
+    mutable std::vector<const Function*> m_functions;
+    mutable std::shared_ptr<SparsityCache> m_sparsityCache;
 };
 
 } // namespace CasOC
@@ -17,10 +17,14 @@
 
 #include "../MocoUtilities.h"
 #include "CasOCHermiteSimpson.h"
+#include "CasOCLegendreGaussRadau.h"
+#include "CasOCMultipleShooting.h"
 #include "CasOCProblem.h"
 #include "CasOCTranscription.h"
 #include "CasOCTrapezoidal.h"
 
+#include <cctype>
+
 using OpenSim::Exception;
 using OpenSim::format;
 
@@ -32,6 +36,23 @@ std::unique_ptr<Transcription> Solver::createTranscription() const {
         transcription = OpenSim::make_unique<Trapezoidal>(*this, m_problem);
     } else if (m_transcriptionScheme == "hermite-simpson") {
         transcription = OpenSim::make_unique<HermiteSimpson>(*this, m_problem);
+    } else if (m_transcriptionScheme == "multiple-shooting") {
+        transcription =
+                OpenSim::make_unique<MultipleShooting>(*this, m_problem);
+    } else if (m_transcriptionScheme.find("legendre-gauss-radau-") == 0 ||
+               m_transcriptionScheme.find("flipped-legendre-gauss-radau-") ==
+                       0) {
+        // The scheme ends with the polynomial degree, e.g.
+        // "legendre-gauss-radau-3".
+        const bool flipped = m_transcriptionScheme.find("flipped-") == 0;
+        const auto suffix = m_transcriptionScheme.substr(
+                m_transcriptionScheme.rfind('-') + 1);
+        OPENSIM_THROW_IF(suffix.size() != 1 || !std::isdigit(suffix[0]),
+                Exception,
+                format("Unknown transcription scheme '%s'.",
+                        m_transcriptionScheme));
+        transcription = OpenSim::make_unique<LegendreGaussRadau>(
+                *this, m_problem, std::stoi(suffix), flipped);
     } else {
         OPENSIM_THROW(Exception, format("Unknown transcription scheme '%s'.",
                                          m_transcriptionScheme));
@@ -69,7 +90,24 @@ void Solver::setParallelism(std::string parallelism, int numThreads) {
     m_numThreads = numThreads;
 }
 
+TimingProfile createNLPFunctionTimingProfile(const casadi::Dict& stats) {
+    TimingProfile profile;
+    const std::string prefix = "t_wall_";
+    for (const auto& stat : stats) {
+        if (stat.first.compare(0, prefix.size() + 4, prefix + "nlp_") != 0) {
+            continue;
+        }
+        const std::string name = stat.first.substr(prefix.size());
+        const std::string callsKey = "n_call_" + name;
+        const int numCalls =
+                stats.count(callsKey) ? (int)stats.at(callsKey) : -1;
+        profile.push_back({name, stat.second.to_double(), numCalls});
+    }
+    return profile;
+}
+
 Solution Solver::solve(const Iterate& guess) const {
+    const OpenSim::Stopwatch stopwatch;
     auto transcription = createTranscription();
     auto pointsForSparsityDetection =
             std::make_shared<std::vector<VariablesDM>>();
@@ -89,8 +127,13 @@ Solution Solver::solve(const Iterate& guess) const {
     }
     m_problem.initialize(m_finite_difference_scheme,
             std::const_pointer_cast<const std::vector<VariablesDM>>(
-                    pointsForSparsityDetection));
-    return transcription->solve(guess);
+                    pointsForSparsityDetection),
+            m_sparsityCache);
+    const double initializationTime = stopwatch.getElapsedTime();
+    Solution solution = transcription->solve(guess);
+    solution.timing_profile.insert(solution.timing_profile.begin(),
+            TimingEntry{"problem_initialization", initializationTime, -1});
+    return solution;
 }
 
 } // namespace CasOC
@@ -109,6 +109,19 @@ public:
         return m_interpolateControlMidpoints;
     }
 
+    /// The number of Runge-Kutta steps used to integrate each mesh interval
+    /// with the "multiple-shooting" transcription scheme.
+    /// @note Default is 10.
+    void setMultipleShootingNumSteps(int numSteps) {
+        OPENSIM_THROW_IF(numSteps < 1, OpenSim::Exception,
+                OpenSim::format(
+                        "Expected numSteps >= 1 but got %i.", numSteps));
+        m_multipleShootingNumSteps = numSteps;
+    }
+    int getMultipleShootingNumSteps() const {
+        return m_multipleShootingNumSteps;
+    }
+
     void setOptimSolver(std::string optimSolver) {
         m_optimSolver = std::move(optimSolver);
     }
@@ -136,6 +149,12 @@ public:
     /// to determine sparsity.
     void setSparsityDetectionRandomCount(int count);
 
+    /// If sparsity detection is not "none", reuse the Jacobian sparsity
+    /// patterns in this cache, and add any patterns that are detected.
+    void setSparsityCache(std::shared_ptr<SparsityCache> cache) {
+        m_sparsityCache = std::move(cache);
+    }
+
     /// If this is set to a non-empty string, the sparsity patterns of the
     /// optimization problem derivatives are written to files whose names use
     /// `setting` as a prefix.
@@ -184,6 +203,7 @@ private:
     bool m_minimizeImplicitAuxiliaryDerivatives = false;
     double m_implicitAuxiliaryDerivativesWeight = 1.0;
     bool m_interpolateControlMidpoints = true;
+    int m_multipleShootingNumSteps = 10;
     Bounds m_implicitMultibodyAccelerationBounds;
     Bounds m_implicitAuxiliaryDerivativeBounds;
     std::string m_finite_difference_scheme = "central";
@@ -191,6 +211,7 @@ private:
     std::string m_write_sparsity;
     int m_callbackInterval = 0;
     int m_sparsity_detection_random_count = 3;
+    std::shared_ptr<SparsityCache> m_sparsityCache;
     std::string m_parallelism = "serial";
     int m_numThreads = 1;
     casadi::Dict m_pluginOptions;
@@ -198,6 +219,13 @@ private:
     std::string m_optimSolver;
 };
 
+/// The time spent in, and the number of calls to, each function of the
+/// nonlinear program (e.g., "nlp_jac_g"), from the "t_wall_nlp_*" and
+/// "n_call_nlp_*" entries of the NLP solver's stats. The evaluations of the
+/// problem's functions (including finite differences) occur within these
+/// functions; the remainder of the solve is the optimizer's own time.
+TimingProfile createNLPFunctionTimingProfile(const casadi::Dict& stats);
+
 } // namespace CasOC
 
 #endif // MOCO_CASOCSOLVER_H
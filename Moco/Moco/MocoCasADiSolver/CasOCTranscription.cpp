@@ -35,7 +35,15 @@ public:
             casadi_int outputInterval)
             : m_transcription(transcription), m_problem(problem),
               m_numVariables(numVariables), m_numConstraints(numConstraints),
-              m_callbackInterval(outputInterval) {
+              m_callbackInterval(outputInterval),
+              m_lowerBounds(transcription.flattenVariables(
+                      transcription.m_lowerBounds)),
+              m_upperBounds(transcription.flattenVariables(
+                      transcription.m_upperBounds)),
+              m_constraintsLowerBounds(transcription.flattenConstraints(
+                      transcription.m_constraintsLowerBounds)),
+              m_constraintsUpperBounds(transcription.flattenConstraints(
+                      transcription.m_constraintsUpperBounds)) {
         construct("NlpsolCallback", {});
     }
     casadi_int get_n_in() override { return casadi::nlpsol_n_out(); }
@@ -66,17 +74,53 @@ public:
             iterate.iteration = evalCount;
             m_problem.intermediateCallbackWithIterate(iterate);
         }
-        m_problem.intermediateCallback();
+        const bool proceed =
+                m_problem.intermediateCallback(calcIterationInfo(args));
         ++evalCount;
-        return {0};
+        // A nonzero output stops the solver.
+        return {proceed ? 0 : 1};
     }
 
 private:
+    /// The arguments are the outputs of nlpsol().
+    IterationInfo calcIterationInfo(const std::vector<DM>& args) const {
+        const DM& x = args.at(0);
+        IterationInfo info;
+        info.iteration = evalCount;
+        info.objective = double(args.at(1));
+        info.primal_infeasibility = std::max(
+                calcBoundViolation(args.at(2), m_constraintsLowerBounds,
+                        m_constraintsUpperBounds),
+                calcBoundViolation(x, m_lowerBounds, m_upperBounds));
+        info.step_norm = std::numeric_limits<double>::quiet_NaN();
+        if (evalCount > 0) {
+            info.step_norm = double(DM::norm_inf(x - m_previousVariables));
+        }
+        m_previousVariables = x;
+        return info;
+    }
+    static double calcBoundViolation(
+            const DM& values, const DM& lower, const DM& upper) {
+        double violation = 0;
+        for (casadi_int i = 0; i < values.numel(); ++i) {
+            const double value = *(values.ptr() + i);
+            violation = std::max(violation,
+                    std::max(*(lower.ptr() + i) - value,
+                            value - *(upper.ptr() + i)));
+        }
+        return violation;
+    }
+
     const Transcription& m_transcription;
     const Problem& m_problem;
     casadi_int m_numVariables;
     casadi_int m_numConstraints;
     casadi_int m_callbackInterval;
+    const DM m_lowerBounds;
+    const DM m_upperBounds;
+    const DM m_constraintsLowerBounds;
+    const DM m_constraintsUpperBounds;
+    mutable DM m_previousVariables;
     mutable int evalCount = 0;
 };
 
@@ -588,7 +632,9 @@ Solution Transcription::solve(const Iterate& guessOrig) {
 
     // Define the NLP.
     // ---------------
+    OpenSim::Stopwatch stopwatch;
     transcribe();
+    const double transcriptionTime = stopwatch.getElapsedTime();
 
     // Resample the guess.
     // -------------------
@@ -629,12 +675,6 @@ Solution Transcription::solve(const Iterate& guessOrig) {
 
     // Create the CasADi NLP function.
     // -------------------------------
-    // Option handling is copied from casadi::OptiNode::solver().
-    casadi::Dict options = m_solver.getPluginOptions();
-    if (!options.empty()) {
-        options[m_solver.getOptimSolver()] = m_solver.getSolverOptions();
-    }
-
     auto x = flattenVariables(m_vars);
     casadi_int numVariables = x.numel();
 
@@ -643,6 +683,33 @@ Solution Transcription::solve(const Iterate& guessOrig) {
     auto g = flattenConstraints(m_constraints);
     casadi_int numConstraints = g.numel();
 
+    // The multipliers in the guess are only meaningful if they came from an
+    // NLP of the same size (e.g., same mesh and transcription scheme).
+    const bool warmStartMultipliers = guess.lam_x.numel() == numVariables &&
+                                      guess.lam_g.numel() == numConstraints &&
+                                      numVariables > 0;
+
+    // Option handling is copied from casadi::OptiNode::solver().
+    casadi::Dict options = m_solver.getPluginOptions();
+    if (!options.empty()) {
+        casadi::Dict solverOptions = m_solver.getSolverOptions();
+        if (warmStartMultipliers && m_solver.getOptimSolver() == "ipopt") {
+            // Without these settings, IPOPT pushes the guess away from the
+            // bounds and largely discards the multipliers. Options set by the
+            // user take precedence.
+            solverOptions.emplace(
+                    "warm_start_init_point", std::string("yes"));
+            for (const std::string name :
+                    {"warm_start_bound_push", "warm_start_bound_frac",
+                            "warm_start_slack_bound_push",
+                            "warm_start_slack_bound_frac",
+                            "warm_start_mult_bound_push"}) {
+                solverOptions.emplace(name, 1e-9);
+            }
+        }
+        options[m_solver.getOptimSolver()] = solverOptions;
+    }
+
     NlpsolCallback callback(*this, m_problem, numVariables, numConstraints,
             m_solver.getCallbackInterval());
     options["iteration_callback"] = callback;
@@ -675,25 +742,41 @@ Solution Transcription::solve(const Iterate& guessOrig) {
         jacobian.sparsity().to_file(
                 prefix + "constraint_Jacobian_sparsity.mtx");
     }
+    stopwatch.reset();
     const casadi::Function nlpFunc =
             casadi::nlpsol("nlp", m_solver.getOptimSolver(), nlp, options);
+    // Detecting the sparsity of the functions occurs when constructing the
+    // NLP solver, but we report it separately.
+    const double nlpConstructionTime =
+            stopwatch.getElapsedTime() - calcSparsityDetectionTime();
 
     // Run the optimization (evaluate the CasADi NLP function).
     // --------------------------------------------------------
     // The inputs and outputs of nlpFunc are numeric (casadi::DM).
-    const casadi::DMDict nlpResult =
-            nlpFunc(casadi::DMDict{{"x0", flattenVariables(guess.variables)},
-                    {"lbx", flattenVariables(m_lowerBounds)},
-                    {"ubx", flattenVariables(m_upperBounds)},
-                    {"lbg", flattenConstraints(m_constraintsLowerBounds)},
-                    {"ubg", flattenConstraints(m_constraintsUpperBounds)}});
+    casadi::DMDict nlpInputs{{"x0", flattenVariables(guess.variables)},
+            {"lbx", flattenVariables(m_lowerBounds)},
+            {"ubx", flattenVariables(m_upperBounds)},
+            {"lbg", flattenConstraints(m_constraintsLowerBounds)},
+            {"ubg", flattenConstraints(m_constraintsUpperBounds)}};
+    if (warmStartMultipliers) {
+        nlpInputs["lam_x0"] = guess.lam_x;
+        nlpInputs["lam_g0"] = guess.lam_g;
+    }
+    stopwatch.reset();
+    const casadi::DMDict nlpResult = nlpFunc(nlpInputs);
+    const double nlpSolveTime = stopwatch.getElapsedTime();
 
     // Create a CasOC::Solution.
     // -------------------------
     Solution solution = m_problem.createIterate<Solution>();
+    // Do this before evaluating any functions below.
+    solution.timing_profile = createTimingProfile(nlpFunc.stats(),
+            transcriptionTime, nlpConstructionTime, nlpSolveTime);
     const auto finalVariables = nlpResult.at("x");
     solution.variables = expandVariables(finalVariables);
     solution.objective = nlpResult.at("f").scalar();
+    solution.lam_g = nlpResult.at("lam_g");
+    solution.lam_x = nlpResult.at("lam_x");
 
     casadi::DMVector finalVarsDMV{finalVariables};
     casadi::Function objectiveFunc("objective", {x}, {m_objectiveTerms});
@@ -721,6 +804,45 @@ Solution Transcription::solve(const Iterate& guessOrig) {
     return solution;
 }
 
+double Transcription::calcSparsityDetectionTime() const {
+    long long timeInNs = 0;
+    for (const auto* function : m_problem.getFunctions()) {
+        timeInNs += function->getSparsityDetectionTimeInNs();
+    }
+    return SimTK::nsToSec(timeInNs);
+}
+
+TimingProfile Transcription::createTimingProfile(const casadi::Dict& stats,
+        double transcriptionTime, double nlpConstructionTime,
+        double nlpSolveTime) const {
+    TimingProfile profile;
+    profile.push_back({"transcription", transcriptionTime, -1});
+    profile.push_back({"sparsity_detection", calcSparsityDetectionTime(), -1});
+    profile.push_back({"nlp_construction", nlpConstructionTime, -1});
+
+    // CasADi records the time spent in, and the number of calls to, each NLP
+    // function (e.g., t_wall_nlp_jac_g and n_call_nlp_jac_g); the finite
+    // differences of our functions occur within these NLP functions.
+    const double totalTime = stats.count("t_wall_total")
+                                     ? stats.at("t_wall_total").to_double()
+                                     : nlpSolveTime;
+    profile.push_back({"nlp_solve", totalTime, -1});
+    const TimingProfile nlpFunctions = createNLPFunctionTimingProfile(stats);
+    double functionTime = 0;
+    for (const auto& entry : nlpFunctions) functionTime += entry.duration;
+    // The optimizer's own time is dominated by factorizing the KKT system.
+    profile.push_back({"optimizer", totalTime - functionTime, -1});
+    profile.insert(profile.end(), nlpFunctions.begin(), nlpFunctions.end());
+
+    for (const auto* function : m_problem.getFunctions()) {
+        if (!function->getNumEvaluations()) continue;
+        profile.push_back({"function_" + function->name(),
+                SimTK::nsToSec(function->getEvaluationTimeInNs()),
+                (int)function->getNumEvaluations()});
+    }
+    return profile;
+}
+
 void Transcription::printConstraintValues(const Iterate& it,
         const Constraints<casadi::DM>& constraints,
         std::ostream& stream) const {
@@ -1218,4 +1340,25 @@ casadi::MXVector Transcription::evalOnTrajectory(
     }*/
 }
 
+casadi::MXVector Transcription::evalOnMeshIntervals(
+        const casadi::Function& intervalFunction) const {
+    auto parallelism = m_solver.getParallelism();
+    const auto intervalsFunc = intervalFunction.map(
+            m_numMeshIntervals, parallelism.first, parallelism.second);
+
+    const casadi::Matrix<casadi_int> startIndices =
+            m_meshIndices(Slice(0, m_numMeshIntervals));
+    const casadi::Matrix<casadi_int> endIndices =
+            m_meshIndices(Slice(1, m_numMeshPoints));
+    const MX startTimes = m_times(startIndices);
+    MXVector mxIn{startTimes, m_times(endIndices) - startTimes,
+            m_vars.at(states)(Slice(), startIndices),
+            m_vars.at(controls)(Slice(), startIndices),
+            m_vars.at(controls)(Slice(), endIndices),
+            MX::repmat(m_vars.at(parameters), 1, m_numMeshIntervals)};
+    MXVector mxOut;
+    intervalsFunc.call(mxIn, mxOut);
+    return mxOut;
+}
+
 } // namespace CasOC
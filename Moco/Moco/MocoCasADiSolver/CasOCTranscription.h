@@ -81,6 +81,14 @@ protected:
             const std::vector<Var>& inputs,
             const casadi::Matrix<casadi_int>& timeIndices) const;
 
+    /// Evaluate a function over each mesh interval (e.g., to integrate the
+    /// dynamics for shooting methods). The inputs to `intervalFunction` are
+    /// the time at the start of the mesh interval, the duration of the mesh
+    /// interval, the states at the start of the mesh interval, the controls
+    /// at the start and end of the mesh interval, and the parameters.
+    casadi::MXVector evalOnMeshIntervals(
+            const casadi::Function& intervalFunction) const;
+
     template <typename TRow, typename TColumn>
     void setVariableBounds(Var var, const TRow& rowIndices,
             const TColumn& columnIndices, const Bounds& bounds) {
@@ -112,6 +120,15 @@ protected:
     void printObjectiveBreakdown(const Iterate& it,
             const casadi::DM& objectiveTerms,
             std::ostream& stream = std::cout) const;
+    /// The total time, in seconds, that the problem's functions spent
+    /// detecting their sparsity.
+    double calcSparsityDetectionTime() const;
+    /// Combine the phases of solve() that we timed with the timings that
+    /// CasADi records for the NLP functions and the evaluation statistics of
+    /// each of the problem's functions.
+    TimingProfile createTimingProfile(const casadi::Dict& stats,
+            double transcriptionTime, double nlpConstructionTime,
+            double nlpSolveTime) const;
 
     const Solver& m_solver;
     const Problem& m_problem;
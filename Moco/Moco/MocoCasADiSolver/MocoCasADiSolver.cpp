@@ -21,7 +21,9 @@
 #include "../MocoUtilities.h"
 #include "CasOCSolver.h"
 #include "MocoCasOCProblem.h"
+#include <algorithm>
 #include <casadi/casadi.hpp>
+#include <iomanip>
 
 using casadi::Callback;
 using casadi::Dict;
@@ -32,6 +34,53 @@ using casadi::Sparsity;
 
 using namespace OpenSim;
 
+namespace {
+const std::vector<std::string> ipoptLinearSolvers{
+        "mumps", "ma27", "ma57", "ma86", "ma97"};
+
+/// Select the IPOPT linear solver and translate the ordering and memory
+/// factor into the options specific to that linear solver.
+void setIpoptLinearSolverOptions(const std::string& linearSolver,
+        const std::string& ordering, double memoryFactor, Dict& options) {
+    // Remove options for any previously-selected linear solver.
+    for (auto it = options.begin(); it != options.end();) {
+        bool isLinearSolverOption = it->first == "linear_solver";
+        for (const auto& name : ipoptLinearSolvers) {
+            if (it->first.compare(0, name.size() + 1, name + "_") == 0) {
+                isLinearSolverOption = true;
+            }
+        }
+        it = isLinearSolverOption ? options.erase(it) : std::next(it);
+    }
+    if (linearSolver.empty()) return;
+
+    options["linear_solver"] = linearSolver;
+    // The memory factor scales IPOPT's default for each option.
+    if (linearSolver == "mumps") {
+        if (ordering == "amd") options["mumps_pivot_order"] = 0;
+        if (ordering == "metis") options["mumps_pivot_order"] = 5;
+        if (memoryFactor != -1) {
+            options["mumps_mem_percent"] =
+                    (int)std::round(1000.0 * memoryFactor);
+        }
+    } else if (linearSolver == "ma27") {
+        if (memoryFactor != -1) {
+            options["ma27_liw_init_factor"] = 5.0 * memoryFactor;
+            options["ma27_la_init_factor"] = 5.0 * memoryFactor;
+        }
+    } else if (linearSolver == "ma57") {
+        if (ordering == "amd") options["ma57_pivot_order"] = 0;
+        if (ordering == "metis") options["ma57_pivot_order"] = 4;
+        if (memoryFactor != -1) {
+            options["ma57_pre_alloc"] = 1.05 * memoryFactor;
+        }
+    } else {
+        // ma86 and ma97.
+        if (!ordering.empty()) options[linearSolver + "_order"] = ordering;
+    }
+}
+} // anonymous namespace
+
 MocoCasADiSolver::MocoCasADiSolver() { constructProperties(); }
 
 void MocoCasADiSolver::constructProperties() {
@@ -46,6 +95,11 @@ void MocoCasADiSolver::constructProperties() {
     constructProperty_implicit_multibody_accelerations_weight(1.0);
     constructProperty_minimize_implicit_auxiliary_derivatives(false);
     constructProperty_implicit_auxiliary_derivatives_weight(1.0);
+    constructProperty_precompute_prescribed_kinematics(false);
+    constructProperty_multiple_shooting_num_steps(10);
+    constructProperty_optim_ipopt_linear_solver("");
+    constructProperty_optim_ipopt_linear_solver_ordering("");
+    constructProperty_optim_ipopt_linear_solver_memory_factor(-1);
 }
 
 MocoTrajectory MocoCasADiSolver::createGuess(const std::string& type) const {
@@ -104,6 +158,13 @@ void MocoCasADiSolver::clearGuess() {
     set_guess_file("");
     m_guessToUse.reset();
 }
+
+void MocoCasADiSolver::setReuseSparsityPatterns(bool tf) {
+    m_reuseSparsityPatterns = tf;
+    if (!tf) clearSparsityPatterns();
+}
+void MocoCasADiSolver::clearSparsityPatterns() { m_sparsityCache.reset(); }
+
 const MocoTrajectory& MocoCasADiSolver::getGuess() const {
     if (!m_guessToUse) {
         if (get_guess_file() != "" && m_guessFromFile.empty()) {
@@ -142,14 +203,7 @@ std::unique_ptr<MocoCasOCProblem> MocoCasADiSolver::createCasOCProblem() const {
     //                 "or use the command-line or Matlab interfaces."
     //              << std::endl;
     //}
-    int numThreads;
-    if (parallel == 0) {
-        numThreads = 1;
-    } else if (parallel == 1) {
-        numThreads = std::thread::hardware_concurrency();
-    } else {
-        numThreads = parallel;
-    }
+    const int numThreads = getNumThreadsForParallel(parallel);
 
     checkPropertyInSet(
             *this, getProperty_multibody_dynamics_mode(), {"explicit", "implicit"});
@@ -168,20 +222,45 @@ std::unique_ptr<MocoCasOCProblem> MocoCasADiSolver::createCasOCProblem() const {
 }
 
 std::unique_ptr<CasOC::Solver> MocoCasADiSolver::createCasOCSolver(
-        const MocoCasOCProblem& casProblem) const {
+        const MocoCasOCProblem& casProblem,
+        const std::vector<double>& mesh) const {
     auto casSolver = OpenSim::make_unique<CasOC::Solver>(casProblem);
 
     // Set solver options.
     // -------------------
     Dict solverOptions;
     checkPropertyInSet(*this, getProperty_optim_solver(), {"ipopt", "snopt"});
-    checkPropertyInSet(*this, getProperty_transcription_scheme(),
-            {"trapezoidal", "hermite-simpson"});
+    OPENSIM_THROW_IF_FRMOBJ(get_transcription_scheme() != "trapezoidal" &&
+                                    get_transcription_scheme() !=
+                                            "hermite-simpson" &&
+                                    get_transcription_scheme() !=
+                                            "multiple-shooting" &&
+                                    !getLegendreGaussRadauDegree(),
+            Exception,
+            format("Expected transcription_scheme to be 'trapezoidal', "
+                   "'hermite-simpson', 'legendre-gauss-radau-N', "
+                   "'flipped-legendre-gauss-radau-N' (N from 1 to 9), or "
+                   "'multiple-shooting', but got '%s'.",
+                    get_transcription_scheme()));
     OPENSIM_THROW_IF(casProblem.getNumKinematicConstraintEquations() != 0 &&
                              get_transcription_scheme() == "trapezoidal",
             OpenSim::Exception,
             "Kinematic constraints not supported with "
             "trapezoidal transcription.");
+    if (get_transcription_scheme() == "multiple-shooting") {
+        OPENSIM_THROW_IF_FRMOBJ(
+                casProblem.getNumKinematicConstraintEquations() != 0,
+                Exception,
+                "Kinematic constraints not supported with multiple "
+                "shooting.");
+        OPENSIM_THROW_IF_FRMOBJ(get_multibody_dynamics_mode() != "explicit",
+                Exception,
+                format("Expected multibody_dynamics_mode to be 'explicit' "
+                       "with multiple shooting, but got '%s'.",
+                        get_multibody_dynamics_mode()));
+        checkPropertyIsPositive(
+                *this, getProperty_multiple_shooting_num_steps());
+    }
     // Enforcing constraint derivatives is only supported when Hermite-Simpson
     // is set as the transcription scheme.
     if (casProblem.getNumKinematicConstraintEquations() != 0) {
@@ -252,6 +331,22 @@ std::unique_ptr<CasOC::Solver> MocoCasADiSolver::createCasOCSolver(
             solverOptions["constr_viol_tol"] = tol;
             solverOptions["acceptable_constr_viol_tol"] = tol;
         }
+
+        checkPropertyInSet(*this, getProperty_optim_ipopt_linear_solver(),
+                {"", "mumps", "ma27", "ma57", "ma86", "ma97"});
+        checkPropertyInSet(*this,
+                getProperty_optim_ipopt_linear_solver_ordering(),
+                {"", "amd", "metis"});
+        OPENSIM_THROW_IF_FRMOBJ(
+                get_optim_ipopt_linear_solver_memory_factor() <= 0 &&
+                        get_optim_ipopt_linear_solver_memory_factor() != -1,
+                Exception,
+                format("Expected optim_ipopt_linear_solver_memory_factor to "
+                       "be positive or -1, but got %g.",
+                        get_optim_ipopt_linear_solver_memory_factor()));
+        setIpoptLinearSolverOptions(get_optim_ipopt_linear_solver(),
+                get_optim_ipopt_linear_solver_ordering(),
+                get_optim_ipopt_linear_solver_memory_factor(), solverOptions);
     }
 
     checkPropertyInSet(*this, getProperty_optim_sparsity_detection(),
@@ -260,6 +355,12 @@ std::unique_ptr<CasOC::Solver> MocoCasADiSolver::createCasOCSolver(
     casSolver->setSparsityDetectionRandomCount(3);
 
     casSolver->setWriteSparsity(get_optim_write_sparsity());
+    if (m_reuseSparsityPatterns) {
+        if (!m_sparsityCache) {
+            m_sparsityCache = std::make_shared<CasOC::SparsityCache>();
+        }
+        casSolver->setSparsityCache(m_sparsityCache);
+    }
 
     checkPropertyInSet(*this, getProperty_optim_finite_difference_scheme(),
             {"central", "forward", "backward"});
@@ -270,16 +371,15 @@ std::unique_ptr<CasOC::Solver> MocoCasADiSolver::createCasOCSolver(
     Dict pluginOptions;
     pluginOptions["verbose_init"] = true;
 
-    if (getProperty_mesh().empty()) {
+    if (!mesh.empty()) {
+        casSolver->setMesh(mesh);
+    } else if (getProperty_mesh().empty()) {
         casSolver->setNumMeshIntervals(get_num_mesh_intervals());
     } else {
-        std::vector<double> mesh;
-        for (int i = 0; i < getProperty_mesh().size(); ++i) {
-            mesh.push_back(get_mesh(i));
-        }
-        casSolver->setMesh(mesh);
+        casSolver->setMesh(createMesh());
     }
     casSolver->setTranscriptionScheme(get_transcription_scheme());
+    casSolver->setMultipleShootingNumSteps(get_multiple_shooting_num_steps());
     casSolver->setMinimizeLagrangeMultipliers(
             get_minimize_lagrange_multipliers());
     casSolver->setLagrangeMultiplierWeight(get_lagrange_multiplier_weight());
@@ -329,23 +429,63 @@ MocoSolution MocoCasADiSolver::solveImpl() const {
         std::cout << std::string(79, '-') << std::endl;
         getProblemRep().printDescription();
     }
+    const Stopwatch setupStopwatch;
     auto casProblem = createCasOCProblem();
-    auto casSolver = createCasOCSolver(*casProblem);
+    const double setupTime = setupStopwatch.getElapsedTime();
     if (get_verbosity()) {
         std::cout << "Number of threads: " << casProblem->getJarSize()
                   << std::endl;
     }
 
-    MocoTrajectory guess = getGuess();
-    CasOC::Iterate casGuess;
-    if (guess.empty()) {
-        casGuess = casSolver->createInitialGuessFromBounds();
+    auto solveOnMesh = [&](const std::vector<double>& mesh,
+                               const MocoTrajectory& guess) -> MocoSolution {
+        const Stopwatch meshStopwatch;
+        auto casSolver = createCasOCSolver(*casProblem, mesh);
+        CasOC::Iterate casGuess;
+        if (guess.empty()) {
+            casGuess = casSolver->createInitialGuessFromBounds();
+        } else {
+            casGuess = convertToCasOCIterate(guess);
+            if (!get_optim_warm_start_multipliers()) {
+                casGuess.lam_g = casadi::DM();
+                casGuess.lam_x = casadi::DM();
+            }
+        }
+        casProblem->resetJarWaitStatistics();
+        casProblem->setIterationReporter(createIterationReporter());
+        CasOC::Solution casSolution = casSolver->solve(casGuess);
+        MocoSolution solution =
+                convertToMocoTrajectory<MocoSolution>(casSolution);
+        setSolutionStats(solution, casSolution.stats.at("success"),
+                casSolution.objective, casSolution.stats.at("return_status"),
+                casSolution.stats.at("iter_count"),
+                SimTK::nsToSec(meshStopwatch.getElapsedTimeInNs()),
+                casSolution.objective_breakdown);
+        std::vector<std::tuple<std::string, double, int>> timingProfile;
+        timingProfile.emplace_back("problem_setup", setupTime, -1);
+        for (const auto& entry : casSolution.timing_profile) {
+            timingProfile.emplace_back(
+                    entry.name, entry.duration, entry.num_calls);
+        }
+        timingProfile.emplace_back("problem_rep_wait",
+                SimTK::nsToSec(casProblem->getJarWaitTimeInNs()),
+                casProblem->getJarNumWaits());
+        if (casProblem->getPrecomputeKinematics()) {
+            timingProfile.emplace_back("precomputed_kinematics",
+                    SimTK::nsToSec(
+                            casProblem->getPrecomputedKinematicsTimeInNs()),
+                    casProblem->getNumPrecomputedKinematicsTimes());
+        }
+        setSolutionTimingProfile(solution, std::move(timingProfile));
+        return solution;
+    };
+
+    MocoSolution mocoSolution;
+    if (get_mesh_refinement_max_iterations()) {
+        mocoSolution = solveWithMeshRefinement(getGuess(), solveOnMesh);
     } else {
-        casGuess = convertToCasOCIterate(guess);
+        mocoSolution = solveOnMesh({}, getGuess());
     }
-    CasOC::Solution casSolution = casSolver->solve(casGuess);
-    MocoSolution mocoSolution =
-            convertToMocoTrajectory<MocoSolution>(casSolution);
 
     // If enforcing model constraints and not minimizing Lagrange multipliers,
     // check the rank of the constraint Jacobian and if rank-deficient, print
@@ -397,10 +537,9 @@ MocoSolution MocoCasADiSolver::solveImpl() const {
     }
 
     const long long elapsed = stopwatch.getElapsedTimeInNs();
-    setSolutionStats(mocoSolution, casSolution.stats.at("success"),
-            casSolution.objective, casSolution.stats.at("return_status"),
-            casSolution.stats.at("iter_count"), SimTK::nsToSec(elapsed),
-            casSolution.objective_breakdown);
+    // The duration includes creating the problem and, with mesh refinement,
+    // all solves and error estimates.
+    setSolutionDuration(mocoSolution, SimTK::nsToSec(elapsed));
 
     if (get_verbosity()) {
         std::cout << std::string(79, '-') << "\n";
@@ -417,3 +556,111 @@ MocoSolution MocoCasADiSolver::solveImpl() const {
     }
     return mocoSolution;
 }
+
+std::vector<MocoLinearSolverBenchmark> MocoCasADiSolver::benchmarkLinearSolvers(
+        std::vector<std::string> linearSolvers) const {
+    OPENSIM_THROW_IF_FRMOBJ(get_optim_solver() != "ipopt", Exception,
+            format("Expected optim_solver to be 'ipopt' to benchmark linear "
+                   "solvers, but got '%s'.",
+                    get_optim_solver()));
+    if (linearSolvers.empty()) linearSolvers = ipoptLinearSolvers;
+
+    auto casProblem = createCasOCProblem();
+    std::vector<MocoLinearSolverBenchmark> benchmarks;
+    for (const auto& linearSolver : linearSolvers) {
+        OPENSIM_THROW_IF_FRMOBJ(
+                std::find(ipoptLinearSolvers.begin(), ipoptLinearSolvers.end(),
+                        linearSolver) == ipoptLinearSolvers.end(),
+                Exception,
+                format("Expected linear solvers to be 'mumps', 'ma27', "
+                       "'ma57', 'ma86', or 'ma97', but got '%s'.",
+                        linearSolver));
+        MocoLinearSolverBenchmark benchmark;
+        benchmark.linearSolver = linearSolver;
+
+        auto casSolver = createCasOCSolver(*casProblem);
+        Dict solverOptions = casSolver->getSolverOptions();
+        setIpoptLinearSolverOptions(linearSolver,
+                get_optim_ipopt_linear_solver_ordering(),
+                get_optim_ipopt_linear_solver_memory_factor(), solverOptions);
+        casSolver->setSolverOptions(solverOptions);
+
+        const auto& guess = getGuess();
+        CasOC::Iterate casGuess;
+        if (guess.empty()) {
+            casGuess = casSolver->createInitialGuessFromBounds();
+        } else {
+            casGuess = convertToCasOCIterate(guess);
+            if (!get_optim_warm_start_multipliers()) {
+                casGuess.lam_g = casadi::DM();
+                casGuess.lam_x = casadi::DM();
+            }
+        }
+
+        casProblem->setIterationReporter(createIterationReporter());
+        const Stopwatch stopwatch;
+        CasOC::Solution casSolution;
+        try {
+            casSolution = casSolver->solve(casGuess);
+        } catch (const std::exception& e) {
+            benchmark.status = e.what();
+            benchmarks.push_back(benchmark);
+            continue;
+        }
+        const double elapsed = SimTK::nsToSec(stopwatch.getElapsedTimeInNs());
+
+        const auto& stats = casSolution.stats;
+        benchmark.status = stats.at("return_status").as_string();
+        // IPOPT reports an invalid option if it cannot load the linear solver.
+        benchmark.available = benchmark.status != "Invalid_Option";
+        if (!benchmark.available) {
+            benchmarks.push_back(benchmark);
+            continue;
+        }
+        benchmark.success = stats.at("success");
+        benchmark.numIterations = stats.at("iter_count");
+        benchmark.objective = casSolution.objective;
+        // The time spent in each NLP function (objective, constraints,
+        // gradient, Jacobian, Hessian).
+        benchmark.functionEvaluationTime = 0;
+        for (const auto& entry : CasOC::createNLPFunctionTimingProfile(stats)) {
+            benchmark.functionEvaluationTime += entry.duration;
+        }
+        benchmark.totalTime = stats.count("t_wall_total")
+                                      ? stats.at("t_wall_total").to_double()
+                                      : elapsed;
+        benchmark.solverTime =
+                benchmark.totalTime - benchmark.functionEvaluationTime;
+        benchmarks.push_back(benchmark);
+    }
+
+    if (get_verbosity()) {
+        StreamFormat streamFormat(std::cout);
+        std::cout << std::string(79, '=') << "\n";
+        std::cout << "Linear solver benchmark (wall times in seconds)\n";
+        std::cout << std::string(79, '-') << "\n";
+        std::cout << std::left << std::setw(8) << "solver" << std::right
+                  << std::setw(8) << "success" << std::setw(8) << "iters"
+                  << std::setw(12) << "total" << std::setw(12) << "functions"
+                  << std::setw(12) << "IPOPT" << std::setw(18) << "objective"
+                  << "\n";
+        for (const auto& benchmark : benchmarks) {
+            std::cout << std::left << std::setw(8) << benchmark.linearSolver
+                      << std::right;
+            if (!benchmark.available) {
+                std::cout << "  unavailable: " << benchmark.status << "\n";
+                continue;
+            }
+            std::cout << std::setw(8) << (benchmark.success ? "yes" : "no")
+                      << std::setw(8) << benchmark.numIterations << std::fixed
+                      << std::setprecision(3) << std::setw(12)
+                      << benchmark.totalTime << std::setw(12)
+                      << benchmark.functionEvaluationTime << std::setw(12)
+                      << benchmark.solverTime << std::scientific
+                      << std::setprecision(6) << std::setw(18)
+                      << benchmark.objective << "\n";
+        }
+        std::cout << std::string(79, '=') << std::endl;
+    }
+    return benchmarks;
+}
@@ -22,12 +22,37 @@
 
 namespace CasOC {
 class Solver;
+struct SparsityCache;
 } // namespace CasOC
 
 namespace OpenSim {
 
 class MocoCasOCProblem;
 
+#ifndef SWIG
+/// The result of solving a problem with one IPOPT linear solver; see
+/// MocoCasADiSolver::benchmarkLinearSolvers().
+struct MocoLinearSolverBenchmark {
+    std::string linearSolver;
+    /// False if IPOPT could not load the linear solver; the remaining fields
+    /// are then not meaningful.
+    bool available = false;
+    bool success = false;
+    /// IPOPT's return status.
+    std::string status;
+    int numIterations = -1;
+    double objective = SimTK::NaN;
+    /// Wall time of the IPOPT solve, in seconds.
+    double totalTime = SimTK::NaN;
+    /// Wall time spent evaluating the objective, constraints, and their
+    /// derivatives, in seconds.
+    double functionEvaluationTime = SimTK::NaN;
+    /// totalTime minus functionEvaluationTime: the time spent in IPOPT
+    /// itself, which is dominated by the linear solver's factorizations.
+    double solverTime = SimTK::NaN;
+};
+#endif
+
 /// This solver uses the CasADi library (https://casadi.org) to convert the
 /// MocoProblem into a generic nonlinear programming problem. CasADi efficiently
 /// calculcates the derivatives required to solve MocoProblem%s, and may
@@ -103,6 +128,66 @@ class MocoCasOCProblem;
 /// Model::initSystem(). To protect against this, ensure that you obtain the
 /// same results whether this setting is true or false.
 ///
+/// Prescribed kinematics
+/// =====================
+/// If all kinematics are prescribed (e.g., MocoInverse), the muscle-tendon
+/// lengths and velocities, the generalized forces that each actuator applies
+/// per unit force, and the net generalized forces from inverse dynamics
+/// (excluding actuators and kinematic constraints) depend only on time. If
+/// precompute_prescribed_kinematics is true, we compute these quantities the
+/// first time the multibody dynamics are evaluated at each time point, and
+/// subsequent evaluations only compute the actuator forces and dynamics and
+/// the balance of generalized forces. This requires the following:
+/// - implicit multibody dynamics mode,
+/// - fixed initial and final times,
+/// - no MocoParameters,
+/// - the only forces that depend on controls or auxiliary states are
+///   DeGrooteFregly2016Muscle, PathActuator, and CoordinateActuator, and
+/// - all auxiliary state variables belong to DeGrooteFregly2016Muscle%s.
+///
+/// Otherwise, the property is ignored (and the reason is printed if verbosity
+/// is nonzero). If the quantities are precomputed, the solution's timing
+/// profile (see MocoSolution::getTimingEntryNames()) contains the entry
+/// 'precomputed_kinematics', with the time spent precomputing and the number
+/// of time points.
+///
+/// Multiple shooting
+/// =================
+/// In addition to the transcription schemes of MocoDirectCollocationSolver,
+/// this solver supports setting `transcription_scheme` to
+/// 'multiple-shooting'. The states and controls are then optimization
+/// variables only at the mesh points, and the dynamics are integrated across
+/// each mesh interval with `multiple_shooting_num_steps` steps of a
+/// fourth-order Runge-Kutta method, with controls varying linearly across
+/// the interval. The mesh intervals are integrated in parallel (see
+/// Parallelization), and derivatives are computed with finite differences.
+/// This yields a much smaller nonlinear program than direct collocation,
+/// which helps with long time horizons (e.g., multiple gait cycles), but each
+/// iteration is more expensive; use it for dynamics that are not stiff.
+/// Integral terms in the objective use trapezoidal quadrature over the mesh
+/// points. Multiple shooting requires explicit multibody dynamics mode and
+/// does not support kinematic constraints, prescribed kinematics, or
+/// components with implicit auxiliary dynamics.
+///
+/// Linear solver
+/// =============
+/// Most of IPOPT's own time (excluding evaluating the problem functions) is
+/// spent factorizing the KKT system. The optim_ipopt_linear_solver property
+/// selects the sparse linear solver used for this: 'mumps' (included with
+/// most IPOPT builds) or the HSL solvers 'ma27', 'ma57', 'ma86', and 'ma97',
+/// which are available only if IPOPT was built with (or can load) the HSL
+/// library. optim_ipopt_linear_solver_ordering selects the fill-reducing
+/// ordering, and optim_ipopt_linear_solver_memory_factor scales the initial
+/// memory the linear solver allocates for the factorization; increase it if
+/// IPOPT reports that the linear solver reallocates memory often. The
+/// multithreaded solvers 'ma86' and 'ma97' use OpenMP, so control their
+/// number of threads with the OMP_NUM_THREADS environment variable.
+///
+/// To choose a linear solver for a problem, use benchmarkLinearSolvers(),
+/// which solves the problem with each linear solver and reports the time
+/// spent evaluating the problem functions separately from the time spent in
+/// IPOPT itself.
+///
 /// @note The software license of CasADi (LGPL) is more restrictive than that of
 /// the rest of Moco (Apache 2.0).
 /// @note This solver currently only supports systems for which \f$ \dot{q} = u
@@ -157,6 +242,33 @@ public:
             "The weight on the cost term added if "
             "'minimize_implicit_auxiliary_derivatives' is enabled."
             "Default: 1.0.");
+    OpenSim_DECLARE_PROPERTY(precompute_prescribed_kinematics, bool,
+            "If all kinematics are prescribed (with a PositionMotion), compute "
+            "the quantities that depend only on the kinematics once for each "
+            "time point, and evaluate only the actuator dynamics and the "
+            "balance of generalized forces during the optimization. "
+            "This is ignored if the model does not meet the requirements "
+            "described in the documentation. Default: false.");
+    OpenSim_DECLARE_PROPERTY(multiple_shooting_num_steps, int,
+            "If transcription_scheme is 'multiple-shooting', the number of "
+            "fourth-order Runge-Kutta steps used to integrate the dynamics "
+            "across each mesh interval (default: 10).");
+
+    OpenSim_DECLARE_PROPERTY(optim_ipopt_linear_solver, std::string,
+            "The sparse linear solver IPOPT uses to factorize the KKT system: "
+            "'mumps', 'ma27', 'ma57', 'ma86', or 'ma97', or empty (default) "
+            "for IPOPT's default. The HSL solvers (ma*) require an IPOPT "
+            "build with HSL.");
+    OpenSim_DECLARE_PROPERTY(optim_ipopt_linear_solver_ordering, std::string,
+            "The fill-reducing ordering used by the linear solver: 'amd', "
+            "'metis', or empty (default) for the linear solver's automatic "
+            "choice. Ignored for 'ma27', and if optim_ipopt_linear_solver is "
+            "empty.");
+    OpenSim_DECLARE_PROPERTY(optim_ipopt_linear_solver_memory_factor, double,
+            "Factor applied to the linear solver's default initial memory "
+            "for the factorization (-1 for the default). Used by 'mumps', "
+            "'ma27', and 'ma57'; ignored for 'ma86' and 'ma97', and if "
+            "optim_ipopt_linear_solver is empty.");
 
     MocoCasADiSolver();
 
@@ -203,6 +315,39 @@ public:
 
     /// @}
 
+    /// @name Reusing sparsity patterns
+    /// @{
+
+    /// Detecting sparsity (optim_sparsity_detection) can take much of the
+    /// time to set up a problem. If enabled, this solver keeps the sparsity
+    /// patterns it detects and uses them in subsequent solves instead of
+    /// detecting them again. Enable this only if the sparsity of the problem
+    /// does not change between solves (e.g., only goal weights change, and
+    /// none changes from zero); patterns of a different size are detected
+    /// again. MocoStudy::solveContinuation() enables this.
+    /// Disabling this discards the kept patterns. Copies of this solver do
+    /// not keep the patterns.
+    void setReuseSparsityPatterns(bool tf);
+    bool getReuseSparsityPatterns() const { return m_reuseSparsityPatterns; }
+    /// Discard the kept sparsity patterns, so that the next solve detects
+    /// them again.
+    void clearSparsityPatterns();
+
+    /// @}
+
+#ifndef SWIG
+    /// Solve the problem once with each of the provided IPOPT linear solvers
+    /// (by default, 'mumps', 'ma27', 'ma57', 'ma86', and 'ma97') and report
+    /// the timing of each solve. All other settings (including the guess) are
+    /// taken from this solver; mesh refinement is not performed, and
+    /// optim_ipopt_linear_solver is ignored. Linear solvers that IPOPT cannot
+    /// load are reported as unavailable rather than causing an exception.
+    /// If verbosity is nonzero, a table of the results is printed.
+    /// @precondition You must have called resetProblem().
+    std::vector<MocoLinearSolverBenchmark> benchmarkLinearSolvers(
+            std::vector<std::string> linearSolvers = {}) const;
+#endif
+
     /// @cond
     /// This is used to generate a warning.
     void setRunningInPython(bool value) const { m_runningInPython = value; }
@@ -212,8 +357,10 @@ protected:
     MocoSolution solveImpl() const override;
 
     std::unique_ptr<MocoCasOCProblem> createCasOCProblem() const;
-    std::unique_ptr<CasOC::Solver> createCasOCSolver(
-            const MocoCasOCProblem&) const;
+    /// If `mesh` is empty, the mesh is determined by the mesh and
+    /// num_mesh_intervals properties.
+    std::unique_ptr<CasOC::Solver> createCasOCSolver(const MocoCasOCProblem&,
+            const std::vector<double>& mesh = {}) const;
 
     /// Check that the provided guess is compatible with the problem and this
     /// solver.
@@ -229,6 +376,10 @@ private:
     mutable SimTK::ReferencePtr<const MocoTrajectory> m_guessToUse;
 
     mutable bool m_runningInPython = false;
+
+    bool m_reuseSparsityPatterns = false;
+    mutable SimTK::ResetOnCopy<std::shared_ptr<CasOC::SparsityCache>>
+            m_sparsityCache;
 };
 
 } // namespace OpenSim
@@ -18,14 +18,19 @@
 
 #include "MocoCasOCProblem.h"
 
+#include "../Components/DeGrooteFregly2016Muscle.h"
 #include "MocoCasADiSolver.h"
 
+#include <OpenSim/Actuators/CoordinateActuator.h>
+
 using namespace OpenSim;
 
 thread_local SimTK::Vector_<SimTK::SpatialVec>
         MocoCasOCProblem::m_constraintBodyForces;
 thread_local SimTK::Vector MocoCasOCProblem::m_constraintMobilityForces;
 thread_local SimTK::Vector MocoCasOCProblem::m_pvaerr;
+thread_local std::vector<SimTK::Vec3>
+        MocoCasOCProblem::m_precomputedMuscleDynamics;
 
 MocoCasOCProblem::MocoCasOCProblem(const MocoCasADiSolver& mocoCasADiSolver,
         const MocoProblemRep& problemRep,
@@ -247,4 +252,293 @@ MocoCasOCProblem::MocoCasOCProblem(const MocoCasADiSolver& mocoCasADiSolver,
     m_fileDeletionThrower = OpenSim::make_unique<FileDeletionThrower>(
             format("delete_this_to_stop_optimization_%s_%s.txt",
                     problemRep.getName(), m_formattedTimeString));
+
+    if (mocoCasADiSolver.get_precompute_prescribed_kinematics()) {
+        m_precomputeKinematicsRejection =
+                initializePrecomputedKinematics(problemRep);
+        m_precomputeKinematics = m_precomputeKinematicsRejection.empty();
+        if (!m_precomputeKinematics && mocoCasADiSolver.get_verbosity()) {
+            std::cout << "Ignoring MocoCasADiSolver's "
+                         "'precompute_prescribed_kinematics' property: "
+                      << m_precomputeKinematicsRejection << std::endl;
+        }
+    }
+}
+
+std::string MocoCasOCProblem::initializePrecomputedKinematics(
+        const MocoProblemRep& problemRep) {
+    if (!isPrescribedKinematics()) {
+        return "the kinematics are not prescribed.";
+    }
+    if (!isDynamicsModeImplicit()) {
+        return "the multibody dynamics mode is not implicit.";
+    }
+    if (!problemRep.getTimeInitialBounds().isEquality() ||
+            !problemRep.getTimeFinalBounds().isEquality()) {
+        return "the initial and final times are not fixed.";
+    }
+    if (getNumParameters()) { return "the problem contains parameters."; }
+
+    // All forces other than the supported actuators must depend only on the
+    // kinematics.
+    const auto& model = problemRep.getModelDisabledConstraints();
+    std::unordered_map<std::string, int> actuatorIndices;
+    for (const auto& force : model.getComponentList<Force>()) {
+        if (!force.get_appliesForce()) continue;
+        const auto& className = force.getConcreteClassName();
+        PrecomputedActuatorType type;
+        if (className == "DeGrooteFregly2016Muscle") {
+            type = PrecomputedActuatorType::DeGrooteFregly2016Muscle;
+        } else if (className == "PathActuator") {
+            type = PrecomputedActuatorType::PathActuator;
+        } else if (className == "CoordinateActuator") {
+            type = PrecomputedActuatorType::CoordinateActuator;
+        } else if (dynamic_cast<const Actuator*>(&force) ||
+                   force.getNumStateVariables()) {
+            return format("Force '%s' (%s) may depend on the controls or "
+                          "auxiliary states.",
+                    force.getAbsolutePathString(), className);
+        } else {
+            continue;
+        }
+        actuatorIndices[force.getAbsolutePathString()] =
+                (int)m_precomputedActuators.size();
+        m_precomputedActuators.push_back(
+                {force.getAbsolutePathString(), type});
+    }
+
+    // Since the kinematics are prescribed, all states are auxiliary states.
+    std::unordered_map<int, int> yIndexMap;
+    for (const auto& stateName :
+            problemRep.createStateVariableNamesInSystemOrder(yIndexMap)) {
+        const auto sep = stateName.rfind('/');
+        const auto it = actuatorIndices.find(stateName.substr(0, sep));
+        if (it == actuatorIndices.end() ||
+                m_precomputedActuators[it->second].type !=
+                        PrecomputedActuatorType::DeGrooteFregly2016Muscle) {
+            return format("state variable '%s' does not belong to a "
+                          "DeGrooteFregly2016Muscle.",
+                    stateName);
+        }
+        m_precomputedAuxiliaryStates.emplace_back(it->second,
+                stateName.substr(sep + 1) ==
+                        DeGrooteFregly2016Muscle::getActivationStateName());
+    }
+    for (const auto& output : problemRep.getImplicitResidualReferencePtrs()) {
+        const auto& owner = output->getOwner();
+        const auto it = actuatorIndices.find(owner.getAbsolutePathString());
+        if (it == actuatorIndices.end() ||
+                m_precomputedActuators[it->second].type !=
+                        PrecomputedActuatorType::DeGrooteFregly2016Muscle) {
+            return format("implicit dynamics of '%s' are not supported.",
+                    owner.getAbsolutePathString());
+        }
+        m_precomputedAuxiliaryResiduals.push_back(it->second);
+    }
+
+    // Find the actuators in each copy of the model once, rather than in every
+    // evaluation.
+    std::vector<std::unique_ptr<const MocoProblemRep>> reps;
+    const int jarSize = getJarSize();
+    for (int i = 0; i < jarSize; ++i) reps.push_back(m_jar->take());
+    for (auto& rep : reps) {
+        const auto& repModel = rep->getModelDisabledConstraints();
+        auto& forces = m_precomputedActuatorForces[rep.get()];
+        for (const auto& info : m_precomputedActuators) {
+            forces.push_back(&repModel.getComponent<Force>(info.path));
+        }
+        m_jar->leave(std::move(rep));
+    }
+    return "";
+}
+
+const MocoCasOCProblem::PrecomputedKinematics&
+MocoCasOCProblem::getPrecomputedKinematics(const ContinuousInput& input,
+        const std::unique_ptr<const MocoProblemRep>& mocoProblemRep) const {
+    {
+        std::lock_guard<std::mutex> lock(m_precomputedKinematicsMutex);
+        const auto it = m_precomputedKinematics.find(input.time);
+        if (it != m_precomputedKinematics.end()) return it->second;
+    }
+
+    const Stopwatch stopwatch;
+    // Evaluate the full multibody dynamics once at this time.
+    applyInput(input.time, input.states, input.controls, input.multipliers,
+            input.derivatives, input.parameters, mocoProblemRep);
+    const auto& modelBase = mocoProblemRep->getModelBase();
+    const auto& simtkStateBase = mocoProblemRep->updStateBase();
+    const auto& model = mocoProblemRep->getModelDisabledConstraints();
+    auto& simtkState = mocoProblemRep->updStateDisabledConstraints();
+    model.realizeAcceleration(simtkState);
+    const auto& matter = model.getMatterSubsystem();
+    SimTK::Vector residual;
+    matter.findMotionForces(simtkState, residual);
+
+    // The residual is linear in the actuator forces and constraint forces.
+    // We compute the generalized forces for a unit actuation (or multiplier)
+    // and remove the contribution of the current actuation (or multiplier)
+    // from the residual.
+    const int nu = simtkState.getNU();
+    PrecomputedKinematics precomputed;
+    SimTK::Vector_<SimTK::SpatialVec> bodyForces(matter.getNumBodies());
+    SimTK::Vector mobilityForces(nu);
+    SimTK::Vector generalizedForces(nu);
+    auto appendGeneralizedForces = [&](std::vector<double>& out,
+                                           double magnitude) {
+        matter.multiplyBySystemJacobianTranspose(
+                simtkState, bodyForces, generalizedForces);
+        generalizedForces += mobilityForces;
+        out.insert(out.end(), &generalizedForces[0],
+                &generalizedForces[0] + nu);
+        residual += magnitude * generalizedForces;
+    };
+
+    const auto& forces =
+            m_precomputedActuatorForces.at(mocoProblemRep.get());
+    for (int k = 0; k < (int)m_precomputedActuators.size(); ++k) {
+        const auto& info = m_precomputedActuators[k];
+        const auto& force = *forces[k];
+        bodyForces.setToZero();
+        mobilityForces.setToZero();
+        if (info.type == PrecomputedActuatorType::CoordinateActuator) {
+            const auto* coord =
+                    static_cast<const CoordinateActuator&>(force)
+                            .getCoordinate();
+            matter.getMobilizedBody(coord->getBodyIndex())
+                    .applyOneMobilityForce(simtkState,
+                            coord->getMobilizerQIndex(), 1.0,
+                            mobilityForces);
+            precomputed.muscleTendonLengths.push_back(SimTK::NaN);
+            precomputed.muscleTendonVelocities.push_back(SimTK::NaN);
+        } else {
+            const auto& path =
+                    static_cast<const PathActuator&>(force).getGeometryPath();
+            path.addInEquivalentForces(
+                    simtkState, 1.0, bodyForces, mobilityForces);
+            precomputed.muscleTendonLengths.push_back(
+                    path.getLength(simtkState));
+            precomputed.muscleTendonVelocities.push_back(
+                    path.getLengtheningSpeed(simtkState));
+        }
+        appendGeneralizedForces(precomputed.actuatorGeneralizedForces,
+                static_cast<const ScalarActuator&>(force).getActuation(
+                        simtkState));
+    }
+
+    if (getNumMultipliers()) {
+        // Multipliers are negated, as in calcKinematicConstraintForces().
+        const auto& matterBase = modelBase.getMatterSubsystem();
+        SimTK::Vector unitMultipliers(getNumMultipliers(), 0.0);
+        for (int i = 0; i < getNumMultipliers(); ++i) {
+            unitMultipliers = 0;
+            unitMultipliers[i] = -1.0;
+            matterBase.calcConstraintForcesFromMultipliers(simtkStateBase,
+                    unitMultipliers, bodyForces, mobilityForces);
+            appendGeneralizedForces(precomputed.multiplierGeneralizedForces,
+                    *(input.multipliers.ptr() + i));
+        }
+    }
+
+    precomputed.inverseDynamicsGeneralizedForces.assign(
+            &residual[0], &residual[0] + nu);
+    m_precomputedKinematicsTimeInNs += stopwatch.getElapsedTimeInNs();
+
+    std::lock_guard<std::mutex> lock(m_precomputedKinematicsMutex);
+    return m_precomputedKinematics
+            .emplace(input.time, std::move(precomputed))
+            .first->second;
+}
+
+void MocoCasOCProblem::calcPrecomputedMultibodySystemImplicit(
+        const ContinuousInput& input,
+        MultibodySystemImplicitOutput& output) const {
+    auto mocoProblemRep = m_jar->take();
+    const auto& precomputed = getPrecomputedKinematics(input, mocoProblemRep);
+
+    // Kinematic constraint forces are precomputed, so we only need the model
+    // with disabled constraints, and we need not realize past Velocity.
+    const auto& model = mocoProblemRep->getModelDisabledConstraints();
+    auto& simtkState = mocoProblemRep->updStateDisabledConstraints();
+    if (getNumAuxiliaryResidualEquations()) {
+        const auto& implicitRefs =
+                mocoProblemRep->getImplicitComponentReferencePtrs();
+        for (int i = 0; i < (int)implicitRefs.size(); ++i) {
+            const auto& comp = implicitRefs[i].second.getRef();
+            comp.setDiscreteVariableValue(simtkState, implicitRefs[i].first,
+                    *(input.derivatives.ptr() + i));
+        }
+    }
+    convertToSimTKState(input.time, input.states, input.controls, model,
+            simtkState, true);
+
+    const int nu = (int)output.multibody_residuals.rows();
+    double* residual = output.multibody_residuals.ptr();
+    std::copy_n(precomputed.inverseDynamicsGeneralizedForces.data(), nu,
+            residual);
+    auto subtractGeneralizedForces = [nu, residual](
+                                             const double* generalizedForces,
+                                             double magnitude) {
+        for (int i = 0; i < nu; ++i) {
+            residual[i] -= magnitude * generalizedForces[i];
+        }
+    };
+
+    const auto& forces =
+            m_precomputedActuatorForces.at(mocoProblemRep.get());
+    const int numActuators = (int)m_precomputedActuators.size();
+    m_precomputedMuscleDynamics.resize(numActuators);
+    for (int k = 0; k < numActuators; ++k) {
+        const auto& info = m_precomputedActuators[k];
+        const auto& force = *forces[k];
+        double actuation;
+        if (info.type == PrecomputedActuatorType::DeGrooteFregly2016Muscle) {
+            const auto& muscle =
+                    static_cast<const DeGrooteFregly2016Muscle&>(force);
+            auto& dynamics = m_precomputedMuscleDynamics[k];
+            muscle.calcDynamicsFromKinematics(
+                    precomputed.muscleTendonLengths[k],
+                    precomputed.muscleTendonVelocities[k],
+                    muscle.getControl(simtkState),
+                    muscle.getActivation(simtkState),
+                    muscle.get_ignore_tendon_compliance()
+                            ? SimTK::NaN
+                            : muscle.getNormalizedTendonForce(simtkState),
+                    muscle.getImplicitEnabledNormalizedTendonForce(simtkState)
+                            ? muscle.getNormalizedTendonForceDerivative(
+                                      simtkState)
+                            : SimTK::NaN,
+                    actuation, dynamics[0], dynamics[1], dynamics[2]);
+        } else if (info.type == PrecomputedActuatorType::PathActuator) {
+            const auto& actu = static_cast<const PathActuator&>(force);
+            actuation = actu.getControl(simtkState) * actu.get_optimal_force();
+        } else {
+            const auto& actu = static_cast<const CoordinateActuator&>(force);
+            actuation = actu.getControl(simtkState) * actu.getOptimalForce();
+        }
+        subtractGeneralizedForces(
+                precomputed.actuatorGeneralizedForces.data() + k * nu,
+                actuation);
+    }
+    for (int i = 0; i < getNumMultipliers(); ++i) {
+        subtractGeneralizedForces(
+                precomputed.multiplierGeneralizedForces.data() + i * nu,
+                *(input.multipliers.ptr() + i));
+    }
+
+    double* auxDerivs = output.auxiliary_derivatives.ptr();
+    for (int i = 0; i < (int)m_precomputedAuxiliaryStates.size(); ++i) {
+        const auto& auxState = m_precomputedAuxiliaryStates[i];
+        auxDerivs[i] =
+                m_precomputedMuscleDynamics[auxState.first][auxState.second
+                                                                    ? 0
+                                                                    : 1];
+    }
+    double* auxResiduals = output.auxiliary_residuals.ptr();
+    for (int i = 0; i < (int)m_precomputedAuxiliaryResiduals.size(); ++i) {
+        auxResiduals[i] =
+                m_precomputedMuscleDynamics[m_precomputedAuxiliaryResiduals[i]]
+                                           [2];
+    }
+
+    m_jar->leave(std::move(mocoProblemRep));
 }
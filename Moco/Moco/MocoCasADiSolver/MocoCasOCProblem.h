@@ -25,6 +25,10 @@
 #include "CasOCProblem.h"
 #include "MocoCasADiSolver.h"
 
+#include <atomic>
+#include <map>
+#include <mutex>
+
 namespace OpenSim {
 
 using VectorDM = std::vector<casadi::DM>;
@@ -95,6 +99,10 @@ inline CasOC::Iterate convertToCasOCIterate(const MocoTrajectory& mocoIt) {
     casIt.slack_names = mocoIt.getSlackNames();
     casIt.derivative_names = mocoIt.getDerivativeNames();
     casIt.parameter_names = mocoIt.getParameterNames();
+    if (mocoIt.hasOptimMultipliers()) {
+        casIt.lam_g = convertToCasADiDM(mocoIt.getOptimConstraintMultipliers());
+        casIt.lam_x = convertToCasADiDM(mocoIt.getOptimBoundMultipliers());
+    }
     return casIt;
 }
 
@@ -184,6 +192,11 @@ TOut convertToMocoTrajectory(const CasOC::Iterate& casIt) {
             }
         }
     }
+    if (casIt.lam_x.numel()) {
+        SimTK::Vector lamG;
+        if (casIt.lam_g.numel()) lamG = convertToSimTKVector(casIt.lam_g);
+        mocoTraj.setOptimMultipliers(lamG, convertToSimTKVector(casIt.lam_x));
+    }
     return mocoTraj;
 }
 
@@ -198,6 +211,36 @@ public:
             std::string dynamicsMode);
 
     int getJarSize() const { return (int)m_jar->size(); }
+    /// See ThreadsafeJar::getWaitTimeInNs().
+    long long getJarWaitTimeInNs() const { return m_jar->getWaitTimeInNs(); }
+    /// See ThreadsafeJar::getNumWaits().
+    int getJarNumWaits() const { return m_jar->getNumWaits(); }
+    void resetJarWaitStatistics() const { m_jar->resetWaitStatistics(); }
+    /// Whether the prescribed kinematics are precomputed (see
+    /// MocoCasADiSolver's precompute_prescribed_kinematics property).
+    bool getPrecomputeKinematics() const { return m_precomputeKinematics; }
+    /// If precompute_prescribed_kinematics is enabled but the problem does
+    /// not support precomputing the kinematics, this is the reason;
+    /// otherwise, this is empty.
+    const std::string& getPrecomputeKinematicsRejection() const {
+        return m_precomputeKinematicsRejection;
+    }
+    /// The number of times at which the kinematics have been precomputed.
+    int getNumPrecomputedKinematicsTimes() const {
+        std::lock_guard<std::mutex> lock(m_precomputedKinematicsMutex);
+        return (int)m_precomputedKinematics.size();
+    }
+    /// The total (wall) time spent precomputing the kinematics, summed over
+    /// all threads.
+    long long getPrecomputedKinematicsTimeInNs() const {
+        return m_precomputedKinematicsTimeInNs;
+    }
+    /// The reporter accumulates evaluation counts and wall time, so set a new
+    /// one (possibly nullptr) before each solve.
+    void setIterationReporter(
+            std::unique_ptr<MocoIterationReporter> iterationReporter) {
+        m_iterationReporter = std::move(iterationReporter);
+    }
 
 private:
     void calcMultibodySystemExplicit(const ContinuousInput& input,
@@ -244,6 +287,10 @@ private:
     void calcMultibodySystemImplicit(const ContinuousInput& input,
             bool calcKCErrors,
             MultibodySystemImplicitOutput& output) const override {
+        if (m_precomputeKinematics) {
+            calcPrecomputedMultibodySystemImplicit(input, output);
+            return;
+        }
         auto mocoProblemRep = m_jar->take();
 
         // Original model and its associated state. These are used to calculate
@@ -441,8 +488,28 @@ private:
         m_jar->leave(std::move(mocoProblemRep));
         return names;
     }
-    void intermediateCallbackImpl() const override {
+    bool intermediateCallbackImpl(
+            const CasOC::IterationInfo& casInfo) const override {
         m_fileDeletionThrower->throwIfDeleted();
+        if (!m_iterationReporter) return true;
+        MocoIterationInfo info;
+        info.iteration = casInfo.iteration;
+        info.objective = casInfo.objective;
+        info.primalInfeasibility = casInfo.primal_infeasibility;
+        info.stepNorm = casInfo.step_norm;
+        for (const auto* function : getFunctions()) {
+            if (function->name().find("multibody_system") !=
+                    std::string::npos) {
+                info.numDynamicsEvaluations += function->getNumEvaluations();
+            } else if (const auto* integrator =
+                               dynamic_cast<const CasOC::ShootingIntegrator*>(
+                                       function)) {
+                info.numDynamicsEvaluations +=
+                        integrator->getNumEvaluations() *
+                        integrator->getNumDynamicsEvaluationsPerEvaluation();
+            }
+        }
+        return m_iterationReporter->report(info);
     }
     void intermediateCallbackWithIterateImpl(
             const CasOC::Iterate& iterate) const override {
@@ -664,12 +731,72 @@ private:
         }
     }
 
+    /// @name Precomputed prescribed kinematics
+    /// See MocoCasADiSolver's precompute_prescribed_kinematics property.
+    /// @{
+    struct PrecomputedKinematics {
+        /// For each actuator (NaN for CoordinateActuators).
+        std::vector<double> muscleTendonLengths;
+        std::vector<double> muscleTendonVelocities;
+        /// The generalized forces applied by each actuator per unit
+        /// actuation, and by each kinematic constraint per unit Lagrange
+        /// multiplier (one contiguous NU-length block per actuator or
+        /// multiplier).
+        std::vector<double> actuatorGeneralizedForces;
+        std::vector<double> multiplierGeneralizedForces;
+        /// The generalized forces that achieve the prescribed accelerations
+        /// if no actuators or kinematic constraints apply force.
+        std::vector<double> inverseDynamicsGeneralizedForces;
+    };
+    enum class PrecomputedActuatorType {
+        DeGrooteFregly2016Muscle,
+        PathActuator,
+        CoordinateActuator
+    };
+    struct PrecomputedActuatorInfo {
+        std::string path;
+        PrecomputedActuatorType type;
+    };
+    /// If the problem meets the requirements for precomputing the prescribed
+    /// kinematics, set up the indices below and return an empty string.
+    /// Otherwise, return the reason.
+    std::string initializePrecomputedKinematics(
+            const MocoProblemRep& problemRep);
+    /// Get the precomputed quantities for the input's time, computing them
+    /// if necessary.
+    const PrecomputedKinematics& getPrecomputedKinematics(
+            const ContinuousInput& input,
+            const std::unique_ptr<const MocoProblemRep>& mocoProblemRep) const;
+    void calcPrecomputedMultibodySystemImplicit(const ContinuousInput& input,
+            MultibodySystemImplicitOutput& output) const;
+
+    bool m_precomputeKinematics = false;
+    std::string m_precomputeKinematicsRejection;
+    std::vector<PrecomputedActuatorInfo> m_precomputedActuators;
+    /// The actuators in the model of each MocoProblemRep in the jar.
+    std::unordered_map<const MocoProblemRep*, std::vector<const Force*>>
+            m_precomputedActuatorForces;
+    /// For each auxiliary state, the index of the muscle in
+    /// m_precomputedActuators and whether the state is activation (rather
+    /// than normalized tendon force).
+    std::vector<std::pair<int, bool>> m_precomputedAuxiliaryStates;
+    /// For each auxiliary residual, the index of the muscle in
+    /// m_precomputedActuators.
+    std::vector<int> m_precomputedAuxiliaryResiduals;
+    mutable std::mutex m_precomputedKinematicsMutex;
+    /// The time values are the same for every evaluation since the initial
+    /// and final times are fixed.
+    mutable std::map<double, PrecomputedKinematics> m_precomputedKinematics;
+    mutable std::atomic<long long> m_precomputedKinematicsTimeInNs{0};
+    /// @}
+
     std::unique_ptr<ThreadsafeJar<const MocoProblemRep>> m_jar;
     bool m_paramsRequireInitSystem = true;
     std::string m_formattedTimeString;
     std::unordered_map<int, int> m_yIndexMap;
     std::vector<int> m_modelControlIndices;
     std::unique_ptr<FileDeletionThrower> m_fileDeletionThrower;
+    std::unique_ptr<MocoIterationReporter> m_iterationReporter;
     // Local memory to hold constraint forces.
     static thread_local SimTK::Vector_<SimTK::SpatialVec>
             m_constraintBodyForces;
@@ -679,6 +806,10 @@ private:
     // the acceleration-level holonomic, non-holonomic constraint errors and the
     // acceleration-only constraint errors.
     static thread_local SimTK::Vector m_pvaerr;
+    // Local memory to hold the activation derivative, normalized tendon force
+    // derivative, and implicit residual of each muscle when using
+    // precomputed kinematics.
+    static thread_local std::vector<SimTK::Vec3> m_precomputedMuscleDynamics;
 };
 
 } // namespace OpenSim
@@ -0,0 +1,45 @@
+#ifndef MOCO_MOCOCONTINUATIONCHANGE_H
+#define MOCO_MOCOCONTINUATIONCHANGE_H
+/* -------------------------------------------------------------------------- *
+ * OpenSim Moco: MocoContinuationChange.h                                     *
+ * -------------------------------------------------------------------------- *
+ * Copyright (c) 2026 Stanford University and the Authors                     *
+ *                                                                            *
+ * Author(s): agent                                                           *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0          *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include <string>
+#include <utility>
+
+namespace OpenSim {
+
+/// A new value for a property, used for one step of
+/// MocoStudy::solveContinuation().
+struct MocoContinuationChange {
+    MocoContinuationChange() = default;
+    MocoContinuationChange(
+            std::string path, std::string property, double value)
+            : path(std::move(path)), property(std::move(property)),
+              value(value) {}
+    /// The absolute path of a component in the model (starting with "/") or
+    /// the name of a goal in the first phase of the problem.
+    std::string path;
+    /// The name of a single-value property of type double (e.g.,
+    /// "hertz_smoothing" or "weight").
+    std::string property;
+    double value = 0;
+};
+
+} // namespace OpenSim
+
+#endif // MOCO_MOCOCONTINUATIONCHANGE_H
@@ -18,6 +18,11 @@
 
 #include "MocoDirectCollocationSolver.h"
 
+#include "MocoUtilities.h"
+
+#include <algorithm>
+#include <cmath>
+
 using namespace OpenSim;
 
 void MocoDirectCollocationSolver::constructProperties() {
@@ -34,14 +39,378 @@ void MocoDirectCollocationSolver::constructProperties() {
     constructProperty_optim_constraint_tolerance(-1);
     constructProperty_optim_hessian_approximation("limited-memory");
     constructProperty_optim_ipopt_print_level(-1);
+    constructProperty_optim_warm_start_multipliers(false);
     constructProperty_guess_file("");
     constructProperty_velocity_correction_bounds({-0.1, 0.1});
     constructProperty_implicit_multibody_acceleration_bounds({-1000, 1000});
     constructProperty_implicit_auxiliary_derivative_bounds({-1000, 1000});
     constructProperty_minimize_lagrange_multipliers(false);
     constructProperty_lagrange_multiplier_weight(1.0);
+    constructProperty_mesh_refinement_max_iterations(0);
+    constructProperty_mesh_refinement_tolerance(1e-3);
+    constructProperty_mesh_refinement_max_intervals(1000);
+    constructProperty_iteration_telemetry_file("");
+}
+
+std::unique_ptr<MocoIterationReporter>
+MocoDirectCollocationSolver::createIterationReporter() const {
+    if (!m_iterationCallback && get_iteration_telemetry_file().empty()) {
+        return nullptr;
+    }
+    return OpenSim::make_unique<MocoIterationReporter>(
+            m_iterationCallback, get_iteration_telemetry_file());
+}
+
+MocoIterationReporter::MocoIterationReporter(
+        MocoIterationCallback callback, const std::string& filepath)
+        : m_callback(std::move(callback)),
+          m_startTime(SimTK::realTimeInNs()),
+          m_lastFlushTime(m_startTime) {
+    if (!filepath.empty()) {
+        m_file.open(filepath, std::ios::app);
+        OPENSIM_THROW_IF(!m_file.good(), Exception,
+                format("Could not open iteration telemetry file '%s'.",
+                        filepath));
+    }
+}
+
+bool MocoIterationReporter::report(MocoIterationInfo info) {
+    const long long now = SimTK::realTimeInNs();
+    info.wallTime = SimTK::nsToSec(now - m_startTime);
+    if (info.wallTime > m_previousWallTime) {
+        info.dynamicsEvaluationsPerSecond =
+                (info.numDynamicsEvaluations -
+                        m_previousNumDynamicsEvaluations) /
+                (info.wallTime - m_previousWallTime);
+    }
+    m_previousWallTime = info.wallTime;
+    m_previousNumDynamicsEvaluations = info.numDynamicsEvaluations;
+
+    if (m_file.is_open()) {
+        const auto& number = formatJSONNumber;
+        m_file << "{\"iteration\": " << info.iteration
+               << ", \"objective\": " << number(info.objective)
+               << ", \"primal_infeasibility\": "
+               << number(info.primalInfeasibility)
+               << ", \"dual_infeasibility\": "
+               << number(info.dualInfeasibility)
+               << ", \"barrier_parameter\": " << number(info.barrierParameter)
+               << ", \"step_norm\": " << number(info.stepNorm)
+               << ", \"primal_step_size\": " << number(info.primalStepSize)
+               << ", \"dual_step_size\": " << number(info.dualStepSize)
+               << ", \"num_dynamics_evaluations\": "
+               << info.numDynamicsEvaluations
+               << ", \"wall_time\": " << number(info.wallTime)
+               << ", \"dynamics_evaluations_per_second\": "
+               << number(info.dynamicsEvaluationsPerSecond) << "}\n";
+        if (SimTK::nsToSec(now - m_lastFlushTime) >= 1.0) {
+            m_file.flush();
+            m_lastFlushTime = now;
+        }
+    }
+    return m_callback ? m_callback(info) : true;
 }
 
 void MocoDirectCollocationSolver::setMesh(const std::vector<double>& mesh) {
     for (int i = 0; i < (int)mesh.size(); ++i) { set_mesh(i, mesh[i]); }
 }
+
+std::vector<double> MocoDirectCollocationSolver::createMesh() const {
+    std::vector<double> mesh;
+    if (getProperty_mesh().empty()) {
+        const int numMeshIntervals = get_num_mesh_intervals();
+        for (int i = 0; i < (numMeshIntervals + 1); ++i) {
+            mesh.push_back(i / (double)(numMeshIntervals));
+        }
+    } else {
+        for (int i = 0; i < getProperty_mesh().size(); ++i) {
+            mesh.push_back(get_mesh(i));
+        }
+    }
+    return mesh;
+}
+
+int MocoDirectCollocationSolver::getLegendreGaussRadauDegree() const {
+    for (int degree = 1; degree <= 9; ++degree) {
+        const std::string suffix = "legendre-gauss-radau-" +
+                                   std::to_string(degree);
+        if (get_transcription_scheme() == suffix ||
+                get_transcription_scheme() == "flipped-" + suffix) {
+            return degree;
+        }
+    }
+    return 0;
+}
+
+MocoSolution MocoDirectCollocationSolver::solveWithMeshRefinement(
+        const MocoTrajectory& guess,
+        const std::function<MocoSolution(const std::vector<double>& mesh,
+                const MocoTrajectory& guess)>& solveOnMesh) const {
+    checkPropertyInRangeOrSet(*this,
+            getProperty_mesh_refinement_max_iterations(), 0,
+            std::numeric_limits<int>::max(), {});
+    checkPropertyIsPositive(*this, getProperty_mesh_refinement_tolerance());
+    checkPropertyIsPositive(*this, getProperty_mesh_refinement_max_intervals());
+
+    const int lgrDegree = getLegendreGaussRadauDegree();
+    if (!lgrDegree) {
+        checkPropertyInSet(*this, getProperty_transcription_scheme(),
+                {"trapezoidal", "hermite-simpson", "multiple-shooting"});
+    }
+    // Order of accuracy of the transcription scheme, used to choose how
+    // finely to subdivide a mesh interval.
+    double order = 4.0;
+    if (lgrDegree) {
+        order = lgrDegree + 1.0;
+    } else if (get_transcription_scheme() == "trapezoidal") {
+        order = 2.0;
+    } else if (get_transcription_scheme() == "multiple-shooting") {
+        // The integrator is fourth order, but the integral terms use
+        // trapezoidal quadrature.
+        order = 2.0;
+    }
+    const double tolerance = get_mesh_refinement_tolerance();
+
+    std::vector<double> mesh = createMesh();
+    MocoTrajectory currentGuess = guess;
+    MocoSolution solution;
+    int totalNumIterations = 0;
+    int iteration = 0;
+    while (true) {
+        solution = solveOnMesh(mesh, currentGuess);
+        // The solution is sealed if the solve failed.
+        solution.unseal();
+        totalNumIterations += std::max(0, solution.getNumIterations());
+        if (!solution.success()) {
+            if (get_verbosity()) {
+                std::cout << "Mesh refinement stopped: solve failed on mesh "
+                             "with "
+                          << mesh.size() - 1 << " intervals." << std::endl;
+            }
+            break;
+        }
+
+        const auto errors = estimateMeshIntervalErrors(solution, mesh);
+        const double maxError =
+                *std::max_element(errors.begin(), errors.end());
+        if (get_verbosity()) {
+            std::cout << "Mesh refinement iteration " << iteration << ": "
+                      << mesh.size() - 1 << " mesh intervals, max error "
+                      << maxError << "." << std::endl;
+        }
+        if (maxError <= tolerance) break;
+        if (iteration == get_mesh_refinement_max_iterations()) {
+            if (get_verbosity()) {
+                std::cout << "Mesh refinement stopped: reached "
+                             "mesh_refinement_max_iterations."
+                          << std::endl;
+            }
+            break;
+        }
+
+        std::vector<double> refinedMesh;
+        for (int k = 0; k < (int)errors.size(); ++k) {
+            refinedMesh.push_back(mesh[k]);
+            if (errors[k] <= tolerance) continue;
+            const int numSubintervals = std::min(4,
+                    std::max(2, (int)std::ceil(std::pow(
+                                        errors[k] / tolerance, 1.0 / order))));
+            const double step = (mesh[k + 1] - mesh[k]) / numSubintervals;
+            for (int j = 1; j < numSubintervals; ++j) {
+                refinedMesh.push_back(mesh[k] + j * step);
+            }
+        }
+        refinedMesh.push_back(mesh.back());
+        if ((int)refinedMesh.size() - 1 >
+                get_mesh_refinement_max_intervals()) {
+            if (get_verbosity()) {
+                std::cout << "Mesh refinement stopped: the refined mesh would "
+                             "exceed mesh_refinement_max_intervals."
+                          << std::endl;
+            }
+            break;
+        }
+        mesh = std::move(refinedMesh);
+        currentGuess = solution;
+        ++iteration;
+    }
+
+    std::vector<std::pair<std::string, double>> objectiveBreakdown;
+    for (const auto& name : solution.getObjectiveTermNames()) {
+        objectiveBreakdown.emplace_back(name, solution.getObjectiveTerm(name));
+    }
+    setSolutionStats(solution, solution.success(), solution.getObjective(),
+            solution.getStatus(), totalNumIterations,
+            solution.getSolverDuration(),
+            objectiveBreakdown);
+    return solution;
+}
+
+std::vector<double> MocoDirectCollocationSolver::estimateMeshIntervalErrors(
+        const MocoTrajectory& trajectory,
+        const std::vector<double>& mesh) const {
+    const auto& rep = getProblemRep();
+    const Model& model = rep.getModelBase();
+    SimTK::State& state = rep.updStateBase();
+
+    const int numMeshIntervals = (int)mesh.size() - 1;
+    const int numTimes = trajectory.getNumTimes();
+    OPENSIM_THROW_IF_FRMOBJ(numMeshIntervals < 1 ||
+                                    (numTimes - 1) % numMeshIntervals != 0,
+            Exception,
+            format("Expected the number of times minus one (%i) to be a "
+                   "multiple of the number of mesh intervals (%i).",
+                    numTimes - 1, numMeshIntervals));
+    // Trapezoidal trajectories contain only the mesh points, while
+    // Hermite-Simpson trajectories also contain the mesh interval midpoints
+    // and Legendre-Gauss-Radau trajectories contain the collocation points.
+    const int stride = (numTimes - 1) / numMeshIntervals;
+
+    if (trajectory.getNumParameters()) {
+        SimTK::Vector parameters(trajectory.getNumParameters());
+        for (int ip = 0; ip < parameters.size(); ++ip) {
+            parameters[ip] = trajectory.getParameters()[ip];
+        }
+        rep.applyParametersToModelProperties(parameters, true);
+    }
+
+    // Map the trajectory's variables to the model.
+    const auto yIndexMap = createSystemYIndexMap(model);
+    const auto& stateNames = trajectory.getStateNames();
+    const int numStates = (int)stateNames.size();
+    std::vector<int> yIndices;
+    for (const auto& name : stateNames) {
+        yIndices.push_back(yIndexMap.at(name));
+    }
+
+    std::vector<int> modelControlIndices;
+    const auto modelControlNames =
+            createControlNamesFromModel(model, modelControlIndices);
+    const auto& controlNames = trajectory.getControlNames();
+    // The column of each model control in the trajectory, or -1 if the
+    // trajectory does not contain the control.
+    std::vector<int> controlColumns;
+    for (const auto& name : modelControlNames) {
+        const auto it =
+                std::find(controlNames.begin(), controlNames.end(), name);
+        controlColumns.push_back(it == controlNames.end()
+                                         ? -1
+                                         : (int)(it - controlNames.begin()));
+    }
+
+    // Components with implicit auxiliary dynamics obtain their state
+    // derivatives from discrete variables.
+    struct ImplicitDerivative {
+        const Component* component;
+        std::string discreteVariableName;
+        int column;
+    };
+    std::vector<ImplicitDerivative> implicitDerivatives;
+    const auto& derivativeNames = trajectory.getDerivativeNames();
+    for (const auto& ref : rep.getImplicitComponentReferencePtrs()) {
+        const std::string path = ref.second->getAbsolutePathString();
+        const auto it = std::find(derivativeNames.begin(),
+                derivativeNames.end(), path + "/" + ref.first);
+        if (it == derivativeNames.end()) continue;
+        implicitDerivatives.push_back({&model.getComponent(path), ref.first,
+                (int)(it - derivativeNames.begin())});
+    }
+
+    const SimTK::Vector& time = trajectory.getTime();
+    const SimTK::Matrix& states = trajectory.getStatesTrajectory();
+    const SimTK::Matrix& controls = trajectory.getControlsTrajectory();
+    const SimTK::Matrix& derivatives = trajectory.getDerivativesTrajectory();
+
+    // Compute the derivatives of the trajectory's states at time t within
+    // the mesh interval starting at trajectory index itime. Controls and
+    // derivative variables are linearly interpolated from the trajectory.
+    auto calcStateDerivatives = [&](double t, int itime,
+                                        const SimTK::Vector& y,
+                                        SimTK::Vector& ydot) {
+        int j = itime;
+        while (j + 1 < itime + stride && time[j + 1] <= t) ++j;
+        const double dt = time[j + 1] - time[j];
+        const double w = dt > 0 ? (t - time[j]) / dt : 0;
+        auto interpolate = [&](const SimTK::Matrix& matrix, int column) {
+            return (1 - w) * matrix(j, column) + w * matrix(j + 1, column);
+        };
+
+        state.setTime(t);
+        for (int is = 0; is < numStates; ++is) {
+            state.updY()[yIndices[is]] = y[is];
+        }
+        model.getSystem().prescribe(state);
+        for (const auto& implicitDerivative : implicitDerivatives) {
+            implicitDerivative.component->setDiscreteVariableValue(state,
+                    implicitDerivative.discreteVariableName,
+                    interpolate(derivatives, implicitDerivative.column));
+        }
+        model.realizeVelocity(state);
+        auto& modelControls = model.updControls(state);
+        for (int ic = 0; ic < (int)controlColumns.size(); ++ic) {
+            modelControls[modelControlIndices[ic]] =
+                    controlColumns[ic] == -1
+                            ? 0
+                            : interpolate(controls, controlColumns[ic]);
+        }
+        model.setControls(state, modelControls);
+        model.realizeAcceleration(state);
+        for (int is = 0; is < numStates; ++is) {
+            ydot[is] = state.getYDot()[yIndices[is]];
+        }
+    };
+
+    // States and state derivatives at the mesh points.
+    std::vector<SimTK::Vector> meshStates(
+            numMeshIntervals + 1, SimTK::Vector(numStates));
+    std::vector<SimTK::Vector> meshStateDerivatives(
+            numMeshIntervals + 1, SimTK::Vector(numStates));
+    for (int m = 0; m < numMeshIntervals + 1; ++m) {
+        const int itime = m * stride;
+        for (int is = 0; is < numStates; ++is) {
+            meshStates[m][is] = states(itime, is);
+        }
+        calcStateDerivatives(time[itime],
+                std::min(m, numMeshIntervals - 1) * stride, meshStates[m],
+                meshStateDerivatives[m]);
+    }
+
+    // Evaluate the dynamics residual of the cubic Hermite interpolant of the
+    // states at two points in each mesh interval. The midpoint is not used
+    // because Hermite-Simpson collocation enforces the dynamics there.
+    std::vector<double> errors(numMeshIntervals, 0.0);
+    SimTK::Vector y(numStates);
+    SimTK::Vector ydotInterpolant(numStates);
+    SimTK::Vector ydotModel(numStates);
+    for (int k = 0; k < numMeshIntervals; ++k) {
+        const int itime = k * stride;
+        const double h = time[itime + stride] - time[itime];
+        if (h <= 0) continue;
+        const auto& y0 = meshStates[k];
+        const auto& y1 = meshStates[k + 1];
+        const auto& f0 = meshStateDerivatives[k];
+        const auto& f1 = meshStateDerivatives[k + 1];
+        for (const double s : {0.25, 0.75}) {
+            const double s2 = s * s;
+            const double s3 = s2 * s;
+            for (int is = 0; is < numStates; ++is) {
+                y[is] = (2 * s3 - 3 * s2 + 1) * y0[is] +
+                        (s3 - 2 * s2 + s) * h * f0[is] +
+                        (-2 * s3 + 3 * s2) * y1[is] +
+                        (s3 - s2) * h * f1[is];
+                ydotInterpolant[is] = (6 * s2 - 6 * s) * (y0[is] - y1[is]) / h +
+                                      (3 * s2 - 4 * s + 1) * f0[is] +
+                                      (3 * s2 - 2 * s) * f1[is];
+            }
+            calcStateDerivatives(time[itime] + s * h, itime, y, ydotModel);
+            for (int is = 0; is < numStates; ++is) {
+                const double scale =
+                        1.0 + std::max(std::abs(y0[is]), std::abs(y1[is]));
+                errors[k] = std::max(errors[k],
+                        h * std::abs(ydotInterpolant[is] - ydotModel[is]) /
+                                scale);
+            }
+        }
+    }
+    return errors;
+}
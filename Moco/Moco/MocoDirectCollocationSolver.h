@@ -22,8 +22,67 @@
 
 #include <OpenSim/Common/Object.h>
 
+#include <fstream>
+#include <functional>
+
 namespace OpenSim {
 
+#ifndef SWIG
+/// Information about one iteration of the optimization solver (see "Iteration
+/// telemetry" in MocoDirectCollocationSolver). Quantities that the solver does
+/// not report are NaN.
+struct MocoIterationInfo {
+    int iteration = -1;
+    double objective = SimTK::NaN;
+    /// Maximum violation of the constraints (and, for MocoCasADiSolver, the
+    /// variable bounds).
+    double primalInfeasibility = SimTK::NaN;
+    /// IPOPT's dual infeasibility (MocoTropterSolver only).
+    double dualInfeasibility = SimTK::NaN;
+    /// IPOPT's barrier parameter (MocoTropterSolver only).
+    double barrierParameter = SimTK::NaN;
+    /// Infinity norm of the step in the variables.
+    double stepNorm = SimTK::NaN;
+    /// The fraction of IPOPT's step taken for the primal and dual variables
+    /// (MocoTropterSolver only).
+    double primalStepSize = SimTK::NaN;
+    double dualStepSize = SimTK::NaN;
+    /// Number of evaluations of the multibody dynamics (across all threads)
+    /// since the solver started.
+    long long numDynamicsEvaluations = 0;
+    /// Wall time since the solver started, in seconds.
+    double wallTime = SimTK::NaN;
+    /// Evaluations of the multibody dynamics per second of wall time since
+    /// the previous iteration.
+    double dynamicsEvaluationsPerSecond = SimTK::NaN;
+};
+
+/// Return false to stop the solver.
+using MocoIterationCallback = std::function<bool(const MocoIterationInfo&)>;
+
+/// The direct collocation solvers use this class to fill in the timing and
+/// throughput of each MocoIterationInfo and pass it on to the iteration
+/// callback and the iteration telemetry file. The file is opened for appending
+/// and is written to at least once per second (and when this object is
+/// destroyed).
+class OSIMMOCO_API MocoIterationReporter {
+public:
+    /// Either argument may be empty.
+    MocoIterationReporter(
+            MocoIterationCallback callback, const std::string& filepath);
+    /// Returns false if the callback requested to stop the solver.
+    bool report(MocoIterationInfo info);
+
+private:
+    MocoIterationCallback m_callback;
+    std::ofstream m_file;
+    long long m_startTime;
+    long long m_lastFlushTime;
+    double m_previousWallTime = 0;
+    long long m_previousNumDynamicsEvaluations = 0;
+};
+#endif
+
 /// This is a base class for solvers that use direct collocation to convert
 /// an optimal control problem into a generic nonlinear programming problem.
 /// The best resource for learning about direct collocation is the Betts
@@ -48,6 +107,19 @@ namespace OpenSim {
 /// including model kinematic constraints, the 'hermite-simpson' option is
 /// required (see Kinematic constraints section below).
 ///
+/// MocoCasADiSolver also supports the Legendre-Gauss-Radau (LGR) orthogonal
+/// collocation schemes 'legendre-gauss-radau-N' and
+/// 'flipped-legendre-gauss-radau-N', where N (1 to 9) is the degree of the
+/// polynomial that approximates the states within each mesh interval. Each
+/// mesh interval contains N - 1 collocation points in addition to the mesh
+/// points. For smooth problems, these schemes achieve a given accuracy with
+/// far fewer mesh intervals than 'hermite-simpson'; for example,
+/// 'legendre-gauss-radau-3' with 10 mesh intervals is often as accurate as
+/// 'hermite-simpson' with 50 mesh intervals. The flipped variant collocates
+/// the dynamics at the end of each mesh interval rather than the start.
+/// Enforcing derivatives of kinematic constraints is not supported with these
+/// schemes.
+///
 /// Path constraints on controls with Hermite-Simpson transcription
 /// ---------------------------------------------------------------
 /// For Hermite-Simpson transcription, the direct collocation solvers enforce
@@ -82,6 +154,62 @@ namespace OpenSim {
 /// velocity correction variables that project state variables onto the
 /// constraint manifold when necessary to properly enforce defect constraints
 /// (see Posa et al. 2016 for details).
+///
+/// Mesh refinement
+/// ---------------
+/// If `mesh_refinement_max_iterations` is greater than 0, the solver
+/// repeatedly solves the problem, refining the mesh between solves. The first
+/// solve uses the mesh described by `mesh` or `num_mesh_intervals`. After each
+/// solve, the solver estimates the error in each mesh interval by evaluating
+/// the residual of the model's dynamics at two points within the interval,
+/// using a cubic Hermite interpolant of the states. The residual is scaled by
+/// the duration of the interval and normalized by the magnitude of the
+/// states, so the error estimate is roughly a relative error in the states.
+/// Each interval whose error exceeds `mesh_refinement_tolerance` is divided
+/// into 2 to 4 equal intervals (more for larger errors), and the problem is
+/// solved again on the new mesh, using the previous solution as the initial
+/// guess. Refinement stops once all errors are below the tolerance, after
+/// `mesh_refinement_max_iterations` refinements, if refining would exceed
+/// `mesh_refinement_max_intervals` mesh intervals, or if a solve fails. The
+/// solution from the last solve is returned; its number of iterations and
+/// solver duration are the totals over all solves.
+///
+/// This allows using a coarse initial mesh and concentrating mesh points
+/// where the solution changes rapidly (e.g., at foot contact), which is
+/// usually faster than solving on a fine uniform mesh.
+///
+/// Warm starts
+/// -----------
+/// Solutions from MocoCasADiSolver and MocoTropterSolver (with IPOPT) carry
+/// the multipliers of the nonlinear program's constraints and variable bounds
+/// (see MocoTrajectory::getOptimConstraintMultipliers()). When solving a
+/// sequence of similar problems (e.g., slowly varying goal weights or
+/// parameter sweeps), set the previous solution as the guess and enable
+/// `optim_warm_start_multipliers` to start IPOPT from both the previous primal
+/// and dual variables, which usually requires far fewer iterations than
+/// starting from the primal variables alone. The multipliers are used only if
+/// the nonlinear program has the same number of variables and constraints as
+/// the one that produced them (same mesh and transcription scheme); otherwise,
+/// only the primal variables are used. In mesh refinement, the mesh changes
+/// between solves, so only the primal variables are used.
+///
+/// Iteration telemetry
+/// -------------------
+/// To monitor long solves (e.g., to detect and stop a stalled solve on a
+/// cluster), provide a callback with setIterationCallback() (C++ only) or a
+/// file path with `iteration_telemetry_file`. After each iteration of IPOPT,
+/// the solver reports the objective, the primal infeasibility, the step, the
+/// number of evaluations of the multibody dynamics, the wall time, and the
+/// evaluation throughput (see MocoIterationInfo). The file receives one JSON
+/// object per line (JSON Lines), for example:
+/// @code{.json}
+/// {"iteration": 3, "objective": 1.5, "primal_infeasibility": 0.02, ...}
+/// @endcode
+/// If the callback returns false, the solver stops and the solution is
+/// sealed. MocoCasADiSolver computes the infeasibility and step from the
+/// iterates, since CasADi does not pass on IPOPT's other statistics during
+/// the solve. With mesh refinement, the iteration number restarts for each
+/// solve.
 
 class OSIMMOCO_API MocoDirectCollocationSolver : public MocoSolver {
     OpenSim_DECLARE_ABSTRACT_OBJECT(MocoDirectCollocationSolver, MocoSolver);
@@ -97,8 +225,12 @@ public:
             "0 for silent. 1 for only Moco's own output. "
             "2 for output from CasADi and the underlying solver (default: 2).");
     OpenSim_DECLARE_PROPERTY(transcription_scheme, std::string,
-            "'trapezoidal' for trapezoidal transcription, or 'hermite-simpson' "
-            "(default) for separated Hermite-Simpson transcription.");
+            "'trapezoidal' for trapezoidal transcription, 'hermite-simpson' "
+            "(default) for separated Hermite-Simpson transcription, or "
+            "'legendre-gauss-radau-N' or 'flipped-legendre-gauss-radau-N' "
+            "(N from 1 to 9; MocoCasADiSolver only) for Legendre-Gauss-Radau "
+            "collocation with polynomials of degree N. MocoCasADiSolver also "
+            "supports 'multiple-shooting'.");
     OpenSim_DECLARE_PROPERTY(interpolate_control_midpoints, bool,
             "If the transcription scheme is set to 'hermite-simpson', then "
             "enable this property to constrain the control values at mesh "
@@ -124,6 +256,12 @@ public:
             "Newton.");
     OpenSim_DECLARE_PROPERTY(optim_ipopt_print_level, int,
             "IPOPT's verbosity (see IPOPT documentation).");
+    OpenSim_DECLARE_PROPERTY(optim_warm_start_multipliers, bool,
+            "If the initial guess contains optimizer multipliers for a "
+            "nonlinear program of the same size (e.g., the guess is a solution "
+            "to a similar problem on the same mesh), initialize IPOPT's "
+            "constraint and bound multipliers from the guess and use IPOPT's "
+            "warm start options. Default: false.");
     OpenSim_DECLARE_OPTIONAL_PROPERTY(enforce_constraint_derivatives, bool,
             "'true' (default) or 'false', whether or not derivatives of "
             "kinematic constraints are enforced as path constraints in the "
@@ -151,6 +289,20 @@ public:
     OpenSim_DECLARE_PROPERTY(implicit_auxiliary_derivative_bounds, MocoBounds,
             "Bounds on derivative variables for components with auxiliary "
             "dynamics in implicit form. Default: [-1000, 1000]");
+    OpenSim_DECLARE_PROPERTY(mesh_refinement_max_iterations, int,
+            "Maximum number of times the mesh is refined and the problem is "
+            "solved again (default: 0, which disables mesh refinement). See "
+            "'Mesh refinement' in the documentation.");
+    OpenSim_DECLARE_PROPERTY(mesh_refinement_tolerance, double,
+            "Mesh intervals whose estimated error exceeds this tolerance are "
+            "subdivided during mesh refinement (default: 1e-3).");
+    OpenSim_DECLARE_PROPERTY(mesh_refinement_max_intervals, int,
+            "Mesh refinement stops if the refined mesh would have more than "
+            "this number of mesh intervals (default: 1000).");
+    OpenSim_DECLARE_PROPERTY(iteration_telemetry_file, std::string,
+            "If provided, a record of each iteration of the optimization "
+            "solver is appended to this file as a line of JSON. See 'Iteration "
+            "telemetry' in the documentation. Default: empty.");
 
     MocoDirectCollocationSolver() { constructProperties(); }
 
@@ -160,6 +312,18 @@ public:
     /// increasing (no duplicate times), and end with 1.
     void setMesh(const std::vector<double>& mesh);
 
+#ifndef SWIG
+    /// Call this function after each iteration of the optimization solver
+    /// (IPOPT only). See "Iteration telemetry" above.
+    void setIterationCallback(MocoIterationCallback callback) {
+        m_iterationCallback = std::move(callback);
+    }
+    /// Create a reporter for the iteration callback and
+    /// `iteration_telemetry_file`, or nullptr if neither is set. The solvers
+    /// call this at the start of each solve.
+    std::unique_ptr<MocoIterationReporter> createIterationReporter() const;
+#endif
+
 protected:
     OpenSim_DECLARE_PROPERTY(guess_file, std::string,
             "A MocoTrajectory file storing an initial guess.");
@@ -167,6 +331,38 @@ protected:
             "Usually non-uniform, user-defined list of mesh points to sample. "
             "Takes precedence over uniform mesh with num_mesh_intervals.");
     void constructProperties();
+
+    /// The mesh given by the mesh property, or a uniform mesh with
+    /// num_mesh_intervals intervals if the mesh property is empty.
+    std::vector<double> createMesh() const;
+
+    /// If transcription_scheme is a Legendre-Gauss-Radau scheme (e.g.,
+    /// 'legendre-gauss-radau-3'), return its polynomial degree; otherwise,
+    /// return 0.
+    int getLegendreGaussRadauDegree() const;
+
+    /// Solve the problem with `solveOnMesh`, refining the mesh between solves
+    /// as described in "Mesh refinement" above. `solveOnMesh` must solve the
+    /// problem on the given mesh using the given guess (which may have a
+    /// different number of times) and set the stats of the returned solution.
+    /// The returned solution's number of iterations is the total over all
+    /// solves, and its solver duration is that of the last solve; the caller
+    /// should set the duration of the entire solve.
+    MocoSolution solveWithMeshRefinement(const MocoTrajectory& guess,
+            const std::function<MocoSolution(const std::vector<double>& mesh,
+                    const MocoTrajectory& guess)>& solveOnMesh) const;
+
+    /// Estimate the error in each interval of `mesh` for a trajectory
+    /// obtained on that mesh. The trajectory contains the mesh points and the
+    /// same number of points within each mesh interval (e.g., none for
+    /// trapezoidal, or the midpoints for Hermite-Simpson).
+    std::vector<double> estimateMeshIntervalErrors(
+            const MocoTrajectory& trajectory,
+            const std::vector<double>& mesh) const;
+
+#ifndef SWIG
+    MocoIterationCallback m_iterationCallback;
+#endif
 };
 
 } // namespace OpenSim
@@ -112,32 +112,58 @@ void MocoContactTrackingGoal::initializeOnModelImpl(const Model& model) const {
         for (int ic = 0; ic < group.getProperty_contact_force_paths().size();
                 ++ic) {
             const auto& path = group.get_contact_force_paths(ic);
-            const auto& contactForce =
-                    model.getComponent<SmoothSphereHalfSpaceForce>(path);
+            const auto& contactForce = model.getComponent<Force>(path);
+            // The names of the two bodies to which the contact force applies
+            // forces.
+            std::string contactBaseName;
+            std::string planeBaseName;
+            if (dynamic_cast<const SmoothSphereHalfSpaceForce*>(
+                        &contactForce) ||
+                    dynamic_cast<const SmoothMultiSphereHalfSpaceForce*>(
+                            &contactForce)) {
+                contactBaseName =
+                        contactForce.getConnectee<PhysicalFrame>("sphere_frame")
+                                .findBaseFrame()
+                                .getName();
+                planeBaseName = contactForce
+                                        .getConnectee<PhysicalFrame>(
+                                                "half_space_frame")
+                                        .findBaseFrame()
+                                        .getName();
+            } else if (dynamic_cast<const MultiStationPlaneContactForce*>(
+                               &contactForce)) {
+                contactBaseName =
+                        contactForce.getConnectee<PhysicalFrame>("frame")
+                                .findBaseFrame()
+                                .getName();
+                planeBaseName = model.getGround().getName();
+            } else {
+                OPENSIM_THROW_FRMOBJ(Exception,
+                        format("Expected contact force '%s' to be a "
+                               "SmoothSphereHalfSpaceForce, a "
+                               "SmoothMultiSphereHalfSpaceForce, or a "
+                               "MultiStationPlaneContactForce, but it is a "
+                               "%s.",
+                                path, contactForce.getConcreteClassName()));
+            }
 
             // First, assume we want the first 3 entries in
             // SmoothSphereHalfSpaceForce::getRecordValues(), which contain
-            // forces on the sphere.
+            // forces on the sphere (SmoothMultiSphereHalfSpaceForce and
+            // MultiStationPlaneContactForce use the same layout for their
+            // first 12 entries).
             int recordOffset = 0;
-            const std::string& sphereBaseName =
-                    contactForce.getConnectee<PhysicalFrame>("sphere_frame")
-                            .findBaseFrame()
-                            .getName();
-            if (sphereBaseName != appliedToBody) {
-                // The ExternalForce is not applied to the sphere's body.
-                const std::string& halfSpaceBaseName =
-                        contactForce
-                                .getConnectee<PhysicalFrame>("half_space_frame")
-                                .findBaseFrame()
-                                .getName();
-                OPENSIM_THROW_IF_FRMOBJ(halfSpaceBaseName != appliedToBody,
+            if (contactBaseName != appliedToBody) {
+                // The ExternalForce is not applied to the sphere's (or
+                // stations') body.
+                OPENSIM_THROW_IF_FRMOBJ(planeBaseName != appliedToBody,
                         Exception,
-                        format("Contact force '%s' has sphere base frame '%s' "
-                               "and half space base frame '%s'; one of these "
+                        format("Contact force '%s' has contact base frame '%s' "
+                               "and plane base frame '%s'; one of these "
                                "frames should match the applied_to_body "
                                "setting ('%s') of ExternalForce '%s'.",
                                 contactForce.getAbsolutePathString(),
-                                sphereBaseName, halfSpaceBaseName,
+                                contactBaseName, planeBaseName,
                                 appliedToBody,
                                 group.get_external_force_name()));
                 // We want the forces applied to the half space, which are
@@ -20,6 +20,8 @@
 
 #include "MocoGoal.h"
 #include <OpenSim/Simulation/Model/ExternalLoads.h>
+#include "../Components/MultiStationPlaneContactForce.h"
+#include "../Components/SmoothMultiSphereHalfSpaceForce.h"
 #include "../Components/SmoothSphereHalfSpaceForce.h"
 
 namespace OpenSim {
@@ -32,7 +34,9 @@ class OSIMMOCO_API MocoContactTrackingGoalGroup : public Object {
     OpenSim_DECLARE_CONCRETE_OBJECT(MocoContactTrackingGoalGroup, Object);
 public:
     OpenSim_DECLARE_LIST_PROPERTY(contact_force_paths, std::string,
-            "Paths to SmoothSphereHalfSpaceForce objects in the model whose "
+            "Paths to SmoothSphereHalfSpaceForce, "
+            "SmoothMultiSphereHalfSpaceForce, or "
+            "MultiStationPlaneContactForce objects in the model whose "
             "forces are summed and compared to an single ExternalForce.");
     OpenSim_DECLARE_PROPERTY(external_force_name, std::string,
             "The name of an ExternalForce object in the ExternalLoads set.");
@@ -52,7 +56,8 @@ private:
 /// experimental external loads file. Tracking ground reaction forces for the
 /// left and right feet in gait requires only one instance of this goal.
 ///
-/// @note The only contact element supported is SmoothSphereHalfSpaceForce.
+/// @note The only contact elements supported are SmoothSphereHalfSpaceForce,
+/// SmoothMultiSphereHalfSpaceForce, and MultiStationPlaneContactForce.
 ///
 /// @note This goal does not include torques or centers of pressure.
 ///
@@ -224,7 +229,7 @@ private:
     /// sphere or to the half space) and a spline representation of associated
     /// experimental data.
     struct GroupInfo {
-        std::vector<std::pair<const SmoothSphereHalfSpaceForce*, int>> contacts;
+        std::vector<std::pair<const Force*, int>> contacts;
         GCVSplineSet refSplines;
         const PhysicalFrame* refExpressedInFrame = nullptr;
     };
@@ -111,6 +111,9 @@ std::pair<MocoStudy, TimeSeriesTable> MocoInverse::initializeInternal() const {
     solver.set_optim_sparsity_detection("random");
     // Forward is 3x faster than central.
     solver.set_optim_finite_difference_scheme("forward");
+    // The kinematics are prescribed, so the muscle-tendon lengths, moment
+    // arms, and inverse dynamics need only be computed once per time point.
+    solver.set_precompute_prescribed_kinematics(true);
     solver.set_num_mesh_intervals(timeInfo.numMeshIntervals);
     if (!getProperty_max_iterations().empty()) {
         solver.set_optim_max_iterations(get_max_iterations());
@@ -82,6 +82,16 @@ private:
 /// - optim_constraint_tolerance: 1e-3
 /// - optim_sparsity_detection: random
 /// - optim_finite_difference_scheme: forward
+/// - precompute_prescribed_kinematics: true
+///
+/// With precompute_prescribed_kinematics, the muscle-tendon lengths and
+/// velocities, moment arms, and net generalized forces from inverse dynamics
+/// are computed once for each time point, and the optimization only evaluates
+/// the muscle dynamics and the balance of generalized forces. This is much
+/// faster, but supports only the following actuators:
+/// DeGrooteFregly2016Muscle, PathActuator, and CoordinateActuator (see
+/// MocoCasADiSolver for the full requirements). For other models, MocoInverse
+/// realizes the multibody system in every evaluation, as usual.
 ///
 /// MocoInverse minimizes the sum of squared controls and, optionally, the sum
 /// of squared activations. Currently, the costs used by MocoInverse cannot be
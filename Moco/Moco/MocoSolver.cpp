@@ -97,6 +97,15 @@ void MocoSolver::setSolutionStats(MocoSolution& sol, bool success,
     sol.setObjectiveBreakdown(std::move(objectiveBreakdown));
 }
 
+void MocoSolver::setSolutionDuration(MocoSolution& sol, double duration) {
+    sol.setSolverDuration(duration);
+}
+
+void MocoSolver::setSolutionTimingProfile(MocoSolution& sol,
+        std::vector<std::tuple<std::string, double, int>> profile) {
+    sol.setTimingProfile(std::move(profile));
+}
+
 std::unique_ptr<ThreadsafeJar<const MocoProblemRep>>
         MocoSolver::createProblemRepJar(int size) const {
     auto jar = OpenSim::make_unique<ThreadsafeJar<const MocoProblemRep>>();
@@ -100,6 +100,14 @@ protected:
             double duration,
             std::vector<std::pair<std::string, double>> objectiveBreakdown =
                     {});
+    /// Set the solver duration of the solution (e.g., to the duration of the
+    /// entire solve, including problem setup and mesh refinement).
+    static void setSolutionDuration(MocoSolution&, double duration);
+    /// Store a timing profile in the solution; each entry is a name, a
+    /// duration in seconds, and a number of calls (-1 if not applicable). See
+    /// MocoSolution::getTimingEntryNames().
+    static void setSolutionTimingProfile(MocoSolution&,
+            std::vector<std::tuple<std::string, double, int>> profile);
 
     const MocoProblemRep& getProblemRep() const {
         return m_problemRep;
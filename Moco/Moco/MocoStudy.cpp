@@ -22,6 +22,7 @@
 #include "MocoProblem.h"
 #include "MocoTropterSolver.h"
 #include "MocoUtilities.h"
+#include <iomanip>
 #include <regex>
 
 #include <OpenSim/Common/IO.h>
@@ -112,6 +113,121 @@ MocoSolution MocoStudy::solve() const {
     return solution;
 }
 
+std::vector<MocoSolution> MocoStudy::solveContinuation(
+        const std::vector<std::vector<MocoContinuationChange>>& schedule)
+        const {
+    MocoStudy study(*this);
+    study.set_write_solution("false");
+    MocoPhase& phase = study.updProblem().updPhase(0);
+
+    // Only process the model if the schedule changes model properties.
+    std::unique_ptr<Model> model;
+    for (const auto& step : schedule) {
+        for (const auto& change : step) {
+            if (!model && !change.path.empty() && change.path[0] == '/') {
+                model.reset(new Model(phase.getModelProcessor().process()));
+            }
+        }
+    }
+
+    // Changing goal properties does not change the sparsity of the problem
+    // unless a property changes from zero (e.g., a goal's weight), so
+    // MocoCasADiSolver can reuse the sparsity patterns from previous steps.
+    auto* casadi = dynamic_cast<MocoCasADiSolver*>(&study.updSolver());
+    if (casadi) casadi->setReuseSparsityPatterns(true);
+
+    std::vector<MocoSolution> solutions;
+    for (int istep = 0; istep < (int)schedule.size(); ++istep) {
+        bool sparsityMayChange = false;
+        for (const auto& change : schedule[istep]) {
+            Object* object = nullptr;
+            if (!change.path.empty() && change.path[0] == '/') {
+                object = &model->updComponent(change.path);
+                sparsityMayChange = true;
+            } else {
+                object = &phase.updGoal(change.path);
+            }
+            OPENSIM_THROW_IF_FRMOBJ(!object->hasProperty(change.property),
+                    Exception,
+                    format("Continuation step %i: '%s' has no property "
+                           "'%s'.",
+                            istep, change.path, change.property));
+            auto& property = object->updPropertyByName(change.property);
+            OPENSIM_THROW_IF_FRMOBJ(
+                    !dynamic_cast<Property<double>*>(&property) ||
+                            property.isListProperty(),
+                    Exception,
+                    format("Continuation step %i: expected property '%s' of "
+                           "'%s' to be a single double.",
+                            istep, change.property, change.path));
+            auto& value = Property<double>::updAs(property);
+            if (value.getValue() == 0 && change.value != 0) {
+                sparsityMayChange = true;
+            }
+            value.setValue(change.value);
+        }
+        if (model) phase.setModelCopy(*model);
+        if (casadi && sparsityMayChange) casadi->clearSparsityPatterns();
+
+        if (istep > 0) {
+            const MocoTrajectory& guess = solutions.back();
+            auto& solver = study.updSolver();
+            if (casadi) {
+                casadi->setGuess(guess);
+            } else if (auto* tropter =
+                               dynamic_cast<MocoTropterSolver*>(&solver)) {
+                tropter->setGuess(guess);
+            }
+            if (auto* dircol =
+                            dynamic_cast<MocoDirectCollocationSolver*>(&solver)) {
+                dircol->set_optim_warm_start_multipliers(true);
+            }
+        }
+
+        std::cout << std::string(79, '=') << "\n";
+        std::cout << "Continuation step " << istep << " ("
+                  << schedule.size() << " steps in total).\n";
+        std::cout << std::string(79, '=') << std::endl;
+        MocoSolution solution = study.solve();
+        if (get_write_solution() != "false") {
+            OpenSim::IO::makeDir(get_write_solution());
+            std::string prefix = getName().empty() ? "MocoStudy" : getName();
+            const std::string filename =
+                    get_write_solution() +
+                    SimTK::Pathname::getPathSeparator() + prefix +
+                    "_continuation" + std::to_string(istep) + "_solution.sto";
+            MocoSolution unsealed = solution;
+            unsealed.unseal();
+            try {
+                unsealed.write(filename);
+            } catch (const TimestampGreaterThanEqualToNext&) {
+                std::cout << "Could not write solution to file...skipping."
+                          << std::endl;
+            }
+        }
+        solutions.push_back(solution);
+        if (!solution.success()) break;
+    }
+
+    // Summarize the effort for each step.
+    std::cout << std::string(79, '-') << "\n";
+    std::cout << "Continuation summary\n";
+    std::cout << std::setw(6) << "step" << std::setw(10) << "success"
+              << std::setw(12) << "iterations" << std::setw(14)
+              << "duration (s)" << std::setw(16) << "objective" << "\n";
+    for (int istep = 0; istep < (int)solutions.size(); ++istep) {
+        MocoSolution solution = solutions[istep];
+        solution.unseal();
+        std::cout << std::setw(6) << istep << std::setw(10)
+                  << (solution.success() ? "yes" : "no") << std::setw(12)
+                  << solution.getNumIterations() << std::setw(14)
+                  << solution.getSolverDuration() << std::setw(16)
+                  << solution.getObjective() << "\n";
+    }
+    std::cout << std::string(79, '-') << std::endl;
+    return solutions;
+}
+
 void MocoStudy::visualize(const MocoTrajectory& it) const {
     // TODO this does not need the Solver at all, so this could be moved to
     // MocoProblem.
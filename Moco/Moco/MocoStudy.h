@@ -18,6 +18,7 @@
  * limitations under the License.                                             *
  * -------------------------------------------------------------------------- */
 
+#include "MocoContinuationChange.h"
 #include "MocoSolver.h"
 
 #include <OpenSim/Common/Object.h>
@@ -52,6 +53,15 @@ class MocoCasADiSolver;
 /// After calling solve(), you can edit the MocoProblem and/or the MocoSolver.
 /// You can then call solve() again, if you wish.
 ///
+/// Continuation
+/// ------------
+/// Some problems (e.g., with contact or implicit tendon dynamics) converge
+/// only if solved as a sequence of increasingly difficult problems, each
+/// starting from the solution to the previous one. solveContinuation() solves
+/// such a sequence, changing model or goal properties between solves (e.g.,
+/// the smoothing of a contact force or the weight of a goal). See
+/// solveContinuation().
+///
 /// Saving the study setup to a file
 /// --------------------------------
 /// You can save the MocoStudy to a file by calling MocoStudy::print(), and you
@@ -122,6 +132,29 @@ public:
     /// hold.
     MocoSolution solve() const;
 
+    /// Solve a sequence of problems (continuation, or homotopy). Each element
+    /// of `schedule` is a step: the property changes to apply before solving
+    /// the step's problem. Changes accumulate across steps. The first step
+    /// uses the solver's guess, and each subsequent step uses the previous
+    /// step's solution as the guess; with MocoCasADiSolver or
+    /// MocoTropterSolver, the optimizer is also warm-started with the previous
+    /// step's multipliers (see `optim_warm_start_multipliers`), which is
+    /// effective because the changes do not alter the size of the problem.
+    /// With MocoCasADiSolver, a step whose changes are to goal properties
+    /// only (none of which changes from zero) reuses the sparsity patterns
+    /// detected in previous steps (see
+    /// MocoCasADiSolver::setReuseSparsityPatterns()).
+    /// The changes are applied to a copy of this study, so this study is
+    /// unaffected. Continuation stops early if a step fails; the failed
+    /// (sealed) solution is the last element of the returned vector. Each
+    /// solution's getNumIterations() and getSolverDuration() report the
+    /// effort for that step, and a summary of all steps is printed at the end.
+    /// If write_solution is not "false", each step's solution is written to
+    /// `<name>_continuation<step>_solution.sto`.
+    std::vector<MocoSolution> solveContinuation(
+            const std::vector<std::vector<MocoContinuationChange>>& schedule)
+            const;
+
     /// Interactively visualize a trajectory using the simbody-visualizer. The
     /// trajectory could be an initial guess, a solution, etc.
     /// @precondition
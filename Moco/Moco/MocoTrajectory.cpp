@@ -23,6 +23,8 @@
 #include <OpenSim/Common/FileAdapter.h>
 #include <OpenSim/Common/GCVSplineSet.h>
 #include <OpenSim/Simulation/Model/Model.h>
+#include <fstream>
+#include <iomanip>
 
 using namespace OpenSim;
 
@@ -1390,6 +1392,69 @@ void MocoSolution::printObjectiveBreakdown() const {
     std::cout << std::flush;
 }
 
+std::vector<std::string> MocoSolution::getTimingEntryNames() const {
+    std::vector<std::string> names;
+    for (const auto& entry : m_timingProfile) {
+        names.push_back(std::get<0>(entry));
+    }
+    return names;
+}
+
+const std::tuple<std::string, double, int>& MocoSolution::getTimingEntry(
+        const std::string& name) const {
+    for (const auto& entry : m_timingProfile) {
+        if (std::get<0>(entry) == name) { return entry; }
+    }
+    OPENSIM_THROW(Exception, format("Timing entry '%s' not found.", name));
+}
+
+double MocoSolution::getTimingEntryDuration(const std::string& name) const {
+    return std::get<1>(getTimingEntry(name));
+}
+
+int MocoSolution::getTimingEntryNumCalls(const std::string& name) const {
+    return std::get<2>(getTimingEntry(name));
+}
+
+void MocoSolution::printTimingProfile() const {
+    if (m_timingProfile.empty()) {
+        std::cout << "no timing profile available" << std::endl;
+        return;
+    }
+    StreamFormat streamFormat(std::cout);
+    int nameWidth = 4;
+    for (const auto& entry : m_timingProfile) {
+        nameWidth = std::max(nameWidth, (int)std::get<0>(entry).size());
+    }
+    std::cout << std::left << std::setw(nameWidth) << "name" << std::right
+              << std::setw(14) << "duration (s)" << std::setw(12) << "calls"
+              << "\n";
+    for (const auto& entry : m_timingProfile) {
+        std::cout << std::left << std::setw(nameWidth) << std::get<0>(entry)
+                  << std::right << std::fixed << std::setprecision(6)
+                  << std::setw(14) << std::get<1>(entry) << std::setw(12);
+        if (std::get<2>(entry) == -1) {
+            std::cout << "-";
+        } else {
+            std::cout << std::get<2>(entry);
+        }
+        std::cout << "\n";
+    }
+    std::cout << std::flush;
+}
+
+void MocoSolution::writeTimingProfile(const std::string& filepath) const {
+    std::ofstream file(filepath);
+    OPENSIM_THROW_IF(!file.good(), Exception,
+            format("Could not open file '%s' for writing.", filepath));
+    file << "name,duration,num_calls\n";
+    file.precision(9);
+    for (const auto& entry : m_timingProfile) {
+        file << std::get<0>(entry) << "," << std::get<1>(entry) << ","
+             << std::get<2>(entry) << "\n";
+    }
+}
+
 void MocoSolution::convertToTableImpl(TimeSeriesTable& table) const {
     std::string success = m_success ? "true" : "false";
     table.updTableMetaData().setValueForKey("success", success);
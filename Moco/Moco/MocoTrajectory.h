@@ -22,6 +22,7 @@
 
 #include <OpenSim/Common/Storage.h>
 #include <OpenSim/Simulation/StatesTrajectory.h>
+#include <tuple>
 
 namespace OpenSim {
 
@@ -673,6 +674,42 @@ public:
     void appendSlack(const std::string& name, const SimTK::Vector& trajectory);
 
     /// @endcond
+
+    /// @name Optimizer multipliers
+    /// Solvers can store the Lagrange multipliers of the nonlinear program's
+    /// constraints and variable bounds in the trajectory they return, so that
+    /// the trajectory can warm-start the optimizer (both primal and dual
+    /// variables) when used as the initial guess for a similar problem. See
+    /// the solver property `optim_warm_start_multipliers`. The multipliers
+    /// are specific to the solver, transcription scheme, and mesh that
+    /// produced them; solvers ignore multipliers whose sizes do not match
+    /// their nonlinear program. Bound multipliers are positive for active
+    /// upper bounds and negative for active lower bounds (CasADi's
+    /// convention). The multipliers are not written to or read from files.
+    /// @{
+    bool hasOptimMultipliers() const {
+        return m_optim_constraint_multipliers.size() ||
+               m_optim_bound_multipliers.size();
+    }
+    void setOptimMultipliers(const SimTK::Vector& constraintMultipliers,
+            const SimTK::Vector& boundMultipliers) {
+        ensureUnsealed();
+        m_optim_constraint_multipliers = constraintMultipliers;
+        m_optim_bound_multipliers = boundMultipliers;
+    }
+    void clearOptimMultipliers() {
+        m_optim_constraint_multipliers.clear();
+        m_optim_bound_multipliers.clear();
+    }
+    const SimTK::Vector& getOptimConstraintMultipliers() const {
+        ensureUnsealed();
+        return m_optim_constraint_multipliers;
+    }
+    const SimTK::Vector& getOptimBoundMultipliers() const {
+        ensureUnsealed();
+        return m_optim_bound_multipliers;
+    }
+    /// @}
 #endif
 
 protected:
@@ -713,6 +750,9 @@ private:
     SimTK::Matrix m_slacks;
     // Dimensions: 1 x parameters
     SimTK::RowVector m_parameters;
+    // Multipliers of the optimizer's constraints and variable bounds.
+    SimTK::Vector m_optim_constraint_multipliers;
+    SimTK::Vector m_optim_bound_multipliers;
 
     // We use "seal" instead of "lock" because locks have a specific meaning
     // with threading (e.g., std::unique_lock()).
@@ -801,6 +841,35 @@ public:
     void printObjectiveBreakdown() const;
     /// @}
 
+    /// @name Timing profile
+    /// Some solvers record the wall time spent in the parts of solving the
+    /// problem (e.g., constructing the problem, evaluating each of the
+    /// problem's functions, and the optimizer's own computations) and the
+    /// number of times each part was invoked. Use these functions to access
+    /// this profile. The entries overlap; for example, time evaluating the
+    /// problem's functions is part of the time evaluating the optimizer's
+    /// functions. If mesh refinement is used, the profile is for the final
+    /// mesh. The profile is available even if the solver did not succeed.
+    /// @{
+
+    /// Returns the number of entries in the profile. If the solver did not
+    /// provide a profile, then this returns 0.
+    int getNumTimingEntries() const { return (int)m_timingProfile.size(); }
+    /// Get the names of all entries in the profile, in the order the solver
+    /// provided them.
+    std::vector<std::string> getTimingEntryNames() const;
+    /// Get the wall time spent in an entry of the profile. Units: seconds.
+    double getTimingEntryDuration(const std::string& name) const;
+    /// Get the number of times the part of the solve for this entry was
+    /// invoked (-1 if not applicable).
+    int getTimingEntryNumCalls(const std::string& name) const;
+    /// Print to the console a table of the entries in the profile.
+    void printTimingProfile() const;
+    /// Write the profile to a comma-separated values file with columns
+    /// name, duration (seconds), and num_calls.
+    void writeTimingProfile(const std::string& filepath) const;
+    /// @}
+
     /// @name Access control
     /// @{
 
@@ -842,6 +911,12 @@ private:
         m_numIterations = numIterations;
     };
     void setSolverDuration(double duration) { m_solverDuration = duration; }
+    void setTimingProfile(
+            std::vector<std::tuple<std::string, double, int>> profile) {
+        m_timingProfile = std::move(profile);
+    }
+    const std::tuple<std::string, double, int>& getTimingEntry(
+            const std::string& name) const;
     void convertToTableImpl(TimeSeriesTable&) const override;
     bool m_success = true;
     double m_objective = -1;
@@ -849,6 +924,7 @@ private:
     std::string m_status;
     int m_numIterations = -1;
     double m_solverDuration = -1;
+    std::vector<std::tuple<std::string, double, int>> m_timingProfile;
     // Allow solvers to set success, status, and construct a solution.
     friend class MocoSolver;
 };
@@ -31,6 +31,7 @@ MocoTropterSolver::MocoTropterSolver() { constructProperties(); }
 void MocoTropterSolver::constructProperties() {
     constructProperty_optim_jacobian_approximation("exact");
     constructProperty_optim_sparsity_detection("random");
+    constructProperty_optim_finite_difference_step_size_mode("fixed");
     constructProperty_exact_hessian_block_sparsity_mode();
 }
 
@@ -54,7 +55,8 @@ MocoTropterSolver::createTropterProblem() const {
 std::unique_ptr<tropter::DirectCollocationSolver<double>>
 MocoTropterSolver::createTropterSolver(
         std::shared_ptr<const MocoTropterSolver::TropterProblemBase<double>>
-                ocp) const {
+                ocp,
+        const std::vector<double>& mesh) const {
 #ifdef MOCO_WITH_TROPTER
     // Check that a non-negative number of mesh points was provided.
     checkPropertyInRangeOrSet(*this, getProperty_num_mesh_intervals(), 0,
@@ -135,17 +137,17 @@ MocoTropterSolver::createTropterSolver(
 
     std::unique_ptr<tropter::DirectCollocationSolver<double>> dircol;
 
-    if (getProperty_mesh().empty()) {
+    if (!mesh.empty()) {
+        dircol = OpenSim::make_unique<tropter::DirectCollocationSolver<double>>(
+                ocp, get_transcription_scheme(), get_optim_solver(), mesh);
+    } else if (getProperty_mesh().empty()) {
         dircol = OpenSim::make_unique<tropter::DirectCollocationSolver<double>>(
                 ocp, get_transcription_scheme(), get_optim_solver(),
                 get_num_mesh_intervals());
     } else {
-        std::vector<double> mesh;
-        for (int i = 0; i < getProperty_mesh().size(); ++i) {
-            mesh.push_back(get_mesh(i));
-        }
         dircol = OpenSim::make_unique<tropter::DirectCollocationSolver<double>>(
-                ocp, get_transcription_scheme(), get_optim_solver(), mesh);
+                ocp, get_transcription_scheme(), get_optim_solver(),
+                createMesh());
     }
 
     dircol->set_verbosity(get_verbosity() >= 1);
@@ -196,6 +198,12 @@ MocoTropterSolver::createTropterSolver(
             {"random", "initial-guess"});
     optsolver.set_sparsity_detection(get_optim_sparsity_detection());
 
+    checkPropertyInSet(*this,
+            getProperty_optim_finite_difference_step_size_mode(),
+            {"fixed", "adaptive", "adaptive-curvature"});
+    optsolver.set_findiff_step_size_mode(
+            get_optim_finite_difference_step_size_mode());
+
     // Set advanced settings.
     // for (int i = 0; i < getProperty_optim_solver_options(); ++i) {
     //    optsolver.set_advanced_option(TODO);
@@ -331,14 +339,58 @@ MocoSolution MocoTropterSolver::solveImpl() const {
         std::cout << std::string(79, '-') << std::endl;
         getProblemRep().printDescription();
     }
-    auto dircol = createTropterSolver(ocp);
-    MocoTrajectory guess = getGuess();
-    tropter::Iterate tropIterate = ocp->convertToTropterIterate(guess);
-    tropter::Solution tropSolution = dircol->solve(tropIterate);
+    auto solveOnMesh = [&](const std::vector<double>& mesh,
+                               const MocoTrajectory& guess) -> MocoSolution {
+        const Stopwatch meshStopwatch;
+        auto dircol = createTropterSolver(ocp, mesh);
+        std::shared_ptr<MocoIterationReporter> reporter =
+                createIterationReporter();
+        if (reporter) {
+            const long long initialNumEvaluations =
+                    ocp->getNumDynamicsEvaluations();
+            dircol->get_opt_solver().set_iteration_callback(
+                    [reporter, ocp, initialNumEvaluations](
+                            const tropter::optimization::IterationInfo&
+                                    tropInfo) -> bool {
+                        MocoIterationInfo info;
+                        info.iteration = tropInfo.iteration;
+                        info.objective = tropInfo.objective;
+                        info.primalInfeasibility =
+                                tropInfo.primal_infeasibility;
+                        info.dualInfeasibility = tropInfo.dual_infeasibility;
+                        info.barrierParameter = tropInfo.barrier_parameter;
+                        info.stepNorm = tropInfo.step_norm;
+                        info.primalStepSize = tropInfo.primal_step_size;
+                        info.dualStepSize = tropInfo.dual_step_size;
+                        info.numDynamicsEvaluations =
+                                ocp->getNumDynamicsEvaluations() -
+                                initialNumEvaluations;
+                        return reporter->report(info);
+                    });
+        }
+        tropter::Iterate tropIterate = ocp->convertToTropterIterate(guess);
+        if (!get_optim_warm_start_multipliers()) {
+            tropIterate.constraint_multipliers.resize(0);
+            tropIterate.bound_multipliers.resize(0);
+        }
+        tropter::Solution tropSolution = dircol->solve(tropIterate);
 
-    if (get_verbosity()) { dircol->print_constraint_values(tropSolution); }
+        if (get_verbosity()) { dircol->print_constraint_values(tropSolution); }
 
-    MocoSolution mocoSolution = ocp->convertToMocoSolution(tropSolution);
+        MocoSolution solution = ocp->convertToMocoSolution(tropSolution);
+        MocoSolver::setSolutionStats(solution, tropSolution.success,
+                tropSolution.objective, tropSolution.status,
+                tropSolution.num_iterations,
+                SimTK::nsToSec(meshStopwatch.getElapsedTimeInNs()));
+        return solution;
+    };
+
+    MocoSolution mocoSolution;
+    if (get_mesh_refinement_max_iterations()) {
+        mocoSolution = solveWithMeshRefinement(getGuess(), solveOnMesh);
+    } else {
+        mocoSolution = solveOnMesh({}, getGuess());
+    }
 
     // If enforcing model constraints and not minimizing Lagrange
     // multipliers, check the rank of the constraint Jacobian and if
@@ -390,11 +442,10 @@ MocoSolution MocoTropterSolver::solveImpl() const {
         }
     }
 
-    // TODO move this to convert():
     const long long elapsed = stopwatch.getElapsedTimeInNs();
-    MocoSolver::setSolutionStats(mocoSolution, tropSolution.success,
-            tropSolution.objective, tropSolution.status,
-            tropSolution.num_iterations, SimTK::nsToSec(elapsed));
+    // The duration includes creating the problem and, with mesh refinement,
+    // all solves and error estimates.
+    setSolutionDuration(mocoSolution, SimTK::nsToSec(elapsed));
 
     if (get_verbosity()) {
         std::cout << std::string(79, '-') << "\n";
@@ -74,6 +74,12 @@ public:
     OpenSim_DECLARE_PROPERTY(optim_sparsity_detection, std::string,
             "Trajectory used to detect sparsity pattern of Jacobian/Hessian; "
             "'random' (default) or 'initial-guess'");
+    OpenSim_DECLARE_PROPERTY(optim_finite_difference_step_size_mode,
+            std::string,
+            "How the finite difference step size for the gradient and "
+            "Jacobian is chosen: 'fixed' (default), 'adaptive' (scaled by the "
+            "magnitude and bounds of each variable), or 'adaptive-curvature' "
+            "(also refined using the curvature at the initial guess).");
     OpenSim_DECLARE_OPTIONAL_PROPERTY(exact_hessian_block_sparsity_mode,
             std::string,
             "'dense' for dense blocks on the Hessian diagonal, or "
@@ -152,10 +158,12 @@ protected:
 
     std::shared_ptr<const TropterProblemBase<double>>
     createTropterProblem() const;
+    /// If `mesh` is empty, the mesh is determined by the mesh and
+    /// num_mesh_intervals properties.
     std::unique_ptr<tropter::DirectCollocationSolver<double>>
     createTropterSolver(
-            std::shared_ptr<const TropterProblemBase<double>>
-                    ocp) const;
+            std::shared_ptr<const TropterProblemBase<double>> ocp,
+            const std::vector<double>& mesh = {}) const;
 
     // TODO ensure that user-provided guess is within bounds.
     MocoSolution solveImpl() const override;
@@ -20,10 +20,13 @@
 
 #include "MocoProblem.h"
 #include "MocoTrajectory.h"
+#include <atomic>
 #include <cstdarg>
 #include <cstdio>
 #include <iomanip>
 #include <regex>
+#include <sstream>
+#include <thread>
 
 #include <simbody/internal/Visualizer_InputListener.h>
 
@@ -34,6 +37,7 @@
 #include <OpenSim/Simulation/Control/PrescribedController.h>
 #include <OpenSim/Simulation/Manager/Manager.h>
 #include <OpenSim/Simulation/Model/Model.h>
+#include <OpenSim/Simulation/Model/Muscle.h>
 #include <OpenSim/Simulation/StatesTrajectory.h>
 #include <OpenSim/Simulation/StatesTrajectoryReporter.h>
 
@@ -488,6 +492,193 @@ MocoTrajectory OpenSim::simulateTrajectoryWithTimeStepping(
     return forwardSolution;
 }
 
+MuscleGeometryTrajectory OpenSim::computeMuscleGeometry(const Model& model,
+        const TimeSeriesTable& coordinates, bool detectSparsity, int parallel,
+        bool allowExtraColumns) {
+    MuscleGeometryTrajectory geometry;
+    geometry.times = coordinates.getIndependentColumn();
+    const int numTimes = (int)geometry.times.size();
+
+    Model modelCopy(model);
+    modelCopy.finalizeFromProperties();
+    for (const auto& muscle : modelCopy.getComponentList<Muscle>()) {
+        geometry.musclePaths.push_back(muscle.getAbsolutePathString());
+    }
+    for (const auto& coord : modelCopy.getCoordinatesInMultibodyTreeOrder()) {
+        geometry.coordinatePaths.push_back(coord->getAbsolutePathString());
+    }
+    const int numMuscles = (int)geometry.musclePaths.size();
+    const int numCoords = (int)geometry.coordinatePaths.size();
+
+    // Determine which column of the table provides each coordinate.
+    std::vector<int> columnIndices(numCoords, -1);
+    const auto& labels = coordinates.getColumnLabels();
+    for (int icol = 0; icol < (int)labels.size(); ++icol) {
+        const auto& label = labels[icol];
+        if (endsWith(label, "/value")) {
+            // This assumes that the coordinate is not named "value".
+            const std::string coordPath =
+                    label.substr(0, label.find("/value"));
+            const auto& coord = modelCopy.getComponent<Coordinate>(coordPath);
+            const auto it = std::find(geometry.coordinatePaths.begin(),
+                    geometry.coordinatePaths.end(),
+                    coord.getAbsolutePathString());
+            columnIndices[it - geometry.coordinatePaths.begin()] = icol;
+        } else {
+            OPENSIM_THROW_IF(!allowExtraColumns, Exception,
+                    format("Column '%s' is not a coordinate value.", label));
+        }
+    }
+
+    // GCVSpline is not threadsafe, so compute the speeds before dividing the
+    // work among threads.
+    const auto& values = coordinates.getMatrix();
+    SimTK::Matrix speeds(numTimes, (int)labels.size(), 0.0);
+    if (numTimes > 1) {
+        const GCVSplineSet splines(coordinates);
+        SimTK::Vector time(1);
+        for (int icoord = 0; icoord < numCoords; ++icoord) {
+            const int icol = columnIndices[icoord];
+            if (icol == -1) continue;
+            const auto& spline = splines.get(labels[icol]);
+            for (int itime = 0; itime < numTimes; ++itime) {
+                time[0] = geometry.times[itime];
+                speeds(itime, icol) = spline.calcDerivative({0}, time);
+            }
+        }
+    }
+
+    geometry.lengths.resize(numTimes, numMuscles);
+    geometry.lengtheningSpeeds.resize(numTimes, numMuscles);
+    geometry.momentArms.assign(numTimes, SimTK::Matrix(numMuscles, numCoords));
+    for (auto& momentArms : geometry.momentArms) momentArms.setToZero();
+    geometry.spannedCoordinates.resize(numMuscles);
+    if (numTimes == 0 || numMuscles == 0) {
+        for (auto& spanned : geometry.spannedCoordinates) {
+            for (int icoord = 0; icoord < numCoords; ++icoord) {
+                spanned.push_back(icoord);
+            }
+        }
+        return geometry;
+    }
+
+    const int numThreads = getNumThreadsForParallel(parallel, numTimes);
+
+    // Each thread uses its own copy of the model.
+    struct Worker {
+        std::unique_ptr<Model> model;
+        SimTK::State state;
+        std::vector<const Muscle*> muscles;
+        std::vector<const Coordinate*> coordinates;
+    };
+    std::vector<Worker> workers(numThreads);
+    for (auto& worker : workers) {
+        worker.model.reset(new Model(modelCopy));
+        worker.state = worker.model->initSystem();
+        for (const auto& path : geometry.musclePaths) {
+            worker.muscles.push_back(
+                    &worker.model->getComponent<Muscle>(path));
+        }
+        for (const auto& path : geometry.coordinatePaths) {
+            worker.coordinates.push_back(
+                    &worker.model->getComponent<Coordinate>(path));
+        }
+    }
+
+    // If spans is empty, compute all moment arms.
+    auto evaluate = [&](Worker& worker, int itime,
+                            const std::vector<std::vector<int>>& spans) {
+        auto& state = worker.state;
+        state.setTime(geometry.times[itime]);
+        for (int icoord = 0; icoord < numCoords; ++icoord) {
+            const int icol = columnIndices[icoord];
+            if (icol == -1) continue;
+            const auto& coord = *worker.coordinates[icoord];
+            coord.setValue(state, values(itime, icol), false);
+            coord.setSpeedValue(state, speeds(itime, icol));
+        }
+        worker.model->realizeVelocity(state);
+        auto& momentArms = geometry.momentArms[itime];
+        for (int imusc = 0; imusc < numMuscles; ++imusc) {
+            const auto& muscle = *worker.muscles[imusc];
+            geometry.lengths(itime, imusc) = muscle.getLength(state);
+            geometry.lengtheningSpeeds(itime, imusc) =
+                    muscle.getLengtheningSpeed(state);
+            if (spans.empty()) {
+                for (int icoord = 0; icoord < numCoords; ++icoord) {
+                    momentArms(imusc, icoord) = muscle.computeMomentArm(
+                            state, *worker.coordinates[icoord]);
+                }
+            } else {
+                for (const int icoord : spans[imusc]) {
+                    momentArms(imusc, icoord) = muscle.computeMomentArm(
+                            state, *worker.coordinates[icoord]);
+                }
+            }
+        }
+    };
+    auto evaluateInParallel = [&](const std::vector<int>& timeIndices,
+                                      const std::vector<std::vector<int>>&
+                                              spans) {
+        performTasksInParallel(numThreads, (int)timeIndices.size(),
+                [&](int ithread, int i) {
+                    evaluate(workers[ithread], timeIndices[i], spans);
+                });
+    };
+
+    std::vector<int> remainingTimes;
+    if (detectSparsity) {
+        // Compute all moment arms at a few times spread through the table.
+        const int numDetectionTimes = std::min(10, numTimes);
+        std::vector<bool> isDetectionTime(numTimes, false);
+        std::vector<int> detectionTimes;
+        for (int i = 0; i < numDetectionTimes; ++i) {
+            const int itime = numDetectionTimes == 1
+                    ? 0 : i * (numTimes - 1) / (numDetectionTimes - 1);
+            isDetectionTime[itime] = true;
+            detectionTimes.push_back(itime);
+        }
+        evaluateInParallel(detectionTimes, {});
+
+        const double momentArmThreshold = 1e-5;
+        for (int imusc = 0; imusc < numMuscles; ++imusc) {
+            for (int icoord = 0; icoord < numCoords; ++icoord) {
+                bool spans = false;
+                for (const int itime : detectionTimes) {
+                    if (std::abs(geometry.momentArms[itime](imusc, icoord)) >
+                            momentArmThreshold) {
+                        spans = true;
+                        break;
+                    }
+                }
+                if (spans) {
+                    geometry.spannedCoordinates[imusc].push_back(icoord);
+                } else {
+                    // Keep the moment arms consistent with the sparsity.
+                    for (const int itime : detectionTimes) {
+                        geometry.momentArms[itime](imusc, icoord) = 0;
+                    }
+                }
+            }
+        }
+        for (int itime = 0; itime < numTimes; ++itime) {
+            if (!isDetectionTime[itime]) remainingTimes.push_back(itime);
+        }
+        evaluateInParallel(remainingTimes, geometry.spannedCoordinates);
+    } else {
+        for (auto& spanned : geometry.spannedCoordinates) {
+            for (int icoord = 0; icoord < numCoords; ++icoord) {
+                spanned.push_back(icoord);
+            }
+        }
+        for (int itime = 0; itime < numTimes; ++itime) {
+            remainingTimes.push_back(itime);
+        }
+        evaluateInParallel(remainingTimes, {});
+    }
+    return geometry;
+}
+
 std::vector<std::string> OpenSim::createStateVariableNamesInSystemOrder(
         const Model& model) {
     std::unordered_map<int, int> yIndexMap;
@@ -777,6 +968,13 @@ std::string OpenSim::format_c(const char* format, ...) {
     return std::string(buf.get());
 }
 
+std::string OpenSim::formatJSONNumber(double value) {
+    if (SimTK::isNaN(value) || SimTK::isInf(value)) return "null";
+    std::stringstream ss;
+    ss << std::setprecision(9) << value;
+    return ss.str();
+}
+
 int OpenSim::getMocoParallelEnvironmentVariable() {
     const std::string varName = "OPENSIM_MOCO_PARALLEL";
     if (SimTK::Pathname::environmentVariableExists(varName)) {
@@ -796,6 +994,46 @@ int OpenSim::getMocoParallelEnvironmentVariable() {
     return -1;
 }
 
+int OpenSim::getNumThreadsForParallel(int parallel, int maxNumThreads) {
+    int numThreads;
+    if (parallel == 0) {
+        numThreads = 1;
+    } else if (parallel == 1) {
+        numThreads = std::thread::hardware_concurrency();
+    } else {
+        numThreads = parallel;
+    }
+    if (maxNumThreads > 0) numThreads = std::min(numThreads, maxNumThreads);
+    return std::max(1, numThreads);
+}
+
+void OpenSim::performTasksInParallel(int numThreads, int numTasks,
+        const std::function<void(int, int)>& task) {
+    std::atomic<int> nextTask(0);
+    std::mutex exceptionMutex;
+    std::exception_ptr exception;
+    auto work = [&](int ithread) {
+        int itask;
+        while ((itask = nextTask++) < numTasks) {
+            try {
+                task(ithread, itask);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(exceptionMutex);
+                if (!exception) exception = std::current_exception();
+                // Skip the remaining tasks.
+                nextTask = numTasks;
+            }
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int ithread = 1; ithread < numThreads; ++ithread) {
+        threads.emplace_back(work, ithread);
+    }
+    work(0);
+    for (auto& thread : threads) thread.join();
+    if (exception) std::rethrow_exception(exception);
+}
+
 TimeSeriesTable OpenSim::createExternalLoadsTableForGait(Model model,
         const StatesTrajectory& trajectory,
         const std::vector<std::string>& forcePathsRightFoot,
@@ -905,3 +1143,161 @@ SimTK::Real OpenSim::solveBisection(
     }
     return midpoint;
 }
+
+RootSolverResult OpenSim::solveNewtonBisection(
+        std::function<SimTK::Real(const SimTK::Real&, SimTK::Real&)>
+                calcResidual,
+        SimTK::Real left, SimTK::Real right, const SimTK::Real& tolerance,
+        int maxIterations) {
+
+    OPENSIM_THROW_IF(maxIterations < 0, Exception,
+            format("Expected maxIterations to be positive, but got %i.",
+                    maxIterations));
+
+    RootSolverResult result;
+    SimTK::Real derivative;
+    const SimTK::Real residualLeft = calcResidual(left, derivative);
+    if (residualLeft == 0) {
+        result.root = left;
+        result.residual = 0;
+        result.converged = true;
+        return result;
+    }
+    const SimTK::Real residualRight = calcResidual(right, derivative);
+    if (residualRight == 0) {
+        result.root = right;
+        result.residual = 0;
+        result.converged = true;
+        return result;
+    }
+    OPENSIM_THROW_IF(residualLeft * residualRight > 0, Exception,
+            format("Function has same sign at bounds of %f and %f.", left,
+                    right));
+
+    // Orient the bracket so that the residual is negative at 'negative' and
+    // positive at 'positive'.
+    SimTK::Real negative = residualLeft < 0 ? left : right;
+    SimTK::Real positive = residualLeft < 0 ? right : left;
+
+    SimTK::Real x = 0.5 * (left + right);
+    SimTK::Real residual = calcResidual(x, derivative);
+    SimTK::Real step = std::abs(right - left);
+    SimTK::Real previousStep = step;
+    while (result.numIterations < maxIterations) {
+        ++result.numIterations;
+        // Bisect if the Newton step would leave the bracket, or if the
+        // residual is not decreasing fast enough (the Newton step is more
+        // than half of the step before last).
+        const bool newtonLeavesBracket =
+                ((x - positive) * derivative - residual) *
+                        ((x - negative) * derivative - residual) >=
+                0;
+        const bool newtonIsSlow =
+                std::abs(2.0 * residual) > std::abs(previousStep * derivative);
+        previousStep = step;
+        if (newtonLeavesBracket || newtonIsSlow) {
+            step = 0.5 * (positive - negative);
+            x = negative + step;
+        } else {
+            step = residual / derivative;
+            x -= step;
+            ++result.numNewtonSteps;
+        }
+        residual = calcResidual(x, derivative);
+        if (residual < 0) {
+            negative = x;
+        } else {
+            positive = x;
+        }
+        if (residual == 0 || std::abs(step) < tolerance ||
+                std::abs(positive - negative) < tolerance) {
+            result.converged = true;
+            break;
+        }
+    }
+    result.root = x;
+    result.residual = residual;
+    return result;
+}
+
+TabulatedCubicSpline::TabulatedCubicSpline(
+        const std::function<double(double)>& function,
+        const std::function<double(double)>& derivative, double lower,
+        double upper, double valueTolerance, double derivativeTolerance,
+        int maxNumIntervals)
+        : m_lower(lower), m_upper(upper) {
+    OPENSIM_THROW_IF(!(lower < upper), Exception,
+            format("Expected lower < upper, but got lower = %g and "
+                   "upper = %g.",
+                    lower, upper));
+    for (int numIntervals = 16;; numIntervals *= 2) {
+        fit(function, derivative, numIntervals);
+        // Measure the error on a dense uniform grid spanning the whole domain
+        // (including the endpoints), with at least 7 points per interval.
+        const int numCheckPoints = std::max(10001, 7 * numIntervals + 1);
+        m_maxValueError = 0;
+        m_maxDerivativeError = 0;
+        for (int i = 0; i < numCheckPoints; ++i) {
+            const double x = i == numCheckPoints - 1
+                    ? upper
+                    : lower + (upper - lower) * i / (numCheckPoints - 1);
+            const double value = function(x);
+            const double deriv = derivative(x);
+            m_maxValueError = std::max(m_maxValueError,
+                    std::abs(calcValue(x) - value) / (1.0 + std::abs(value)));
+            m_maxDerivativeError = std::max(m_maxDerivativeError,
+                    std::abs(calcDerivative(x) - deriv) /
+                            (1.0 + std::abs(deriv)));
+        }
+        if (m_maxValueError <= valueTolerance &&
+                m_maxDerivativeError <= derivativeTolerance) {
+            break;
+        }
+        OPENSIM_THROW_IF(2 * numIntervals > maxNumIntervals, Exception,
+                format("Could not achieve a value error of %g and a "
+                       "derivative error of %g with %i intervals (errors "
+                       "are %g and %g).",
+                        valueTolerance, derivativeTolerance, numIntervals,
+                        m_maxValueError, m_maxDerivativeError));
+    }
+}
+
+void TabulatedCubicSpline::fit(const std::function<double(double)>& function,
+        const std::function<double(double)>& derivative, int numIntervals) {
+    const int n = numIntervals;
+    const double h = (m_upper - m_lower) / n;
+    m_invIntervalWidth = 1.0 / h;
+    std::vector<double> y(n + 1);
+    for (int k = 0; k <= n; ++k) y[k] = function(m_lower + k * h);
+
+    // Solve the tridiagonal system for the slopes at the interior knots,
+    //   m[k-1] + 4 m[k] + m[k+1] = 3 (y[k+1] - y[k-1]) / h,
+    // with the Thomas algorithm.
+    std::vector<double> m(n + 1);
+    m[0] = derivative(m_lower);
+    m[n] = derivative(m_upper);
+    std::vector<double> c(n + 1, 0.0);
+    std::vector<double> d(n + 1, 0.0);
+    for (int k = 1; k < n; ++k) {
+        double rhs = 3.0 * (y[k + 1] - y[k - 1]) / h;
+        if (k == 1) rhs -= m[0];
+        if (k == n - 1) rhs -= m[n];
+        const double denom = 4.0 - c[k - 1];
+        c[k] = 1.0 / denom;
+        d[k] = (rhs - d[k - 1]) / denom;
+    }
+    for (int k = n - 1; k >= 1; --k) {
+        m[k] = d[k] - (k < n - 1 ? c[k] * m[k + 1] : 0.0);
+    }
+
+    // Hermite form of each interval, in terms of t = (x - x_k) / h.
+    m_coefficients.resize(4 * n);
+    for (int k = 0; k < n; ++k) {
+        const double dy = y[k + 1] - y[k];
+        double* a = &m_coefficients[4 * k];
+        a[0] = y[k];
+        a[1] = h * m[k];
+        a[2] = 3.0 * dy - h * (2.0 * m[k] + m[k + 1]);
+        a[3] = -2.0 * dy + h * (m[k] + m[k + 1]);
+    }
+}
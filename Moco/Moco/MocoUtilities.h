@@ -146,6 +146,11 @@ void printMessage(const std::string& formatString, Types... args) {
     std::cout.flush();
 }
 
+/// Format a number for a JSON file with 9 significant digits. JSON has no
+/// representation for NaN or infinity, so these are written as null.
+/// @ingroup mocologutil
+OSIMMOCO_API std::string formatJSONNumber(double value);
+
 #endif // SWIG
 
 /// @}
@@ -411,6 +416,59 @@ OSIMMOCO_API MocoTrajectory simulateTrajectoryWithTimeStepping(
         const MocoTrajectory& trajectory, Model model,
         double integratorAccuracy = -1);
 
+#ifndef SWIG
+/// The lengths, lengthening speeds, and moment arms of the muscles in a model
+/// along a trajectory of coordinate values. See computeMuscleGeometry().
+/// @ingroup mocomodelutil
+struct OSIMMOCO_API MuscleGeometryTrajectory {
+    std::vector<double> times;
+    /// Absolute paths of the muscles, in the order of the columns of
+    /// lengths and lengtheningSpeeds and the rows of each moment arm matrix.
+    std::vector<std::string> musclePaths;
+    /// Absolute paths of the coordinates, in the order of the columns of each
+    /// moment arm matrix.
+    std::vector<std::string> coordinatePaths;
+    /// Muscle-tendon lengths (number of times x number of muscles).
+    SimTK::Matrix lengths;
+    /// Muscle-tendon lengthening speeds (number of times x number of muscles).
+    SimTK::Matrix lengtheningSpeeds;
+    /// One moment arm matrix (number of muscles x number of coordinates) for
+    /// each time.
+    std::vector<SimTK::Matrix> momentArms;
+    /// For each muscle, the indices (into coordinatePaths) of the coordinates
+    /// that the muscle spans. If sparsity was not detected, this contains all
+    /// coordinates for every muscle.
+    std::vector<std::vector<int>> spannedCoordinates;
+};
+
+/// Compute the lengths, lengthening speeds, and moment arms of all muscles in
+/// the model at each time in the provided table of coordinate values. The
+/// column labels of the table must be paths to coordinate value state
+/// variables (e.g., "/jointset/knee/knee_angle/value"); coordinates not in the
+/// table keep their default values and have zero speed. Coordinate speeds are
+/// computed from GCVSplines fit to the table. If allowExtraColumns is false,
+/// an exception is thrown if the table contains columns that are not
+/// coordinate values. As with PositionMotion, kinematic constraints are not
+/// enforced.
+///
+/// If detectSparsity is true, we compute all moment arms at (up to) 10 times
+/// evenly spaced through the table, deem that a muscle spans a coordinate if
+/// any of these moment arms exceeds 1e-5 in magnitude, and compute only the
+/// moment arms for spanned coordinates at the remaining times (the other
+/// entries are zero). This is much faster for large models, but a muscle whose
+/// moment arm about a coordinate is zero at all of these times is assumed to
+/// have zero moment arm about that coordinate at all times.
+///
+/// The times are distributed among threads, each of which uses its own copy of
+/// the model. The parallel argument follows the convention of the
+/// MocoCasADiSolver `parallel` property: 0 for no parallelization, 1 to use
+/// all cores, or greater than 1 to use that number of threads.
+/// @ingroup mocomodelutil
+OSIMMOCO_API MuscleGeometryTrajectory computeMuscleGeometry(const Model& model,
+        const TimeSeriesTable& coordinates, bool detectSparsity = true,
+        int parallel = 1, bool allowExtraColumns = false);
+#endif
+
 /// The map provides the index of each state variable in
 /// SimTK::State::getY() from its each state variable path string.
 /// Empty slots in Y (e.g., for quaternions) are ignored.
@@ -730,6 +788,27 @@ private:
 /// @ingroup mocogenutil
 OSIMMOCO_API int getMocoParallelEnvironmentVariable();
 
+#ifndef SWIG
+/// The number of threads to use for a setting that follows the convention of
+/// MocoCasADiSolver's `parallel` property: 0 for no parallelization, 1 to use
+/// all cores, or greater than 1 to use that number of threads. The result is
+/// at least 1 and, if maxNumThreads is positive, at most maxNumThreads (e.g.,
+/// the number of tasks).
+/// @ingroup mocogenutil
+OSIMMOCO_API int getNumThreadsForParallel(int parallel, int maxNumThreads = -1);
+
+/// Perform the tasks with indices 0 through numTasks - 1 using numThreads
+/// threads, including the calling thread. Each thread repeatedly claims the
+/// next task and invokes task(threadIndex, taskIndex); threadIndex is in
+/// [0, numThreads), so callers can give each thread its own resources (e.g.,
+/// a copy of a model). This function returns once all tasks are done. If a
+/// task throws an exception, the remaining tasks are skipped and the first
+/// exception is rethrown on the calling thread.
+/// @ingroup mocogenutil
+OSIMMOCO_API void performTasksInParallel(int numThreads, int numTasks,
+        const std::function<void(int threadIndex, int taskIndex)>& task);
+#endif
+
 /// This class lets you store objects of a single type for reuse by multiple
 /// threads, ensuring threadsafe access to each of those objects.
 /// @ingroup mocogenutil
@@ -743,9 +822,15 @@ public:
         // Only one thread can lock the mutex at a time, so only one thread
         // at a time can be in any of the functions of this class.
         std::unique_lock<std::mutex> lock(m_mutex);
-        // Block this thread until the condition variable is woken up
-        // (by a notify_...()) and the lambda function returns true.
-        m_inventoryMonitor.wait(lock, [this] { return m_entries.size() > 0; });
+        if (m_entries.empty()) {
+            // Block this thread until the condition variable is woken up
+            // (by a notify_...()) and the lambda function returns true.
+            const long long start = SimTK::realTimeInNs();
+            m_inventoryMonitor.wait(
+                    lock, [this] { return m_entries.size() > 0; });
+            m_waitTimeInNs += SimTK::realTimeInNs() - start;
+            ++m_numWaits;
+        }
         std::unique_ptr<T> top = std::move(m_entries.top());
         m_entries.pop();
         return top;
@@ -764,11 +849,29 @@ public:
         std::lock_guard<std::mutex> lock(m_mutex);
         return (int)m_entries.size();
     }
+    /// The total time, in nanoseconds, that threads spent in take() waiting
+    /// for an object to become available.
+    long long getWaitTimeInNs() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_waitTimeInNs;
+    }
+    /// The number of calls to take() that had to wait for an object.
+    int getNumWaits() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_numWaits;
+    }
+    void resetWaitStatistics() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_waitTimeInNs = 0;
+        m_numWaits = 0;
+    }
 
 private:
     std::stack<std::unique_ptr<T>> m_entries;
     mutable std::mutex m_mutex;
     std::condition_variable m_inventoryMonitor;
+    long long m_waitTimeInNs = 0;
+    int m_numWaits = 0;
 };
 
 /// Thrown by FileDeletionThrower::throwIfDeleted().
@@ -862,6 +965,115 @@ SimTK::Real solveBisection(
         double left, double right, const double& tolerance = 1e-6,
         int maxIterations = 1000);
 
+/// The root and convergence information from solveNewtonBisection().
+/// @ingroup mocogenutil
+struct RootSolverResult {
+    SimTK::Real root = SimTK::NaN;
+    /// The residual at the root.
+    SimTK::Real residual = SimTK::NaN;
+    /// The number of iterations, each of which takes either a Newton step
+    /// or a bisection step and evaluates the residual once.
+    int numIterations = 0;
+    /// The number of iterations that took a Newton step.
+    int numNewtonSteps = 0;
+    bool converged = false;
+};
+
+#ifndef SWIG
+/// Solve for the root of a scalar function using Newton's method,
+/// safeguarded by bisection. The root is kept within a bracket [left, right]
+/// across which the residual changes sign; if a Newton step would leave the
+/// bracket or would not reduce the residual quickly enough, a bisection step
+/// is taken instead. This converges quadratically near the root, yet is as
+/// robust as solveBisection(). The derivative need not be exact; an
+/// approximate derivative only affects the speed of convergence.
+/// @param calcResidual a function that computes the residual and sets the
+///     second argument to the derivative of the residual.
+/// @param left lower bound on the root
+/// @param right upper bound on the root
+/// @param tolerance convergence requires that the last step (or the
+///     bracket) is smaller than tolerance, or that the residual is 0.
+/// @param maxIterations abort after this many iterations; the returned result
+///     has converged = false.
+/// @throws Exception if the residual has the same sign at left and right.
+/// @ingroup mocogenutil
+OSIMMOCO_API
+RootSolverResult solveNewtonBisection(
+        std::function<double(const double&, double&)> calcResidual,
+        double left, double right, const double& tolerance = 1e-6,
+        int maxIterations = 100);
+
+/// A C2 cubic spline approximation of a smooth scalar function on a closed
+/// interval, for replacing expensive analytic curves (e.g., muscle curves
+/// containing exp() and log()) with a few multiplications.
+/// The knots are uniformly spaced, so locating the interval containing x does
+/// not require a search. The slopes at the interior knots are those of the
+/// complete (clamped) interpolating cubic spline, and the slopes at the
+/// endpoints are the exact derivatives of the function.
+///
+/// The number of intervals is doubled, starting from 16, until the error
+/// in both the value and the derivative, measured on a dense uniform grid
+/// spanning the whole domain (at least 10001 points, and at least 7 points
+/// per interval), satisfies
+/// |spline - function| <= tolerance * (1 + |function|).
+/// This mixed absolute/relative error is available via getMaxValueError() and
+/// getMaxDerivativeError().
+/// @throws Exception if the tolerances are not met with maxNumIntervals.
+/// @ingroup moconumutil
+class OSIMMOCO_API TabulatedCubicSpline {
+public:
+    TabulatedCubicSpline() = default;
+    TabulatedCubicSpline(const std::function<double(double)>& function,
+            const std::function<double(double)>& derivative, double lower,
+            double upper, double valueTolerance = 1e-8,
+            double derivativeTolerance = 1e-6, int maxNumIntervals = 8192);
+
+    /// Is x within [lower, upper]? This is false for a default-constructed
+    /// spline.
+    bool isInDomain(double x) const { return x >= m_lower && x <= m_upper; }
+    /// The value of the spline at x, which must be within the domain.
+    double calcValue(double x) const {
+        int k;
+        double t;
+        locate(x, k, t);
+        const double* a = &m_coefficients[4 * k];
+        return a[0] + t * (a[1] + t * (a[2] + t * a[3]));
+    }
+    /// The derivative of the spline at x, which must be within the domain.
+    double calcDerivative(double x) const {
+        int k;
+        double t;
+        locate(x, k, t);
+        const double* a = &m_coefficients[4 * k];
+        return (a[1] + t * (2.0 * a[2] + t * 3.0 * a[3])) * m_invIntervalWidth;
+    }
+    int getNumIntervals() const { return (int)m_coefficients.size() / 4; }
+    double getMaxValueError() const { return m_maxValueError; }
+    double getMaxDerivativeError() const { return m_maxDerivativeError; }
+
+private:
+    // Compute the index of the interval containing x and the location of x
+    // within the interval, t in [0, 1].
+    void locate(double x, int& k, double& t) const {
+        const double u = (x - m_lower) * m_invIntervalWidth;
+        k = std::min(std::max((int)u, 0), getNumIntervals() - 1);
+        t = u - k;
+    }
+    void fit(const std::function<double(double)>& function,
+            const std::function<double(double)>& derivative,
+            int numIntervals);
+
+    double m_lower = SimTK::NaN;
+    double m_upper = SimTK::NaN;
+    double m_invIntervalWidth = SimTK::NaN;
+    // The cubic polynomial for each interval, in terms of t, as 4 consecutive
+    // coefficients in order of increasing degree.
+    std::vector<double> m_coefficients;
+    double m_maxValueError = SimTK::NaN;
+    double m_maxDerivativeError = SimTK::NaN;
+};
+#endif // SWIG
+
 } // namespace OpenSim
 
 #endif // MOCO_MOCOUTILITIES_H
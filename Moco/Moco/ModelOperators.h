@@ -23,6 +23,8 @@
 
 #include <OpenSim/Tools/InverseDynamicsTool.h>
 
+#include <fstream>
+
 namespace OpenSim {
 
 /// Invoke DeGrooteFregly2016Muscle::replaceMuscles() on the model.
@@ -202,6 +204,74 @@ public:
     }
 };
 
+/// Replace the GeometryPath of each muscle with a polynomial approximation of
+/// its length in terms of the coordinates it spans, using
+/// ModelFactory::replacePathsWithPolynomials(). This is much faster than
+/// computing paths with wrapping surfaces. The quality of each fit is written
+/// to report_file, or printed if report_file is empty.
+/// This requires a version of opensim-core whose GeometryPath provides the
+/// polynomial approximation properties.
+class OSIMMOCO_API ModOpReplacePathsWithPolynomials : public ModelOperator {
+    OpenSim_DECLARE_CONCRETE_OBJECT(
+            ModOpReplacePathsWithPolynomials, ModelOperator);
+    OpenSim_DECLARE_PROPERTY(max_order, int,
+            "The maximum order of the polynomials (default: 9).");
+    OpenSim_DECLARE_PROPERTY(length_tolerance, double,
+            "The lowest order whose maximum error in muscle-tendon length is "
+            "below this value is used (default: 0.003 m).");
+    OpenSim_DECLARE_PROPERTY(moment_arm_tolerance, double,
+            "The lowest order whose maximum error in moment arm is below "
+            "this value is used (default: 0.003 m).");
+    OpenSim_DECLARE_PROPERTY(num_samples, int,
+            "The number of sampled coordinate values used to fit each "
+            "muscle's polynomial (default: 1000).");
+    OpenSim_DECLARE_PROPERTY(parallel, int,
+            "Fit the polynomials for multiple muscles in parallel? "
+            "0: not parallel; 1: use all cores (default); greater than 1: use "
+            "this number of threads.");
+    OpenSim_DECLARE_PROPERTY(report_file, std::string,
+            "File to which to write the quality of each fit. If empty "
+            "(default), the report is printed.");
+
+public:
+    ModOpReplacePathsWithPolynomials() {
+        constructProperty_max_order(9);
+        constructProperty_length_tolerance(0.003);
+        constructProperty_moment_arm_tolerance(0.003);
+        constructProperty_num_samples(1000);
+        constructProperty_parallel(1);
+        constructProperty_report_file("");
+    }
+    ModOpReplacePathsWithPolynomials(int maxOrder, double tolerance)
+            : ModOpReplacePathsWithPolynomials() {
+        set_max_order(maxOrder);
+        set_length_tolerance(tolerance);
+        set_moment_arm_tolerance(tolerance);
+    }
+    /// The report file is located relative to `relativeToDirectory`.
+    void operate(Model& model,
+            const std::string& relativeToDirectory) const override {
+        const auto fits = ModelFactory::replacePathsWithPolynomials(model,
+                get_max_order(), get_length_tolerance(),
+                get_moment_arm_tolerance(), get_num_samples(), get_parallel());
+        if (get_report_file().empty()) {
+            ModelFactory::printPolynomialPathFitReport(fits);
+        } else {
+            std::string path = get_report_file();
+            if (!relativeToDirectory.empty()) {
+                using SimTK::Pathname;
+                path = Pathname::
+                        getAbsolutePathnameUsingSpecifiedWorkingDirectory(
+                                relativeToDirectory, path);
+            }
+            std::ofstream stream(path);
+            OPENSIM_THROW_IF(!stream.good(), Exception,
+                    format("Could not open report file '%s'.", path));
+            ModelFactory::printPolynomialPathFitReport(fits, stream);
+        }
+    }
+};
+
 /// Remove all muscles contained in the model's ForceSet.
 class OSIMMOCO_API ModOpRemoveMuscles : public ModelOperator {
     OpenSim_DECLARE_CONCRETE_OBJECT(ModOpRemoveMuscles, ModelOperator);
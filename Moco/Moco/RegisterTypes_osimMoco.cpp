@@ -23,8 +23,10 @@
 #include "Components/ActivationCoordinateActuator.h"
 #include "Components/DeGrooteFregly2016Muscle.h"
 #include "Components/DiscreteForces.h"
+#include "Components/MultiStationPlaneContactForce.h"
 #include "Components/MultivariatePolynomialFunction.h"
 #include "Components/PositionMotion.h"
+#include "Components/SmoothMultiSphereHalfSpaceForce.h"
 #include "Components/SmoothSphereHalfSpaceForce.h"
 #include "Components/StationPlaneContactForce.h"
 #include "MocoBounds.h"
@@ -126,13 +128,17 @@ OSIMMOCO_API void RegisterTypes_osimMoco() {
         Object::registerType(ModOpScaleActiveFiberForceCurveWidthDGF());
         Object::registerType(ModOpReplaceJointsWithWelds());
         Object::registerType(ModOpScaleMaxIsometricForce());
+        Object::registerType(ModOpReplacePathsWithPolynomials());
 
         Object::registerType(AckermannVanDenBogert2010Force());
         Object::registerType(MeyerFregly2016Force());
+        Object::registerType(MultiStationAckermannVanDenBogert2010Force());
+        Object::registerType(MultiStationMeyerFregly2016Force());
         Object::registerType(EspositoMiller2018Force());
         Object::registerType(PositionMotion());
         Object::registerType(DeGrooteFregly2016Muscle());
         Object::registerType(SmoothSphereHalfSpaceForce());
+        Object::registerType(SmoothMultiSphereHalfSpaceForce());
         Object::registerType(MultivariatePolynomialFunction());
 
         Object::registerType(DiscreteForces());
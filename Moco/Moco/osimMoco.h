@@ -24,8 +24,10 @@
 #include "Components/DeGrooteFregly2016Muscle.h"
 #include "Components/DiscreteForces.h"
 #include "Components/ModelFactory.h"
+#include "Components/MultiStationPlaneContactForce.h"
 #include "Components/MultivariatePolynomialFunction.h"
 #include "Components/PositionMotion.h"
+#include "Components/SmoothMultiSphereHalfSpaceForce.h"
 #include "Components/SmoothSphereHalfSpaceForce.h"
 #include "Components/StationPlaneContactForce.h"
 #include "MocoBounds.h"
@@ -118,6 +118,13 @@ convertIterateTropterToMoco(const tropIterateType& tropSol) const {
     for (int i = 0; i < numSlacks; ++i) {
         mocoIter.appendSlack(slack_names[i], slacks.col(i));
     }
+    if (tropSol.bound_multipliers.size()) {
+        mocoIter.setOptimMultipliers(
+                SimTK::Vector((int)tropSol.constraint_multipliers.size(),
+                        tropSol.constraint_multipliers.data()),
+                SimTK::Vector((int)tropSol.bound_multipliers.size(),
+                        tropSol.bound_multipliers.data()));
+    }
     return mocoIter;
 }
 
@@ -209,6 +216,18 @@ convertToTropterIterate(const OpenSim::MocoTrajectory& mocoIter) const {
     } else {
         tropIter.parameters.resize(numParameters);
     }
+    if (mocoIter.hasOptimMultipliers()) {
+        const auto& constraintMults = mocoIter.getOptimConstraintMultipliers();
+        const auto& boundMults = mocoIter.getOptimBoundMultipliers();
+        tropIter.constraint_multipliers.resize(constraintMults.size());
+        for (int i = 0; i < constraintMults.size(); ++i) {
+            tropIter.constraint_multipliers[i] = constraintMults[i];
+        }
+        tropIter.bound_multipliers.resize(boundMults.size());
+        for (int i = 0; i < boundMults.size(); ++i) {
+            tropIter.bound_multipliers[i] = boundMults[i];
+        }
+    }
     return tropIter;
 }
 
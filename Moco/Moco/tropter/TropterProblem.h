@@ -30,6 +30,8 @@
 
 #include <tropter/tropter.h>
 
+#include <atomic>
+
 namespace OpenSim {
 
 inline tropter::Bounds convertBounds(const MocoBounds& mb) {
@@ -549,6 +551,15 @@ public:
 
     tropter::Iterate convertToTropterIterate(
             const MocoTrajectory& mocoIter) const;
+
+    /// The number of times the differential-algebraic equations have been
+    /// evaluated.
+    long long getNumDynamicsEvaluations() const {
+        return m_numDynamicsEvaluations.load(std::memory_order_relaxed);
+    }
+
+protected:
+    mutable std::atomic<long long> m_numDynamicsEvaluations{0};
 };
 
 template <typename T>
@@ -560,6 +571,8 @@ public:
     void initialize_on_mesh(const Eigen::VectorXd&) const override {}
     void calc_differential_algebraic_equations(const tropter::Input<T>& in,
             tropter::Output<T> out) const override {
+        this->m_numDynamicsEvaluations.fetch_add(
+                1, std::memory_order_relaxed);
         // Unpack variables.
         const auto& diffuses = in.diffuses;
 
@@ -656,6 +669,8 @@ public:
     }
     void calc_differential_algebraic_equations(const tropter::Input<T>& in,
             tropter::Output<T> out) const override {
+        this->m_numDynamicsEvaluations.fetch_add(
+                1, std::memory_order_relaxed);
 
         const auto& states = in.states;
         const auto& adjuncts = in.adjuncts;
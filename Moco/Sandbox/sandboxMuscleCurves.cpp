@@ -0,0 +1,140 @@
+/* -------------------------------------------------------------------------- *
+ * OpenSim Moco: sandboxMuscleCurves.cpp                                      *
+ * -------------------------------------------------------------------------- *
+ * Copyright (c) 2019 Stanford University and the Authors                     *
+ *                                                                            *
+ * Author(s): Christopher Dembia                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0          *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Micro-benchmark of the curves of DeGrooteFregly2016Muscle with
+// curve_evaluation_mode 'analytic' and 'tabulated'. For each curve, we report
+// the time per evaluation in each mode and the maximum difference between the
+// modes. The public force-velocity functions are static and therefore always
+// analytic, so they are not included.
+
+#include <Moco/Components/DeGrooteFregly2016Muscle.h>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+using namespace OpenSim;
+
+struct Result {
+    double nanoseconds = 0;
+    double sum = 0;
+};
+
+template <typename F>
+Result timeCurve(
+        F curve, double lower, double upper, std::vector<double>& values) {
+    using clock = std::chrono::high_resolution_clock;
+    const int numPoints = (int)values.size();
+    const int numRepetitions = 2000;
+    Result result;
+    const auto start = clock::now();
+    for (int irep = 0; irep < numRepetitions; ++irep) {
+        for (int i = 0; i < numPoints; ++i) {
+            const double x = lower + (upper - lower) * i / (numPoints - 1);
+            values[i] = curve(x);
+        }
+        // Prevent the compiler from optimizing away the loop.
+        result.sum += values[irep % numPoints];
+    }
+    result.nanoseconds =
+            std::chrono::duration<double, std::nano>(clock::now() - start)
+                    .count() /
+            (numRepetitions * numPoints);
+    return result;
+}
+
+template <typename F>
+void benchmark(const std::string& name, F curve,
+        const DeGrooteFregly2016Muscle& analytic,
+        const DeGrooteFregly2016Muscle& tabulated, double lower,
+        double upper) {
+    const int numPoints = 1000;
+    std::vector<double> analyticValues(numPoints);
+    std::vector<double> tabulatedValues(numPoints);
+    const auto a = timeCurve([&](double x) { return curve(analytic, x); },
+            lower, upper, analyticValues);
+    const auto t = timeCurve([&](double x) { return curve(tabulated, x); },
+            lower, upper, tabulatedValues);
+    double maxError = 0;
+    for (int i = 0; i < numPoints; ++i) {
+        maxError = std::max(maxError,
+                std::abs(analyticValues[i] - tabulatedValues[i]));
+    }
+    std::cout << std::setw(36) << name << std::setw(12) << a.nanoseconds
+              << std::setw(12) << t.nanoseconds << std::setw(12)
+              << a.nanoseconds / t.nanoseconds << std::setw(14) << maxError
+              << std::endl;
+}
+
+int main() {
+    using DGF = DeGrooteFregly2016Muscle;
+    DGF analytic;
+    analytic.finalizeFromProperties();
+
+    DGF tabulated;
+    tabulated.set_curve_evaluation_mode("tabulated");
+    using clock = std::chrono::high_resolution_clock;
+    const auto start = clock::now();
+    tabulated.finalizeFromProperties();
+    std::cout << "Time to build tabulated curves (s): "
+              << std::chrono::duration<double>(clock::now() - start).count()
+              << std::endl;
+
+    std::cout << std::setw(36) << "curve" << std::setw(12) << "analytic"
+              << std::setw(12) << "tabulated" << std::setw(12) << "speedup"
+              << std::setw(14) << "max error" << std::endl;
+    std::cout << std::setw(36) << "" << std::setw(12) << "(ns)"
+              << std::setw(12) << "(ns)" << std::endl;
+    benchmark("active force-length",
+            [](const DGF& m, double x) {
+                return m.calcActiveForceLengthMultiplier(x);
+            },
+            analytic, tabulated, 0.2, 1.8);
+    benchmark("active force-length derivative",
+            [](const DGF& m, double x) {
+                return m.calcActiveForceLengthMultiplierDerivative(x);
+            },
+            analytic, tabulated, 0.2, 1.8);
+    benchmark("passive force-length",
+            [](const DGF& m, double x) {
+                return m.calcPassiveForceMultiplier(x);
+            },
+            analytic, tabulated, 0.2, 1.8);
+    benchmark("passive force-length derivative",
+            [](const DGF& m, double x) {
+                return m.calcPassiveForceMultiplierDerivative(x);
+            },
+            analytic, tabulated, 0.2, 1.8);
+    benchmark("tendon force-length",
+            [](const DGF& m, double x) {
+                return m.calcTendonForceMultiplier(x);
+            },
+            analytic, tabulated, 1.0, 1.09);
+    benchmark("tendon force-length derivative",
+            [](const DGF& m, double x) {
+                return m.calcTendonForceMultiplierDerivative(x);
+            },
+            analytic, tabulated, 1.0, 1.09);
+    benchmark("tendon force-length inverse",
+            [](const DGF& m, double x) {
+                return m.calcTendonForceLengthInverseCurve(x);
+            },
+            analytic, tabulated, 0.0, 5.0);
+
+    return EXIT_SUCCESS;
+}
@@ -541,6 +541,227 @@ TEST_CASE("testSmoothSphereHalfSpaceForce") {
     testSmoothSphereHalfSpaceForce_FrictionForce(equilibriumHeight);
 }
 
+template <typename ContactForce>
+void setContactParameters(ContactForce* force) {
+    force->set_stiffness(1e6);
+    force->set_dissipation(2.0);
+    force->set_static_friction(0.8);
+    force->set_dynamic_friction(0.6);
+    force->set_viscous_friction(0.1);
+    force->set_transition_velocity(0.2);
+}
+
+TEST_CASE("SmoothMultiSphereHalfSpaceForce") {
+    // The multi-sphere force must match one SmoothSphereHalfSpaceForce per
+    // sphere.
+    const std::vector<Vec3> locations{Vec3(0.1, -0.05, 0.02),
+            Vec3(-0.1, -0.06, 0.03), Vec3(0, -0.04, -0.1)};
+    const std::vector<double> radii{0.03, 0.05, 0.04};
+    auto createModel = [&](bool multi) {
+        Model model;
+        auto* body = new Body("body", 1, Vec3(0), SimTK::Inertia(1));
+        model.addComponent(body);
+        auto* joint = new FreeJoint("joint", model.getGround(), *body);
+        model.addComponent(joint);
+        auto* offset = new PhysicalOffsetFrame("offset", *body,
+                SimTK::Transform(SimTK::Rotation(0.3, SimTK::ZAxis),
+                        Vec3(0.01, 0.02, 0.03)));
+        body->addComponent(offset);
+        const Vec3 halfSpaceLocation(0.1, 0.01, 0);
+        const Vec3 halfSpaceOrientation(0.1, 0, -0.5 * SimTK::Pi);
+        if (multi) {
+            auto* force = new SmoothMultiSphereHalfSpaceForce("contact",
+                    *offset, model.getGround(), halfSpaceLocation,
+                    halfSpaceOrientation);
+            for (int i = 0; i < (int)locations.size(); ++i) {
+                force->addContactSphere(locations[i], radii[i]);
+            }
+            setContactParameters(force);
+            model.addComponent(force);
+        } else {
+            for (int i = 0; i < (int)locations.size(); ++i) {
+                auto* force = new SmoothSphereHalfSpaceForce(
+                        "contact" + std::to_string(i), *offset, locations[i],
+                        radii[i], model.getGround(), halfSpaceLocation,
+                        halfSpaceOrientation);
+                setContactParameters(force);
+                model.addComponent(force);
+            }
+        }
+        model.finalizeConnections();
+        return model;
+    };
+
+    Model multiModel = createModel(true);
+    Model singleModel = createModel(false);
+    SimTK::State multiState = multiModel.initSystem();
+    SimTK::State singleState = singleModel.initSystem();
+    for (auto* state : {&multiState, &singleState}) {
+        state->updQ() = SimTK::Vector(
+                createVector({0.1, -0.2, 0.3, 0.02, 0.04, -0.01}));
+        state->updU() =
+                SimTK::Vector(createVector({0.5, -1.0, 0.3, 0.2, -0.3, 0.1}));
+    }
+    multiModel.realizeVelocity(multiState);
+    singleModel.realizeVelocity(singleState);
+
+    const auto& multi =
+            multiModel.getComponent<SmoothMultiSphereHalfSpaceForce>(
+                    "contact");
+    const Array<double> multiValues = multi.getRecordValues(multiState);
+    REQUIRE(multiValues.size() == 12 + 6 * (int)locations.size());
+    REQUIRE(multi.getRecordLabels().size() == multiValues.size());
+
+    std::vector<double> total(12, 0.0);
+    for (int i = 0; i < (int)locations.size(); ++i) {
+        const auto& single =
+                singleModel.getComponent<SmoothSphereHalfSpaceForce>(
+                        "contact" + std::to_string(i));
+        const Array<double> values = single.getRecordValues(singleState);
+        for (int j = 0; j < 12; ++j) total[j] += values[j];
+        // Forces and torques applied by sphere i.
+        for (int j = 0; j < 6; ++j) {
+            CHECK(multiValues[12 + 6 * i + j] ==
+                    Approx(values[j]).margin(1e-8));
+        }
+    }
+    for (int j = 0; j < 12; ++j) {
+        CHECK(multiValues[j] == Approx(total[j]).margin(1e-8));
+    }
+
+    // The generalized accelerations must also match.
+    multiModel.realizeAcceleration(multiState);
+    singleModel.realizeAcceleration(singleState);
+    SimTK_TEST_EQ_TOL(multiState.getUDot(), singleState.getUDot(), 1e-8);
+
+    // The reported values must follow changes to the state, and must match
+    // the cached forces.
+    multiState.updU()[3] = -0.4;
+    multiModel.realizeVelocity(multiState);
+    const auto& forces = multi.getContactForcesOnSpheres(multiState);
+    const Array<double> newValues = multi.getRecordValues(multiState);
+    REQUIRE(forces.size() == locations.size());
+    for (int i = 0; i < (int)locations.size(); ++i) {
+        for (int j = 0; j < 3; ++j) {
+            CHECK(newValues[12 + 6 * i + j] == forces[i][j]);
+        }
+    }
+    CHECK(newValues[12] != multiValues[12]);
+}
+
+using CreateMultiContactFunction =
+        std::function<MultiStationPlaneContactForce*(void)>;
+// The multi-station force must match one StationPlaneContactForce per
+// station.
+void testMultiStationPlaneContactForce(
+        CreateMultiContactFunction createMultiContact,
+        CreateContactFunction createContact) {
+    const std::vector<Vec3> locations{Vec3(0.1, -0.05, 0.02),
+            Vec3(-0.1, -0.06, 0.03), Vec3(0, -0.04, -0.1)};
+    auto createModel = [&](bool multi) {
+        Model model;
+        auto* body = new Body("body", 1, Vec3(0), SimTK::Inertia(1));
+        model.addComponent(body);
+        auto* joint = new FreeJoint("joint", model.getGround(), *body);
+        model.addComponent(joint);
+        auto* offset = new PhysicalOffsetFrame("offset", *body,
+                SimTK::Transform(SimTK::Rotation(0.3, SimTK::ZAxis),
+                        Vec3(0.01, 0.02, 0.03)));
+        body->addComponent(offset);
+        if (multi) {
+            auto* force = createMultiContact();
+            force->setName("contact");
+            for (int i = 0; i < (int)locations.size(); ++i) {
+                force->addStation("station" + std::to_string(i), locations[i]);
+            }
+            force->connectSocket_frame(*offset);
+            model.addComponent(force);
+        } else {
+            for (int i = 0; i < (int)locations.size(); ++i) {
+                auto* station = new Station(*offset, locations[i]);
+                station->setName("station" + std::to_string(i));
+                model.addComponent(station);
+                auto* force = createContact();
+                force->setName("contact" + std::to_string(i));
+                force->connectSocket_station(*station);
+                model.addComponent(force);
+            }
+        }
+        model.finalizeConnections();
+        return model;
+    };
+
+    Model multiModel = createModel(true);
+    Model singleModel = createModel(false);
+    SimTK::State multiState = multiModel.initSystem();
+    SimTK::State singleState = singleModel.initSystem();
+    for (auto* state : {&multiState, &singleState}) {
+        state->updQ() = SimTK::Vector(
+                createVector({0.1, -0.2, 0.3, 0.02, 0.04, -0.01}));
+        state->updU() =
+                SimTK::Vector(createVector({0.5, -1.0, 0.3, 0.2, -0.3, 0.1}));
+    }
+    multiModel.realizeVelocity(multiState);
+    singleModel.realizeVelocity(singleState);
+
+    const auto& multi =
+            multiModel.getComponent<MultiStationPlaneContactForce>("contact");
+    const Array<double> multiValues = multi.getRecordValues(multiState);
+    REQUIRE(multiValues.size() == 12 + 3 * (int)locations.size());
+    REQUIRE(multi.getRecordLabels().size() == multiValues.size());
+
+    const auto& output = multi.getOutput("force_on_station");
+    REQUIRE(output.getChannels().size() == locations.size());
+    Vec3 totalForce(0);
+    for (int i = 0; i < (int)locations.size(); ++i) {
+        const auto& single =
+                singleModel.getComponent<StationPlaneContactForce>(
+                        "contact" + std::to_string(i));
+        const Vec3 force = single.calcContactForceOnStation(singleState);
+        totalForce += force;
+        const std::string name = "station" + std::to_string(i);
+        const Vec3 multiForce =
+                multi.getContactForceOnStation(multiState, name);
+        for (int j = 0; j < 3; ++j) {
+            CHECK(multiForce[j] == Approx(force[j]).margin(1e-8));
+            CHECK(multiValues[12 + 3 * i + j] ==
+                    Approx(force[j]).margin(1e-8));
+        }
+    }
+    for (int j = 0; j < 3; ++j) {
+        CHECK(multiValues[j] == Approx(totalForce[j]).margin(1e-8));
+        CHECK(multiValues[6 + j] == Approx(-totalForce[j]).margin(1e-8));
+    }
+
+    // The generalized accelerations must also match.
+    multiModel.realizeAcceleration(multiState);
+    singleModel.realizeAcceleration(singleState);
+    SimTK_TEST_EQ_TOL(multiState.getUDot(), singleState.getUDot(), 1e-8);
+}
+
+TEST_CASE("MultiStationPlaneContactForce AckermannVanDenBogert2010Force") {
+    testMultiStationPlaneContactForce(
+            []() -> MultiStationPlaneContactForce* {
+                auto* contact =
+                        new MultiStationAckermannVanDenBogert2010Force();
+                contact->set_stiffness(1e5);
+                contact->set_dissipation(1.0);
+                contact->set_friction_coefficient(FRICTION_COEFFICIENT);
+                return contact;
+            },
+            createAVDB);
+}
+
+TEST_CASE("MultiStationPlaneContactForce MeyerFregly2016Force") {
+    testMultiStationPlaneContactForce(
+            []() -> MultiStationPlaneContactForce* {
+                auto* contact = new MultiStationMeyerFregly2016Force();
+                contact->set_stiffness(1e5);
+                contact->set_dissipation(1.0);
+                return contact;
+            },
+            createMeyerFregly);
+}
 
 TEST_CASE("MocoContactTrackingGoal") {
     std::cout.rdbuf(LogManager::cout.rdbuf());
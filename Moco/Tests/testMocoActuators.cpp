@@ -942,6 +942,177 @@ TEST_CASE("DeGrooteFregly2016Muscle basics") {
     }
 }
 
+TEST_CASE("DeGrooteFregly2016Muscle activation time constants") {
+    // Each muscle uses its own time constants.
+    DeGrooteFregly2016Muscle fast;
+    fast.set_ignore_tendon_compliance(true);
+    fast.set_activation_time_constant(0.010);
+    fast.set_deactivation_time_constant(0.040);
+    fast.finalizeFromProperties();
+    DeGrooteFregly2016Muscle slow = fast;
+    slow.set_activation_time_constant(0.030);
+    slow.set_deactivation_time_constant(0.080);
+    slow.finalizeFromProperties();
+
+    for (const auto* muscle : {&fast, &slow}) {
+        const double tauA = muscle->get_activation_time_constant();
+        const double tauD = muscle->get_deactivation_time_constant();
+        for (const auto& excitation : {0.0, 1.0}) {
+            const double activation = 0.4;
+            double tendonForce;
+            double activationDerivative;
+            double normTendonForceDerivative;
+            double implicitResidual;
+            muscle->calcDynamicsFromKinematics(
+                    muscle->get_optimal_fiber_length() +
+                            muscle->get_tendon_slack_length(),
+                    0, excitation, activation, SimTK::NaN, SimTK::NaN,
+                    tendonForce, activationDerivative,
+                    normTendonForceDerivative, implicitResidual);
+            const double f = 0.5 * std::tanh(0.1 * (excitation - activation));
+            const double z = 0.5 + 1.5 * activation;
+            const double expected =
+                    ((f + 0.5) / (tauA * z) + (-f + 0.5) * z / tauD) *
+                    (excitation - activation);
+            CHECK(activationDerivative == Approx(expected));
+        }
+    }
+}
+
+TEST_CASE("DeGrooteFregly2016Muscle tabulated curves") {
+    DeGrooteFregly2016Muscle analytic;
+    analytic.set_active_force_width_scale(1.5);
+    analytic.set_tendon_strain_at_one_norm_force(0.10);
+    analytic.finalizeFromProperties();
+    DeGrooteFregly2016Muscle tabulated = analytic;
+    tabulated.set_curve_evaluation_mode("tabulated");
+    tabulated.finalizeFromProperties();
+
+    // The error is relative to (1 + |value|).
+    const auto checkClose = [](double a, double b, double tolerance) {
+        CHECK(std::abs(a - b) <= tolerance * (1 + std::abs(a)));
+    };
+    // Include points outside the tabulated domains, where the analytic curves
+    // are used.
+    const auto normFiberLength = createVectorLinspace(1001, 0.1, 1.9);
+    for (int i = 0; i < normFiberLength.nrow(); ++i) {
+        const auto& x = normFiberLength[i];
+        checkClose(analytic.calcActiveForceLengthMultiplier(x),
+                tabulated.calcActiveForceLengthMultiplier(x), 1e-8);
+        checkClose(analytic.calcActiveForceLengthMultiplierDerivative(x),
+                tabulated.calcActiveForceLengthMultiplierDerivative(x), 1e-6);
+        checkClose(analytic.calcPassiveForceMultiplier(x),
+                tabulated.calcPassiveForceMultiplier(x), 1e-8);
+        checkClose(analytic.calcPassiveForceMultiplierDerivative(x),
+                tabulated.calcPassiveForceMultiplierDerivative(x), 1e-6);
+    }
+    const auto normTendonForce = createVectorLinspace(1001, 0, 5);
+    for (int i = 0; i < normTendonForce.nrow(); ++i) {
+        const auto& f = normTendonForce[i];
+        const auto x = analytic.calcTendonForceLengthInverseCurve(f);
+        checkClose(x, tabulated.calcTendonForceLengthInverseCurve(f), 1e-8);
+        checkClose(analytic.calcTendonForceMultiplier(x),
+                tabulated.calcTendonForceMultiplier(x), 1e-8);
+        checkClose(analytic.calcTendonForceMultiplierDerivative(x),
+                tabulated.calcTendonForceMultiplierDerivative(x), 1e-6);
+    }
+
+    // The muscle uses the force-velocity curve and its inverse internally,
+    // so we compare quantities that depend on these curves. The fiber is at
+    // its optimal length and the activation is 1.
+    const double optimalFiberLength = analytic.get_optimal_fiber_length();
+    const double tendonSlackLength = analytic.get_tendon_slack_length();
+    const double maxIsometricForce = analytic.get_max_isometric_force();
+    const double maxContractionVelocity =
+            analytic.get_max_contraction_velocity() * optimalFiberLength;
+    {
+        // With a rigid tendon, the tendon force depends on the force-velocity
+        // curve at the fiber velocity.
+        DeGrooteFregly2016Muscle rigidAnalytic = analytic;
+        rigidAnalytic.set_ignore_tendon_compliance(true);
+        rigidAnalytic.finalizeFromProperties();
+        DeGrooteFregly2016Muscle rigidTabulated = rigidAnalytic;
+        rigidTabulated.set_curve_evaluation_mode("tabulated");
+        rigidTabulated.finalizeFromProperties();
+        const auto calcNormTendonForce =
+                [&](const DeGrooteFregly2016Muscle& muscle,
+                        double normFiberVelocity) -> double {
+            double tendonForce, activationDerivative,
+                    normTendonForceDerivative, implicitResidual;
+            muscle.calcDynamicsFromKinematics(
+                    optimalFiberLength + tendonSlackLength,
+                    normFiberVelocity * maxContractionVelocity, 1, 1,
+                    SimTK::NaN, SimTK::NaN, tendonForce, activationDerivative,
+                    normTendonForceDerivative, implicitResidual);
+            return tendonForce / maxIsometricForce;
+        };
+        const auto normFiberVelocity = createVectorLinspace(1001, -1.2, 1.2);
+        for (int i = 0; i < normFiberVelocity.nrow(); ++i) {
+            const auto& v = normFiberVelocity[i];
+            checkClose(calcNormTendonForce(rigidAnalytic, v),
+                    calcNormTendonForce(rigidTabulated, v), 1e-7);
+        }
+    }
+    {
+        // With explicit tendon compliance, the fiber velocity (and therefore
+        // the derivative of normalized tendon force) is computed from the
+        // inverse of the force-velocity curve. The force-velocity multiplier
+        // is approximately the normalized tendon force.
+        const auto calcNormTendonForceDerivative =
+                [&](const DeGrooteFregly2016Muscle& muscle,
+                        double normTendonForce) -> double {
+            const double tendonLength =
+                    tendonSlackLength *
+                    analytic.calcTendonForceLengthInverseCurve(
+                            normTendonForce);
+            double tendonForce, activationDerivative,
+                    normTendonForceDerivative, implicitResidual;
+            muscle.calcDynamicsFromKinematics(
+                    optimalFiberLength + tendonLength, 0, 1, 1,
+                    normTendonForce, SimTK::NaN, tendonForce,
+                    activationDerivative, normTendonForceDerivative,
+                    implicitResidual);
+            return normTendonForceDerivative;
+        };
+        const auto normTendonForce = createVectorLinspace(1001, 0, 2);
+        for (int i = 0; i < normTendonForce.nrow(); ++i) {
+            const auto& f = normTendonForce[i];
+            checkClose(calcNormTendonForceDerivative(analytic, f),
+                    calcNormTendonForceDerivative(tabulated, f), 1e-6);
+        }
+    }
+
+    {
+        // Muscles share splines only if the curve parameters are the same.
+        DeGrooteFregly2016Muscle stiffAnalytic = analytic;
+        stiffAnalytic.set_active_force_width_scale(1.0);
+        stiffAnalytic.set_tendon_strain_at_one_norm_force(0.04);
+        stiffAnalytic.finalizeFromProperties();
+        DeGrooteFregly2016Muscle stiffTabulated = stiffAnalytic;
+        stiffTabulated.set_curve_evaluation_mode("tabulated");
+        stiffTabulated.finalizeFromProperties();
+        // A copy uses the same splines.
+        DeGrooteFregly2016Muscle copy = stiffTabulated;
+        copy.finalizeFromProperties();
+        for (const auto* muscle : {&stiffTabulated, &copy}) {
+            for (int i = 0; i < normFiberLength.nrow(); ++i) {
+                const auto& x = normFiberLength[i];
+                checkClose(stiffAnalytic.calcActiveForceLengthMultiplier(x),
+                        muscle->calcActiveForceLengthMultiplier(x), 1e-8);
+            }
+            for (int i = 0; i < normTendonForce.nrow(); ++i) {
+                const auto& f = normTendonForce[i];
+                checkClose(stiffAnalytic.calcTendonForceLengthInverseCurve(f),
+                        muscle->calcTendonForceLengthInverseCurve(f), 1e-8);
+            }
+        }
+    }
+
+    tabulated.set_curve_evaluation_mode("polynomial");
+    CHECK_THROWS_WITH(tabulated.finalizeFromProperties(),
+            Catch::Contains("Property 'curve_evaluation_mode'"));
+}
+
 Model createHangingMuscleModel(
         bool ignoreActivationDynamics, bool ignoreTendonCompliance, 
         bool isTendonDynamicsExplicit) {
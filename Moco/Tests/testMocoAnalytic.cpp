@@ -54,8 +54,7 @@ SimTK::Matrix expectedSolution(const SimTK::Vector& time) {
     return expectedStatesTrajectory;
 }
 
-TEMPLATE_TEST_CASE("Second order linear min effort", "", MocoTropterSolver,
-        MocoCasADiSolver) {
+MocoStudy createSecondOrderLinearMinEffortStudy() {
     // Kirk 1998, Example 5.1-1, page 198.
 
     Model model;
@@ -84,7 +83,12 @@ TEMPLATE_TEST_CASE("Second order linear min effort", "", MocoTropterSolver,
     problem.setControlInfo("/forceset/coordinateactuator", {-50, 50});
 
     problem.addGoal<MocoControlGoal>("effort", 0.5);
+    return moco;
+}
 
+TEMPLATE_TEST_CASE("Second order linear min effort", "", MocoTropterSolver,
+        MocoCasADiSolver) {
+    MocoStudy moco = createSecondOrderLinearMinEffortStudy();
     auto& solver = moco.initSolver<TestType>();
     solver.set_num_mesh_intervals(50);
     MocoSolution solution = moco.solve();
@@ -94,6 +98,45 @@ TEMPLATE_TEST_CASE("Second order linear min effort", "", MocoTropterSolver,
     OpenSim_CHECK_MATRIX_ABSTOL(solution.getStatesTrajectory(), expected, 1e-5);
 }
 
+TEST_CASE("Second order linear min effort, Legendre-Gauss-Radau") {
+    // With polynomials of degree 3, 10 mesh intervals are as accurate as 50
+    // mesh intervals with Hermite-Simpson.
+    for (const std::string& scheme :
+            {"legendre-gauss-radau-3", "flipped-legendre-gauss-radau-3"}) {
+        CAPTURE(scheme);
+        MocoStudy moco = createSecondOrderLinearMinEffortStudy();
+        auto& solver = moco.initCasADiSolver();
+        solver.set_transcription_scheme(scheme);
+        solver.set_num_mesh_intervals(10);
+        MocoSolution solution = moco.solve();
+
+        // The grid contains the mesh points and 2 collocation points in
+        // each mesh interval.
+        CHECK(solution.getNumTimes() == 31);
+        CHECK(solution.getTime()[0] == 0);
+        CHECK(solution.getTime()[30] == Approx(2));
+
+        const auto expected = expectedSolution(solution.getTime());
+        OpenSim_CHECK_MATRIX_ABSTOL(
+                solution.getStatesTrajectory(), expected, 1e-5);
+
+        // Compare the Gauss-Radau quadrature of the objective to a
+        // Hermite-Simpson solution on a fine mesh.
+        MocoStudy fine = createSecondOrderLinearMinEffortStudy();
+        fine.initCasADiSolver().set_num_mesh_intervals(100);
+        CHECK(solution.getObjective() ==
+                Approx(fine.solve().getObjective()).epsilon(1e-4));
+    }
+
+    SECTION("Invalid degree") {
+        MocoStudy moco = createSecondOrderLinearMinEffortStudy();
+        auto& solver = moco.initCasADiSolver();
+        solver.set_transcription_scheme("legendre-gauss-radau-10");
+        CHECK_THROWS_WITH(moco.solve(),
+                Catch::Contains("Expected transcription_scheme"));
+    }
+}
+
 /// In the "linear tangent steering" problem, we control the direction to apply
 /// a constant thrust to a point mass to move the mass a given vertical distance
 /// and maximize its final horizontal speed. This problem is described in
@@ -260,6 +260,363 @@ TEMPLATE_TEST_CASE("Solver options", "", MocoTropterSolver, MocoCasADiSolver) {
     }
 }
 
+TEMPLATE_TEST_CASE("Mesh refinement", "", MocoTropterSolver, MocoCasADiSolver) {
+    auto transcriptionScheme =
+            GENERATE(as<std::string>{}, "trapezoidal", "hermite-simpson");
+    MocoStudy study;
+    study.set_write_solution("false");
+    MocoProblem& problem = study.updProblem();
+    problem.setModel(createPendulumModel());
+    problem.setTimeBounds(0, 1);
+    problem.setStateInfo(
+            "/jointset/j0/q0/value", {-10, 10}, 0, 0.5 * SimTK::Pi);
+    problem.setStateInfo("/jointset/j0/q0/speed", {-50, 50}, 0, 0);
+    problem.setControlInfo("/tau0", {-100, 100});
+    problem.addGoal<MocoControlGoal>();
+
+    auto& solver = study.initSolver<TestType>();
+    solver.set_transcription_scheme(transcriptionScheme);
+    solver.set_num_mesh_intervals(50);
+    MocoSolution reference = study.solve();
+
+    solver.set_num_mesh_intervals(5);
+    MocoSolution coarse = study.solve();
+    REQUIRE(coarse.success());
+
+    SECTION("Refinement improves accuracy") {
+        solver.set_mesh_refinement_max_iterations(3);
+        solver.set_mesh_refinement_tolerance(1e-4);
+        MocoSolution refined = study.solve();
+        REQUIRE(refined.success());
+        CHECK(refined.getNumTimes() > coarse.getNumTimes());
+        CHECK(refined.getNumIterations() >= coarse.getNumIterations());
+        const std::map<std::string, std::vector<std::string>> columns = {
+                {"states", {}}};
+        CHECK(refined.compareContinuousVariablesRMS(reference, columns) <
+                coarse.compareContinuousVariablesRMS(reference, columns));
+    }
+
+    SECTION("Maximum number of mesh intervals") {
+        solver.set_mesh_refinement_max_iterations(3);
+        solver.set_mesh_refinement_tolerance(1e-4);
+        solver.set_mesh_refinement_max_intervals(5);
+        MocoSolution refined = study.solve();
+        REQUIRE(refined.success());
+        CHECK(refined.getNumTimes() == coarse.getNumTimes());
+        CHECK(refined.getObjective() == Approx(coarse.getObjective()));
+    }
+}
+
+TEST_CASE("Multiple shooting") {
+    MocoStudy study;
+    study.set_write_solution("false");
+    MocoProblem& problem = study.updProblem();
+    problem.setModel(createPendulumModel());
+    problem.setTimeBounds(0, 1);
+    problem.setStateInfo(
+            "/jointset/j0/q0/value", {-10, 10}, 0, 0.5 * SimTK::Pi);
+    problem.setStateInfo("/jointset/j0/q0/speed", {-50, 50}, 0, 0);
+    problem.setControlInfo("/tau0", {-100, 100});
+    problem.addGoal<MocoControlGoal>();
+
+    auto& solver = study.initCasADiSolver();
+    solver.set_num_mesh_intervals(50);
+    MocoSolution reference = study.solve();
+    REQUIRE(reference.success());
+
+    solver.set_transcription_scheme("multiple-shooting");
+    solver.set_num_mesh_intervals(20);
+
+    SECTION("Agrees with direct collocation") {
+        MocoSolution solution = study.solve();
+        REQUIRE(solution.success());
+        // States and controls exist only at the mesh points.
+        CHECK(solution.getNumTimes() == 21);
+        CHECK(solution.getObjective() ==
+                Approx(reference.getObjective()).epsilon(1e-2));
+        CHECK(solution.compareContinuousVariablesRMS(
+                      reference, {{"states", {}}}) < 1e-2);
+
+        // The final states of each interval are consistent with an accurate
+        // forward simulation of the controls.
+        MocoTrajectory simulated = simulateTrajectoryWithTimeStepping(
+                solution, *createPendulumModel(), 1e-8);
+        CHECK(solution.compareContinuousVariablesRMS(
+                      simulated, {{"states", {}}}) < 1e-3);
+    }
+
+    SECTION("Mesh refinement") {
+        solver.set_num_mesh_intervals(5);
+        MocoSolution coarse = study.solve();
+        REQUIRE(coarse.success());
+
+        solver.set_mesh_refinement_max_iterations(3);
+        solver.set_mesh_refinement_tolerance(1e-4);
+        MocoSolution refined = study.solve();
+        REQUIRE(refined.success());
+        CHECK(refined.getNumTimes() > coarse.getNumTimes());
+        const std::map<std::string, std::vector<std::string>> columns = {
+                {"states", {}}};
+        CHECK(refined.compareContinuousVariablesRMS(reference, columns) <
+                coarse.compareContinuousVariablesRMS(reference, columns));
+    }
+
+    SECTION("Implicit dynamics are not supported") {
+        solver.set_multibody_dynamics_mode("implicit");
+        CHECK_THROWS_WITH(study.solve(),
+                Catch::Contains("Expected multibody_dynamics_mode to be "
+                                "'explicit' with multiple shooting"));
+    }
+}
+
+TEST_CASE("IPOPT linear solver") {
+    MocoStudy study = createSlidingMassMocoStudy<MocoCasADiSolver>();
+    auto& solver = study.updSolver<MocoCasADiSolver>();
+    solver.set_optim_ipopt_linear_solver_ordering("amd");
+    solver.set_optim_ipopt_linear_solver_memory_factor(2);
+
+    SECTION("Solve with a selected linear solver") {
+        solver.set_optim_ipopt_linear_solver("mumps");
+        MocoSolution solution = study.solve();
+        CHECK(solution.success());
+        CHECK(solution.getFinalTime() == Approx(2.0).epsilon(1e-2));
+    }
+
+    SECTION("Benchmark") {
+        // Include an HSL solver, which may not be available; this must not
+        // cause an exception.
+        const auto benchmarks =
+                solver.benchmarkLinearSolvers({"mumps", "ma27"});
+        REQUIRE(benchmarks.size() == 2);
+        const auto& mumps = benchmarks[0];
+        CHECK(mumps.linearSolver == "mumps");
+        REQUIRE(mumps.available);
+        CHECK(mumps.success);
+        CHECK(mumps.numIterations > 0);
+        CHECK(mumps.objective == Approx(2.0).epsilon(1e-2));
+        CHECK(mumps.functionEvaluationTime > 0);
+        CHECK(mumps.solverTime > 0);
+        CHECK(mumps.totalTime > mumps.functionEvaluationTime);
+        if (benchmarks[1].available) {
+            CHECK(benchmarks[1].objective == Approx(mumps.objective));
+        }
+        CHECK_THROWS_WITH(solver.benchmarkLinearSolvers({"pardiso"}),
+                Catch::Contains("but got 'pardiso'"));
+    }
+
+    SECTION("Invalid settings") {
+        solver.set_optim_ipopt_linear_solver("ma77");
+        CHECK_THROWS_WITH(study.solve(),
+                Catch::Contains("optim_ipopt_linear_solver"));
+        solver.set_optim_ipopt_linear_solver("mumps");
+        solver.set_optim_ipopt_linear_solver_memory_factor(0);
+        CHECK_THROWS_WITH(study.solve(),
+                Catch::Contains("Expected optim_ipopt_linear_solver_memory_"
+                                "factor to be positive or -1"));
+    }
+}
+
+TEST_CASE("Timing profile") {
+    MocoStudy study = createSlidingMassMocoStudy<MocoCasADiSolver>();
+    MocoSolution solution = study.solve();
+    REQUIRE(solution.getNumTimingEntries() > 0);
+    const auto names = solution.getTimingEntryNames();
+    for (const auto& name : {"problem_setup", "problem_initialization",
+                 "transcription", "sparsity_detection", "nlp_construction",
+                 "nlp_solve", "optimizer", "problem_rep_wait"}) {
+        INFO(name);
+        CHECK(std::find(names.begin(), names.end(), name) != names.end());
+        CHECK(solution.getTimingEntryDuration(name) >= 0);
+    }
+    CHECK(solution.getTimingEntryNumCalls("nlp_solve") == -1);
+    CHECK(solution.getTimingEntryDuration("nlp_solve") <=
+            solution.getSolverDuration());
+    // Each function evaluation is recorded.
+    CHECK(solution.getTimingEntryNumCalls(
+                  "function_explicit_multibody_system") > 0);
+    CHECK(solution.getTimingEntryDuration(
+                  "function_explicit_multibody_system") > 0);
+    CHECK(solution.getTimingEntryNumCalls("nlp_jac_g") > 0);
+    CHECK_THROWS_WITH(solution.getTimingEntryDuration("nonexistent"),
+            Catch::Contains("Timing entry 'nonexistent' not found"));
+
+    solution.writeTimingProfile("testMocoInterface_timing_profile.csv");
+    std::ifstream file("testMocoInterface_timing_profile.csv");
+    std::string line;
+    std::getline(file, line);
+    CHECK(line == "name,duration,num_calls");
+    int numLines = 0;
+    while (std::getline(file, line)) ++numLines;
+    CHECK(numLines == solution.getNumTimingEntries());
+}
+
+TEMPLATE_TEST_CASE(
+        "Iteration telemetry", "", MocoTropterSolver, MocoCasADiSolver) {
+    MocoStudy study = createSlidingMassMocoStudy<TestType>();
+    auto& solver = study.updSolver<TestType>();
+    const std::string filename = "testMocoInterface_iteration_telemetry.jsonl";
+    std::remove(filename.c_str());
+    solver.set_iteration_telemetry_file(filename);
+    std::vector<MocoIterationInfo> infos;
+    solver.setIterationCallback(
+            [&infos](const MocoIterationInfo& info) -> bool {
+        infos.push_back(info);
+        return true;
+    });
+    MocoSolution solution = study.solve();
+    REQUIRE(solution.success());
+    REQUIRE((int)infos.size() == solution.getNumIterations() + 1);
+    for (int i = 0; i < (int)infos.size(); ++i) {
+        CHECK(infos[i].iteration == i);
+        CHECK(infos[i].primalInfeasibility >= 0);
+        CHECK(infos[i].wallTime >= 0);
+        if (i > 0) {
+            CHECK(infos[i].wallTime >= infos[i - 1].wallTime);
+            CHECK(infos[i].numDynamicsEvaluations >=
+                    infos[i - 1].numDynamicsEvaluations);
+        }
+    }
+    CHECK(infos.back().objective == Approx(solution.getObjective()));
+    CHECK(infos.back().numDynamicsEvaluations > 0);
+
+    std::ifstream file(filename);
+    std::string line;
+    int numLines = 0;
+    while (std::getline(file, line)) {
+        CHECK(line.find("{\"iteration\": " + std::to_string(numLines)) == 0);
+        ++numLines;
+    }
+    CHECK(numLines == (int)infos.size());
+
+    // The callback can stop the solver.
+    solver.set_iteration_telemetry_file("");
+    solver.setIterationCallback(
+            [](const MocoIterationInfo& info) { return info.iteration < 2; });
+    MocoSolution stopped = study.solve();
+    CHECK(!stopped.success());
+    CHECK(stopped.unseal().getNumIterations() <= 2);
+}
+
+TEMPLATE_TEST_CASE(
+        "Warm start multipliers", "", MocoTropterSolver, MocoCasADiSolver) {
+    MocoStudy study;
+    study.set_write_solution("false");
+    MocoProblem& problem = study.updProblem();
+    problem.setModel(createPendulumModel());
+    problem.setTimeBounds(0, 1);
+    problem.setStateInfo(
+            "/jointset/j0/q0/value", {-10, 10}, 0, 0.5 * SimTK::Pi);
+    problem.setStateInfo("/jointset/j0/q0/speed", {-50, 50}, 0, 0);
+    problem.setControlInfo("/tau0", {-100, 100});
+    problem.addGoal<MocoControlGoal>();
+
+    auto& solver = study.initSolver<TestType>();
+    solver.set_num_mesh_intervals(20);
+    MocoSolution solution = study.solve();
+    REQUIRE(solution.success());
+    REQUIRE(solution.hasOptimMultipliers());
+    CHECK(solution.getOptimBoundMultipliers().size() > 0);
+    CHECK(solution.getOptimConstraintMultipliers().size() > 0);
+
+    // Multipliers are kept when the solution is used as a guess.
+    MocoTrajectory guess = solution;
+    CHECK(guess.hasOptimMultipliers());
+
+    solver.setGuess(guess);
+    MocoSolution primalOnly = study.solve();
+    REQUIRE(primalOnly.success());
+
+    solver.set_optim_warm_start_multipliers(true);
+    MocoSolution primalDual = study.solve();
+    REQUIRE(primalDual.success());
+    CHECK(primalDual.getNumIterations() < primalOnly.getNumIterations());
+    CHECK(primalDual.compareContinuousVariablesRMS(solution) ==
+            Approx(0).margin(1e-3));
+
+    // Multipliers for a different mesh are ignored.
+    solver.set_num_mesh_intervals(25);
+    MocoSolution differentMesh = study.solve();
+    CHECK(differentMesh.success());
+}
+
+TEMPLATE_TEST_CASE("solveContinuation()", "", MocoTropterSolver,
+        MocoCasADiSolver) {
+    MocoStudy study;
+    study.set_write_solution("false");
+    MocoProblem& problem = study.updProblem();
+    problem.setModel(createPendulumModel());
+    problem.setTimeBounds(0, 1);
+    problem.setStateInfo(
+            "/jointset/j0/q0/value", {-10, 10}, 0, 0.5 * SimTK::Pi);
+    problem.setStateInfo("/jointset/j0/q0/speed", {-50, 50}, 0, 0);
+    problem.setControlInfo("/tau0", {-100, 100});
+    problem.addGoal<MocoControlGoal>("effort");
+    auto& solver = study.initSolver<TestType>();
+    solver.set_num_mesh_intervals(20);
+
+    const std::vector<std::vector<MocoContinuationChange>> schedule = {
+            {},
+            {{"/bodyset/b0", "mass", 1.1}},
+            {{"/bodyset/b0", "mass", 1.2}, {"effort", "weight", 2.0}}};
+    const auto solutions = study.solveContinuation(schedule);
+    REQUIRE(solutions.size() == 3);
+    for (const auto& solution : solutions) {
+        CHECK(solution.success());
+        CHECK(solution.getNumIterations() > 0);
+    }
+
+    // The study itself is unchanged.
+    CHECK(study.getProblem().getPhase(0).getGoal("effort").getWeight() ==
+            Approx(1.0));
+
+    // The last step solves the final problem.
+    problem.updGoal("effort").setWeight(2.0);
+    Model model = problem.getPhase(0).getModelProcessor().process();
+    model.updComponent<Body>("/bodyset/b0").setMass(1.2);
+    problem.setModelCopy(model);
+    study.initSolver<TestType>().set_num_mesh_intervals(20);
+    MocoSolution direct = study.solve();
+    CHECK(solutions.back().compareContinuousVariablesRMS(direct) ==
+            Approx(0).margin(1e-3));
+    CHECK(solutions.back().getObjective() ==
+            Approx(direct.getObjective()).epsilon(1e-4));
+
+    const std::vector<std::vector<MocoContinuationChange>> invalid = {
+            {{"effort", "nonexistent", 1.0}}};
+    CHECK_THROWS_WITH(study.solveContinuation(invalid),
+            Catch::Contains("has no property 'nonexistent'"));
+}
+
+TEST_CASE("solveContinuation() reuses sparsity patterns") {
+    MocoStudy study;
+    study.set_write_solution("false");
+    MocoProblem& problem = study.updProblem();
+    problem.setModel(createPendulumModel());
+    problem.setTimeBounds(0, 1);
+    problem.setStateInfo(
+            "/jointset/j0/q0/value", {-10, 10}, 0, 0.5 * SimTK::Pi);
+    problem.setStateInfo("/jointset/j0/q0/speed", {-50, 50}, 0, 0);
+    problem.setControlInfo("/tau0", {-100, 100});
+    problem.addGoal<MocoControlGoal>("effort");
+    auto& solver = study.initCasADiSolver();
+    solver.set_num_mesh_intervals(20);
+    solver.set_optim_sparsity_detection("random");
+
+    // Only the weight changes in step 1, so its sparsity is not detected
+    // again; the model changes in step 2, so its sparsity is detected.
+    const std::vector<std::vector<MocoContinuationChange>> schedule = {
+            {}, {{"effort", "weight", 2.0}}, {{"/bodyset/b0", "mass", 1.1}}};
+    const auto solutions = study.solveContinuation(schedule);
+    REQUIRE(solutions.size() == 3);
+    for (const auto& solution : solutions) CHECK(solution.success());
+    CHECK(solutions[0].getTimingEntryDuration("sparsity_detection") > 0);
+    CHECK(solutions[1].getTimingEntryDuration("sparsity_detection") == 0);
+    CHECK(solutions[2].getTimingEntryDuration("sparsity_detection") > 0);
+
+    // The study's own solver does not reuse patterns.
+    CHECK(!study.updSolver<MocoCasADiSolver>().getReuseSparsityPatterns());
+}
+
 /*
 
 TEST_CASE("Ordering of calls") {
@@ -1968,6 +2325,147 @@ TEST_CASE("solveBisection()") {
     }
 }
 
+TEST_CASE("solveNewtonBisection()") {
+
+    {
+        auto calcResidual = [](const SimTK::Real& x, SimTK::Real& deriv) {
+            deriv = 3 * SimTK::square(x) - 2;
+            return SimTK::cube(x) - 2 * x - 5;
+        };
+        const auto result = solveNewtonBisection(calcResidual, 0, 5, 1e-12);
+        CHECK(result.converged);
+        CHECK(result.root == Approx(2.0945514815423265).epsilon(1e-12));
+        CHECK(std::abs(result.residual) < 1e-10);
+        // Bisection would require about 42 iterations.
+        CHECK(result.numIterations < 10);
+        CHECK(result.numNewtonSteps > 0);
+    }
+
+    // An inaccurate derivative slows convergence but the root is still
+    // found.
+    {
+        auto calcResidual = [](const SimTK::Real& x, SimTK::Real& deriv) {
+            deriv = 0;
+            return x - 3.78;
+        };
+        const auto result = solveNewtonBisection(calcResidual, -5, 5, 1e-10);
+        CHECK(result.converged);
+        CHECK(result.numNewtonSteps == 0);
+        SimTK_TEST_EQ_TOL(result.root, 3.78, 1e-10);
+    }
+
+    // Reaching the max iterations.
+    {
+        auto calcResidual = [](const SimTK::Real& x, SimTK::Real& deriv) {
+            deriv = 0;
+            return x - 3.78;
+        };
+        const auto result =
+                solveNewtonBisection(calcResidual, -5, 5, 1e-10, 5);
+        CHECK(!result.converged);
+        CHECK(result.numIterations == 5);
+    }
+
+    // Multiple roots.
+    {
+        auto parabola = [](const SimTK::Real& x, SimTK::Real& deriv) {
+            deriv = 2 * (x - 2.5);
+            return SimTK::square(x - 2.5);
+        };
+        REQUIRE_THROWS_AS(solveNewtonBisection(parabola, -5, 5), Exception);
+    }
+}
+
+TEST_CASE("computeMuscleGeometry()") {
+    // The muscle spans only the second coordinate.
+    Model model = ModelFactory::createDoublePendulum();
+    auto* muscle = new DeGrooteFregly2016Muscle();
+    muscle->setName("muscle");
+    muscle->addNewPathPoint("origin", model.getBodySet().get("b0"),
+            SimTK::Vec3(-0.5, 0.1, 0));
+    muscle->addNewPathPoint("insertion", model.getBodySet().get("b1"),
+            SimTK::Vec3(-0.5, 0.1, 0));
+    model.addForce(muscle);
+    model.finalizeConnections();
+
+    const int numTimes = 25;
+    std::vector<double> time(numTimes);
+    SimTK::Matrix data(numTimes, 2);
+    for (int i = 0; i < numTimes; ++i) {
+        time[i] = 0.05 * i;
+        data(i, 0) = std::sin(3 * time[i]);
+        data(i, 1) = 0.5 * std::cos(2 * time[i]) + time[i];
+    }
+    const TimeSeriesTable table(time, data,
+            {"/jointset/j0/q0/value", "/jointset/j1/q1/value"});
+
+    const auto dense = computeMuscleGeometry(model, table, false, 0);
+    const auto sparse = computeMuscleGeometry(model, table, true, 3);
+    REQUIRE(dense.musclePaths == std::vector<std::string>{"/forceset/muscle"});
+    REQUIRE(dense.coordinatePaths ==
+            std::vector<std::string>{"/jointset/j0/q0", "/jointset/j1/q1"});
+    CHECK(dense.spannedCoordinates == std::vector<std::vector<int>>{{0, 1}});
+    CHECK(sparse.spannedCoordinates == std::vector<std::vector<int>>{{1}});
+
+    // Compare to evaluating the muscle directly.
+    const GCVSplineSet splines(table);
+    SimTK::State state = model.initSystem();
+    const auto& coordSet = model.getCoordinateSet();
+    SimTK::Vector splineTime(1);
+    for (int itime = 0; itime < numTimes; ++itime) {
+        CAPTURE(itime);
+        state.setTime(time[itime]);
+        splineTime[0] = time[itime];
+        for (int ic = 0; ic < 2; ++ic) {
+            coordSet.get(ic).setValue(state, data(itime, ic), false);
+            coordSet.get(ic).setSpeedValue(
+                    state, splines.get(ic).calcDerivative({0}, splineTime));
+        }
+        model.realizeVelocity(state);
+        const double length = muscle->getLength(state);
+        const double speed = muscle->getLengtheningSpeed(state);
+        const double r1 = muscle->computeMomentArm(state, coordSet.get(1));
+        for (const auto* geometry : {&dense, &sparse}) {
+            CHECK(geometry->lengths(itime, 0) == Approx(length));
+            CHECK(geometry->lengtheningSpeeds(itime, 0) == Approx(speed));
+            CHECK(geometry->momentArms[itime](0, 1) == Approx(r1));
+        }
+        CHECK(std::abs(dense.momentArms[itime](0, 0)) < 1e-10);
+        CHECK(sparse.momentArms[itime](0, 0) == 0);
+    }
+
+    CHECK_THROWS_AS(computeMuscleGeometry(model,
+                            TimeSeriesTable(time, data,
+                                    {"/jointset/j0/q0/value", "extra"})),
+            Exception);
+}
+
+TEST_CASE("performTasksInParallel()") {
+    CHECK(getNumThreadsForParallel(0) == 1);
+    CHECK(getNumThreadsForParallel(1) >= 1);
+    CHECK(getNumThreadsForParallel(5) == 5);
+    CHECK(getNumThreadsForParallel(5, 3) == 3);
+
+    const int numThreads = 4;
+    const int numTasks = 100;
+    std::vector<int> threadIndices(numTasks, -1);
+    performTasksInParallel(numThreads, numTasks, [&](int ithread, int itask) {
+        threadIndices[itask] = ithread;
+    });
+    for (const auto& ithread : threadIndices) {
+        CHECK(ithread >= 0);
+        CHECK(ithread < numThreads);
+    }
+
+    CHECK_THROWS_WITH(performTasksInParallel(numThreads, numTasks,
+                              [](int, int itask) {
+                                  if (itask == 10) {
+                                      throw Exception("task failed");
+                                  }
+                              }),
+            Catch::Contains("task failed"));
+}
+
 TEST_CASE("Objective breakdown") {
     class MocoConstantGoal : public MocoGoal {
         OpenSim_DECLARE_CONCRETE_OBJECT(MocoConstantGoal, MocoGoal);
@@ -20,6 +20,8 @@
 
 #include <OpenSim/Common/LogManager.h>
 
+#include <chrono>
+
 #define CATCH_CONFIG_MAIN
 #include "Testing.h"
 
@@ -64,6 +66,87 @@ TEST_CASE("PrescribedKinematics prescribe() and realize()") {
     CHECK(ydot[1] == Approx(2 * c2));
 }
 
+// PositionMotion converts the GCVSplines from createFromTable() into a table
+// of polynomials; make sure the result matches the splines.
+TEST_CASE("PositionMotion piecewise polynomials match GCVSplines") {
+    Model model = ModelFactory::createDoublePendulum();
+    const int numTimes = 31;
+    std::vector<double> time(numTimes);
+    SimTK::Matrix data(numTimes, 2);
+    for (int i = 0; i < numTimes; ++i) {
+        time[i] = 0.2 + 0.05 * i;
+        data(i, 0) = std::sin(3 * time[i]);
+        data(i, 1) = 0.5 * std::cos(2 * time[i]) + time[i];
+    }
+    const TimeSeriesTable table(time, data,
+            {"/jointset/j0/q0/value", "/jointset/j1/q1/value"});
+    const GCVSplineSet splines(table);
+    Model modelDirect = model;
+    model.addModelComponent(
+            PositionMotion::createFromTable(model, table).release());
+    auto state = model.initSystem();
+    REQUIRE(model.getComponentList<PositionMotion>()
+                    .begin()
+                    ->isUsingPolynomialTable());
+
+    const auto& system = model.getSystem();
+    SimTK::Vector splineTime(1);
+    // Evaluate out of order, at the knots, between the knots, and outside the
+    // knots.
+    for (const double t : {0.2, 0.2125, 0.95, 0.4, 0.41, 1.7, 0.1, 1.8, 0.6}) {
+        CAPTURE(t);
+        state.setTime(t);
+        system.prescribe(state);
+        model.realizeAcceleration(state);
+        splineTime[0] = t;
+        for (int i = 0; i < 2; ++i) {
+            const auto& spline = splines.get(i);
+            CHECK(state.getQ()[i] ==
+                    Approx(spline.calcValue(splineTime)).margin(1e-10));
+            CHECK(state.getU()[i] ==
+                    Approx(spline.calcDerivative({0}, splineTime))
+                            .margin(1e-8));
+            CHECK(state.getUDot()[i] ==
+                    Approx(spline.calcDerivative({0, 0}, splineTime))
+                            .margin(1e-6));
+        }
+    }
+
+    // Compare the time to prescribe the motion with the time to evaluate the
+    // splines directly. The splines for the direct evaluation have different
+    // knots, so PositionMotion does not convert them into a table.
+    auto* motionDirect = new PositionMotion();
+    motionDirect->setPositionForCoordinate(
+            modelDirect.getCoordinateSet().get(0), splines.get(0));
+    std::vector<double> q1(numTimes - 1);
+    for (int i = 0; i < numTimes - 1; ++i) q1[i] = data(i, 1);
+    motionDirect->setPositionForCoordinate(
+            modelDirect.getCoordinateSet().get(1),
+            GCVSpline(5, numTimes - 1, time.data(), q1.data()));
+    modelDirect.addModelComponent(motionDirect);
+    auto stateDirect = modelDirect.initSystem();
+    REQUIRE_FALSE(motionDirect->isUsingPolynomialTable());
+
+    auto timePrescribe = [](const Model& timedModel,
+                                 SimTK::State& timedState) -> double {
+        const int numEvals = 20000;
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < numEvals; ++i) {
+            timedState.setTime(0.2 + 1.4 * i / numEvals);
+            timedModel.getSystem().prescribe(timedState);
+            timedModel.realizeAcceleration(timedState);
+        }
+        return std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - start)
+                .count();
+    };
+    const double durationTable = timePrescribe(model, state);
+    const double durationDirect = timePrescribe(modelDirect, stateDirect);
+    std::cout << "PositionMotion prescribe and realize (s): polynomial table "
+              << durationTable << ", splines " << durationDirect << std::endl;
+    CHECK(durationTable < durationDirect);
+}
+
 TEST_CASE("PrescribedKinematics direct collocation auxiliary dynamics") {
 
     // Make sure that custom dynamics are still handled properly even when
@@ -117,6 +200,59 @@ TEST_CASE("PrescribedKinematics direct collocation auxiliary dynamics") {
             0.2 * SimTK::exp(solution.getTime()), 1e-4);
 }
 
+// Precomputing the kinematics must not change the problem.
+TEST_CASE("MocoInverse precompute_prescribed_kinematics") {
+    Model model = ModelFactory::createPendulum();
+    auto* muscle = new DeGrooteFregly2016Muscle();
+    muscle->setName("muscle");
+    muscle->set_max_isometric_force(100);
+    muscle->set_optimal_fiber_length(0.2);
+    muscle->set_tendon_slack_length(0.1);
+    muscle->set_ignore_tendon_compliance(false);
+    muscle->set_tendon_compliance_dynamics_mode("implicit");
+    muscle->addNewPathPoint(
+            "origin", model.getGround(), SimTK::Vec3(0.5, 0.3, 0));
+    muscle->addNewPathPoint("insertion", model.getBodySet().get("b0"),
+            SimTK::Vec3(-0.5, 0, 0));
+    model.addForce(muscle);
+    model.finalizeConnections();
+
+    const int numTimes = 21;
+    std::vector<double> time(numTimes);
+    SimTK::Matrix data(numTimes, 1);
+    for (int i = 0; i < numTimes; ++i) {
+        time[i] = 0.05 * i;
+        data(i, 0) = -0.3 + 0.2 * std::sin(2 * SimTK::Pi * time[i]);
+    }
+
+    MocoInverse inverse;
+    inverse.setModel(ModelProcessor(model));
+    inverse.setKinematics(TableProcessor(
+            TimeSeriesTable(time, data, {"/jointset/j0/q0/value"})));
+    inverse.set_mesh_interval(0.05);
+    MocoStudy study = inverse.initialize();
+    auto& solver = study.updSolver<MocoCasADiSolver>();
+    solver.set_precompute_prescribed_kinematics(false);
+    MocoSolution expected = study.solve();
+    solver.set_precompute_prescribed_kinematics(true);
+    MocoSolution actual = study.solve();
+    REQUIRE(expected.success());
+    REQUIRE(actual.success());
+    // The kinematics were precomputed only in the second solve.
+    const auto hasPrecomputedEntry =
+            [](const MocoSolution& solution) -> bool {
+        const auto names = solution.getTimingEntryNames();
+        return std::find(names.begin(), names.end(),
+                       "precomputed_kinematics") != names.end();
+    };
+    CHECK_FALSE(hasPrecomputedEntry(expected));
+    REQUIRE(hasPrecomputedEntry(actual));
+    CHECK(actual.getTimingEntryNumCalls("precomputed_kinematics") > 0);
+    CHECK(actual.compareContinuousVariablesRMS(expected) < 1e-4);
+    CHECK(actual.getObjective() ==
+            Approx(expected.getObjective()).epsilon(1e-4));
+}
+
 TEST_CASE("MocoInverse Rajagopal2016, 18 muscles") {
     std::cout.rdbuf(LogManager::cout.rdbuf());
     std::cerr.rdbuf(LogManager::cerr.rdbuf());
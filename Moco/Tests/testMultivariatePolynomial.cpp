@@ -21,6 +21,8 @@
 
 #include <Moco/osimMoco.h>
 
+#include <fstream>
+
 using namespace OpenSim;
 
 // Create a single leg 2D model with two muscles to test the estimation of
@@ -273,3 +275,66 @@ TEST_CASE("testPolynomialApproximation") {
     testPolynomialApproximationImpl();
     testPolynomialApproximation();
 }
+
+// Fit polynomials to the geometric paths of the muscles in the model and
+// compare the approximations to the geometric paths.
+TEST_CASE("ModOpReplacePathsWithPolynomials") {
+    Model model = createModel();
+    for (auto& muscle : model.updComponentList<Muscle>()) {
+        auto& path = muscle.updGeometryPath();
+        path.set_use_approximation(false);
+        path.updProperty_length_approximation().clear();
+        path.updProperty_approximation_coordinates().clear();
+    }
+    ModOpReplacePathsWithPolynomials modOp(9, 0.003);
+    modOp.set_num_samples(500);
+    modOp.set_report_file("testMultivariatePolynomial_fit_report.txt");
+    ModelProcessor modelProcessor =
+            ModelProcessor(model) | ModOpReplacePathsWithPolynomials(modOp);
+    Model processed = modelProcessor.process();
+    processed.initSystem();
+
+    const auto& hip_flexion = processed.getCoordinateSet().get("hip_flexion");
+    const auto& knee_angle = processed.getCoordinateSet().get("knee_angle");
+    for (const auto& name : {"hamstrings", "RF"}) {
+        CAPTURE(name);
+        const auto& path =
+                processed.getComponent<PathActuator>(name).getGeometryPath();
+        REQUIRE(path.get_use_approximation());
+        REQUIRE(path.getProperty_approximation_coordinates().size() == 2);
+        CHECK(path.get_approximation_coordinates(0) ==
+                "/jointset/hip/hip_flexion");
+        CHECK(path.get_approximation_coordinates(1) ==
+                "/jointset/knee/knee_angle");
+        CHECK(path.computeApproximationErrorOnGrid(40, "length") < 3e-3);
+        CHECK(path.computeApproximationErrorOnGrid(
+                      40, "moment_arm", &hip_flexion) < 3e-3);
+        CHECK(path.computeApproximationErrorOnGrid(
+                      40, "moment_arm", &knee_angle) < 3e-3);
+    }
+
+    // The report lists each muscle.
+    std::ifstream report("testMultivariatePolynomial_fit_report.txt");
+    const std::string contents((std::istreambuf_iterator<char>(report)),
+            std::istreambuf_iterator<char>());
+    CHECK(contents.find("/hamstrings") != std::string::npos);
+    CHECK(contents.find("/RF") != std::string::npos);
+
+    // Fitting in series gives the same polynomials. The paths of this model
+    // already use approximations, but the fit samples the original paths.
+    Model modelSeries = createModel();
+    const auto fitsSeries = ModelFactory::replacePathsWithPolynomials(
+            modelSeries, 9, 0.003, 0.003, 500, 0);
+    REQUIRE(fitsSeries.size() == 2);
+    for (const auto& fit : fitsSeries) {
+        CAPTURE(fit.muscle);
+        CHECK(fit.replaced);
+        const auto& path = processed.getComponent<PathActuator>(fit.muscle)
+                                   .getGeometryPath();
+        const auto& polynomial =
+                dynamic_cast<const MultivariatePolynomialFunction&>(
+                        path.get_length_approximation(0));
+        CHECK(polynomial.getOrder() == fit.order);
+        SimTK_TEST_EQ(polynomial.getCoefficients(), fit.coefficients);
+    }
+}
@@ -0,0 +1,219 @@
+/* -------------------------------------------------------------------------- *
+ * OpenSim Moco: testMultivariatePolynomialFunction.cpp                       *
+ * -------------------------------------------------------------------------- *
+ * Copyright (c) 2026 Stanford University and the Authors                     *
+ *                                                                            *
+ * Author(s): agent                                                           *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0          *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// These tests use only MultivariatePolynomialFunction (and
+// SimTKMultivariatePolynomial), not GeometryPath's polynomial approximation,
+// which testMultivariatePolynomial requires.
+
+#define CATCH_CONFIG_MAIN
+#include "Testing.h"
+
+#include <Moco/Components/MultivariatePolynomialFunction.h>
+
+#include <array>
+#include <chrono>
+#include <iomanip>
+
+using namespace OpenSim;
+
+// Reference implementation of the polynomial that recomputes each power with
+// std::pow, as in the original implementation of
+// SimTKMultivariatePolynomial. If derivComponent >= 0, compute the derivative
+// with respect to that component instead.
+double calcPolynomialReference(const SimTK::Vector& coefficients,
+        int dimension, int order, const SimTK::Vector& x,
+        int derivComponent = -1) {
+    std::array<int, 4> nq{{0, 0, 0, 0}};
+    double value = 0;
+    int coeff_nr = 0;
+    for (nq[0] = 0; nq[0] < order + 1; ++nq[0]) {
+        const int nq2_s = dimension < 2 ? 0 : order - nq[0];
+        for (nq[1] = 0; nq[1] < nq2_s + 1; ++nq[1]) {
+            const int nq3_s = dimension < 3 ? 0 : order - nq[0] - nq[1];
+            for (nq[2] = 0; nq[2] < nq3_s + 1; ++nq[2]) {
+                const int nq4_s =
+                        dimension < 4 ? 0 : order - nq[0] - nq[1] - nq[2];
+                for (nq[3] = 0; nq[3] < nq4_s + 1; ++nq[3]) {
+                    double valueP = 1;
+                    for (int i = 0; i < dimension; ++i) {
+                        if (i == derivComponent) {
+                            valueP *= nq[i] *
+                                      std::pow(x[i], std::max(nq[i] - 1, 0));
+                        } else {
+                            valueP *= std::pow(x[i], nq[i]);
+                        }
+                    }
+                    value += valueP * coefficients[coeff_nr];
+                    ++coeff_nr;
+                }
+            }
+        }
+    }
+    return value;
+}
+
+int calcNumCoefficients(int dimension, int order) {
+    int numCoefficients = 1;
+    for (int i = 1; i <= dimension; ++i) {
+        numCoefficients = numCoefficients * (order + i) / i;
+    }
+    return numCoefficients;
+}
+
+TEST_CASE("SimTKMultivariatePolynomial matches reference implementation") {
+    SimTK::Random::Uniform random(-1.5, 1.5);
+    random.setSeed(1);
+    // Orders above 6 use the generic (not specialized) evaluator.
+    for (int dimension = 1; dimension <= 4; ++dimension) {
+        for (int order = 0; order <= 8; ++order) {
+            CAPTURE(dimension);
+            CAPTURE(order);
+            SimTK::Vector coefficients(
+                    calcNumCoefficients(dimension, order));
+            random.fillArray(&coefficients[0], coefficients.size());
+            SimTKMultivariatePolynomial<double> polynomial(
+                    coefficients, dimension, order);
+            SimTK::Vector x(dimension);
+            SimTK::Vector derivatives;
+            for (int itrial = 0; itrial < 10; ++itrial) {
+                random.fillArray(&x[0], dimension);
+                const double expected = calcPolynomialReference(
+                        coefficients, dimension, order, x);
+                CHECK(polynomial.calcValue(x) ==
+                        Approx(expected).margin(1e-9));
+                const double value =
+                        polynomial.calcValueAndDerivatives(x, derivatives);
+                CHECK(value == Approx(expected).margin(1e-9));
+                REQUIRE(derivatives.size() == dimension);
+                for (int i = 0; i < dimension; ++i) {
+                    const double expectedDeriv = calcPolynomialReference(
+                            coefficients, dimension, order, x, i);
+                    CHECK(polynomial.calcDerivative(
+                                  std::vector<int>{i}, x) ==
+                            Approx(expectedDeriv).margin(1e-9));
+                    CHECK(derivatives[i] ==
+                            Approx(expectedDeriv).margin(1e-9));
+                }
+            }
+        }
+    }
+
+    SECTION("Batched evaluation") {
+        const int dimension = 3;
+        const int order = 4;
+        SimTK::Vector coefficients(calcNumCoefficients(dimension, order));
+        random.fillArray(&coefficients[0], coefficients.size());
+        SimTKMultivariatePolynomial<double> polynomial(
+                coefficients, dimension, order);
+        SimTK::Matrix x(5, dimension);
+        random.fillArray(&x(0, 0), x.nrow() * x.ncol());
+        SimTK::Vector values;
+        SimTK::Matrix derivatives;
+        polynomial.calcValuesAndDerivatives(x, values, derivatives);
+        REQUIRE(values.size() == x.nrow());
+        REQUIRE(derivatives.nrow() == x.nrow());
+        REQUIRE(derivatives.ncol() == dimension);
+        for (int irow = 0; irow < x.nrow(); ++irow) {
+            SimTK::Vector point = x.row(irow).transpose();
+            CHECK(values[irow] == Approx(calcPolynomialReference(
+                    coefficients, dimension, order, point)));
+            for (int i = 0; i < dimension; ++i) {
+                CHECK(derivatives(irow, i) ==
+                        Approx(calcPolynomialReference(coefficients,
+                                dimension, order, point, i)));
+            }
+        }
+        CHECK_THROWS(polynomial.calcValuesAndDerivatives(
+                SimTK::Matrix(5, 2), values, derivatives));
+    }
+}
+
+// Compare the time to evaluate a polynomial and all of its derivatives (as
+// needed for a muscle-tendon length and its moment arms) with the reference
+// implementation and with calcValue() and calcDerivative().
+TEST_CASE("SimTKMultivariatePolynomial benchmark") {
+    using clock = std::chrono::high_resolution_clock;
+    const int numPoints = 100000;
+    SimTK::Random::Uniform random(-1.0, 1.0);
+    random.setSeed(0);
+    std::cout << std::setw(10) << "dimension" << std::setw(8) << "order"
+              << std::setw(14) << "reference" << std::setw(14) << "separate"
+              << std::setw(14) << "together" << " (ns per point)"
+              << std::endl;
+    for (int dimension = 1; dimension <= 4; ++dimension) {
+        for (int order : {3, 5, 7}) {
+            SimTK::Vector coefficients(
+                    calcNumCoefficients(dimension, order));
+            random.fillArray(&coefficients[0], coefficients.size());
+            SimTKMultivariatePolynomial<double> polynomial(
+                    coefficients, dimension, order);
+            SimTK::Vector x(dimension);
+            SimTK::Vector derivatives;
+            double sumReference = 0;
+            double sumSeparate = 0;
+            double sumTogether = 0;
+
+            auto start = clock::now();
+            for (int ipoint = 0; ipoint < numPoints; ++ipoint) {
+                x = (double)ipoint / numPoints;
+                sumReference += calcPolynomialReference(
+                        coefficients, dimension, order, x);
+                for (int i = 0; i < dimension; ++i) {
+                    sumReference += calcPolynomialReference(
+                            coefficients, dimension, order, x, i);
+                }
+            }
+            const double reference =
+                    std::chrono::duration<double, std::nano>(
+                            clock::now() - start).count() / numPoints;
+
+            start = clock::now();
+            for (int ipoint = 0; ipoint < numPoints; ++ipoint) {
+                x = (double)ipoint / numPoints;
+                sumSeparate += polynomial.calcValue(x);
+                for (int i = 0; i < dimension; ++i) {
+                    sumSeparate += polynomial.calcDerivative(
+                            std::vector<int>{i}, x);
+                }
+            }
+            const double separate =
+                    std::chrono::duration<double, std::nano>(
+                            clock::now() - start).count() / numPoints;
+
+            start = clock::now();
+            for (int ipoint = 0; ipoint < numPoints; ++ipoint) {
+                x = (double)ipoint / numPoints;
+                sumTogether +=
+                        polynomial.calcValueAndDerivatives(x, derivatives);
+                for (int i = 0; i < dimension; ++i) {
+                    sumTogether += derivatives[i];
+                }
+            }
+            const double together =
+                    std::chrono::duration<double, std::nano>(
+                            clock::now() - start).count() / numPoints;
+
+            std::cout << std::setw(10) << dimension << std::setw(8) << order
+                      << std::setw(14) << reference << std::setw(14)
+                      << separate << std::setw(14) << together << std::endl;
+            // This also prevents the compiler from removing the loops.
+            CHECK(sumSeparate == Approx(sumReference));
+            CHECK(sumTogether == Approx(sumReference));
+        }
+    }
+}
@@ -0,0 +1,131 @@
+// ----------------------------------------------------------------------------
+// tropter: sandbox_sparsity_pattern.cpp
+// ----------------------------------------------------------------------------
+// Copyright (c) 2017 tropter authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may
+// not use this file except in compliance with the License. You may obtain a
+// copy of the License at http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+// Benchmark of the time to construct the sparsity patterns of the Jacobian and
+// Hessian for direct collocation problems of increasing mesh size. The
+// patterns mimic those from the trapezoidal transcription: 2 time variables
+// coupled to everything, and a dense block of continuous variables per mesh
+// point, with the defects at mesh interval i depending on mesh points i and
+// i + 1.
+
+#include <tropter/SparsityPattern.h>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+using namespace tropter;
+
+struct Timings {
+    double jacobian = 0;
+    double convert = 0;
+    double hessian_from_jacobian = 0;
+    double hessian_blocks = 0;
+    double convert_full = 0;
+    int num_jacobian_nonzeros = 0;
+    int num_hessian_nonzeros = 0;
+};
+
+Timings run(int num_mesh_points, int num_states, int num_controls) {
+    using clock = std::chrono::high_resolution_clock;
+    auto seconds = [](clock::time_point start) {
+        return std::chrono::duration<double>(clock::now() - start).count();
+    };
+    const int num_dense_variables = 2;
+    const int num_con_vars = num_states + num_controls;
+    const int num_variables =
+            num_dense_variables + num_mesh_points * num_con_vars;
+    const int num_defects = (num_mesh_points - 1) * num_states;
+    Timings timings;
+
+    auto start = clock::now();
+    SparsityPattern jacobian(num_defects, num_variables);
+    jacobian.reserve(num_defects * (num_dense_variables + 2 * num_con_vars));
+    for (int imesh = 0; imesh < num_mesh_points - 1; ++imesh) {
+        const int icolstart = num_dense_variables + imesh * num_con_vars;
+        for (int istate = 0; istate < num_states; ++istate) {
+            const int irow = imesh * num_states + istate;
+            for (int icol = 0; icol < num_dense_variables; ++icol) {
+                jacobian.set_nonzero(irow, icol);
+            }
+            for (int icol = 0; icol < 2 * num_con_vars; ++icol) {
+                jacobian.set_nonzero(irow, icolstart + icol);
+            }
+        }
+    }
+    timings.num_jacobian_nonzeros = jacobian.get_num_nonzeros();
+    timings.jacobian = seconds(start);
+
+    start = clock::now();
+    auto crs = jacobian.convert_to_CompressedRowSparsity();
+    timings.convert = seconds(start);
+
+    start = clock::now();
+    auto hescon = SymmetricSparsityPattern::create_from_jacobian_sparsity(
+            jacobian);
+    timings.hessian_from_jacobian = seconds(start);
+
+    start = clock::now();
+    SymmetricSparsityPattern hessian(num_variables);
+    for (int irow = 0; irow < num_dense_variables; ++irow) {
+        for (int icol = irow; icol < num_variables; ++icol) {
+            hessian.set_nonzero(irow, icol);
+        }
+    }
+    SymmetricSparsityPattern block(num_con_vars);
+    block.set_dense();
+    hessian.set_nonzero_block_repeated(num_dense_variables, num_con_vars,
+            num_mesh_points, block);
+    hessian.add_in_nonzeros(hescon);
+    timings.num_hessian_nonzeros = hessian.get_num_nonzeros();
+    timings.hessian_blocks = seconds(start);
+
+    start = clock::now();
+    auto full = hessian.convert_full();
+    full.get_num_nonzeros();
+    timings.convert_full = seconds(start);
+
+    return timings;
+}
+
+int main() {
+    // Roughly the size of a 2D gait model with muscles.
+    const int num_states = 40;
+    const int num_controls = 20;
+    std::cout << "Time (s) to construct sparsity patterns with "
+            << num_states << " states and " << num_controls
+            << " controls.\n";
+    std::cout << std::setw(8) << "mesh"
+            << std::setw(12) << "jac nnz"
+            << std::setw(12) << "hes nnz"
+            << std::setw(12) << "jacobian"
+            << std::setw(12) << "to CRS"
+            << std::setw(12) << "J^T J"
+            << std::setw(12) << "blocks"
+            << std::setw(12) << "full" << std::endl;
+    for (int num_mesh_points : {10, 30, 100, 300, 1000, 3000}) {
+        const auto t = run(num_mesh_points, num_states, num_controls);
+        std::cout << std::setw(8) << num_mesh_points
+                << std::setw(12) << t.num_jacobian_nonzeros
+                << std::setw(12) << t.num_hessian_nonzeros
+                << std::setw(12) << t.jacobian
+                << std::setw(12) << t.convert
+                << std::setw(12) << t.hessian_from_jacobian
+                << std::setw(12) << t.hessian_blocks
+                << std::setw(12) << t.convert_full << std::endl;
+    }
+    return EXIT_SUCCESS;
+}
@@ -17,6 +17,7 @@
 #include <catch.hpp>
 
 #include <tropter/tropter.h>
+#include <tropter/optimization/internal/GraphColoring.h>
 
 #include "testing.h"
 
@@ -498,6 +499,38 @@ TEST_CASE("Check derivatives with analytical deriv.; sparse Jacobian.")
         }
     }
 
+    SECTION("Finite differences with adaptive step sizes") {
+        for (const std::string mode : {"adaptive", "adaptive-curvature"}) {
+            SparseJacobian<double> problemd;
+            auto proxy = problemd.make_decorator();
+            proxy->set_findiff_step_size_mode(mode);
+            SparsityCoordinates jac_sparsity;
+            SparsityCoordinates hes_sparsity;
+            proxy->calc_sparsity(proxy->make_initial_guess_from_bounds(),
+                    jac_sparsity, true, hes_sparsity);
+
+            VectorXd fd_gradient(problem.get_num_variables());
+            proxy->calc_gradient(problem.get_num_variables(), x.data(), true,
+                    fd_gradient.data());
+            INFO(mode);
+            TROPTER_REQUIRE_EIGEN(analytical_gradient, fd_gradient, 1e-7);
+
+            VectorXd fd_jacobian_values(num_jacobian_elem);
+            proxy->calc_jacobian(problem.get_num_variables(), x.data(), true,
+                    num_jacobian_elem, fd_jacobian_values.data());
+            for (int inz = 0; inz < (int)num_jacobian_elem; ++inz) {
+                const auto& i = jac_sparsity.row[inz];
+                const auto& j = jac_sparsity.col[inz];
+                REQUIRE(analytical_jacobian(i, j) ==
+                        Approx(fd_jacobian_values[inz]).epsilon(1e-8));
+            }
+        }
+        SparseJacobian<double> problemd;
+        auto proxy = problemd.make_decorator();
+        REQUIRE_THROWS_WITH(proxy->set_findiff_step_size_mode("optimal"),
+                Catch::Contains("Invalid value for findiff_step_size_mode"));
+    }
+
     // Automatic derivatives.
     // ----------------------
     SECTION("ADOL-C") {
@@ -543,6 +576,157 @@ TEST_CASE("Check derivatives with analytical deriv.; sparse Jacobian.")
     }
 }
 
+/// The objective and constraint take different branches depending on the
+/// sign of the variables, so the ADOL-C tapes recorded at one point are not
+/// valid at another point.
+template<typename T>
+class Branching : public Problem<T> {
+public:
+    Branching() : Problem<T>(2, 1) {
+        this->set_variable_bounds(Vector2d(-1, -1), Vector2d(2, 2));
+        this->set_constraint_bounds(VectorXd::Constant(1, -10),
+                VectorXd::Constant(1, 10));
+    }
+    void calc_objective(const VectorX<T>& x, T& obj_value) const override {
+        const T x0x1 = x[0] * x[1];
+        if (x[0] > 0) obj_value = x0x1 * x0x1;
+        else          obj_value = x0x1 * x0x1 * x0x1;
+    }
+    void calc_constraints(const VectorX<T>& x,
+            Eigen::Ref<VectorX<T>> constr) const override {
+        if (x[1] > 0) constr[0] = x[0] * x[1] * x[1];
+        else          constr[0] = x[0] * x[0] * x[1];
+    }
+    // The analytical derivatives for x[0] <= 0 and x[1] <= 0.
+    static void analytical_gradient(const VectorXd& x, VectorXd& grad) {
+        grad.resize(2);
+        grad << 3 * pow(x[0], 2) * pow(x[1], 3),
+                3 * pow(x[0], 3) * pow(x[1], 2);
+    }
+    static void analytical_jacobian(const VectorXd& x, MatrixXd& jac) {
+        jac.resize(1, 2);
+        jac << 2 * x[0] * x[1], pow(x[0], 2);
+    }
+    static void analytical_hessian_lagrangian(const VectorXd& x,
+            double obj_factor, const VectorXd& lambda, MatrixXd& hessian) {
+        hessian.resize(2, 2);
+        hessian(0, 0) = obj_factor * 6 * x[0] * pow(x[1], 3)
+                + lambda[0] * 2 * x[1];
+        hessian(0, 1) = obj_factor * 9 * pow(x[0], 2) * pow(x[1], 2)
+                + lambda[0] * 2 * x[0];
+        hessian(1, 0) = hessian(0, 1);
+        hessian(1, 1) = obj_factor * 6 * pow(x[0], 3) * x[1];
+    }
+};
+
+TEST_CASE("ADOL-C retapes when control flow changes") {
+    Branching<adouble> problem;
+    auto proxy = problem.make_decorator();
+    proxy->set_verbosity(0);
+    // The tapes are recorded at the middle of the bounds, where x > 0.
+    SparsityCoordinates jac_sparsity;
+    SparsityCoordinates hes_sparsity;
+    proxy->calc_sparsity(proxy->make_initial_guess_from_bounds(),
+            jac_sparsity, true, hes_sparsity);
+
+    // Evaluate where both branches differ from those on the tapes.
+    Vector2d x(-1.5, -0.7);
+    const unsigned num_vars = problem.get_num_variables();
+    const unsigned num_cons = problem.get_num_constraints();
+
+    double obj_value;
+    proxy->calc_objective(num_vars, x.data(), true, obj_value);
+    CHECK(obj_value == Approx(pow(x[0], 3) * pow(x[1], 3)));
+
+    VectorXd constr(num_cons);
+    proxy->calc_constraints(num_vars, x.data(), true, num_cons,
+            constr.data());
+    CHECK(constr[0] == Approx(pow(x[0], 2) * x[1]));
+
+    VectorXd expected_gradient;
+    Branching<double>::analytical_gradient(x, expected_gradient);
+    VectorXd gradient(num_vars);
+    proxy->calc_gradient(num_vars, x.data(), true, gradient.data());
+    TROPTER_REQUIRE_EIGEN(gradient, expected_gradient, 1e-12);
+
+    MatrixXd expected_jacobian;
+    Branching<double>::analytical_jacobian(x, expected_jacobian);
+    const unsigned num_jac_nonzeros = (unsigned)jac_sparsity.row.size();
+    VectorXd jacobian_values(num_jac_nonzeros);
+    proxy->calc_jacobian(num_vars, x.data(), true, num_jac_nonzeros,
+            jacobian_values.data());
+    for (int inz = 0; inz < (int)num_jac_nonzeros; ++inz) {
+        const auto& i = jac_sparsity.row[inz];
+        const auto& j = jac_sparsity.col[inz];
+        CHECK(jacobian_values[inz] == Approx(expected_jacobian(i, j)));
+    }
+
+    const double obj_factor = 0.5;
+    VectorXd lambda(num_cons);
+    lambda << 1.3;
+    MatrixXd expected_hessian;
+    Branching<double>::analytical_hessian_lagrangian(x, obj_factor, lambda,
+            expected_hessian);
+    const unsigned num_hes_nonzeros = (unsigned)hes_sparsity.row.size();
+    VectorXd hessian_values(num_hes_nonzeros);
+    proxy->calc_hessian_lagrangian(num_vars, x.data(), true, obj_factor,
+            num_cons, lambda.data(), true, num_hes_nonzeros,
+            hessian_values.data());
+    for (int inz = 0; inz < (int)num_hes_nonzeros; ++inz) {
+        const auto& i = hes_sparsity.row[inz];
+        const auto& j = hes_sparsity.col[inz];
+        CHECK(hessian_values[inz] == Approx(expected_hessian(i, j)));
+    }
+
+    // Evaluating again (with the retaped tapes) gives the same result.
+    VectorXd gradient_again(num_vars);
+    proxy->calc_gradient(num_vars, x.data(), true, gradient_again.data());
+    TROPTER_REQUIRE_EIGEN(gradient_again, expected_gradient, 1e-12);
+    VectorXd jacobian_values_again(num_jac_nonzeros);
+    proxy->calc_jacobian(num_vars, x.data(), true, num_jac_nonzeros,
+            jacobian_values_again.data());
+    TROPTER_REQUIRE_EIGEN(jacobian_values_again, jacobian_values, 1e-15);
+}
+
+/// On the branch for x[0] <= 0, the constraint depends on x[1], which is not
+/// in the Jacobian sparsity detected for x[0] > 0.
+class BranchingNewNonzero : public Problem<adouble> {
+public:
+    BranchingNewNonzero() : Problem<adouble>(2, 1) {
+        this->set_variable_bounds(Vector2d(-1, -1), Vector2d(2, 2));
+        this->set_constraint_bounds(VectorXd::Constant(1, -10),
+                VectorXd::Constant(1, 10));
+    }
+    void calc_objective(const VectorX<adouble>& x,
+            adouble& obj_value) const override {
+        obj_value = x[0] * x[0] + x[1] * x[1];
+    }
+    void calc_constraints(const VectorX<adouble>& x,
+            Eigen::Ref<VectorX<adouble>> constr) const override {
+        if (x[0] > 0) constr[0] = x[0] * x[0];
+        else          constr[0] = x[0] * x[1];
+    }
+};
+
+TEST_CASE("ADOL-C retaping rejects nonzeros outside the sparsity pattern") {
+    BranchingNewNonzero problem;
+    auto proxy = problem.make_decorator();
+    proxy->set_verbosity(0);
+    SparsityCoordinates jac_sparsity;
+    SparsityCoordinates hes_sparsity;
+    proxy->calc_sparsity(proxy->make_initial_guess_from_bounds(),
+            jac_sparsity, true, hes_sparsity);
+    REQUIRE(jac_sparsity.row.size() == 1);
+
+    Vector2d x(-0.5, 0.3);
+    const unsigned num_vars = problem.get_num_variables();
+    const unsigned num_jac_nonzeros = (unsigned)jac_sparsity.row.size();
+    VectorXd jacobian_values(num_jac_nonzeros);
+    CHECK_THROWS_WITH(proxy->calc_jacobian(num_vars, x.data(), true,
+                              num_jac_nonzeros, jacobian_values.data()),
+            Catch::Contains("not in the sparsity pattern"));
+}
+
 TEST_CASE("Check finite differences on bounds", "[finitediff][!mayfail]")
 {
     HS071<adouble> problem;
@@ -809,6 +993,26 @@ TEST_CASE("Validate sparsity input") {
                 Catch::Contains("must be in the upper triangle"));
     }
 
+    SECTION("Repeated blocks") {
+        SymmetricSparsityPattern block(2);
+        block.set_dense();
+        SymmetricSparsityPattern sparsity(7);
+        sparsity.set_nonzero(0, 6);
+        sparsity.set_nonzero_block_repeated(1, 2, 3, block);
+        REQUIRE(sparsity.get_num_nonzeros() == 10);
+        const auto crs = sparsity.convert_to_CompressedRowSparsity();
+        REQUIRE(crs[0] == std::vector<unsigned int>{6});
+        REQUIRE(crs[1] == (std::vector<unsigned int>{1, 2}));
+        REQUIRE(crs[2] == std::vector<unsigned int>{2});
+        REQUIRE(crs[5] == (std::vector<unsigned int>{5, 6}));
+        REQUIRE(crs[6] == std::vector<unsigned int>{6});
+        REQUIRE(sparsity.convert_full().get_num_nonzeros() == 14);
+
+        REQUIRE_THROWS_WITH(
+                sparsity.set_nonzero_block_repeated(1, 2, 4, block),
+                Catch::Contains("Block does not fit within this matrix"));
+    }
+
 }
 
 
@@ -866,6 +1070,96 @@ public:
         REQUIRE_THROWS(solver.set_sparsity_detection("invalid"));
     }
 };
+TEST_CASE("Graph coloring exploits repeated blocks") {
+    using tropter::optimization::JacobianColoring;
+    using tropter::optimization::HessianColoring;
+    // Mimic direct collocation: 2 leading (time) variables coupled to all
+    // constraints, and blocks of 4 variables, with 3 defects coupling
+    // neighboring blocks and 1 path constraint per block.
+    const int num_leading = 2;
+    const int block_size = 4;
+    const int num_blocks = 20;
+    const int num_vars = num_leading + block_size * num_blocks;
+    const int num_defect_rows = 3 * (num_blocks - 1);
+    const int num_rows = num_defect_rows + num_blocks;
+    RepeatedVariableBlocks blocks{num_leading, block_size, num_blocks};
+
+    SparsityPattern jac_sparsity(num_rows, num_vars);
+    MatrixXd jacobian = MatrixXd::Zero(num_rows, num_vars);
+    auto set_nonzero = [&](int i, int j) {
+        jac_sparsity.set_nonzero(i, j);
+        jacobian(i, j) = 1.0 + i + 0.01 * j;
+    };
+    for (int iblock = 0; iblock < num_blocks - 1; ++iblock) {
+        for (int idefect = 0; idefect < 3; ++idefect) {
+            const int irow = 3 * iblock + idefect;
+            for (int j = 0; j < num_leading; ++j) set_nonzero(irow, j);
+            for (int j = 0; j < 2 * block_size; ++j) {
+                set_nonzero(irow, num_leading + iblock * block_size + j);
+            }
+        }
+    }
+    for (int iblock = 0; iblock < num_blocks; ++iblock) {
+        set_nonzero(num_defect_rows + iblock,
+                num_leading + iblock * block_size);
+        set_nonzero(num_defect_rows + iblock,
+                num_leading + iblock * block_size + 2);
+    }
+
+    SECTION("Jacobian") {
+        JacobianColoring coloring(jac_sparsity, blocks);
+        REQUIRE(coloring.get_uses_repeated_blocks());
+        // Each time variable gets its own seed, and the columns of 2
+        // neighboring blocks share the remaining seeds.
+        const MatrixXd& seed = coloring.get_seed_matrix();
+        CHECK(seed.cols() == num_leading + 2 * block_size);
+        const MatrixXd compressed = jacobian * seed;
+        const int num_nonzeros = coloring.get_num_nonzeros();
+        std::vector<double> values(num_nonzeros);
+        coloring.recover(compressed, values.data());
+        SparsityCoordinates coords;
+        coloring.get_coordinate_format(coords);
+        REQUIRE((int)coords.row.size() == num_nonzeros);
+        for (int inz = 0; inz < num_nonzeros; ++inz) {
+            CHECK(values[inz] == jacobian(coords.row[inz], coords.col[inz]));
+        }
+    }
+
+    SECTION("Hessian") {
+        auto hes_sparsity =
+                SymmetricSparsityPattern::create_from_jacobian_sparsity(
+                        jac_sparsity);
+        const MatrixXd hessian_full =
+                jacobian.transpose() * jacobian +
+                MatrixXd::Identity(num_vars, num_vars);
+        HessianColoring coloring(hes_sparsity, blocks);
+        REQUIRE(coloring.get_uses_repeated_blocks());
+        // The rows of a block couple to the neighboring blocks on both
+        // sides, so the coloring repeats every 3 blocks.
+        const MatrixXd& seed = coloring.get_seed_matrix();
+        CHECK(seed.cols() == num_leading + 3 * block_size);
+        const MatrixXd compressed = hessian_full * seed;
+        const int num_nonzeros = hes_sparsity.get_num_nonzeros();
+        std::vector<double> values(num_nonzeros);
+        coloring.recover(compressed, values.data());
+        SparsityCoordinates coords;
+        coloring.get_coordinate_format(coords);
+        for (int inz = 0; inz < num_nonzeros; ++inz) {
+            CHECK(values[inz] == Approx(
+                    hessian_full(coords.row[inz], coords.col[inz])));
+        }
+    }
+
+    SECTION("Structure is not exploited if blocks are coupled") {
+        // A row that spans all blocks.
+        SparsityPattern coupled(1, num_vars);
+        for (int j = 0; j < num_vars; ++j) coupled.set_nonzero(0, j);
+        JacobianColoring coloring(coupled, blocks);
+        CHECK(!coloring.get_uses_repeated_blocks());
+        CHECK(coloring.get_seed_matrix().cols() == num_vars);
+    }
+}
+
 TEST_CASE("ProblemDecorator sparsity_detection") {
     // Ensure that the sparsity_detection setting is processed properly.
 
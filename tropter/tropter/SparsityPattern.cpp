@@ -20,31 +20,40 @@
 
 #include <Eigen/SparseCore>
 
+#include <numeric>
+
 using namespace tropter;
 
 SparsityPattern::SparsityPattern(int num_rows, int num_cols,
     const std::vector<unsigned int>& row_indices,
     const std::vector<unsigned int>& col_indices)
-    : m_num_rows(num_rows), m_num_cols(num_cols) {
+    : SparsityPattern(num_rows, num_cols) {
     TROPTER_THROW_IF(row_indices.size() != col_indices.size(),
         "Expected row_indices and col_indices to have the same size.");
+    reserve((int)row_indices.size());
     for (int inz = 0; inz < (int)row_indices.size(); ++inz)
         set_nonzero(row_indices[inz], col_indices[inz]);
 }
 
 SparsityPattern::SparsityPattern(int num_cols,
     const std::vector<unsigned int>& nonzero_col_indices)
-    : m_num_rows(1), m_num_cols(num_cols) {
+    : SparsityPattern(1, num_cols) {
+    reserve((int)nonzero_col_indices.size());
     for (const auto& icol : nonzero_col_indices)
         set_nonzero(0, icol);
 }
 
 void SparsityPattern::set_dense() {
+    // Build the compressed storage directly.
+    std::vector<unsigned int>().swap(m_pending_row_indices);
+    std::vector<unsigned int>().swap(m_pending_col_indices);
+    m_col_indices.resize((std::size_t)m_num_rows * m_num_cols);
     for (int irow = 0; irow < m_num_rows; ++irow) {
-        for (int icol = 0; icol < m_num_cols; ++icol) {
-            set_nonzero(irow, icol);
-        }
+        m_row_offsets[irow] = irow * m_num_cols;
+        std::iota(m_col_indices.begin() + irow * m_num_cols,
+            m_col_indices.begin() + (irow + 1) * m_num_cols, 0u);
     }
+    m_row_offsets[m_num_rows] = (unsigned)m_col_indices.size();
 }
 
 void SparsityPattern::set_nonzero(unsigned int row_index,
@@ -55,7 +64,7 @@ void SparsityPattern::set_nonzero(unsigned int row_index,
     TROPTER_THROW_IF(col_index >= (unsigned)m_num_cols,
         "Expected col_index to be in [0, %i), but it's %i.",
         m_num_cols, col_index);
-    m_sparsity.emplace(row_index, col_index);
+    append_nonzero(row_index, col_index);
 }
 
 void SparsityPattern::add_in_nonzeros(const SparsityPattern& other) {
@@ -63,42 +72,104 @@ void SparsityPattern::add_in_nonzeros(const SparsityPattern& other) {
         "Expected the same number of rows.");
     TROPTER_THROW_IF(get_num_cols() != other.get_num_cols(),
         "Expected the same number of columns.");
-    for (const auto& other_entry : other.m_sparsity)
-        set_nonzero(other_entry.first, other_entry.second);
+    other.compress();
+    reserve(other.get_num_nonzeros());
+    for (int irow = 0; irow < other.m_num_rows; ++irow) {
+        for (auto inz = other.m_row_offsets[irow];
+                inz < other.m_row_offsets[irow + 1]; ++inz) {
+            append_nonzero(irow, other.m_col_indices[inz]);
+        }
+    }
+}
+
+void SparsityPattern::reserve(int num_nonzeros) {
+    m_pending_row_indices.reserve(
+            m_pending_row_indices.size() + num_nonzeros);
+    m_pending_col_indices.reserve(
+            m_pending_col_indices.size() + num_nonzeros);
+}
+
+void SparsityPattern::compress() const {
+    if (m_pending_row_indices.empty()) return;
+
+    // Bucket the existing and pending nonzeros by row (counting sort).
+    std::vector<unsigned int> offsets(m_num_rows + 1, 0);
+    for (int irow = 0; irow < m_num_rows; ++irow) {
+        offsets[irow + 1] = m_row_offsets[irow + 1] - m_row_offsets[irow];
+    }
+    for (const auto& irow : m_pending_row_indices) ++offsets[irow + 1];
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+    std::vector<unsigned int> cols(offsets.back());
+    std::vector<unsigned int> next(offsets.begin(), offsets.end() - 1);
+    for (int irow = 0; irow < m_num_rows; ++irow) {
+        for (auto inz = m_row_offsets[irow]; inz < m_row_offsets[irow + 1];
+                ++inz) {
+            cols[next[irow]++] = m_col_indices[inz];
+        }
+    }
+    for (std::size_t i = 0; i < m_pending_row_indices.size(); ++i) {
+        cols[next[m_pending_row_indices[i]]++] = m_pending_col_indices[i];
+    }
+    std::vector<unsigned int>().swap(m_pending_row_indices);
+    std::vector<unsigned int>().swap(m_pending_col_indices);
+
+    // Sort each row and remove duplicates, compacting the rows in place.
+    unsigned int num_nonzeros = 0;
+    for (int irow = 0; irow < m_num_rows; ++irow) {
+        const auto begin = cols.begin() + offsets[irow];
+        auto end = cols.begin() + offsets[irow + 1];
+        std::sort(begin, end);
+        end = std::unique(begin, end);
+        const auto dest = cols.begin() + num_nonzeros;
+        if (dest != begin) std::copy(begin, end, dest);
+        m_row_offsets[irow] = num_nonzeros;
+        num_nonzeros += (unsigned int)(end - begin);
+    }
+    m_row_offsets[m_num_rows] = num_nonzeros;
+    cols.resize(num_nonzeros);
+    m_col_indices.swap(cols);
 }
 
 CompressedRowSparsity
 SparsityPattern::convert_to_CompressedRowSparsity() const {
+    compress();
     CompressedRowSparsity crs(m_num_rows);
     for (int irow = 0; irow < m_num_rows; ++irow) {
-        std::vector<unsigned int> nonzeros_this_row;
-        for (const auto& nonzero : m_sparsity) {
-            if ((int)nonzero.first == irow)
-                nonzeros_this_row.push_back(nonzero.second);
-        }
-        std::sort(nonzeros_this_row.begin(), nonzeros_this_row.end());
-        crs[irow] = nonzeros_this_row;
+        crs[irow].assign(m_col_indices.begin() + m_row_offsets[irow],
+            m_col_indices.begin() + m_row_offsets[irow + 1]);
     }
     return crs;
 }
 
 void SparsityPattern::write(const std::string& filename) {
+    compress();
     std::ofstream file(filename);
     file << "num_rows=" << m_num_rows << std::endl;
     file << "num_cols=" << m_num_cols << std::endl;
     file << "row_indices,column_indices" << std::endl;
-    for (const auto& entry : m_sparsity)
-        file << entry.first << "," << entry.second << std::endl;
+    for (int irow = 0; irow < m_num_rows; ++irow) {
+        for (auto inz = m_row_offsets[irow]; inz < m_row_offsets[irow + 1];
+                ++inz) {
+            file << irow << "," << m_col_indices[inz] << std::endl;
+        }
+    }
     file.close();
 }
 
 
 
 SparsityPattern SymmetricSparsityPattern::convert_full() const {
+    compress();
     SparsityPattern full(*this);
-    for (const auto& entry : m_sparsity)
-        // Swap row and col indicies.
-        full.set_nonzero(entry.second, entry.first);
+    full.reserve(get_num_nonzeros());
+    for (int irow = 0; irow < m_num_rows; ++irow) {
+        for (auto inz = m_row_offsets[irow]; inz < m_row_offsets[irow + 1];
+                ++inz) {
+            // Swap row and col indicies.
+            full.append_nonzero(m_col_indices[inz], irow);
+        }
+    }
     return full;
 }
 
@@ -110,10 +181,16 @@ SymmetricSparsityPattern::create_from_jacobian_sparsity(
         // Use 'short' instead of 'bool' to avoid MSVC warning C4804.
         Eigen::SparseMatrix<short> S1(
             jac_sparsity.get_num_rows(), jac_sparsity.get_num_cols());
-        S1.reserve(jac_sparsity.get_num_nonzeros());
+        const auto& row_offsets = jac_sparsity.get_row_offsets();
+        const auto& col_indices = jac_sparsity.get_col_indices();
         std::vector<Eigen::Triplet<short>> triplets;
-        for (const auto& entry : jac_sparsity.m_sparsity)
-            triplets.emplace_back(entry.first, entry.second, 1);
+        triplets.reserve(col_indices.size());
+        for (int irow = 0; irow < jac_sparsity.get_num_rows(); ++irow) {
+            for (auto inz = row_offsets[irow]; inz < row_offsets[irow + 1];
+                    ++inz) {
+                triplets.emplace_back(irow, col_indices[inz], 1);
+            }
+        }
         S1.setFromTriplets(triplets.begin(), triplets.end());
         S1.makeCompressed();
 
@@ -121,21 +198,29 @@ SymmetricSparsityPattern::create_from_jacobian_sparsity(
     }
 
     SymmetricSparsityPattern output((int)S2.rows());
+    output.reserve((int)S2.nonZeros());
     for (int i = 0; i < S2.outerSize(); ++i) {
         for (Eigen::SparseMatrix<bool>::InnerIterator it(S2, i); it; ++it) {
             if (it.value())
-                output.set_nonzero((int)it.row(), (int)it.col());
+                output.append_nonzero((int)it.row(), (int)it.col());
         }
     }
     return output;
 }
 
 void SymmetricSparsityPattern::set_dense() {
+    // Build the compressed storage directly.
+    std::vector<unsigned int>().swap(m_pending_row_indices);
+    std::vector<unsigned int>().swap(m_pending_col_indices);
+    m_col_indices.resize((std::size_t)m_num_rows * (m_num_rows + 1) / 2);
+    unsigned int num_nonzeros = 0;
     for (int irow = 0; irow < m_num_rows; ++irow) {
+        m_row_offsets[irow] = num_nonzeros;
         for (int icol = irow; icol < m_num_cols; ++icol) {
-            set_nonzero(irow, icol);
+            m_col_indices[num_nonzeros++] = icol;
         }
     }
+    m_row_offsets[m_num_rows] = num_nonzeros;
 }
 
 void SymmetricSparsityPattern::set_nonzero(unsigned int row_index,
@@ -148,22 +233,34 @@ void SymmetricSparsityPattern::set_nonzero(unsigned int row_index,
 
 void SymmetricSparsityPattern::set_nonzero_block(
         unsigned int startindex,
-        SymmetricSparsityPattern& block) {
-    TROPTER_THROW_IF((int)startindex + block.get_num_rows() > get_num_rows(),
+        const SymmetricSparsityPattern& block) {
+    set_nonzero_block_repeated(startindex, 0, 1, block);
+}
+
+void SymmetricSparsityPattern::set_nonzero_block_repeated(
+        unsigned int startindex, unsigned int stride, int num_blocks,
+        const SymmetricSparsityPattern& block) {
+    if (num_blocks <= 0) return;
+    // The last block is the one furthest from the upper left corner.
+    const int lastindex = (int)startindex + (num_blocks - 1) * (int)stride;
+    TROPTER_THROW_IF(lastindex + block.get_num_rows() > get_num_rows(),
         "Block does not fit within this matrix (number of rows: %i, "
         "required number of rows to set block: %i).", get_num_rows(),
-            (int)startindex + block.get_num_rows());
-    TROPTER_THROW_IF((int)startindex + block.get_num_cols() > get_num_cols(),
+            lastindex + block.get_num_rows());
+    TROPTER_THROW_IF(lastindex + block.get_num_cols() > get_num_cols(),
         "Block does not fit within this matrix (number of columns: %i, "
         "required number of columns to set block: %i).", get_num_cols(),
-            (int)startindex + block.get_num_cols());
-    for (const auto& block_entries : block.m_sparsity) {
-        set_nonzero(startindex + block_entries.first,
-            startindex + block_entries.second);
+            lastindex + block.get_num_cols());
+    block.compress();
+    reserve(num_blocks * block.get_num_nonzeros());
+    for (int iblock = 0; iblock < num_blocks; ++iblock) {
+        const unsigned int offset = startindex + iblock * stride;
+        for (int irow = 0; irow < block.m_num_rows; ++irow) {
+            for (auto inz = block.m_row_offsets[irow];
+                    inz < block.m_row_offsets[irow + 1]; ++inz) {
+                append_nonzero(offset + irow,
+                        offset + block.m_col_indices[inz]);
+            }
+        }
     }
 }
-
-
-
-
-
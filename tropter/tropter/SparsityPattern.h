@@ -18,7 +18,6 @@
 
 #include "common.h"
 #include <vector>
-#include <set>
 
 namespace tropter {
 
@@ -34,10 +33,16 @@ using CompressedRowSparsity = std::vector<std::vector<unsigned int>>;
 
 
 /// This represents the sparsity pattern of a matrix.
+/// Nonzeros are collected in flat coordinate (row, column) vectors as they
+/// are added; the first time the pattern is queried, these coordinates are
+/// sorted, duplicates are removed, and the result is stored in compressed
+/// row storage (CSR). This allows building patterns with millions of
+/// nonzeros without the memory and time overhead of a node-based container.
 class SparsityPattern {
 public:
     SparsityPattern(int num_rows, int num_cols)
-        : m_num_rows(num_rows), m_num_cols(num_cols) {}
+        : m_num_rows(num_rows), m_num_cols(num_cols),
+          m_row_offsets(num_rows + 1, 0) {}
     SparsityPattern(int num_rows, int num_cols,
         const std::vector<unsigned int>& row_indices,
         const std::vector<unsigned int>& col_indices);
@@ -45,6 +50,7 @@ public:
     /// num_cols, whose nonzero entries are specified by nonzero_col_indices.
     SparsityPattern(int num_cols,
         const std::vector<unsigned int>& nonzero_col_indices);
+    virtual ~SparsityPattern() = default;
     /// Set all elements to be nonzero.
     virtual void set_dense();
     /// Set a single entry of the matrix as nonzero.
@@ -54,10 +60,23 @@ public:
     /// Add in nonzeros from `other`'s nonzeros. This matrix and `other` must
     /// have the same dimensions.
     void add_in_nonzeros(const SparsityPattern& other);
+    /// Reserve memory for nonzeros that will be added with set_nonzero().
+    void reserve(int num_nonzeros);
 
     int get_num_rows() const { return m_num_rows; }
     int get_num_cols() const { return m_num_cols; }
-    int get_num_nonzeros() const { return (int)m_sparsity.size(); }
+    int get_num_nonzeros() const
+    {   compress(); return (int)m_col_indices.size(); }
+
+    /// The nonzeros in row i have column indices
+    /// get_col_indices()[get_row_offsets()[i]] through
+    /// get_col_indices()[get_row_offsets()[i + 1] - 1], sorted in increasing
+    /// order. The length of this vector is the number of rows plus 1.
+    const std::vector<unsigned int>& get_row_offsets() const
+    {   compress(); return m_row_offsets; }
+    /// @copydoc get_row_offsets()
+    const std::vector<unsigned int>& get_col_indices() const
+    {   compress(); return m_col_indices; }
 
     CompressedRowSparsity convert_to_CompressedRowSparsity() const;
 
@@ -66,10 +85,25 @@ public:
     void write(const std::string& filename);
 
 protected:
+    /// Append a nonzero without checking its indices; the caller is
+    /// responsible for ensuring the indices are valid.
+    void append_nonzero(unsigned int row_index, unsigned int col_index) {
+        m_pending_row_indices.push_back(row_index);
+        m_pending_col_indices.push_back(col_index);
+    }
+    /// Merge the nonzeros added since the last call into the compressed row
+    /// storage, removing duplicates.
+    void compress() const;
+
     int m_num_rows;
     int m_num_cols;
     friend class SymmetricSparsityPattern;
-    std::set<std::pair<unsigned int, unsigned int>> m_sparsity;
+    // Nonzeros that have not yet been merged into the compressed storage.
+    mutable std::vector<unsigned int> m_pending_row_indices;
+    mutable std::vector<unsigned int> m_pending_col_indices;
+    // Compressed row storage.
+    mutable std::vector<unsigned int> m_row_offsets;
+    mutable std::vector<unsigned int> m_col_indices;
 };
 
 
@@ -88,7 +122,16 @@ public:
     /// (startindex, startindex) in this matrix.
     /// Note, no nonzeros are "removed", only added.
     void set_nonzero_block(unsigned int startindex,
-        SymmetricSparsityPattern& block);
+        const SymmetricSparsityPattern& block);
+    /// Add in the same nonzero block num_blocks times along the diagonal,
+    /// placing the upper left corner of the first block at
+    /// (startindex, startindex) and that of each subsequent block `stride`
+    /// rows and columns further. This is the structure of the per-mesh-point
+    /// blocks in direct collocation, and is much faster than calling
+    /// set_nonzero_block() for each block.
+    void set_nonzero_block_repeated(unsigned int startindex,
+        unsigned int stride, int num_blocks,
+        const SymmetricSparsityPattern& block);
 
     /// Create a non-symmetric sparsity pattern of this matrix where the
     /// lower triangle is filled in by mirroring the upper triangle.
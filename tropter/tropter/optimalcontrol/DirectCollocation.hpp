@@ -108,7 +108,16 @@ Solution DirectCollocationSolver<T>::solve(
     } else {
         Eigen::VectorXd variables =
                 m_transcription->construct_iterate(initial_guess, true);
-        optsol = m_optsolver->optimize(variables);
+        if (initial_guess.bound_multipliers.size() ==
+                        m_transcription->get_num_variables() &&
+                initial_guess.constraint_multipliers.size() ==
+                        m_transcription->get_num_constraints()) {
+            optsol = m_optsolver->optimize(variables,
+                    initial_guess.constraint_multipliers,
+                    initial_guess.bound_multipliers);
+        } else {
+            optsol = m_optsolver->optimize(variables);
+        }
     }
     Iterate traj =
             m_transcription->deconstruct_iterate(optsol.variables);
@@ -128,6 +137,8 @@ Solution DirectCollocationSolver<T>::solve(
     solution.success = optsol.success;
     solution.status = optsol.status;
     solution.num_iterations = optsol.num_iterations;
+    solution.constraint_multipliers = optsol.constraint_multipliers;
+    solution.bound_multipliers = optsol.bound_multipliers;
     if (!solution && m_verbosity) {
         std::cerr << "[tropter] DirectCollocationSolver did not succeed:\n"
                 << solution.status << std::endl;
@@ -239,6 +239,8 @@ Iterate Iterate::interpolate(Eigen::VectorXd newTime) const {
     }
 
     out.parameters = parameters;
+    out.constraint_multipliers = constraint_multipliers;
+    out.bound_multipliers = bound_multipliers;
 
     return out;
 }
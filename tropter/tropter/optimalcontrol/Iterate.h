@@ -62,6 +62,12 @@ struct Iterate {
     std::vector<std::string> adjunct_names;
     std::vector<std::string> diffuse_names;
     std::vector<std::string> parameter_names;
+    /// Multipliers for the constraints and variable bounds of the
+    /// optimization problem, used to warm-start the optimizer (see
+    /// optimization::Solution). These are not interpolated, and are used only
+    /// if their sizes match the optimization problem.
+    Eigen::VectorXd constraint_multipliers;
+    Eigen::VectorXd bound_multipliers;
     /// This constructor leaves all members empty.
     Iterate() = default;
     /// True if the size of all members is 0; false otherwise.
@@ -90,6 +90,17 @@ public:
     void calc_sparsity_hessian_lagrangian(const Eigen::VectorXd& x,
         SymmetricSparsityPattern&,
         SymmetricSparsityPattern&) const override;
+    /// The variables at the midpoint and end of each mesh interval form a
+    /// repeated block; the variables at the first mesh point are treated as
+    /// leading variables. The diffuse variables are stored after all
+    /// collocation points, so we only report this structure if there are no
+    /// diffuse variables.
+    optimization::RepeatedVariableBlocks
+    get_repeated_variable_blocks() const override {
+        if (m_num_diffuses) return {};
+        return {m_num_dense_variables + m_num_continuous_variables,
+                2 * m_num_continuous_variables, m_num_mesh_intervals};
+    }
 
     /// For continuous variables, the format is
     /// `<continuous-variable-name>_<mesh-point-index>`. The mesh point index is
@@ -530,10 +530,8 @@ void HermiteSimpson<T>::calc_sparsity_hessian_lagrangian(
     // Repeat the block down the diagonal of the Hessian of constraints.
     // TODO may need to move this into each branch of if-statement above,
     // depending on how automatic sparsity detection is implemented.
-    for (int i_col = 0; i_col < m_num_col_points; ++i_col) {
-        const auto istart = m_num_dense_variables + i_col * num_con_vars;
-        hescon_sparsity.set_nonzero_block(istart, dae_sparsity);
-    }
+    hescon_sparsity.set_nonzero_block_repeated(m_num_dense_variables,
+            num_con_vars, m_num_col_points, dae_sparsity);
 
     // Hessian of objective.
     // ---------------------
@@ -563,12 +561,9 @@ void HermiteSimpson<T>::calc_sparsity_hessian_lagrangian(
             // TODO may need to move this into each branch of if-statement
             // above, depending on how automatic sparsity detection is
             // implemented.
-            for (int i_col = 0; i_col < m_num_col_points; ++i_col) {
-                const auto istart =
-                        m_num_dense_variables + i_col * num_con_vars;
-                hesobj_sparsity.set_nonzero_block(
-                        istart, integral_cost_sparsity);
-            }
+            hesobj_sparsity.set_nonzero_block_repeated(
+                    m_num_dense_variables, num_con_vars, m_num_col_points,
+                    integral_cost_sparsity);
         }
 
         // The cost depends on the initial state/controls, final state/controls,
@@ -79,6 +79,12 @@ public:
     void calc_sparsity_hessian_lagrangian(const Eigen::VectorXd& x,
             SymmetricSparsityPattern&,
             SymmetricSparsityPattern&) const override;
+    /// The variables at each mesh point form a repeated block.
+    optimization::RepeatedVariableBlocks
+    get_repeated_variable_blocks() const override {
+        return {m_num_dense_variables, m_num_continuous_variables,
+                m_num_mesh_points};
+    }
 
     /// For continuous variables, the format is
     /// `<continuous-variable-name>_<mesh-point-index>`. The mesh point index is
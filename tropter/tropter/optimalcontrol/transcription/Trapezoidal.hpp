@@ -405,10 +405,8 @@ void Trapezoidal<T>::calc_sparsity_hessian_lagrangian(const Eigen::VectorXd& x,
     }
 
     // Repeat the block down the diagonal of the Hessian of constraints.
-    for (int imesh = 0; imesh < m_num_mesh_points; ++imesh) {
-        const auto istart = m_num_dense_variables + imesh * num_con_vars;
-        hescon_sparsity.set_nonzero_block(istart, dae_sparsity);
-    }
+    hescon_sparsity.set_nonzero_block_repeated(m_num_dense_variables,
+            num_con_vars, m_num_mesh_points, dae_sparsity);
 
     // Hessian of objective.
     // ---------------------
@@ -465,12 +463,9 @@ void Trapezoidal<T>::calc_sparsity_hessian_lagrangian(const Eigen::VectorXd& x,
 
             // Repeat the block down the diagonal of the Hessian of the
             // objective.
-            for (int imesh = 0; imesh < m_num_mesh_points; ++imesh) {
-                const auto istart =
-                        m_num_dense_variables + imesh * num_con_vars;
-                hesobj_sparsity.set_nonzero_block(
-                        istart, integral_cost_sparsity);
-            }
+            hesobj_sparsity.set_nonzero_block_repeated(
+                    m_num_dense_variables, num_con_vars, m_num_mesh_points,
+                    integral_cost_sparsity);
         }
 
         // The cost depends on the initial state/controls, final state/controls,
@@ -28,6 +28,20 @@ namespace optimization {
 
 class ProblemDecorator;
 
+/// Describes variables that consist of a few leading variables (e.g., time
+/// and parameters), followed by `num_blocks` consecutive blocks of
+/// `block_size` variables that all enter the problem in the same way (e.g.,
+/// the variables at each mesh point of a direct collocation problem),
+/// possibly followed by a few trailing variables. A structure with no blocks
+/// means the variables have no known repeated structure; a value-initialized
+/// object (`{}`) has no blocks.
+/// @ingroup optimization
+struct RepeatedVariableBlocks {
+    int num_leading_variables;
+    int block_size;
+    int num_blocks;
+};
+
 /// @ingroup optimization
 class AbstractProblem {
 public:
@@ -111,6 +125,17 @@ public:
 
     class CalcSparsityHessianLagrangianNotImplemented : public Exception {};
 
+    /// When using finite differences, the perturbation directions for the
+    /// Jacobian and Hessian are found by coloring their sparsity patterns.
+    /// If the variables have a repeated block structure, describe it here so
+    /// that we can color a few blocks and tile that coloring across all
+    /// blocks; the number of perturbations then does not grow with the
+    /// number of blocks. If the sparsity patterns do not actually follow this
+    /// structure, we fall back to coloring the entire pattern.
+    /// By default, this returns a structure with no blocks.
+    virtual RepeatedVariableBlocks get_repeated_variable_blocks() const
+    {   return {}; }
+
     virtual std::unique_ptr<ProblemDecorator>
     make_decorator() const = 0;
 
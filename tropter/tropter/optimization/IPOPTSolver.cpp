@@ -20,6 +20,8 @@
 #include <IpTNLP.hpp>
 #include <IpIpoptApplication.hpp>
 #include <IpIpoptData.hpp>
+
+#include <algorithm>
 using Eigen::VectorXd;
 using Eigen::MatrixXd;
 using Eigen::Ref;
@@ -33,11 +35,23 @@ class IPOPTSolver::TNLP : public Ipopt::TNLP {
 public:
     using Index = Ipopt::Index;
     using Number = Ipopt::Number;
-    TNLP(const ProblemDecorator& problem);
+    /// The iteration callback may be empty.
+    TNLP(const ProblemDecorator& problem,
+            const IterationCallback& iteration_callback);
     void initialize(const VectorXd& guess,
             SparsityCoordinates jacobian_sparsity,
             SparsityCoordinates hessian_sparsity);
+    /// Provide initial values for the multipliers (for a warm start).
+    void set_initial_multipliers(const VectorXd& constraint_multipliers,
+            const VectorXd& bound_multipliers) {
+        m_initial_constraint_multipliers = constraint_multipliers;
+        m_initial_bound_multipliers = bound_multipliers;
+    }
     const Eigen::VectorXd& get_solution() const { return m_solution; }
+    const Eigen::VectorXd& get_constraint_multipliers() const
+    {   return m_constraint_multipliers; }
+    const Eigen::VectorXd& get_bound_multipliers() const
+    {   return m_bound_multipliers; }
     const double& get_optimal_objective_value() const
     {   return m_optimal_obj_value; }
     const int& get_num_iterations() const { return m_num_iterations; }
@@ -61,7 +75,7 @@ private:
                          Number* g_lower, Number* g_upper) override;
 
     // z: multipliers for bound constraints on x.
-    // warmstart will require giving initial values for the multipliers.
+    // Multipliers are requested only if warm_start_init_point is "yes".
     bool get_starting_point(Index num_variables, bool init_x, Number* x,
                             bool init_z, Number* z_L, Number* z_U,
                             Index num_constraints, bool init_lambda,
@@ -94,30 +108,45 @@ private:
                            const Number* g, const Number* lambda,
                            Number obj_value, const Ipopt::IpoptData* ip_data,
                            Ipopt::IpoptCalculatedQuantities* ip_cq) override;
-    /*
     /// This allows us to inspect intermediate iterations while solving the
     /// problem.
-    virtual bool intermediate_callback(Ipopt::AlgorithmMode mode,
+    bool intermediate_callback(Ipopt::AlgorithmMode /*mode*/,
             Index iter, Number obj_value,
             Number inf_pr, Number inf_du,
             Number mu, Number d_norm,
-            Number regularization_size,
+            Number /*regularization_size*/,
             Number alpha_du, Number alpha_pr,
-            Index ls_trials,
-            const Ipopt::IpoptData* ip_data,
-            Ipopt::IpoptCalculatedQuantities* ip_cq) override {
-    }*/
+            Index /*ls_trials*/,
+            const Ipopt::IpoptData* /*ip_data*/,
+            Ipopt::IpoptCalculatedQuantities* /*ip_cq*/) override {
+        if (!m_iteration_callback) return true;
+        IterationInfo info;
+        info.iteration = iter;
+        info.objective = obj_value;
+        info.primal_infeasibility = inf_pr;
+        info.dual_infeasibility = inf_du;
+        info.barrier_parameter = mu;
+        info.step_norm = d_norm;
+        info.primal_step_size = alpha_pr;
+        info.dual_step_size = alpha_du;
+        return m_iteration_callback(info);
+    }
 
     // Members.
 //    const ProblemDecorator& m_problem;
     // TODO reconsider the type of this variable:
     const ProblemDecorator& m_problem;
+    const IterationCallback& m_iteration_callback;
 
     unsigned m_num_variables = std::numeric_limits<unsigned>::max();
     unsigned m_num_constraints = std::numeric_limits<unsigned>::max();
 
     Eigen::VectorXd m_initial_guess;
+    Eigen::VectorXd m_initial_constraint_multipliers;
+    Eigen::VectorXd m_initial_bound_multipliers;
     Eigen::VectorXd m_solution;
+    Eigen::VectorXd m_constraint_multipliers;
+    Eigen::VectorXd m_bound_multipliers;
     double m_optimal_obj_value = std::numeric_limits<double>::quiet_NaN();
     int m_num_iterations = -1;
 
@@ -165,6 +194,18 @@ std::string convert_IPOPT_ApplicationReturnStatus_to_string(
 }
 
 Solution IPOPTSolver::optimize_impl(const VectorXd& guess) const {
+    return optimize_ipopt(guess, nullptr, nullptr);
+}
+
+Solution IPOPTSolver::optimize_warm_start_impl(const VectorXd& guess,
+        const VectorXd& constraint_multipliers,
+        const VectorXd& bound_multipliers) const {
+    return optimize_ipopt(guess, &constraint_multipliers, &bound_multipliers);
+}
+
+Solution IPOPTSolver::optimize_ipopt(const VectorXd& guess,
+        const VectorXd* constraint_multipliers,
+        const VectorXd* bound_multipliers) const {
 
     Ipopt::SmartPtr<Ipopt::IpoptApplication> app = IpoptApplicationFactory();
     // Set options.
@@ -218,6 +259,19 @@ Solution IPOPTSolver::optimize_impl(const VectorXd& guess) const {
             "computed Hessian information.");
     }
 
+    if (constraint_multipliers) {
+        // Without these settings, IPOPT pushes the guess away from the bounds
+        // and largely discards the multipliers. The advanced options below
+        // take precedence.
+        ipoptions->SetStringValue("warm_start_init_point", "yes");
+        for (const std::string name : {"warm_start_bound_push",
+                     "warm_start_bound_frac", "warm_start_slack_bound_push",
+                     "warm_start_slack_bound_frac",
+                     "warm_start_mult_bound_push"}) {
+            ipoptions->SetNumericValue(name, 1e-9);
+        }
+    }
+
     // Set advanced options.
     for (const auto& option : get_advanced_options_string()) {
         if (option.second) {
@@ -261,7 +315,8 @@ Solution IPOPTSolver::optimize_impl(const VectorXd& guess) const {
 
     // Create NLP.
     // -----------
-    Ipopt::SmartPtr<TNLP> nlp = new TNLP(*m_problem.get());
+    Ipopt::SmartPtr<TNLP> nlp =
+            new TNLP(*m_problem.get(), get_iteration_callback());
     // TODO avoid copying x (initial guess).
     // Determine sparsity pattern of Jacobian, Hessian, etc.
     SparsityCoordinates jacobian_sparsity;
@@ -270,6 +325,10 @@ Solution IPOPTSolver::optimize_impl(const VectorXd& guess) const {
             need_exact_hessian, hessian_sparsity);
     nlp->initialize(guess, std::move(jacobian_sparsity),
             std::move(hessian_sparsity));
+    if (constraint_multipliers) {
+        nlp->set_initial_multipliers(
+                *constraint_multipliers, *bound_multipliers);
+    }
 
     // Optimize!!!
     // -----------
@@ -289,11 +348,14 @@ Solution IPOPTSolver::optimize_impl(const VectorXd& guess) const {
     }
     solution.status = convert_IPOPT_ApplicationReturnStatus_to_string(status);
     solution.num_iterations = nlp->get_num_iterations();
+    solution.constraint_multipliers = nlp->get_constraint_multipliers();
+    solution.bound_multipliers = nlp->get_bound_multipliers();
     return solution;
 }
 
-IPOPTSolver::TNLP::TNLP(const ProblemDecorator& problem)
-        : m_problem(problem)
+IPOPTSolver::TNLP::TNLP(const ProblemDecorator& problem,
+        const IterationCallback& iteration_callback)
+        : m_problem(problem), m_iteration_callback(iteration_callback)
 {
     m_num_variables = m_problem.get_num_variables();
     m_num_constraints = m_problem.get_num_constraints();
@@ -381,20 +443,35 @@ bool IPOPTSolver::TNLP::get_bounds_info(
 }
 
 // z: multipliers for bound constraints on x.
-// warmstart will require giving initial values for the multipliers.
+// Multipliers are requested only if warm_start_init_point is "yes".
 bool IPOPTSolver::TNLP::get_starting_point(
         Index num_variables, bool init_x, Number* x,
-        bool init_z, Number* /*z_L*/, Number* /*z_U*/,
+        bool init_z, Number* z_L, Number* z_U,
         Index num_constraints, bool init_lambda,
-        Number* /*lambda*/) {
+        Number* lambda) {
     // Must this method provide initial values for x, z, lambda?
     assert(init_x == true);
-    assert(init_z == false);
-    assert(init_lambda == false);
     assert((unsigned)num_constraints == m_num_constraints);
     for (Index ivar = 0; ivar < num_variables; ++ivar) {
         x[ivar] = m_initial_guess[ivar];
     }
+    if (init_z) {
+        // The user set warm_start_init_point without providing multipliers.
+        if (m_initial_bound_multipliers.size() != num_variables) return false;
+        // Our bound multipliers are z_U - z_L.
+        for (Index ivar = 0; ivar < num_variables; ++ivar) {
+            z_L[ivar] = std::max(0.0, -m_initial_bound_multipliers[ivar]);
+            z_U[ivar] = std::max(0.0, m_initial_bound_multipliers[ivar]);
+        }
+    }
+    if (init_lambda) {
+        if (m_initial_constraint_multipliers.size() != num_constraints) {
+            return false;
+        }
+        for (Index icon = 0; icon < num_constraints; ++icon) {
+            lambda[icon] = m_initial_constraint_multipliers[icon];
+        }
+    }
     return true;
 }
 
@@ -471,9 +548,9 @@ bool IPOPTSolver::TNLP::eval_h(
 void IPOPTSolver::TNLP::finalize_solution(Ipopt::SolverReturn /*status*/,
                                           Index num_variables,
                                           const Number* x,
-                                          const Number* /*z_L*/, const Number* /*z_U*/,
-                                          Index /*num_constraints*/,
-                                          const Number* /*g*/, const Number* /*lambda*/,
+                                          const Number* z_L, const Number* z_U,
+                                          Index num_constraints,
+                                          const Number* /*g*/, const Number* lambda,
                                           Number obj_value,
                                           const Ipopt::IpoptData* ip_data,
                                           Ipopt::IpoptCalculatedQuantities* /*ip_cq*/)
@@ -484,6 +561,14 @@ void IPOPTSolver::TNLP::finalize_solution(Ipopt::SolverReturn /*status*/,
         //printf("x[%d]: %e\n", i, x[i]);
         m_solution[i] = x[i];
     }
+    m_bound_multipliers.resize(num_variables);
+    for (Index i = 0; i < num_variables; ++i) {
+        m_bound_multipliers[i] = z_U[i] - z_L[i];
+    }
+    m_constraint_multipliers.resize(num_constraints);
+    for (Index i = 0; i < num_constraints; ++i) {
+        m_constraint_multipliers[i] = lambda[i];
+    }
     m_optimal_obj_value = obj_value;
     m_num_iterations = ip_data->iter_count();
     //printf("\nSolution of the bound multipliers, z_L and z_U\n");
@@ -495,7 +580,6 @@ void IPOPTSolver::TNLP::finalize_solution(Ipopt::SolverReturn /*status*/,
     //}
     //printf("\nObjective value\n");
     //printf("f(x*) = %e\n", obj_value);
-    // TODO also implement Ipopt's intermediate_() function.
 }
 
 
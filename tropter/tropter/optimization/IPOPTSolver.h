@@ -48,6 +48,12 @@ public:
     static void print_available_options();
 protected:
     Solution optimize_impl(const Eigen::VectorXd& guess) const override;
+    /// Sets IPOPT's warm_start_init_point option and small values for the
+    /// warm_start_*_push/frac options (unless they are set as advanced
+    /// options), and provides the multipliers to IPOPT.
+    Solution optimize_warm_start_impl(const Eigen::VectorXd& guess,
+            const Eigen::VectorXd& constraint_multipliers,
+            const Eigen::VectorXd& bound_multipliers) const override;
     void get_available_options(
             std::vector<std::string>&, std::vector<std::string>&,
             std::vector<std::string>&) const override;
@@ -56,6 +62,10 @@ protected:
     }
 private:
     class TNLP;
+    /// The multipliers are null if not warm starting.
+    Solution optimize_ipopt(const Eigen::VectorXd& guess,
+            const Eigen::VectorXd* constraint_multipliers,
+            const Eigen::VectorXd* bound_multipliers) const;
 };
 
 } // namespace optimization
@@ -38,6 +38,14 @@ void ProblemDecorator::set_findiff_hessian_mode(std::string value) {
     m_findiff_hessian_mode = std::move(value);
 }
 
+void ProblemDecorator::set_findiff_step_size_mode(std::string value) {
+    TROPTER_VALUECHECK(value == "fixed" || value == "adaptive" ||
+            value == "adaptive-curvature",
+            "findiff_step_size_mode", value,
+            "'fixed', 'adaptive', or 'adaptive-curvature'");
+    m_findiff_step_size_mode = std::move(value);
+}
+
 // Explicit instantiation.
 
 template class Problem<double>;
@@ -114,10 +114,29 @@ public:
     ///  - "slow": Slower mode to be used only for debugging. Each nonzero of
     ///    the Hessian of the Lagrangian is computed separately.
     void set_findiff_hessian_mode(std::string value);
+    /// How to choose the step sizes for the gradient and Jacobian, which are
+    /// computed with central differences.
+    ///  - "fixed": default. Use sqrt(machine epsilon) for all variables.
+    ///  - "adaptive": Scale the step for each variable by the variable's
+    ///    magnitude (at the first point at which derivatives are computed)
+    ///    and by the width of its bounds, using cbrt(machine epsilon) as the
+    ///    relative step. The steps are chosen once and reused in all
+    ///    subsequent iterations.
+    ///  - "adaptive-curvature": Like "adaptive", but additionally refine the
+    ///    step for each variable (for the Jacobian, for each group of
+    ///    variables perturbed together) from an estimate of the third
+    ///    derivative along that variable, to balance truncation and roundoff
+    ///    error. This requires 4 extra function evaluations per variable
+    ///    (objective) or per perturbation direction (constraints), but only
+    ///    once.
+    /// The Hessian always uses findiff_hessian_step_size.
+    void set_findiff_step_size_mode(std::string value);
     /// @copydoc set_findiff_hessian_step_size()
     double get_findiff_hessian_step_size() const;
     /// @copydoc set_findiff_hessian_mode()
     const std::string& get_findiff_hessian_mode() const;
+    /// @copydoc set_findiff_step_size_mode()
+    const std::string& get_findiff_step_size_mode() const;
     /// @}
 
 protected:
@@ -128,6 +147,7 @@ private:
     int m_verbosity = 1;
     double m_findiff_hessian_step_size = 1e-5;
     std::string m_findiff_hessian_mode = "fast";
+    std::string m_findiff_step_size_mode = "fixed";
 };
 
 inline int ProblemDecorator::get_verbosity() const
@@ -136,6 +156,8 @@ inline double ProblemDecorator::get_findiff_hessian_step_size() const
 {   return m_findiff_hessian_step_size; }
 inline const std::string& ProblemDecorator::get_findiff_hessian_mode() const
 {   return m_findiff_hessian_mode; }
+inline const std::string& ProblemDecorator::get_findiff_step_size_mode() const
+{   return m_findiff_step_size_mode; }
 template<typename ...Types>
 inline void ProblemDecorator::print(
         const std::string& format_string, Types... args) const {
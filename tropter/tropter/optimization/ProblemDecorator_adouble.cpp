@@ -17,6 +17,8 @@
 #include <tropter/SparsityPattern.h>
 #include <tropter/Exception.hpp>
 
+#include <map>
+
 #ifdef _MSC_VER
 // Ignore warnings from ADOL-C headers.
     #pragma warning(push)
@@ -88,6 +90,11 @@ calc_sparsity(const Eigen::VectorXd& x,
 
     // This function also creates the ADOL-C tapes that are used in the other
     // function calls.
+    for (auto* retaped : {&m_jacobian_retaped, &m_hessian_retaped}) {
+        retaped->clear();
+        retaped->active = false;
+        retaped->stale = false;
+    }
 
     // Objective.
     // ----------
@@ -191,9 +198,9 @@ calc_objective(unsigned num_variables, const double* x,
             const_cast<double*>(x), &obj_value);
     // TODO create fancy return value checking (create a class for it).
     // check_adolc_driver_return_value(status);
-    //assert(status == 3);
-    assert(status >= 0);
-    // TODO if status != 3, retape.
+    // A negative status means the control flow differs from that at the
+    // point at which the tape was recorded.
+    if (status < 0) retape_objective(num_variables, x, obj_value);
 }
 
 void Problem<adouble>::Decorator::
@@ -208,8 +215,9 @@ calc_constraints(unsigned num_variables, const double* variables,
             // The signature of ::function() should take a const double*; I'm
             // fairly sure ADOL-C won't try to edit the independent variables.
             const_cast<double*>(variables), constr);
-    //assert(status == 3);
-    assert(status >= 0);
+    if (status < 0) {
+        retape_constraints(num_variables, variables, num_constraints, constr);
+    }
 }
 
 void Problem<adouble>::Decorator::
@@ -217,25 +225,70 @@ calc_gradient(unsigned num_variables, const double* x, bool /*new_x*/,
         double* grad) const
 {
     int status = ::gradient(m_objective_tag, num_variables, x, grad);
-    assert(status); // TODO error codes can be -2,-1,0,1,2,3; improve assert!
+    if (status < 0) {
+        double obj_value; // Unused.
+        retape_objective(num_variables, x, obj_value);
+        status = ::gradient(m_objective_tag, num_variables, x, grad);
+    }
+    TROPTER_THROW_IF(status < 0,
+            "ADOL-C could not compute the gradient of the objective "
+            "(status %i), even after retaping the objective.", status);
 }
 
 void Problem<adouble>::Decorator::
 calc_jacobian(unsigned num_variables, const double* x, bool /*new_x*/,
         unsigned /*num_nonzeros*/, double* jacobian_values) const
 {
-    int repeated_call = 1; // We already have the sparsity structure.
-    int status = ::sparse_jac(m_constraints_tag, get_num_constraints(),
-            num_variables, repeated_call, x,
-            &m_jacobian_num_nonzeros,
-            &m_jacobian_row_indices, &m_jacobian_col_indices,
-            &jacobian_values, const_cast<int*>(m_sparse_jac_options.data()));
-    // TODO create enums for ADOL-C's return values.
-    //assert(status == 3);
-    assert(status >= 0);
-
-    // TODO if we call with repeated_call == 0, we must first delete the
-    // previous memory for row indices, etc.
+    const auto num_constraints = get_num_constraints();
+    if (!m_jacobian_retaped.active) {
+        int repeated_call = 1; // We already have the sparsity structure.
+        int status = ::sparse_jac(m_constraints_tag, num_constraints,
+                num_variables, repeated_call, x,
+                &m_jacobian_num_nonzeros,
+                &m_jacobian_row_indices, &m_jacobian_col_indices,
+                &jacobian_values,
+                const_cast<int*>(m_sparse_jac_options.data()));
+        // TODO create enums for ADOL-C's return values.
+        if (status >= 0) return;
+        Eigen::VectorXd constraint_values(num_constraints); // Unused.
+        retape_constraints(num_variables, x, num_constraints,
+                constraint_values.data());
+    }
+
+    // The constraints tape has been re-recorded at least once.
+    auto& retaped = m_jacobian_retaped;
+    int status = -1;
+    if (!retaped.stale) {
+        int repeated_call = 1;
+        status = ::sparse_jac(m_constraints_tag, num_constraints,
+                num_variables, repeated_call, x,
+                &retaped.num_nonzeros,
+                &retaped.row_indices, &retaped.col_indices,
+                &retaped.values,
+                const_cast<int*>(m_sparse_jac_options.data()));
+        if (status < 0) {
+            Eigen::VectorXd constraint_values(num_constraints); // Unused.
+            retape_constraints(num_variables, x, num_constraints,
+                    constraint_values.data());
+        }
+    }
+    if (retaped.stale) {
+        retaped.clear();
+        int repeated_call = 0; // The tape changed; recompute the sparsity.
+        status = ::sparse_jac(m_constraints_tag, num_constraints,
+                num_variables, repeated_call, x,
+                &retaped.num_nonzeros,
+                &retaped.row_indices, &retaped.col_indices,
+                &retaped.values,
+                const_cast<int*>(m_sparse_jac_options.data()));
+        map_to_original_sparsity("Jacobian", m_jacobian_num_nonzeros,
+                m_jacobian_row_indices, m_jacobian_col_indices, retaped);
+    }
+    TROPTER_THROW_IF(status < 0,
+            "ADOL-C could not compute the Jacobian of the constraints "
+            "(status %i), even after retaping the constraints.", status);
+    scatter_to_original_sparsity(retaped, m_jacobian_num_nonzeros,
+            jacobian_values);
 }
 
 void Problem<adouble>::Decorator::
@@ -285,12 +338,140 @@ calc_hessian_lagrangian(unsigned num_variables, const double* x,
     set_param_vec(m_lagrangian_tag, 1 + num_constraints,
             m_hessian_obj_factor_lambda.data());
 
-    int status = sparse_hess(m_lagrangian_tag, num_variables, repeated_call,
-            x, &m_hessian_num_nonzeros, &m_hessian_row_indices,
-            &m_hessian_col_indices,
-            &hessian_values,
-            const_cast<int*>(m_sparse_hess_options.data()));
-    assert(status >= 0);
+    if (!m_hessian_retaped.active) {
+        int status = sparse_hess(m_lagrangian_tag, num_variables,
+                repeated_call, x, &m_hessian_num_nonzeros,
+                &m_hessian_row_indices, &m_hessian_col_indices,
+                &hessian_values,
+                const_cast<int*>(m_sparse_hess_options.data()));
+        if (status >= 0) return;
+        retape_lagrangian(num_variables, x, obj_factor, num_constraints,
+                lambda);
+    }
+
+    // The Lagrangian tape has been re-recorded at least once.
+    auto& retaped = m_hessian_retaped;
+    int status = -1;
+    if (!retaped.stale) {
+        status = sparse_hess(m_lagrangian_tag, num_variables, repeated_call,
+                x, &retaped.num_nonzeros,
+                &retaped.row_indices, &retaped.col_indices,
+                &retaped.values,
+                const_cast<int*>(m_sparse_hess_options.data()));
+        if (status < 0) {
+            retape_lagrangian(num_variables, x, obj_factor, num_constraints,
+                    lambda);
+        }
+    }
+    if (retaped.stale) {
+        retaped.clear();
+        repeated_call = 0; // The tape changed; recompute the sparsity.
+        status = sparse_hess(m_lagrangian_tag, num_variables, repeated_call,
+                x, &retaped.num_nonzeros,
+                &retaped.row_indices, &retaped.col_indices,
+                &retaped.values,
+                const_cast<int*>(m_sparse_hess_options.data()));
+        map_to_original_sparsity("Hessian of the Lagrangian",
+                m_hessian_num_nonzeros,
+                m_hessian_row_indices, m_hessian_col_indices, retaped);
+    }
+    TROPTER_THROW_IF(status < 0,
+            "ADOL-C could not compute the Hessian of the Lagrangian "
+            "(status %i), even after retaping the Lagrangian.", status);
+    scatter_to_original_sparsity(retaped, m_hessian_num_nonzeros,
+            hessian_values);
+}
+
+void Problem<adouble>::Decorator::
+retape_objective(unsigned num_variables, const double* x,
+        double& obj_value) const
+{
+    trace_objective(m_objective_tag, num_variables, x, obj_value);
+    ++m_num_objective_retapes;
+    print("Control flow of the objective changed; retaped the objective "
+          "(%i retape(s) so far).", m_num_objective_retapes);
+}
+
+void Problem<adouble>::Decorator::
+retape_constraints(unsigned num_variables, const double* x,
+        unsigned num_constraints, double* constr) const
+{
+    trace_constraints(m_constraints_tag, num_variables, x,
+            num_constraints, constr);
+    m_jacobian_retaped.active = true;
+    m_jacobian_retaped.stale = true;
+    ++m_num_constraints_retapes;
+    print("Control flow of the constraints changed; retaped the constraints "
+          "(%i retape(s) so far).", m_num_constraints_retapes);
+}
+
+void Problem<adouble>::Decorator::
+retape_lagrangian(unsigned num_variables, const double* x,
+        double obj_factor, unsigned num_constraints,
+        const double* lambda) const
+{
+    double lagr_value; // Unused.
+    trace_lagrangian(m_lagrangian_tag, num_variables, x, obj_factor,
+            num_constraints, lambda, lagr_value);
+    m_hessian_retaped.active = true;
+    m_hessian_retaped.stale = true;
+    ++m_num_lagrangian_retapes;
+    print("Control flow of the Lagrangian changed; retaped the Lagrangian "
+          "(%i retape(s) so far).", m_num_lagrangian_retapes);
+}
+
+void Problem<adouble>::Decorator::RetapedSparsity::clear() {
+    delete [] row_indices;
+    row_indices = nullptr;
+    delete [] col_indices;
+    col_indices = nullptr;
+    delete [] values;
+    values = nullptr;
+    num_nonzeros = -1;
+    original_index.clear();
+}
+
+void Problem<adouble>::Decorator::
+map_to_original_sparsity(const std::string& description,
+        int original_num_nonzeros,
+        const unsigned int* original_row_indices,
+        const unsigned int* original_col_indices,
+        RetapedSparsity& retaped) const
+{
+    std::map<std::pair<unsigned int, unsigned int>, int> original;
+    for (int inz = 0; inz < original_num_nonzeros; ++inz) {
+        original.emplace(std::make_pair(original_row_indices[inz],
+                original_col_indices[inz]), inz);
+    }
+    int num_missing = 0;
+    retaped.original_index.resize(retaped.num_nonzeros);
+    for (int inz = 0; inz < retaped.num_nonzeros; ++inz) {
+        const auto it = original.find(std::make_pair(
+                retaped.row_indices[inz], retaped.col_indices[inz]));
+        if (it == original.end()) {
+            ++num_missing;
+        } else {
+            retaped.original_index[inz] = it->second;
+        }
+    }
+    // The optimizer cannot accept a new sparsity pattern during the
+    // optimization, and dropping these nonzeros would give wrong derivatives.
+    TROPTER_THROW_IF(num_missing,
+            "The retaped %s has %i nonzero(s) that are not in the sparsity "
+            "pattern provided to the solver. The sparsity pattern detected "
+            "from the initial guess does not cover all branches of the "
+            "problem's control flow; try a different initial guess or use "
+            "finite differences.", description.c_str(), num_missing);
+    retaped.stale = false;
+}
+
+void Problem<adouble>::Decorator::
+scatter_to_original_sparsity(const RetapedSparsity& retaped,
+        int original_num_nonzeros, double* original_values) {
+    std::fill(original_values, original_values + original_num_nonzeros, 0.0);
+    for (int inz = 0; inz < retaped.num_nonzeros; ++inz) {
+        original_values[retaped.original_index[inz]] = retaped.values[inz];
+    }
 }
 
 void Problem<adouble>::Decorator::
@@ -68,6 +68,56 @@ private:
             unsigned num_constraints, const double* lambda,
             double& lagrangian_value) const;
 
+    // Retaping
+    // --------
+    // ADOL-C's drivers return a negative status if an adouble comparison
+    // evaluates differently than it did when the tape was recorded (that is,
+    // the control flow has changed, as with contact models that contain `if`
+    // statements). In that case, the tape is no longer valid at the current
+    // variables and we must record it again. We only re-record the tape
+    // whose control flow changed.
+    void retape_objective(unsigned num_variables, const double* variables,
+            double& obj_value) const;
+    void retape_constraints(unsigned num_variables, const double* variables,
+            unsigned num_constraints, double* constr) const;
+    void retape_lagrangian(unsigned num_variables, const double* variables,
+            double obj_factor, unsigned num_constraints,
+            const double* lambda) const;
+
+    /// ADOL-C discards its sparse derivative information for a tag when that
+    /// tag is re-recorded, and the nonzeros it reports for the new tape can
+    /// be ordered differently from (or even differ from) the pattern we gave
+    /// to the solver in calc_sparsity(). After a retape, ADOL-C writes into
+    /// these buffers and we scatter the values into the original pattern.
+    struct RetapedSparsity {
+        ~RetapedSparsity() { clear(); }
+        /// Delete the memory allocated by ADOL-C.
+        void clear();
+        /// Has the tape been re-recorded since calc_sparsity()?
+        bool active = false;
+        /// Must ADOL-C recompute its sparsity information for the tape
+        /// (repeated_call = 0)?
+        bool stale = false;
+        int num_nonzeros = -1;
+        unsigned int* row_indices = nullptr;
+        unsigned int* col_indices = nullptr;
+        double* values = nullptr;
+        /// For each of ADOL-C's nonzeros, the index of the same nonzero in
+        /// the original pattern.
+        std::vector<int> original_index;
+    };
+    /// Determine RetapedSparsity::original_index after ADOL-C recomputed the
+    /// sparsity for a retaped tape. Throws an exception if the retaped tape
+    /// has nonzeros that are not in the original pattern.
+    void map_to_original_sparsity(const std::string& description,
+            int original_num_nonzeros,
+            const unsigned int* original_row_indices,
+            const unsigned int* original_col_indices,
+            RetapedSparsity& retaped) const;
+    /// Copy values computed using a retaped tape into the original pattern.
+    static void scatter_to_original_sparsity(const RetapedSparsity& retaped,
+            int original_num_nonzeros, double* original_values);
+
     const Problem<adouble>& m_problem;
 
     // ADOL-C
@@ -93,6 +143,13 @@ private:
     // Working memory for lambda multipliers and the "obj_factor."
     mutable std::vector<double> m_hessian_obj_factor_lambda;
     std::vector<int> m_sparse_hess_options;
+
+    mutable RetapedSparsity m_jacobian_retaped;
+    mutable RetapedSparsity m_hessian_retaped;
+
+    mutable int m_num_objective_retapes = 0;
+    mutable int m_num_constraints_retapes = 0;
+    mutable int m_num_lagrangian_retapes = 0;
 };
 
 } // namespace optimization
@@ -17,6 +17,8 @@
 #include <tropter/Exception.hpp>
 #include "internal/GraphColoring.h"
 
+#include <functional>
+
 //#if defined(TROPTER_WITH_OPENMP) && _OPENMP
 //    // TODO only include ifdef _OPENMP
 //    #include <omp.h>
@@ -46,6 +48,49 @@ using Eigen::VectorXd;
 namespace tropter {
 namespace optimization {
 
+// Estimate the multiplier t for the central difference step t * direction
+// that balances truncation error (t^2 |f'''| / 6) and roundoff error
+// (machine epsilon * |f| / t); the optimum is t = cbrt(3 eps |f| / |f'''|).
+// We estimate the third derivative (along direction) with a larger pilot
+// step. calc_f(t, f) evaluates the function at x + t * direction; for a
+// vector-valued function, we use the smallest multiplier of all elements.
+// The result is within [0.01, 100].
+static double estimate_step_multiplier(int num_outputs,
+        const std::function<void(double, VectorXd&)>& calc_f) {
+    const double machine_eps = Eigen::NumTraits<double>::epsilon();
+    // The direction is scaled by cbrt(eps), and an appropriate step for a
+    // third derivative is about eps^(1/5).
+    const double pilot = std::pow(machine_eps, 0.2) / std::cbrt(machine_eps);
+    VectorXd f_2pos(num_outputs);
+    VectorXd f_pos(num_outputs);
+    VectorXd f_neg(num_outputs);
+    VectorXd f_2neg(num_outputs);
+    calc_f(2 * pilot, f_2pos);
+    calc_f(pilot, f_pos);
+    calc_f(-pilot, f_neg);
+    calc_f(-2 * pilot, f_2neg);
+    bool found_curvature = false;
+    double multiplier = 100.0;
+    for (int i = 0; i < num_outputs; ++i) {
+        const double magnitude =
+                std::max(std::abs(f_pos[i]), std::abs(f_neg[i]));
+        const double difference =
+                f_2pos[i] - 2 * f_pos[i] + 2 * f_neg[i] - f_2neg[i];
+        // Ignore differences that could be caused by roundoff alone.
+        if (!std::isfinite(difference) ||
+                std::abs(difference) <= 8 * machine_eps * magnitude) {
+            continue;
+        }
+        const double third_derivative =
+                difference / (2 * pilot * pilot * pilot);
+        multiplier = std::min(multiplier, std::cbrt(
+                3 * machine_eps * magnitude / std::abs(third_derivative)));
+        found_curvature = true;
+    }
+    if (!found_curvature) return 1.0;
+    return std::min(std::max(multiplier, 0.01), 100.0);
+}
+
 // We must implement the destructor in a context where the JacobianColoring
 // class is complete (since it's used in a unique ptr member variable.).
 Problem<double>::Decorator::~Decorator() {}
@@ -98,16 +143,21 @@ calc_sparsity(const Eigen::VectorXd& variables,
             calc_jacobian_sparsity_with_perturbation(variables,
                     num_jac_rows, calc_constraints, constr_names, var_names);
 
-    m_jacobian_coloring.reset(new JacobianColoring(jacobian_sparsity));
+    const auto blocks = m_problem.get_repeated_variable_blocks();
+    m_jacobian_coloring.reset(new JacobianColoring(jacobian_sparsity, blocks));
     m_jacobian_coloring->get_coordinate_format(jacobian_sparsity_coordinates);
+    m_jacobian_col_indices = jacobian_sparsity_coordinates.col;
     int num_jacobian_seeds = (int)m_jacobian_coloring->get_seed_matrix().cols();
-    print("Number of seeds for Jacobian: %i", num_jacobian_seeds);
+    print("Number of seeds for Jacobian: %i%s", num_jacobian_seeds,
+            m_jacobian_coloring->get_uses_repeated_blocks() ?
+            " (tiled across repeated blocks)" : "");
     // jacobian_sparsity.write("DEBUG_findiff_jacobian_sparsity.csv");
 
     // Allocate memory that is used in jacobian().
     m_constr_pos.resize(num_jac_rows);
     m_constr_neg.resize(num_jac_rows);
     m_jacobian_compressed.resize(num_jac_rows, num_jacobian_seeds);
+    m_findiff_steps_are_chosen = false;
 
     // Hessian.
     // ========
@@ -125,6 +175,14 @@ calc_sparsity(const Eigen::VectorXd& variables,
         if (get_findiff_hessian_mode() == "slow") {
             m_hessian_indices = hessian_sparsity_coordinates;
         }
+
+        // Allocate memory that is used in calc_hessian_lagrangian().
+        const auto num_hescon_seeds =
+                m_hescon_coloring->get_seed_matrix().cols();
+        m_hescon_compressed.resize(num_vars, num_hescon_seeds);
+        m_hescon_double_compressed.resize(num_jac_rows, num_jacobian_seeds);
+        m_constr_hescon_perturbed.resize(num_jac_rows, num_hescon_seeds);
+        m_constr_jac_difference.resize(num_jac_rows, num_jacobian_seeds);
     }
 }
 
@@ -177,8 +235,9 @@ calc_sparsity_hessian_lagrangian(const VectorXd& x,
     }
 
     // Create GraphColoring objects.
-    m_hescon_coloring.reset(new HessianColoring(hescon_sparsity));
-    m_hesobj_coloring.reset(new HessianColoring(hesobj_sparsity));
+    const auto blocks = m_problem.get_repeated_variable_blocks();
+    m_hescon_coloring.reset(new HessianColoring(hescon_sparsity, blocks));
+    m_hesobj_coloring.reset(new HessianColoring(hesobj_sparsity, blocks));
     m_hesobj_coloring->get_coordinate_format(m_hesobj_indices);
 
     // Sparsity of Hessian of Lagrangian.
@@ -186,7 +245,7 @@ calc_sparsity_hessian_lagrangian(const VectorXd& x,
     SymmetricSparsityPattern hessian_sparsity = hescon_sparsity;
     hessian_sparsity.add_in_nonzeros(hesobj_sparsity);
 
-    m_hessian_coloring.reset(new HessianColoring(hessian_sparsity));
+    m_hessian_coloring.reset(new HessianColoring(hessian_sparsity, blocks));
     m_hessian_coloring->get_coordinate_format(hessian_sparsity_coordinates);
 
     //hessian_sparsity.write("DEBUG_findiff_hessian_lagrangian_sparsity.csv");
@@ -218,15 +277,79 @@ calc_constraints(unsigned num_variables, const double* variables,
     std::copy(constrvec.data(), constrvec.data() + num_constraints, constr);
 }
 
+void Problem<double>::Decorator::
+choose_findiff_steps(const VectorXd& x) const {
+    const int num_vars = (int)x.size();
+    const auto& mode = get_findiff_step_size_mode();
+    m_findiff_steps_are_chosen = true;
+    if (mode == "fixed") {
+        const double eps = std::sqrt(Eigen::NumTraits<double>::epsilon());
+        m_gradient_steps = VectorXd::Constant(num_vars, eps);
+        m_jacobian_steps = m_gradient_steps;
+        return;
+    }
+
+    // Scale by the magnitude and bounds of each variable.
+    // ---------------------------------------------------
+    // The error of a central difference is smallest for a relative step of
+    // about cbrt(machine epsilon). A variable whose value is near 0 but that
+    // has wide bounds is perturbed relative to the width of its bounds.
+    const double cbrt_eps = std::cbrt(Eigen::NumTraits<double>::epsilon());
+    const auto& lower = get_variable_lower_bounds();
+    const auto& upper = get_variable_upper_bounds();
+    VectorXd steps(num_vars);
+    for (int i = 0; i < num_vars; ++i) {
+        double typical = std::abs(x[i]);
+        if (std::isfinite(lower[i]) && std::isfinite(upper[i])) {
+            typical = std::max(typical, 0.5 * (upper[i] - lower[i]));
+        } else {
+            typical = std::max(typical, 1.0);
+        }
+        if (typical == 0) typical = 1.0;
+        steps[i] = cbrt_eps * typical;
+    }
+    m_gradient_steps = steps;
+    m_jacobian_steps = steps;
+
+    if (mode == "adaptive-curvature") {
+        // Refine the steps using the curvature at x.
+        // -------------------------------------------
+        VectorXd x_working = x;
+        for (const auto& i : m_gradient_nonzero_indices) {
+            m_gradient_steps[i] *= estimate_step_multiplier(1,
+                    [&](double t, VectorXd& obj) {
+                        x_working[i] = x[i] + t * steps[i];
+                        obj[0] = 0;
+                        m_problem.calc_objective(x_working, obj[0]);
+                        x_working[i] = x[i];
+                    });
+        }
+        const auto& seed = m_jacobian_coloring->get_seed_matrix();
+        for (Eigen::Index iseed = 0; iseed < seed.cols(); ++iseed) {
+            const VectorXd direction = steps.cwiseProduct(seed.col(iseed));
+            const double multiplier = estimate_step_multiplier(
+                    (int)get_num_constraints(),
+                    [&](double t, VectorXd& constr) {
+                        constr.setZero();
+                        m_problem.calc_constraints(x + t * direction, constr);
+                    });
+            for (int i = 0; i < num_vars; ++i) {
+                if (seed(i, iseed)) m_jacobian_steps[i] *= multiplier;
+            }
+        }
+    }
+    print("Finite difference step sizes ('%s'): gradient in [%g, %g], "
+          "Jacobian in [%g, %g].", mode.c_str(),
+            m_gradient_steps.minCoeff(), m_gradient_steps.maxCoeff(),
+            m_jacobian_steps.minCoeff(), m_jacobian_steps.maxCoeff());
+}
+
 void Problem<double>::Decorator::
 calc_gradient(unsigned num_variables, const double* x, bool /*new_x*/,
         double* grad) const
 {
     m_x_working = Eigen::Map<const VectorXd>(x, num_variables);
-
-    // TODO use a better estimate for this step size.
-    const double eps = std::sqrt(Eigen::NumTraits<double>::epsilon());
-    const double two_eps = 2 * eps;
+    if (!m_findiff_steps_are_chosen) choose_findiff_steps(m_x_working);
 
     // We only compute the entries that are nonzero, and we must make sure
     // all other entries are 0.
@@ -245,6 +368,7 @@ calc_gradient(unsigned num_variables, const double* x, bool /*new_x*/,
     //            firstprivate(m_x_working)
     //            private(obj_pos, obj_neg)
     for (const auto& i : m_gradient_nonzero_indices) {
+        const double& eps = m_gradient_steps[i];
         obj_pos = 0;
         obj_neg = 0;
         // Perform a central difference.
@@ -254,7 +378,7 @@ calc_gradient(unsigned num_variables, const double* x, bool /*new_x*/,
         m_problem.calc_objective(m_x_working, obj_neg);
         // Restore the original value.
         m_x_working[i] = x[i];
-        grad[i] = (obj_pos - obj_neg) / two_eps;
+        grad[i] = (obj_pos - obj_neg) / (2 * eps);
     }
 }
 
@@ -264,30 +388,32 @@ calc_jacobian(unsigned num_variables, const double* variables, bool /*new_x*/,
 {
     // TODO give error message that sparsity() must be called first.
 
-    // TODO scale by magnitude of x.
-    const double eps = std::sqrt(Eigen::NumTraits<double>::epsilon());
-    const double two_eps = 2 * eps;
+    Eigen::Map<const VectorXd> x0(variables, num_variables);
+    if (!m_findiff_steps_are_chosen) choose_findiff_steps(x0);
     // Number of perturbation directions.
     const auto& seed = m_jacobian_coloring->get_seed_matrix();
     const Eigen::Index num_seeds = seed.cols();
-    Eigen::Map<const VectorXd> x0(variables, num_variables);
 
     // Compute the dense "compressed Jacobian" using the directions ColPack
-    // told us to use.
+    // told us to use. Each variable is perturbed by its own step, so we
+    // divide by the step after recovering the sparse Jacobian.
     // TODO for OpenMP: Trapezoidal has working memory!
     //#pragma omp parallel for firstprivate(m_constr_pos, m_constr_neg)
     for (Eigen::Index iseed = 0; iseed < num_seeds; ++iseed) {
-        const auto direction = seed.col(iseed);
+        const VectorXd direction =
+                m_jacobian_steps.cwiseProduct(seed.col(iseed));
         // Perturb x in the positive direction.
-        m_problem.calc_constraints(x0 + eps * direction, m_constr_pos);
+        m_problem.calc_constraints(x0 + direction, m_constr_pos);
         // Perturb x in the negative direction.
-        m_problem.calc_constraints(x0 - eps * direction, m_constr_neg);
+        m_problem.calc_constraints(x0 - direction, m_constr_neg);
         // Compute central difference.
-        m_jacobian_compressed.col(iseed) =
-                (m_constr_pos - m_constr_neg) / two_eps;
+        m_jacobian_compressed.col(iseed) = 0.5 * (m_constr_pos - m_constr_neg);
     }
 
     m_jacobian_coloring->recover(m_jacobian_compressed, jacobian_values);
+    for (int inz = 0; inz < (int)m_jacobian_col_indices.size(); ++inz) {
+        jacobian_values[inz] /= m_jacobian_steps[m_jacobian_col_indices[inz]];
+    }
 }
 
 void Problem<double>::Decorator::
@@ -325,57 +451,64 @@ calc_hessian_lagrangian(unsigned num_variables, const double* x_raw,
     m_problem.calc_constraints(x0, p1);
 
     const auto& hescon_seed = m_hescon_coloring->get_seed_matrix();
-    const Eigen::Index num_hescon_seeds = hescon_seed.cols();
+    const int num_hescon_seeds = (int)hescon_seed.cols();
 
     const auto& jac_seed = m_jacobian_coloring->get_seed_matrix();
-    const Eigen::Index num_jac_seeds = jac_seed.cols();
+    const int num_jac_seeds = (int)jac_seed.cols();
     int num_jac_nonzeros = m_jacobian_coloring->get_num_nonzeros();
 
     // Hessian of constraints.
     // -----------------------
-    // Allocate memory (TODO preallocate once in calc_sparsity()).
-    // Compressed Hessian of constraints.
-    Eigen::MatrixXd hescon_c(num_variables, num_hescon_seeds);
-    // Double-compressed second derivatives; same shape as a compressed
-    // Jacobian. Used in the inner loop.
-    Eigen::MatrixXd hescon_cc(num_constraints, num_jac_seeds);
-    // Store perturbed values of constraints.
-    VectorXd p2(num_constraints);
-    VectorXd p3(num_constraints);
-    VectorXd p4(num_constraints);
+    // The second derivative along Hessian seed i and Jacobian seed j is
+    // (p1 - p2_i - p3_j + p4_ij) / eps^2, with
+    //      p1 = c(x),
+    //      p2_i = c(x + eps * hescon_seed_i),
+    //      p3_j = c(x + eps * jac_seed_j),
+    //      p4_ij = c(x + eps * hescon_seed_i + eps * jac_seed_j).
+    // Only p4 depends on both seeds, so we evaluate p2 and p3 once up front
+    // rather than once per pair of seeds.
+    m_constr_hescon_perturbed.setZero();
+    m_constr_jac_difference.setZero();
+    for (int ihesseed = 0; ihesseed < num_hescon_seeds; ++ihesseed) {
+        auto p2 = m_constr_hescon_perturbed.col(ihesseed);
+        m_problem.calc_constraints(x0 + eps * hescon_seed.col(ihesseed), p2);
+    }
+    for (int ijacseed = 0; ijacseed < num_jac_seeds; ++ijacseed) {
+        auto p1_minus_p3 = m_constr_jac_difference.col(ijacseed);
+        m_problem.calc_constraints(
+                x0 + eps * jac_seed.col(ijacseed), p1_minus_p3);
+        p1_minus_p3 = p1 - p1_minus_p3;
+    }
 
+    Eigen::VectorXd Bgunc_coeffs(num_jac_nonzeros);
+    Eigen::SparseMatrix<double> Bgunc;
     // Loop through Hessian seeds.
     for (int ihesseed = 0; ihesseed < num_hescon_seeds; ++ihesseed) {
-        const auto hes_direction = hescon_seed.col(ihesseed);
-        VectorXd xb = x0 + eps * hes_direction;
-        p2.setZero();
-        m_problem.calc_constraints(xb, p2);
+        const VectorXd xb = x0 + eps * hescon_seed.col(ihesseed);
+        const auto p2 = m_constr_hescon_perturbed.col(ihesseed);
 
+        m_hescon_double_compressed.setZero();
         for (int ijacseed = 0; ijacseed < num_jac_seeds; ++ijacseed) {
-            const auto jac_direction = jac_seed.col(ijacseed);
-            p3.setZero();
-            m_problem.calc_constraints(x0 + eps * jac_direction, p3);
-            p4.setZero();
-            m_problem.calc_constraints(xb + eps * jac_direction, p4);
-
+            auto col = m_hescon_double_compressed.col(ijacseed);
+            // p4.
+            m_problem.calc_constraints(xb + eps * jac_seed.col(ijacseed), col);
             // Finite difference.
-            hescon_cc.col(ijacseed) = (p1 - p2 - p3 + p4) / eps_squared;
+            col = (m_constr_jac_difference.col(ijacseed) - p2 + col)
+                    / eps_squared;
         }
 
         // Recover (uncompress).
-        Eigen::VectorXd Bgunc_coeffs(num_jac_nonzeros);
-        m_jacobian_coloring->recover(hescon_cc, Bgunc_coeffs.data());
-        // TODO preallocate:
-        Eigen::SparseMatrix<double> Bgunc;
+        m_jacobian_coloring->recover(m_hescon_double_compressed,
+                Bgunc_coeffs.data());
         m_jacobian_coloring->convert(Bgunc_coeffs.data(), Bgunc);
 
-        hescon_c.col(ihesseed) = Bgunc.transpose() * lambda;
+        m_hescon_compressed.col(ihesseed) = Bgunc.transpose() * lambda;
     }
 
     // Convert the compressed Hessian of constraints into a SparseMatrix, for
     // ease of combining with Hessian of objective.
     Eigen::SparseMatrix<double> hessian;
-    m_hescon_coloring->recover(hescon_c, hessian);
+    m_hescon_coloring->recover(m_hescon_compressed, hessian);
 
     //m_time_hescon +=
     //        duration_cast<duration<double>>(high_resolution_clock::now() -
@@ -505,16 +638,25 @@ calc_hessian_lagrangian_slow(unsigned num_variables, const double* x_raw,
 
     assert(m_hessian_indices.row.size() == m_hessian_indices.col.size());
 
-    // TODO can avoid computing f(x + eps * e_i) multiple times.
+    // Avoid computing L(x + eps * e_i) multiple times.
+    std::vector<double> perturbed_lagrangian(num_variables);
+    std::vector<bool> perturbed_lagrangian_is_cached(num_variables, false);
+    auto get_perturbed_lagrangian = [&](int i) {
+        if (!perturbed_lagrangian_is_cached[i]) {
+            x[i] += eps;
+            calc_lagrangian(x, obj_factor, lambda, perturbed_lagrangian[i]);
+            x[i] = x_raw[i];
+            perturbed_lagrangian_is_cached[i] = true;
+        }
+        return perturbed_lagrangian[i];
+    };
     for (int inz = 0; inz < (int)m_hessian_indices.row.size(); ++inz) {
         int i = m_hessian_indices.row[inz];
         int j = m_hessian_indices.col[inz];
 
         if (i == j) {
 
-            x[i] += eps;
-            double lagr_pos;
-            calc_lagrangian(x, obj_factor, lambda, lagr_pos);
+            double lagr_pos = get_perturbed_lagrangian(i);
 
             x[i] = x_raw[i] - eps;
             double lagr_neg;
@@ -527,20 +669,17 @@ calc_hessian_lagrangian_slow(unsigned num_variables, const double* x_raw,
 
         } else {
 
-            x[i] += eps;
-            double lagr_i;
-            calc_lagrangian(x, obj_factor, lambda, lagr_i);
+            double lagr_i = get_perturbed_lagrangian(i);
 
+            x[i] += eps;
             x[j] += eps;
             double lagr_ij;
             calc_lagrangian(x, obj_factor, lambda, lagr_ij);
-
             x[i] = x_raw[i];
-            double lagr_j;
-            calc_lagrangian(x, obj_factor, lambda, lagr_j);
-
             x[j] = x_raw[j];
 
+            double lagr_j = get_perturbed_lagrangian(j);
+
             hessian_values[inz] =
                     (lagr_ij + lagr_0 - lagr_i - lagr_j) / eps_squared;
         }
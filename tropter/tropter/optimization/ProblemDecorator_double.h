@@ -74,6 +74,10 @@ private:
     void calc_sparsity_hessian_lagrangian(
             const Eigen::VectorXd&, SparsityCoordinates&) const;
 
+    /// Choose the per-variable step sizes for the gradient and Jacobian
+    /// according to get_findiff_step_size_mode(), about the point x.
+    void choose_findiff_steps(const Eigen::VectorXd& x) const;
+
     void calc_hessian_objective(const Eigen::VectorXd& x0,
             Eigen::VectorXd& hesobj_values) const;
     void calc_lagrangian(
@@ -97,6 +101,13 @@ private:
     // (conservative estimate of the indicies of the gradient that are nonzero).
     mutable std::vector<unsigned int> m_gradient_nonzero_indices;
 
+    // Step sizes for the gradient and Jacobian (one per variable). These are
+    // chosen at the first point at which we compute derivatives after
+    // calc_sparsity(), and are reused for subsequent iterations.
+    mutable bool m_findiff_steps_are_chosen = false;
+    mutable Eigen::VectorXd m_gradient_steps;
+    mutable Eigen::VectorXd m_jacobian_steps;
+
     // Jacobian.
     // ---------
     // This class (a) determines the directions in which to perturb
@@ -109,6 +120,8 @@ private:
     mutable Eigen::VectorXd m_constr_pos;
     mutable Eigen::VectorXd m_constr_neg;
     mutable Eigen::MatrixXd m_jacobian_compressed;
+    // Column index of each nonzero in the coordinate format of the Jacobian.
+    mutable std::vector<unsigned int> m_jacobian_col_indices;
 
     // Hessian/Lagrangian.
     // -------------------
@@ -121,6 +134,16 @@ private:
     mutable SparsityCoordinates m_hessian_indices;
     // Working memory.
     // mutable Eigen::VectorXd m_constr_working;
+    // Compressed Hessian of constraints (num_variables x num_hescon_seeds).
+    mutable Eigen::MatrixXd m_hescon_compressed;
+    // Double-compressed second derivatives; same shape as a compressed
+    // Jacobian.
+    mutable Eigen::MatrixXd m_hescon_double_compressed;
+    // Perturbed constraint values that are shared by all pairs of seeds:
+    // c(x + eps * hescon_seed_i) for each Hessian seed, and
+    // c(x) - c(x + eps * jac_seed_j) for each Jacobian seed.
+    mutable Eigen::MatrixXd m_constr_hescon_perturbed;
+    mutable Eigen::MatrixXd m_constr_jac_difference;
     mutable Eigen::Matrix<bool, Eigen::Dynamic, 1>
             m_perturbed_objective_is_cached;
     mutable Eigen::VectorXd m_perturbed_objective_cache;
@@ -83,12 +83,22 @@ const std::string& Solver::get_sparsity_detection() const {
     return m_sparsity_detection;
 }
 
+void Solver::set_iteration_callback(IterationCallback callback) {
+    m_iteration_callback = std::move(callback);
+}
+const IterationCallback& Solver::get_iteration_callback() const {
+    return m_iteration_callback;
+}
+
 void Solver::set_findiff_hessian_mode(std::string v) {
     m_problem->set_findiff_hessian_mode(std::move(v));
 }
 void Solver::set_findiff_hessian_step_size(double v) {
     m_problem->set_findiff_hessian_step_size(v);
 }
+void Solver::set_findiff_step_size_mode(std::string v) {
+    m_problem->set_findiff_step_size_mode(std::move(v));
+}
 
 void Solver::print_option_values(std::ostream& stream) const {
     const std::string unset("<unset>");
@@ -180,6 +190,27 @@ Solver::optimize(const Eigen::VectorXd& variables) const
     return optimize_impl(variables);
 }
 
+Solution
+Solver::optimize(const Eigen::VectorXd& variables,
+        const Eigen::VectorXd& constraint_multipliers,
+        const Eigen::VectorXd& bound_multipliers) const
+{
+    m_problem->validate();
+    TROPTER_THROW_IF(variables.size() != m_problem->get_num_variables(),
+            "Expected guess to have %i elements, but it has %i elements.",
+            m_problem->get_num_variables(), variables.size() );
+    TROPTER_THROW_IF(
+            constraint_multipliers.size() != m_problem->get_num_constraints(),
+            "Expected %i constraint multipliers, but got %i.",
+            m_problem->get_num_constraints(), constraint_multipliers.size());
+    TROPTER_THROW_IF(
+            bound_multipliers.size() != m_problem->get_num_variables(),
+            "Expected %i bound multipliers, but got %i.",
+            m_problem->get_num_variables(), bound_multipliers.size());
+    return optimize_warm_start_impl(variables, constraint_multipliers,
+            bound_multipliers);
+}
+
 Solution
 Solver::optimize() const {
     m_problem->validate();
@@ -19,6 +19,7 @@
 #include <tropter/common.h>
 #include <Eigen/Dense>
 
+#include <functional>
 #include <memory>
 #include <unordered_map>
 
@@ -39,8 +40,37 @@ struct Solution {
     /// Number of solver iterations at which this solution was obtained.
     int num_iterations = -1;
     std::string status;
+    /// Lagrange multipliers for the constraints, if the solver provides them.
+    Eigen::VectorXd constraint_multipliers;
+    /// Lagrange multipliers for the variable bounds, if the solver provides
+    /// them: positive if the upper bound is active and negative if the lower
+    /// bound is active.
+    Eigen::VectorXd bound_multipliers;
 };
 
+/// Information about one iteration of the optimization solver, passed to the
+/// iteration callback (see Solver::set_iteration_callback()). Quantities that
+/// the solver does not report are NaN.
+struct IterationInfo {
+    int iteration = -1;
+    double objective = std::numeric_limits<double>::quiet_NaN();
+    /// Maximum violation of the constraints.
+    double primal_infeasibility = std::numeric_limits<double>::quiet_NaN();
+    /// Optimality error of the Lagrangian gradient.
+    double dual_infeasibility = std::numeric_limits<double>::quiet_NaN();
+    /// Barrier parameter (for interior point methods).
+    double barrier_parameter = std::numeric_limits<double>::quiet_NaN();
+    /// Infinity norm of the primal step.
+    double step_norm = std::numeric_limits<double>::quiet_NaN();
+    /// Step sizes (fraction of the step taken) for the primal and dual
+    /// variables.
+    double primal_step_size = std::numeric_limits<double>::quiet_NaN();
+    double dual_step_size = std::numeric_limits<double>::quiet_NaN();
+};
+
+/// Return false to stop the optimization.
+using IterationCallback = std::function<bool(const IterationInfo&)>;
+
 /// The OptimizationSolver class contains some generic options that are
 /// common across different concrete solvers. To learn how the different
 /// solves interpret these generic options, view the documentaiton for the
@@ -66,6 +96,16 @@ public:
     /// OptimizationProblemProxy::make_initial_guess_from_bounds()).
     /// @returns The value of the objective function evaluated at the solution.
     Solution optimize() const;
+    /// Optimize the optimization problem, starting from the provided primal
+    /// variables and Lagrange multipliers (a warm start). This is useful
+    /// when solving a sequence of similar problems, using the solution of the
+    /// previous problem (including its multipliers) for the next one. The
+    /// multipliers have the same meaning as Solution::constraint_multipliers
+    /// and Solution::bound_multipliers. Solvers that do not support warm
+    /// starts ignore the multipliers.
+    Solution optimize(const Eigen::VectorXd& guess,
+            const Eigen::VectorXd& constraint_multipliers,
+            const Eigen::VectorXd& bound_multipliers) const;
 
     /// @name Set common options
     /// @{
@@ -104,6 +144,12 @@ public:
     void set_findiff_hessian_mode(std::string v);
     /// @copydoc ProblemDecorator::set_findiff_hessian_step_size()
     void set_findiff_hessian_step_size(double value);
+    /// @copydoc ProblemDecorator::set_findiff_step_size_mode()
+    void set_findiff_step_size_mode(std::string v);
+    /// This function is called after each iteration of the optimization
+    /// solver; if it returns false, the solver stops.
+    /// @note This setting currently takes effect only when using IPOPT.
+    void set_iteration_callback(IterationCallback callback);
     /// @}
 
     /// @name Set solver-specific advanced options.
@@ -146,10 +192,19 @@ public:
     /// @copydoc set_hessian_approximation()
     Optional<std::string> get_hessian_approximation() const;
     const std::string& get_sparsity_detection() const;
+    /// @copydoc set_iteration_callback()
+    const IterationCallback& get_iteration_callback() const;
     /// @}
 
 protected:
     virtual Solution optimize_impl(const Eigen::VectorXd& guess) const = 0;
+    /// Derived classes that support warm starts override this function. By
+    /// default, the multipliers are ignored.
+    virtual Solution optimize_warm_start_impl(const Eigen::VectorXd& guess,
+            const Eigen::VectorXd& /*constraint_multipliers*/,
+            const Eigen::VectorXd& /*bound_multipliers*/) const {
+        return optimize_impl(guess);
+    }
     virtual void get_available_options(
             std::vector<std::string>& options_string,
             std::vector<std::string>& options_int,
@@ -193,6 +248,7 @@ private:
     std::string m_jacobian_approximation = "exact";
     Optional<std::string> m_hessian_approximation;
     std::string m_sparsity_detection = "initial-guess";
+    IterationCallback m_iteration_callback;
 
     OptionsMap<std::string> m_advanced_options_string;
     OptionsMap<int> m_advanced_options_int;
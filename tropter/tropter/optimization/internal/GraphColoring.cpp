@@ -18,6 +18,8 @@
 #include <tropter/Exception.hpp>
 #include <ColPack/ColPackHeaders.h>
 
+#include <set>
+
 using namespace tropter;
 using namespace tropter::optimization;
 
@@ -64,16 +66,158 @@ void convert_sparsity_format(
     }
 }
 
+// Coloring columns that have a repeated block structure.
+// Columns outside of the blocks each get their own color. Two block columns
+// conflict if they are both nonzero in one of the rows we consider. If no row
+// spans more than `period` consecutive blocks, then the columns in blocks k
+// and k + period never conflict, and we can color the columns of `period`
+// consecutive blocks (a "super-block") and reuse these colors for every
+// super-block. A column of the super-block must then have a color different
+// from every column it conflicts with in *any* super-block; rows whose
+// nonzeros map to the same super-block columns produce the same conflicts,
+// so we examine each distinct row only once. The cost of the coloring and
+// the number of colors are therefore independent of the number of blocks.
+// If only_block_rows is true, we ignore the rows of the non-block columns
+// (for symmetric matrices, see HessianColoring).
+// Returns the number of colors, or 0 if the structure cannot be exploited,
+// in which case `colors` is left empty.
+int color_repeated_blocks(const SparsityPattern& sparsity,
+        const RepeatedVariableBlocks& blocks, bool only_block_rows,
+        std::vector<int>& colors) {
+    colors.clear();
+    const int num_cols = sparsity.get_num_cols();
+    const int block_size = blocks.block_size;
+    const int block_begin = blocks.num_leading_variables;
+    const int block_end = block_begin + block_size * blocks.num_blocks;
+    if (block_size <= 0 || blocks.num_blocks < 2 || block_begin < 0 ||
+            block_end > num_cols) {
+        return 0;
+    }
+    const auto& row_offsets = sparsity.get_row_offsets();
+    const auto& col_indices = sparsity.get_col_indices();
+    const int row_begin = only_block_rows ? block_begin : 0;
+    const int row_end = only_block_rows ? block_end : sparsity.get_num_rows();
+
+    // Determine the number of consecutive blocks spanned by any row.
+    // The column indices of each row are sorted.
+    int period = 1;
+    for (int i = row_begin; i < row_end; ++i) {
+        int first_block = -1;
+        int last_block = -1;
+        for (unsigned k = row_offsets[i]; k < row_offsets[i + 1]; ++k) {
+            const int col = (int)col_indices[k];
+            if (col < block_begin || col >= block_end) continue;
+            const int iblock = (col - block_begin) / block_size;
+            if (first_block == -1) first_block = iblock;
+            last_block = iblock;
+        }
+        if (first_block != -1) {
+            period = std::max(period, last_block - first_block + 1);
+        }
+    }
+    // Tiling is only worthwhile if the super-block repeats, and we must
+    // store the conflicts within the super-block densely.
+    const int num_super_cols = period * block_size;
+    if (2 * period > blocks.num_blocks || num_super_cols > 8192) return 0;
+
+    // Conflicts between the columns of the super-block.
+    std::vector<bool> conflicts((size_t)num_super_cols * num_super_cols);
+    std::set<std::vector<int>> distinct_rows;
+    std::vector<int> super_cols;
+    for (int i = row_begin; i < row_end; ++i) {
+        super_cols.clear();
+        for (unsigned k = row_offsets[i]; k < row_offsets[i + 1]; ++k) {
+            const int col = (int)col_indices[k];
+            if (col < block_begin || col >= block_end) continue;
+            const int iblock = (col - block_begin) / block_size;
+            super_cols.push_back((iblock % period) * block_size +
+                    (col - block_begin) % block_size);
+        }
+        if (super_cols.size() < 2) continue;
+        std::sort(super_cols.begin(), super_cols.end());
+        if (!distinct_rows.insert(super_cols).second) continue;
+        for (const auto& a : super_cols) {
+            for (const auto& b : super_cols) {
+                if (a != b) conflicts[(size_t)a * num_super_cols + b] = true;
+            }
+        }
+    }
+
+    // Greedily color the super-block, smallest available color first.
+    std::vector<int> super_colors(num_super_cols, -1);
+    // used[c] == a means color c is taken by a neighbor of column a.
+    std::vector<int> used(num_super_cols, -1);
+    int num_block_colors = 0;
+    for (int a = 0; a < num_super_cols; ++a) {
+        for (int b = 0; b < a; ++b) {
+            if (conflicts[(size_t)a * num_super_cols + b]) {
+                used[super_colors[b]] = a;
+            }
+        }
+        int color = 0;
+        while (used[color] == a) ++color;
+        super_colors[a] = color;
+        num_block_colors = std::max(num_block_colors, color + 1);
+    }
+
+    // Tile the coloring; non-block columns get their own colors.
+    colors.resize(num_cols);
+    int num_colors = num_block_colors;
+    for (int col = 0; col < block_begin; ++col) colors[col] = num_colors++;
+    for (int col = block_begin; col < block_end; ++col) {
+        const int iblock = (col - block_begin) / block_size;
+        colors[col] = super_colors[(iblock % period) * block_size +
+                (col - block_begin) % block_size];
+    }
+    for (int col = block_end; col < num_cols; ++col) colors[col] = num_colors++;
+    return num_colors;
+}
+
+// Create the seed matrix for the given coloring of the columns.
+Eigen::MatrixXd create_seed_matrix(const std::vector<int>& colors,
+        int num_seeds) {
+    Eigen::MatrixXd seed = Eigen::MatrixXd::Zero(colors.size(), num_seeds);
+    for (int j = 0; j < (int)colors.size(); ++j) seed(j, colors[j]) = 1;
+    return seed;
+}
+
+// Get the (row, column) indices of the nonzeros, row by row.
+void get_compressed_row_coordinates(const SparsityPattern& sparsity,
+        std::vector<unsigned int>& row_indices,
+        std::vector<unsigned int>& col_indices) {
+    const auto& row_offsets = sparsity.get_row_offsets();
+    col_indices = sparsity.get_col_indices();
+    row_indices.resize(col_indices.size());
+    for (int i = 0; i < sparsity.get_num_rows(); ++i) {
+        std::fill(row_indices.begin() + row_offsets[i],
+                row_indices.begin() + row_offsets[i + 1], (unsigned)i);
+    }
+}
+
 // We must implement the destructor in a context where ColPack's coloring
 // class is complete (since it's used in a unique ptr member variable.).
 JacobianColoring::~JacobianColoring() {}
 
-JacobianColoring::JacobianColoring(SparsityPattern sparsity)
+JacobianColoring::JacobianColoring(SparsityPattern sparsity,
+        const RepeatedVariableBlocks& blocks)
         : m_sparsity(std::move(sparsity)),
           m_num_rows(m_sparsity.get_num_rows()),
           m_num_cols(m_sparsity.get_num_cols()),
           m_num_nonzeros(m_sparsity.get_num_nonzeros()) {
 
+    // Exploit repeated blocks, if possible.
+    // -------------------------------------
+    // With this coloring, each nonzero is the only nonzero of its color in
+    // its row, so we can recover the Jacobian directly without ColPack.
+    const int num_block_seeds =
+            color_repeated_blocks(m_sparsity, blocks, false, m_colors);
+    if (num_block_seeds) {
+        m_seed = create_seed_matrix(m_colors, num_block_seeds);
+        get_compressed_row_coordinates(m_sparsity,
+                m_recovered_row_indices, m_recovered_col_indices);
+        return;
+    }
+
     // TODO m_sparsity.check();
     convert_sparsity_format(m_sparsity, m_sparsity_ADOLC_format);
 
@@ -149,6 +293,15 @@ void JacobianColoring::recover(const Eigen::MatrixXd& jacobian_compressed,
         double* jacobian_sparse_coordinate_format) {
     assert(jacobian_compressed.cols() == m_seed.cols());
 
+    if (!m_colors.empty()) {
+        for (int inz = 0; inz < m_num_nonzeros; ++inz) {
+            jacobian_sparse_coordinate_format[inz] = jacobian_compressed(
+                    m_recovered_row_indices[inz],
+                    m_colors[m_recovered_col_indices[inz]]);
+        }
+        return;
+    }
+
     // Convert jacobian_compressed into the format ColPack accepts.
     for (Eigen::Index iseed = 0; iseed < m_seed.cols(); ++iseed) {
         for (unsigned int i = 0; i < jacobian_compressed.rows(); ++i) {
@@ -192,11 +345,31 @@ void JacobianColoring::convert(
 // HessianColoring
 // ----------------------------------------------------------------------------
 
-HessianColoring::HessianColoring(const SymmetricSparsityPattern& sparsity)
+HessianColoring::HessianColoring(const SymmetricSparsityPattern& sparsity,
+        const RepeatedVariableBlocks& blocks)
         : m_num_vars(sparsity.get_num_cols()),
           m_num_nonzeros(sparsity.get_num_nonzeros()) {
 
-    convert_sparsity_format(sparsity.convert_full(), m_sparsity_ADOLC_format);
+    const SparsityPattern full_sparsity = sparsity.convert_full();
+
+    // Exploit repeated blocks, if possible.
+    // -------------------------------------
+    // Only the rows of the block variables need to be free of same-colored
+    // nonzeros; the rows of the other variables are recovered from their
+    // (uniquely colored) columns.
+    const int num_block_seeds =
+            color_repeated_blocks(full_sparsity, blocks, true, m_colors);
+    if (num_block_seeds) {
+        m_block_begin = blocks.num_leading_variables;
+        m_block_end = m_block_begin + blocks.block_size * blocks.num_blocks;
+        m_seed = create_seed_matrix(m_colors, num_block_seeds);
+        // The upper triangle.
+        get_compressed_row_coordinates(sparsity,
+                m_recovered_row_indices, m_recovered_col_indices);
+        return;
+    }
+
+    convert_sparsity_format(full_sparsity, m_sparsity_ADOLC_format);
 
     // Determine the efficient perturbation directions.
     // ------------------------------------------------
@@ -280,6 +453,21 @@ void HessianColoring::recover(const Eigen::MatrixXd& hessian_compressed,
         double* hessian_sparse_coordinate_format) {
     assert(hessian_compressed.cols() == m_seed.cols());
 
+    if (!m_colors.empty()) {
+        for (int inz = 0; inz < m_num_nonzeros; ++inz) {
+            const int i = m_recovered_row_indices[inz];
+            const int j = m_recovered_col_indices[inz];
+            if (i < m_block_begin || i >= m_block_end) {
+                hessian_sparse_coordinate_format[inz] =
+                        hessian_compressed(j, m_colors[i]);
+            } else {
+                hessian_sparse_coordinate_format[inz] =
+                        hessian_compressed(i, m_colors[j]);
+            }
+        }
+        return;
+    }
+
     // Convert hessian_compressed into the format ColPack accepts.
     for (Eigen::Index iseed = 0; iseed < m_seed.cols(); ++iseed) {
         for (unsigned int i = 0; i < hessian_compressed.rows(); ++i) {
@@ -17,6 +17,7 @@
 // ----------------------------------------------------------------------------
 
 #include <tropter/SparsityPattern.h>
+#include <tropter/optimization/AbstractProblem.h>
 
 #include <Eigen/Dense>
 #include <Eigen/SparseCore>
@@ -52,6 +53,11 @@ using Double2DPtr =
 /// Jacobian containing the derivative in each of the perturbation directions.
 /// This class also supports recovering the sparse Jacobian from the compressed
 /// dense Jacobian.
+/// If the variables have a repeated block structure (see
+/// RepeatedVariableBlocks), we instead color only the few blocks that can
+/// interact and tile this coloring across all blocks; the number of seeds is
+/// then independent of the number of blocks, and the Jacobian is recovered
+/// directly from the compressed Jacobian.
 /// This is an internal class (not available from the interface).
 class JacobianColoring {
 public:
@@ -67,7 +73,12 @@ public:
     ///     nonzeros in that row. More information about this format can be
     ///     found in ADOL-C's manual.
     ///     TODO update comment.
-    JacobianColoring(SparsityPattern sparsity);
+    /// @param blocks
+    ///     The repeated block structure of the columns, if any. If the
+    ///     sparsity pattern does not follow this structure, ColPack colors
+    ///     the entire pattern.
+    JacobianColoring(SparsityPattern sparsity,
+            const RepeatedVariableBlocks& blocks = {});
 
     ~JacobianColoring();
 
@@ -76,6 +87,10 @@ public:
 
     const SparsityPattern& get_sparsity() const { return m_sparsity; }
 
+    /// Was the coloring obtained by tiling the coloring of repeated blocks
+    /// (rather than by coloring the entire pattern with ColPack)?
+    bool get_uses_repeated_blocks() const { return !m_colors.empty(); }
+
     /// This matrix has dimensions num_columns x num_seeds, where num_seeds is
     /// the ("minimal") number of directions in which to perturb (num_columns
     /// is the number of variables). Each column of this matrix is a
@@ -118,6 +133,10 @@ private:
             m_coloring;
     mutable std::unique_ptr<ColPack::JacobianRecovery1D> m_recovery;
 
+    // If we exploit repeated blocks, this holds the color (seed index) of
+    // each column, and we do not use the ColPack objects above.
+    std::vector<int> m_colors;
+
     // We determine the sparsity structure of the Jacobian (by propagating
     // NaNs through the constraint function) and hold the result in this
     // variable to pass to ColPack methods.
@@ -143,12 +162,23 @@ private:
 /// [2] Gebremedhin, Assefaw Hadish, Fredrik Manne, and Alex Pothen. "What color
 /// is your Jacobian? Graph coloring for computing derivatives." SIAM review
 /// 47.4 (2005): 629-705.
+/// If the variables have a repeated block structure (see
+/// RepeatedVariableBlocks), each variable outside of the blocks gets its own
+/// seed, and the block variables are colored such that no row of the
+/// Hessian within the blocks contains two variables of the same color. This
+/// coloring is tiled across blocks and permits direct recovery: an element
+/// in a row of a non-block variable is read from the (symmetric) column of
+/// that variable.
 class HessianColoring {
 public:
-    HessianColoring(const SymmetricSparsityPattern& sparsity);
+    HessianColoring(const SymmetricSparsityPattern& sparsity,
+            const RepeatedVariableBlocks& blocks = {});
 
     ~HessianColoring();
 
+    /// @copydoc JacobianColoring::get_uses_repeated_blocks()
+    bool get_uses_repeated_blocks() const { return !m_colors.empty(); }
+
     /// This matrix has dimensions num_variables x num_seeds, where num_seeds is
     /// the ("minimal") number of directions in which to perturb. Each column of
     /// this matrix is a perturbation direction.
@@ -209,6 +239,13 @@ private:
     mutable std::unique_ptr<ColPack::GraphColoringInterface> m_coloring;
     mutable std::unique_ptr<ColPack::HessianRecovery> m_recovery;
 
+    // If we exploit repeated blocks, this holds the color (seed index) of
+    // each variable, and we do not use the ColPack objects above.
+    std::vector<int> m_colors;
+    // Variables in [m_block_begin, m_block_end) are in repeated blocks.
+    int m_block_begin = 0;
+    int m_block_end = 0;
+
     internal::UnsignedInt2DPtr m_sparsity_ADOLC_format;
 
     // This has dimensions num_variables x num_perturbation_directions. All